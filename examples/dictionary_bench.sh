@@ -0,0 +1,44 @@
+#!/bin/bash
+#
+# Compares the state dictionaries of the parallel exploration (-R) on the
+# example models: the Localization Table in its ASYNCHRONOUS, MIXTE and STATIC
+# modes, the shared lock-free hash table (-lockfree) and the tree compression
+# table (-tree).
+# For each run it prints the wall time, the number of states, the LT
+# collisions and the load distribution among threads (mean standard deviation
+# of the number of states per thread, see -stats).
+#
+# Usage: dictionary_bench.sh [-m mercury] [-t threads] [model.net ...]
+#
+
+MERCURY=../src/mercury
+THREADS=4
+while getopts "m:t:" opt; do
+    case $opt in
+        m) MERCURY=$OPTARG ;;
+        t) THREADS=$OPTARG ;;
+        *) echo "Usage: $0 [-m mercury] [-t threads] [model.net ...]"; exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+MODELS=${@:-"fms_4.net hanoi_12.net kanban_5.net ph_10.net frog_5_3.net"}
+
+CONFIGS=("-smode 0" "-smode 2" "-smode 3" "-lockfree" "-tree")
+NAMES=("ASYNCHRONOUS" "MIXTE" "STATIC" "LOCKFREE" "TREE")
+
+printf "%-16s %-14s %10s %10s %10s %8s\n" "model" "dictionary" "time(s)" \
+    "states" "collisions" "msd"
+for model in $MODELS; do
+    for i in "${!CONFIGS[@]}"; do
+        start=$(date +%s.%N)
+        out=$($MERCURY -th $THREADS ${CONFIGS[$i]} -stats $model 2>&1)
+        end=$(date +%s.%N)
+        states=$(echo "$out" | grep "#States:" | tail -1 | tr -dc '0-9')
+        collisions=$(echo "$out" | grep "#Collisions:" | tail -1 | tr -dc '0-9')
+        msd=$(echo "$out" | grep "#Mean Standard Deviation:" \
+            | sed 's/.*: *//')
+        printf "%-16s %-14s %10.2f %10s %10s %8s\n" "$model" "${NAMES[$i]}" \
+            $(awk "BEGIN {print $end - $start}") "${states:--}" \
+            "${collisions:--}" "${msd:--}"
+    done
+done
@@ -183,8 +183,9 @@ LocalizationTable * localization_table_with_tables_create(unsigned long size,
     for(j=0;j<number_of_tables;j++){
         pthread_mutex_init(&(lt->array_mutex_shared_stacks[j]), NULL);
     }
-    //Start a global mutex for configuration control.
+    //Start a global mutex and cond for configuration control.
     pthread_mutex_init(&(lt->mutex), NULL);
+    pthread_cond_init(&(lt->cond), NULL);
     //Return the lt structure
     return lt;
 }
@@ -299,11 +300,14 @@ extern int localization_table_search_and_insert_id(void *element,int id,
     uint32_t magic32 = id;    
     uint8_t magic8 = id;    
     LTAnswer flag_case = COLLISION;
+    //One wide hash, the keys are derived from it
+    HashWide wide;
+    (*lt->hash_function)(element, &wide);
     //Register for LT loop
     register int  i;
     for (i=0; i < lt->max_number_of_keys; i++) {
         //READ byte position from lt
-        hash = (*lt->hash_function)(element, i);
+        hash = hash_wide_k(&wide, i);
         local_hash = (hash & lt->mask);
         //With memoization key        
         if(lt->memoization==MEMOIZATION_ON){
@@ -461,6 +465,13 @@ extern int localization_table_search_and_insert_id(void *element,int id,
 
 }
 
+//Owner thread of an element for static tables
+static inline int _localization_table_owner(void *element, LocalizationTable *lt){
+    HashWide wide;
+    (*lt->hash_function)(element, &wide);
+    return (int) (hash_wide_k(&wide, 1) % (NUMBEROFTHREADS));
+}
+
 int localization_table_search_and_insert(void *element,int id,
         LocalizationTable *lt, void **return_element){
     assert(element && lt);
@@ -471,7 +482,7 @@ int localization_table_search_and_insert(void *element,int id,
     switch (lt->type){
         case STATIC:
         case MIXED_STATIC:
-            return_id = ((*lt->hash_function)(element, 1)) % (NUMBEROFTHREADS);
+            return_id = _localization_table_owner(element, lt);
             //Already assinged? Maybe is old...
             const int return_value = hash_table_search(element, lt->array_local_tables[return_id]);
             if(return_value > 0){
@@ -538,9 +549,8 @@ int localization_table_search_and_insert(void *element,int id,
                     pthread_mutex_lock(&(lt->array_mutex_shared_stacks[return_id]));
                     stack_in_place_push(lt->array_shared_stacks + return_id, element);
                     pthread_mutex_unlock(&(lt->array_mutex_shared_stacks[return_id]));
-                    //TODO: it is not right to have this cond_broadcast here, it is confusing
-                    if (idle_vector[return_id])
-                          pthread_cond_broadcast(&cond_sleep);
+                    //Wake up return_id if it is parked
+                    termination_notify_thread(&explorer_termination, return_id);
                     return 0;
                 case 1:
                     *return_element = hash_table_get(lt->array_local_tables[return_id]);
@@ -588,7 +598,7 @@ void * localization_table_search(void *element,int id,
     //Get id from LT
     switch (lt->type){
         case STATIC:
-            return_id = ((*lt->hash_function)(element, 1)) % (NUMBEROFTHREADS);
+            return_id = _localization_table_owner(element, lt);
             //Already assinged? Maybe is old...
             if(hash_table_force_search(element, lt->array_local_tables[return_id])){
                 return hash_table_get(lt->array_local_tables[return_id]);
@@ -797,6 +807,41 @@ long localization_table_overhead(LocalizationTable *lt){
     return (sizeof(LocalizationTable) + lt->mask*sizeof(uint8_t) + hash_table_overhead_value);
 }
 
+static ub8 _localization_table_bytes(LocalizationTable *lt){
+    switch (lt->slot_size){
+        case LT_2BYTE:
+            return (lt->mask+1)*2;
+        case LT_4BYTE:
+            return (lt->mask+1)*4;
+        default:
+            return lt->mask+1;
+    }
+}
+
+ub8 localization_table_dump(LocalizationTable *lt, FILE *file){
+    assert(lt && file);
+    ub8 header[2] = {lt->mask, (ub8) lt->slot_size};
+    ub8 bytes = _localization_table_bytes(lt);
+    errno = 0;
+    if(fwrite(header, sizeof(ub8), 2, file)!=2 
+            || fwrite(lt->table, sizeof(uint8_t), bytes, file)!=bytes)
+        ERRORMACRO("Localization Table: Unable to write the table");
+    return sizeof(header) + bytes;
+}
+
+void localization_table_load(LocalizationTable *lt, FILE *file){
+    assert(lt && file);
+    ub8 header[2];
+    ub8 bytes = _localization_table_bytes(lt);
+    errno = 0;
+    if(fread(header, sizeof(ub8), 2, file)!=2)
+        ERRORMACRO("Localization Table: Unable to read the table");
+    if(header[0]!=lt->mask || header[1]!=(ub8) lt->slot_size)
+        ERRORMACRO("Localization Table: The table read has a different size");
+    if(fread(lt->table, sizeof(uint8_t), bytes, file)!=bytes)
+        ERRORMACRO("Localization Table: Unable to read the table");
+}
+
 /*
  * //Iterate looking for an error over the tables
     void *item =NULL, *item_2 = NULL;
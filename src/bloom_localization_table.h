@@ -60,7 +60,11 @@
  * Localization Table Definition
  */
 
-typedef HashWord (*HashFunctionPointer)(void *element, int number);
+/**
+ * Hashes an element into a wide hash value. The probe keys, memoization bits
+ * and owner ids are derived from it (see hash_wide_k).
+ */
+typedef void (*HashFunctionPointer)(void *element, HashWide *wide);
 
 typedef enum LocalizationTableTypeEnum{ASYNCHRONOUS, SYNCHRONOUS, MIXTE, STATIC, MIXED_STATIC}LocalizationTableType;
 typedef enum LocalizationTableStatusEnum {READY, NOT_CONFIGURED}LocalizationTableStatus;
@@ -280,6 +284,23 @@ extern char * localization_table_type_to_string(int type);
  */
 extern long localization_table_overhead(LocalizationTable *lt);
 
+/**
+ * Writes the table of bytes to file (checkpoints). No thread may be 
+ * inserting in the table.
+ * @param lt a valid LocalizationTable reference
+ * @param file a file opened for writing
+ * @return the number of bytes written
+ */
+extern ub8 localization_table_dump(LocalizationTable *lt, FILE *file);
+
+/**
+ * Reads a table of bytes written by localization_table_dump. The table must 
+ * have been created with the same size and slot size.
+ * @param lt a valid LocalizationTable reference
+ * @param file a file opened for reading
+ */
+extern void localization_table_load(LocalizationTable *lt, FILE *file);
+
 
 #endif	/* _BLOOM_LT_H */
 
@@ -145,12 +145,15 @@ BPanswer bloom_probabilistic_search_and_insert(void *element,
     //Bloom Answer
     BPanswer flag_case = BP_NOT_PART_OF_THE_SET;
     
+    //One wide hash, the keys are derived from it
+    HashWide wide;
+    (*bp->hash_function)(element, &wide);
     //First hash is the golden hash
-    local_hash = (*bp->hash_function)(element, 0);
+    local_hash = hash_wide_k(&wide, 0);
     #if Mbit==32
         //2x32bit hash values = 64 bit
         HashWord local_hash_double;
-        local_hash_double = (*bp->hash_function)(element, 1);
+        local_hash_double = hash_wide_k(&wide, 1);
         //Jump first hash
         start_level = 1;
     #endif
@@ -241,13 +244,12 @@ BPanswer bloom_probabilistic_search_and_insert(void *element,
         for (i=0; i < bp->number_of_keys; i++) {
             //Get the hash - first level only
             if(level==0)
-                hash_values[i] = (*bp->hash_function)(element, i+ 1 + start_level);
+                hash_values[i] = hash_wide_k(&wide, i+ 1 + start_level);
             //If the hash is valid - for multiple levels
             if(hash_values[i]){
                 //If this key had not being inserted, try it
                 if(level>0)
-                    hash_values[i] =
-                            (*bp->hash_function)(element,
+                    hash_values[i] = hash_wide_k(&wide,
                                 level*(bp->number_of_keys) +i + 1+ start_level);
                 local_hash = (hash_values[i] & bp->bloom_array->mask);
                 //Try to write the hash piece (8bits) - Lock slot
@@ -54,7 +54,8 @@
 typedef enum BPanswer_enum{BP_NEW, BP_NEW_NOT_COUNT, BP_NEW_BUT_INCOMPLETE,
             BP_OLD, BP_NOT_PART_OF_THE_SET, BP_NOT_SURE}BPanswer;
 
-typedef HashWord (*BloomProbGetKey)(void *element, int number);
+//Wide hash of the element, the keys are derived with hash_wide_k
+typedef void (*BloomProbGetKey)(void *element, HashWide *wide);
 
 typedef struct BloomProbTableStruct{
     ub8 mask;
@@ -48,6 +48,7 @@
 #include "work_stealing.h"
 #include "petri_net.h"
 #include "reachgraph_parallel.h"
+#include "frontier.h"
 
 //Local Variables
 uint new_zero = 0;
@@ -73,6 +74,9 @@ const int share_when = 100;
 __thread long local_work = 1;
 __thread long share_work = 0;
 
+//Backward search by levels (-blevel)
+Frontier *backward_frontier = NULL;
+
 
 /*****************************************************************************/
 //Functions for local  Hash Table use
@@ -649,6 +653,12 @@ void checker_init_local(ModelChecker *checker, const Net *net){
     checker_net = net;
 }
 
+int checker_evaluate(Expression *exp, StateType *state, const Net *net,
+        int number_of_successors){
+    checker_net = net;
+    return _checker_evaluate_expression(exp, state, number_of_successors);
+}
+
 int checker_accept_state(StateType *state, int number_of_successors){
     assert(state);
     //Test state with search constraint
@@ -801,10 +811,92 @@ int checker_forward_search_proof_the_formula(){
         _checker_proof_or_disproof(1);
     //Create Work-stealing structure for backward search
     work_stealing_config(NUMBEROFTHREADS);
+    if(GRAPHMC==REVERSE_GRAPH && BACKWARDLEVEL){
+        frontier_free(backward_frontier);
+        backward_frontier = frontier_create();
+    }
     //Move to backward search
     return 0;
 }
 
+static inline FrontierChunk * _checker_frontier_add(FrontierChunk *chunk,
+        StateType *st){
+    if(chunk->size==FRONTIER_CHUNK){
+        frontier_publish(backward_frontier, chunk);
+        chunk = frontier_chunk_new();
+    }
+    chunk->states[chunk->size++] = state_arena_handle(st);
+    return chunk;
+}
+
+//Backward search of the reverse graph by levels (-blevel): the states whose
+//successors are all flagged form the next level. The threads share a level
+//by chunks, without stacks to lock or work to steal.
+static int _checker_backward_levels(){
+    FrontierChunk *out = frontier_chunk_new(), *in = NULL;
+    const StateHandle *father_list = NULL;
+    StateType *st = NULL, *top = NULL;
+    register ub4 i, j;
+
+    //First level: the accepted states
+    while(!stack_empty(checker_local->accepted_states)){
+        number_accepted++;
+        st = (StateType *) stack_pop(checker_local->accepted_states);
+        state_number_of_successors_set(st, 0);
+        out = _checker_frontier_add(out, st);
+    }
+    frontier_publish(backward_frontier, out);
+    out = frontier_chunk_new();
+
+    do{
+        //Barrier, the last thread moves to the next level
+        if(work_stealing_barrier(id)){
+            if(!frontier_next_level(backward_frontier))
+                //Fixpoint, the init state was not reached
+                _checker_stop_search();
+            work_stealing_broadcast();
+        }
+        while(!checker_is_over() && (in = frontier_claim(backward_frontier))){
+            for(j=0; j < in->size; j++){
+                st = (StateType *) state_arena_pointer(in->states[j]);
+                //Get list of fathers (predeccessors)
+                const ub4 fathers_size = state_link_get(st, &father_list);
+                for(i=0; i < fathers_size; i++){
+                    number_of_links++;
+                    top = (StateType *) state_arena_pointer(father_list[i]);
+                    //Decrease the number of successors for each father
+                    if(state_number_of_successors_get(top)
+                        && (state_number_of_successors_dec(top)==0)){
+                        number_of_zeros++;
+                        //Only one need to reach the initial state
+                        if (checker_local->branch_operator != MC_LEADSTO
+                            && state_compare(top, checker_local->init_state, checker_net)==0){
+                            frontier_chunk_free(in);
+                            frontier_chunk_free(out);
+                            //Finished
+                            _checker_stop_search();
+                            //Return true - Formula is true
+                            _checker_proof_or_disproof(1);
+                            work_stealing_broadcast();
+                            return 1;
+                        }
+                        //All sons are flaged, next level
+                        out = _checker_frontier_add(out, top);
+                    }
+                }
+            }
+            frontier_chunk_free(in);
+        }
+        //The rest of the level
+        if(out->size){
+            frontier_publish(backward_frontier, out);
+            out = frontier_chunk_new();
+        }
+    } while(!checker_is_over());
+    frontier_chunk_free(out);
+    return 0;
+}
+
 int checker_perform_backward_search(){
     //Backward search is only for: 
     //1)f =  A<> p
@@ -817,6 +909,23 @@ int checker_perform_backward_search(){
         return 0;
     }
 
+    if(GRAPHMC==REVERSE_GRAPH){
+        //Build the index of the reverse arcs logged by the forward search
+        state_link_count();
+        if(work_stealing_barrier(id)){
+            state_link_alloc();
+            work_stealing_broadcast();
+        }
+        state_link_place();
+        if(work_stealing_barrier(id)){
+            work_stealing_broadcast();
+        }
+        state_link_fill();
+        if(work_stealing_barrier(id)){
+            work_stealing_broadcast();
+        }
+    }
+
     //Test if there is at least one accepted state - should never happend
     //Test if it the foward search stoped at the init state
     if(!stack_empty(checker_local->accepted_states)
@@ -840,7 +949,10 @@ int checker_perform_backward_search(){
     local_stack = stack_init();
 
     local_work = 0;
-    if(GRAPHMC==REVERSE_GRAPH){
+    if(GRAPHMC==REVERSE_GRAPH && BACKWARDLEVEL){
+        if(_checker_backward_levels())
+            return 1;
+    }else if(GRAPHMC==REVERSE_GRAPH){
         //Perform a backward search over the new flagged states
         //1)Iterate over all accepted states from stack
         StateType *st =NULL;
@@ -848,7 +960,8 @@ int checker_perform_backward_search(){
         //Iterate
         //First, set to zero all accepted states
         //states for later iteration
-        StateType *father_list = NULL, *top = NULL;
+        const StateHandle *father_list = NULL;
+        StateType *top = NULL;
         while(!stack_empty(checker_local->accepted_states)){
             number_accepted++;
             st = (StateType *) stack_pop(checker_local->accepted_states);
@@ -859,7 +972,7 @@ int checker_perform_backward_search(){
         }
 
         //Barrier
-        if(work_stealing_barrier()){
+        if(work_stealing_barrier(id)){
             work_stealing_broadcast();
         }
 
@@ -871,17 +984,13 @@ int checker_perform_backward_search(){
                 //get state
                 st = (StateType *) stack_pop(local_stack);
                 //Get list of fathers (predeccessors)
-                const int fathers_size = state_link_get(st, &father_list);
-                register int i;
+                const ub4 fathers_size = state_link_get(st, &father_list);
+                register ub4 i;
                 //Try to flag fathers
                 for(i=0; i < fathers_size; i++){
                     number_of_links++;
                     //Get top (father)
-                    //TODO::REmove this condition from here
-                    if(fathers_size > 1)
-                        top =  (StateType *) *((StateType **) (father_list + i*sizeof(StateType **)));
-                    else
-                        top = (StateType *) (father_list);
+                    top = (StateType *) state_arena_pointer(father_list[i]);
                     //Decrease the number of successors for each father
                     if(state_number_of_successors_get(top)
                         && (state_number_of_successors_dec(top)==0)){
@@ -909,12 +1018,14 @@ int checker_perform_backward_search(){
                             //Test if there is someone idle
                             if(bool_work_to_share)
                                 //I have some work to share, wake him up
-                                work_stealing_wake_up();
+                                work_stealing_wake_up(id);
                             
                         }
                         else{
                             work_stealing_share_work(local_stack, share_when, id);
                             local_work -= share_when;
+                            //some work to share, wake one thief up
+                            work_stealing_wake_up(id);
                         }    
                     } 
                 }
@@ -924,7 +1035,7 @@ int checker_perform_backward_search(){
                 local_work = work_stealing_get_work(local_stack, id);
                 if(stack_empty(local_stack)){
                     //Wait for work
-                    if(work_stealing_wait_for_work()){
+                    if(work_stealing_wait_for_work(id)){
                         //Finished
                         _checker_stop_search();
                         //Wake up everybody
@@ -960,7 +1071,7 @@ int checker_perform_backward_search(){
         }
 
         //Barrier
-        if(work_stealing_barrier()){
+        if(work_stealing_barrier(id)){
             work_stealing_broadcast();
         }
 
@@ -1006,14 +1117,14 @@ int checker_perform_backward_search(){
                                 //Test if there is someone idle
                                 if(bool_work_to_share)
                                     //I have some work to share, wake him up
-                                    work_stealing_wake_up();
+                                    work_stealing_wake_up(id);
 
                             }
                             else{
                                 work_stealing_share_work(local_stack, share_when, id);
                                 local_work -= share_when;
                                 //some work to share, wake him up
-                                work_stealing_wake_up();
+                                work_stealing_wake_up(id);
                             }
                             //Flag ???
                             //state_flag_set(top);
@@ -1025,7 +1136,7 @@ int checker_perform_backward_search(){
                 local_work = work_stealing_get_work(local_stack, id);
                 if(stack_empty(local_stack)){
                     //Wait for work
-                    if(work_stealing_wait_for_work()){
+                    if(work_stealing_wait_for_work(id)){
                         //Finished
                         _checker_stop_search();
                         //Wake up
@@ -1062,7 +1173,7 @@ int checker_perform_backward_search(){
         }
 
         //Barrier
-        if(work_stealing_barrier()){
+        if(work_stealing_barrier(id)){
             work_stealing_broadcast();
         }
            
@@ -1105,12 +1216,14 @@ int checker_perform_backward_search(){
                                 //Test if there is someone idle
                                 if(bool_work_to_share)
                                     //I have some work to share, wake him up
-                                    work_stealing_wake_up();
+                                    work_stealing_wake_up(id);
 
                             }
                             else{
                                 work_stealing_share_work(local_stack, share_when, id);
                                 local_work -= share_when;
+                                //some work to share, wake one thief up
+                                work_stealing_wake_up(id);
                             }
                         }/* else if(!links){
                             work_found++;
@@ -1188,7 +1301,7 @@ int checker_perform_backward_search(){
                 }             
                
                 //Wait for work
-                if(stack_empty(local_stack) && work_stealing_wait_for_work()){                    
+                if(stack_empty(local_stack) && work_stealing_wait_for_work(id)){                    
                     _checker_set_wait_state();
                     /*if(!new_zero)
                         //End Checker
@@ -1254,7 +1367,7 @@ int checker_perform_backward_search(){
                             else if(wait_to_end)
                                 _checker_wait_to_stop();                       
                     
-                        if(work_stealing_barrier()){
+                        if(work_stealing_barrier(id)){
                            if(*(checker_local->state) == MC_WAIT){
                                 //Finished - Last thread to park
                                 //Stop the search (threr is no cycle)
@@ -1277,7 +1390,7 @@ int checker_perform_backward_search(){
 
    if(checker_local->branch_operator == MC_LEADSTO){
         //Check if all p1 are followed by p2
-        //work_stealing_barrier();
+        //work_stealing_barrier(id);
         StateType *ss=NULL;
         while(!stack_empty(checker_local->control_states)){
             ss = stack_pop(checker_local->control_states);
@@ -1326,7 +1439,7 @@ void checker_get_couter_example(){
                 }
                 if(stack_empty(local_stack)){
                     //No work fount, Park and Wait for work
-                    if(work_stealing_wait_for_work())
+                    if(work_stealing_wait_for_work(id))
                         //Finished - Last thread to park
                         //Stop the search (threr is no cycle)
                         _checker_stop_search();
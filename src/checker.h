@@ -152,6 +152,18 @@ extern void checker_init_local(ModelChecker *checker, const Net *net);
 
 extern int checker_accept_state(StateType *state, int number_of_successors);
 
+/*
+ * Evaluates an atomic proposition (expression of the formula) on a state,
+ * outside of the CTL search. It is used by the LTL model checker.
+ * @param exp An expression of the parsed formula
+ * @param state A State Structure
+ * @param net The local copy of the net
+ * @param number_of_successors For dead property
+ * @return the value of the expression
+ */
+extern int checker_evaluate(Expression *exp, StateType *state, const Net *net,
+        int number_of_successors);
+
 
 /*
  * Set the number of successors for not constrainted states. It is useful
@@ -45,22 +45,24 @@
 #include "collisions_partition.h"
 #include "partition.h"
 #include "stack_partition.h"
-#include "avl.h"
 #include "state.h"
 #include "disc_access.h"
 #include "atomic_interface.h"
 #include "state_cache.h"
+#include "work_deque.h"
 
 //#define STATE_PER_COLLISION_PARTITION 52428//16384
 //#define STATE_PER_COLLISION_BITS 16
 
-__thread CollisionsByPartitionNode* _cp_node_at_time;
+//Smallest log buffer, grown by doubling up to STATEPERCOLLISIONPARTITION
+#define COLLISION_LOG_START 64
 
-__thread AvlType* _cp_local_tree = NULL;  
+//Logs of collisions of the thread, indexed by partition
+__thread CollisionLog* _cp_logs = NULL;
 
-__thread HashTable* _cp_table_of_collisions;
+__thread HashTable* _cp_table_of_new_states;
 
-__thread HashTable* _cp_table;
+__thread HashTable** _cp_table;
 
 __thread PartitionTable* _cp_partition;
 
@@ -72,8 +74,21 @@ __thread int _write_cleaning_size;
 
 __thread CacheTable * _cache;
 
+//Collision resolution tasks, one deque per thread
+WorkDequeType** _cp_tasks = NULL;
+
+int _cp_number_of_tasks_deques = 0;
+
 unsigned int _number_write_times=0;
 
+unsigned int _number_reads_skipped=0;
+
+unsigned int _number_writes_skipped=0;
+
+unsigned int _number_tasks=0;
+
+unsigned int _number_tasks_stolen=0;
+
 /******************************************************************************/
 //For Hash Table use
 static int _cp_state_hash_table_compare(void *item_table, void *item_new){
@@ -94,90 +109,155 @@ static void _cp_state_hash_table_free(void *item){
 }
 
 /******************************************************************************/
-//For Avl tree use
-int _compare_collision_in_avl(DataHolder collision1, 
-        DataHolder collision2){
-    CollisionsByPartitionNode* c1 = (CollisionsByPartitionNode *) collision1;
-    CollisionsByPartitionNode* c2 = (CollisionsByPartitionNode *) collision2;
-    if(c1->partition > c2->partition)
-        return 1;
-    if(c1->partition < c2->partition)
-        return -1;
-    return 0;
-}
+//Private functions
 
-int _compare_collision_key_in_avl(DataHolder collision1, 
-        DataHolder i){
-    CollisionsByPartitionNode* c1 = (CollisionsByPartitionNode *) collision1;
-    int * c2 = (int *) i;
-    if(c1->partition > *c2)
-        return 1;
-    if(c1->partition < *c2)
-        return -1;
-    return 0;
+//Inserts the states accepted before the partition of states was read
+static int _cp_merge_new_states(){
+    StateType * temp_state = NULL;
+    int inserted = 0;
+    hash_table_reset_iterator(_cp_table_of_new_states);
+    temp_state = hash_table_iterate_next(_cp_table_of_new_states);
+    while(temp_state!=NULL){
+        inserted += hash_table_insert(temp_state, *_cp_table) ? 1 : 0;
+        temp_state = hash_table_iterate_next(_cp_table_of_new_states);
+    }
+    hash_table_reset(_cp_table_of_new_states);
+    return inserted;
 }
 
-/******************************************************************************/
-//Private functions
-
 void _check_collisions(int p, int c){ 
     //Local Temp state
     StateType * temp_state = NULL; 
-    hash_table_reset(_cp_table_of_collisions); 
-    hash_table_reset(_cp_table);
-    int count = c;
+    hash_table_reset(_cp_table_of_new_states);
+    hash_table_reset(*_cp_table);
+    int count = c, size = state_size();
     if(count == 0)
         count = partition_get_write_number_collision(_cp_partition, p);
     _interface_atomic_add_uint(&_number_write_times, count);               
-    if(count > 0) {
-        if(partition_get(_cp_partition, p, _cp_table, PARTITION_OF_STATES)){        
-           while(count > 0){
-               if(partition_get(_cp_partition, p, _cp_table_of_collisions, PARTITION_OF_COLLISIONS, count)){
-                   hash_table_reset_iterator(_cp_table_of_collisions);
-                   temp_state = hash_table_iterate_next(_cp_table_of_collisions);
-                    while(temp_state!=NULL){  
-                        //collisions_processed_tls--;
-                        if(hash_table_insert(temp_state, _cp_table)){ 
-                            //states_processed_tls++;   
-                            stack_partition_push(_cp_stack,temp_state);
-                        }
-                        temp_state = hash_table_iterate_next(_cp_table_of_collisions);
-                    } 
-                    hash_table_reset(_cp_table_of_collisions);                                      
-               } else {
-                   break;
-               }
-               count--;
+    //The partition of states is read at the first collision that its summary
+    //does not rule out. Before that, collisions are new states.
+    int loaded = 0, inserted = 0;
+    while(count > 0){
+        int i, log_count = 0;
+        ub1 *log = partition_get_log(_cp_partition, p, count, &log_count);
+        for(i=0; log!=NULL && i < log_count; i++){
+            temp_state = (StateType *) (log + ((ub8) i)*size);
+            if(!loaded && partition_summary_test(_cp_partition, p, temp_state)){
+                if(!partition_get(_cp_partition, p, *_cp_table, PARTITION_OF_STATES))
+                    return;
+                inserted = _cp_merge_new_states();
+                loaded = 1;
+            }
+            if(loaded){
+                if(hash_table_insert(temp_state, *_cp_table)){
+                    stack_partition_push(_cp_stack,temp_state);
+                    inserted++;
+                }
+            } else if(hash_table_insert(temp_state, _cp_table_of_new_states)){
+                stack_partition_push(_cp_stack,temp_state);
+                if(_cp_table_of_new_states->count > STATEPERCOLLISIONPARTITION){
+                    partition_append_states(_cp_partition, p, _cp_table_of_new_states);
+                    hash_table_reset(_cp_table_of_new_states);
+                }
             }
-            partition_write(_cp_partition, p, _cp_table, PARTITION_OF_STATES);
-            hash_table_reset(_cp_table);
-        } /*else {
-            ERRORMACRO("Unable to start collision resolution");
-        }*/
+        } 
+        //A missing write number was read by an earlier cleaning or is
+        //still being handed to the I/O threads: keep going with the
+        //older ones
+        count--;
     }
-    
+    //A partition without new states is still valid on disc
+    if(loaded && inserted > 0)
+        partition_write_async(_cp_partition, p, _cp_table, PARTITION_OF_STATES);
+    else if(loaded)
+        _interface_atomic_inc_uint(&_number_writes_skipped);
+    else if(_cp_table_of_new_states->count > 0){
+        partition_append_states(_cp_partition, p, _cp_table_of_new_states);
+        hash_table_reset(_cp_table_of_new_states);
+        _interface_atomic_inc_uint(&_number_reads_skipped);
+    }
+}
+
+//Appends the log to the partition of collisions and returns its write number
+static int _write_collision(int partition){
+    CollisionLog *log = _cp_logs + partition;
+    if(log->count==0)
+        return 0;
+    int write_times = partition_get_new_write_number_collision(_cp_partition, partition);
+    partition_write_log_async(_cp_partition, partition, log->states, log->count, write_times);
+    log->count = 0;
+    return write_times;
+}
+
+static void _cp_log_grow(CollisionLog *log){
+    int capacity = (log->capacity==0) ? COLLISION_LOG_START : 2*log->capacity;
+    if(capacity > STATEPERCOLLISIONPARTITION)
+        capacity = STATEPERCOLLISIONPARTITION;
+    errno = 0;
+    log->states = (ub1 *) realloc(log->states, ((ub8) capacity)*state_size());
+    if(log->states==NULL || errno)
+        ERRORMACRO("collision_partition_insert: Impossible to grow the log of collisions");
+    log->capacity = capacity;
 }
 
-void _write_collision (DataHolder node){     
-    CollisionsByPartitionNode* c = (CollisionsByPartitionNode* ) node;
-    if(c->table->count>0){
-        int write_times = partition_get_new_write_number_collision(_cp_partition, c->partition);
-        partition_write(_cp_partition, c->partition, c->table, PARTITION_OF_COLLISIONS, write_times);
+//Takes the next task: own deque first, then the deques of the others
+static int _cp_next_task(int id){
+    void *task = work_deque_pop(_cp_tasks[id]);
+    if(task!=NULL)
+        return (int) (long) task;
+    int i, busy = 1;
+    while(busy){
+        busy = 0;
+        for(i=1; i < _cp_number_of_tasks_deques; i++){
+            WorkDequeType *victim = _cp_tasks[(id + i) % _cp_number_of_tasks_deques];
+            if(work_deque_empty(victim))
+                continue;
+            busy = 1;
+            task = work_deque_steal(victim);
+            if(task!=NULL){
+                _interface_atomic_inc_uint(&_number_tasks_stolen);
+                return (int) (long) task;
+            }
+        }
     }
-    hash_table_reset(c->table);
+    return 0;
+}
+
+typedef struct CollisionTaskStruct{
+    int partition;
+    ub8 weight;
+}CollisionTask;
+
+static int _cp_compare_tasks(const void *t1, const void *t2){
+    ub8 w1 = ((const CollisionTask *) t1)->weight;
+    ub8 w2 = ((const CollisionTask *) t2)->weight;
+    if(w1 > w2)
+        return -1;
+    if(w1 < w2)
+        return 1;
+    return ((const CollisionTask *) t1)->partition - ((const CollisionTask *) t2)->partition;
 }
 
 
 /******************************************************************************/
 //Public functions
 
-void collision_partition_init(HashTable* table, PartitionTable* partition, 
+void collision_partition_init(HashTable** table, PartitionTable* partition, 
         StackPartition* stack, Net* net){
     assert(stack!=NULL && table != NULL && partition != NULL && net!=NULL);
     _cp_stack = stack;
     _cp_table = table;
+    //States the partition summaries ruled out
+    hash_table_create(HASH_TABLE_IN_PLACE, COLLISIONTABLESIZE,
+                    &_cp_table_of_new_states, &_cp_state_hash_table_compare,
+                    &_cp_state_hash_table_get_key, &_cp_state_hash_table_free,
+                     state_size());
     _cp_partition = partition;    
     _cp_local_net = net;
+    errno = 0;
+    _cp_logs = (CollisionLog *) calloc(partition->lock_table_size + 1, sizeof(CollisionLog));
+    if(_cp_logs==NULL || errno)
+        ERRORMACRO("collision_partition_init: Impossible to create the logs of collisions");
     _write_cleaning_size = ((int) pow(2,(TABLESIZE - COLLISIONTABLESIZE + 2)));//4 times bigger
     if(STATECACHEFORCOLLISION){
         _cache = cache_table_create(TABLESIZE, state_size(),
@@ -187,80 +267,112 @@ void collision_partition_init(HashTable* table, PartitionTable* partition,
 }
 
 void collision_partition_insert(StateType *state, int partition, int current_partition){
-    if(STATECACHEFORCOLLISION && cache_table_test_and_insert(state, _cache)){
+    if(STATECACHEFORCOLLISION && cache_table_test_and_insert(state, _cache))
         return;
-    } else  if(_cp_local_tree==NULL){  
-        CollisionsByPartitionNode * node = NULL;
-        node = (CollisionsByPartitionNode *) malloc(sizeof(CollisionsByPartitionNode));
-        hash_table_create(HASH_TABLE_IN_PLACE, COLLISIONTABLESIZE,
-                        &(node->table), &_cp_state_hash_table_compare,
-                        &_cp_state_hash_table_get_key, &_cp_state_hash_table_free,
-                         state_size()); 
-        hash_table_insert(state, node->table);
-        //Table used for collision check
-        _cp_table_of_collisions = node->table;
-        //collisions_processed_tls++;
-        node->partition = partition;
-        _cp_local_tree = avl_init(node);
-    } else {
-        CollisionsByPartitionNode * node = avl_lookup(_cp_local_tree, &partition, &_compare_collision_key_in_avl);
-        if(node!=NULL){ 
-            if(hash_table_insert(state, node->table))
-                //collisions_processed_tls++;
-            if(node->table->count > STATEPERCOLLISIONPARTITION){
-                int write_times = partition_get_new_write_number_collision(_cp_partition, partition);
-                //fprintf(stdout, " Write time %d for partition %d\n", node->write_times, partition);
-                partition_write(_cp_partition, partition, node->table, PARTITION_OF_COLLISIONS, write_times);
-                if(DISCCOLLISIONASYNC && (write_times % (_write_cleaning_size)) == 0){
-                    //check if locked
-                    if(partition_try_lock(_cp_partition, partition)){
-                        _cp_table_of_collisions = node->table; 
-                        //Solve some collisions
-                        //Save partition of states        
-                        partition_force_lock(_cp_partition, current_partition);
-                        WARNINGMACRO(" Partition lock due to high number of collisions");
-                        partition_write(_cp_partition, current_partition, _cp_table, PARTITION_OF_STATES);
-                        _check_collisions(node->partition, write_times);
-                        //Recover partition of states;
-                        partition_get(_cp_partition, current_partition, _cp_table, PARTITION_OF_STATES);
-                        WARNINGMACRO(" Partition unlock");
-                        _interface_atomic_inc_uint(&_number_write_times);
-                        //partition_release(_cp_partition, current_partition);     
-                        partition_close(_cp_partition, current_partition);     
-                        partition_release(_cp_partition, partition);
-                    }   else {
-                        WARNINGMACRO(" Partition still closed");
-                    }
-                } 
-                hash_table_reset(node->table);
-            }
-        } else {
-            CollisionsByPartitionNode * node = NULL;
-            node = (CollisionsByPartitionNode *) malloc(sizeof(CollisionsByPartitionNode));
-            hash_table_create(HASH_TABLE_IN_PLACE, COLLISIONTABLESIZE,
-                            &(node->table), &_cp_state_hash_table_compare,
-                            &_cp_state_hash_table_get_key, &_cp_state_hash_table_free,
-                             state_size()); 
-            hash_table_insert(state, node->table);
-            //collisions_processed_tls++;
-            node->partition = partition;
-            avl_search_insert(&_cp_local_tree, node, &_compare_collision_in_avl, NULL);
+    CollisionLog *log = _cp_logs + partition;
+    if(log->count==log->capacity)
+        _cp_log_grow(log);
+    memcpy(log->states + ((ub8) log->count)*state_size(), state, state_size());
+    log->count++;
+    if(log->count < STATEPERCOLLISIONPARTITION)
+        return;
+    int write_times = _write_collision(partition);
+    if(DISCCOLLISIONASYNC && (write_times % (_write_cleaning_size)) == 0){
+        //check if locked
+        if(partition_try_lock(_cp_partition, partition)){
+            //Solve some collisions
+            //Save partition of states        
+            partition_force_lock(_cp_partition, current_partition);
+            WARNINGMACRO(" Partition lock due to high number of collisions");
+            partition_write(_cp_partition, current_partition, *_cp_table, PARTITION_OF_STATES);
+            _check_collisions(partition, write_times);
+            //Recover partition of states;
+            partition_get(_cp_partition, current_partition, *_cp_table, PARTITION_OF_STATES);
+            WARNINGMACRO(" Partition unlock");
+            _interface_atomic_inc_uint(&_number_write_times);
+            //partition_release(_cp_partition, current_partition);     
+            partition_close(_cp_partition, current_partition);     
+            partition_release(_cp_partition, partition);
+        }   else {
+            WARNINGMACRO(" Partition still closed");
         }
-    }
+    } 
 } 
 
+void collision_partition_save_collisions(){
+    long p;
+    for(p=0; p <= _cp_partition->last_number && p <= _cp_partition->lock_table_size; p++)
+        _write_collision(p);
+}
+
+int collision_partition_release_logs(){
+    int released = 0;
+    long p;
+    for(p=0; p <= _cp_partition->lock_table_size; p++){
+        CollisionLog *log = _cp_logs + p;
+        if(log->states!=NULL && log->count==0){
+            free(log->states);
+            log->states = NULL;
+            log->capacity = 0;
+            released++;
+        }
+    }
+    return released;
+}
 
-void collision_partition_iterate_collisions(){    
-    int partition = partition_get_next_collision_partition_number(_cp_partition);
+void collision_partition_schedule(int number_of_threads, int sequential){
+    assert(_cp_partition!=NULL && number_of_threads > 0);
+    int i;
+    if(_cp_tasks==NULL){
+        _cp_tasks = (WorkDequeType **) malloc(number_of_threads*sizeof(WorkDequeType *));
+        if(_cp_tasks==NULL)
+            ERRORMACRO("collision_partition_schedule: Impossible to create the task deques");
+        for(i=0; i < number_of_threads; i++)
+            _cp_tasks[i] = work_deque_init();
+        _cp_number_of_tasks_deques = number_of_threads;
+    }
+    //The logs still queued must be on disc to be weighted
+    partition_table_sync(_cp_partition);
+    long p, last = _cp_partition->last_number;
+    if(last > _cp_partition->lock_table_size)
+        last = _cp_partition->lock_table_size;
+    CollisionTask *tasks = (CollisionTask *) malloc((last + 1)*sizeof(CollisionTask));
+    if(tasks==NULL)
+        ERRORMACRO("collision_partition_schedule: Impossible to create the tasks");
+    int count = 0;
+    for(p=1; p <= last; p++)
+        if(partition_get_write_number_collision(_cp_partition, p) > 0){
+            tasks[count].partition = p;
+            tasks[count].weight = partition_log_size(_cp_partition, p);
+            count++;
+        }
+    qsort(tasks, count, sizeof(CollisionTask), &_cp_compare_tasks);
+    //The heaviest tasks are dealt round robin and pushed last, so that each
+    //owner pops them first. The owners are waiting at the barrier.
+    int deques = sequential ? 1 : number_of_threads;
+    for(i=count - 1; i >= 0; i--)
+        work_deque_push(_cp_tasks[i % deques], (void *) (long) tasks[i].partition);
+    _interface_atomic_add_uint(&_number_tasks, count);
+    free(tasks);
+}
+
+int collision_partition_resolve(int id){
+    assert(_cp_tasks!=NULL && id < _cp_number_of_tasks_deques);
+    int resolved = 0;
+    int partition = _cp_next_task(id);
     while(partition!=0){
+        //One task ahead, read while the current one is resolved
+        int next = _cp_next_task(id);
+        if(next!=0){
+            partition_prefetch(_cp_partition, next, PARTITION_OF_STATES);
+            partition_prefetch(_cp_partition, next, PARTITION_OF_COLLISIONS);
+        }
         _check_collisions(partition, 0);
         partition_set_write_number_collision_to_zero(_cp_partition, partition);
-        partition = partition_get_next_collision_partition_number(_cp_partition);
-    }    
-}
-
-void collision_partition_save_collisions(){
-    avl_app(_cp_local_tree, &_write_collision);
+        resolved++;
+        partition = next;
+    }
+    return resolved;
 }
 
 void collision_partition_stats(PartitionTable* partition){
@@ -270,5 +382,8 @@ void collision_partition_stats(PartitionTable* partition){
     fprintf(stdout, "\n\tCollision Stats:\t");
     fprintf(stdout, "\n\tNumber of partitions cleaned:\t~ %ud", _number_write_times);
     fprintf(stdout, "\n\tNumber of collisions:\t~ %ud", _number_write_times*((int) pow(2,(TABLESIZE - COLLISIONTABLESIZE + 2))));
+    fprintf(stdout, "\n\tPartitions of states not read:\t %u", _number_reads_skipped);
+    fprintf(stdout, "\n\tPartitions of states not rewritten:\t %u", _number_writes_skipped);
+    fprintf(stdout, "\n\tCollision tasks:\t %u (%u stolen)", _number_tasks, _number_tasks_stolen);
     fflush(stdout);
 }
@@ -31,7 +31,12 @@
  * 
  * @section DESCRIPTION
  *
- * TODO
+ * Collisions of the disc based exploration: states found by a thread that 
+ * belong to another partition. Each thread appends them to a log per 
+ * partition, written to disc when full or at the end of a round. The 
+ * collision resolution is a set of tasks, one per partition with logs, that
+ * the threads take from work stealing deques: the partition of states is
+ * loaded once and the logs of all threads are checked against it.
  *
  */
 
@@ -46,21 +51,54 @@
 #include "petri_net.h"
 
 
-typedef struct CollisionsByPartitionNodeStruct{
-    HashTable * table;
-    int partition;
-}CollisionsByPartitionNode;
+/**
+ * Log of collisions of one partition, not written yet. States are appended
+ * as they come, duplicates are dropped when the log is resolved.
+ */
+typedef struct CollisionLogStruct{
+    ub1 * states;
+    int count;
+    int capacity;
+}CollisionLog;
 
-extern void collision_partition_init(HashTable* table, PartitionTable* partition,
+/**
+ * Sets the thread context of the collision resolution.
+ * @param table Reference to the thread table of states. Asynchronous writes
+ * replace the table, so the reference is kept instead of the table.
+ */
+extern void collision_partition_init(HashTable** table, PartitionTable* partition,
         StackPartition* stack, Net* net);
 
 extern void collision_partition_insert(StateType *state, int partition, 
         int current_partition);
 
-extern void collision_partition_iterate_collisions();
-
+/**
+ * Writes the logs of collisions of the thread that are not empty.
+ */
 extern void collision_partition_save_collisions();
 
+/**
+ * Releases the buffers of the empty logs of the thread, after 
+ * collision_partition_save_collisions (memory budget).
+ * @return the number of buffers released
+ */
+extern int collision_partition_release_logs();
+
+/**
+ * Creates a task for each partition with logs of collisions, the heaviest
+ * (bytes of logs) first. Called by a single thread while the others wait at a
+ * barrier.
+ * @param sequential all tasks are given to the thread 0
+ */
+extern void collision_partition_schedule(int number_of_threads, int sequential);
+
+/**
+ * Resolves the tasks of the thread, then steals the tasks of the others 
+ * until none is left.
+ * @return the number of partitions resolved
+ */
+extern int collision_partition_resolve(int id);
+
 extern void collision_partition_stats(PartitionTable* partition);
 
 
@@ -97,6 +97,8 @@ extern int REJECTCOLLISIONS;
 extern int ENABLECTLMC;
 extern char *CTLFORMULA;
 extern int GRAPHMC;
+extern int BACKWARDLEVEL;
+extern int LTLMC;
 extern void /*<Formula>*/ *FORMULA_MC;
 
 /*Hash Table Size*/
@@ -123,6 +125,8 @@ void _print_mc_graph_choose(){
     switch (GRAPHMC){
         case REVERSE_GRAPH:
             fprintf(stdout, " Reverse Graph");
+            if(BACKWARDLEVEL)
+                fprintf(stdout, " (levels)");
             break;
         case PARENTAL_GRAPH:
             fprintf(stdout, " Parental Graph");
@@ -191,7 +195,12 @@ void _command_mode_name(){
     multiset_set_type(); //BUG:Avoid problems with multiset type
     switch (MODE){
         case MR:
-            fprintf(stdout, "-R Localization Table with Local hash Tables running on %d threads", NUMBEROFTHREADS);
+            if(DICTIONARY == HASH_TABLE_LOCKFREE)
+                fprintf(stdout, "-R Lock-free shared hash Table running on %d threads", NUMBEROFTHREADS);
+            else if(DICTIONARY == TREE_COMPRESSION)
+                fprintf(stdout, "-R Tree compression Table running on %d threads", NUMBEROFTHREADS);
+            else
+                fprintf(stdout, "-R Localization Table with Local hash Tables running on %d threads", NUMBEROFTHREADS);
             break;
         default:
             fprintf(stdout, "Unknow");
@@ -229,7 +238,26 @@ void _command_mode_name(){
                 fprintf(stdout, "\n \t Hash Size:\t  \t \t %d \t", GLOBALTABLESIZE);
                 break;
             }        
+            case HASH_TABLE_LOCKFREE:{
+                fprintf(stdout, "\n Lock-free Hash table Configuration:\t\t\t");
+                fprintf(stdout, "\n \t Architecture:\t  \t \t %d \t", bit);
+                fprintf(stdout, "\n \t Hash Size:\t  \t \t %d \t", GLOBALTABLESIZE);
+                break;
+            }
+            case TREE_COMPRESSION:{
+                fprintf(stdout, "\n Tree compression table Configuration:\t\t\t");
+                fprintf(stdout, "\n \t Architecture:\t  \t \t %d \t", bit);
+                fprintf(stdout, "\n \t Root table Size:\t \t %d \t", GLOBALTABLESIZE);
+                break;
+            }
             case PARTITION_SSD:
+                if(DISCBFS){
+                    fprintf(stdout, "\n Disk BFS Configuration:\t\t\t");
+                    fprintf(stdout, "\n \t Architecture:\t  \t \t %d \t", bit);
+                    fprintf(stdout, "\n \t Number of buckets:\t \t %d \t\t", NUMBEROFPARTITIONS);
+                    fprintf(stdout, "\n \t Spill buffers Size:\t \t %d \t", HASHSIZE);
+                    break;
+                }
             case LOCALIZATION_TABLE:{
                 fprintf(stdout, "\n Localization Table Configuration:\t\t\t");
                 fprintf(stdout, "\n \t Architecture:\t  \t \t %d \t", bit);
@@ -244,7 +272,14 @@ void _command_mode_name(){
                     fprintf(stdout, "\n \t Collision Table:\t \t \t %d\t\t", COLLISIONTABLESIZE);
                     if(DISCCOLLISIONASYNC)
                         fprintf(stdout, "\n \t Collision Mode :\t Async \t\t");
-                }
+                    fprintf(stdout, "\n \t I/O threads:\t \t %d\t\t", DISCIOTHREADS);
+                    if(CHECKPOINTDIR)
+                        fprintf(stdout, "\n \t %s:\t \t %s\t\t", 
+                                RESUME ? "Resume from" : "Checkpoints", CHECKPOINTDIR);
+                    if(MEMBUDGET > 0)
+                        fprintf(stdout, "\n \t Memory budget:\t \t %.2f GiB\t", MEMBUDGET);
+                } else if(MEMSPILL > 0)
+                    fprintf(stdout, "\n \t Spill to disc past:\t \t %.2f GiB\t", MEMSPILL);
                 break;
             }
             case PROBABILIST:{
@@ -300,14 +335,16 @@ void _command_mode_name(){
         fprintf(stdout, "\n \t Number of threads:\t \t %d \t", thr);
         fprintf(stdout, "\n \t Share Work Load:\t \t %f \t", wl);
         fprintf(stdout, "\n \t Min Private Work Load: \t %d \t", pw);
-        if(DICTIONARY!=PARTITION_SSD && DICTIONARY!=HASH_TABLE_TBB){
+        if(DICTIONARY!=PARTITION_SSD && DICTIONARY!=HASH_TABLE_TBB
+                && DICTIONARY!=HASH_TABLE_LOCKFREE && DICTIONARY!=TREE_COMPRESSION){
             if(ADAPTATIVEWORKLOAD)
                 fprintf(stdout, "\n \t Adptative Work Load:\t \t YES \t");
             else
                 fprintf(stdout, "\n \t Adptative Work Load:\t \t NO \t");
             fprintf(stdout, "\n \t Sync Mode: \t \t \t %s \t", localization_table_type_to_string(SYNCMODE ));
         }
-        if(DICTIONARY!=HASH_TABLE_TBB)
+        if(DICTIONARY!=HASH_TABLE_TBB && DICTIONARY!=HASH_TABLE_LOCKFREE
+                && DICTIONARY!=TREE_COMPRESSION)
                 fprintf(stdout, "\n \t Local Hash Table address space: %.d bits \t", TABLESIZE);
     }
     //Memory Configurations
@@ -372,14 +409,16 @@ void command_mode(){
 }
 
 void command_model_checker(){
-    fprintf(stdout, "\n CTL MC:\t\t\t");
+    fprintf(stdout, LTLMC ? "\n LTL MC:\t\t\t" : "\n CTL MC:\t\t\t");
     fprintf(stdout, "\n \t Model Checking: \t\t enabled\t");
     fprintf(stdout, "\n \t Formula: \t\t\t");
     fprintf(stdout, "\n \t \t Text: \t\t \t  %s \t", CTLFORMULA);
     fprintf(stdout, "\n \t \t Parsed: \t\t ");
     logic_print_formula((Formula *) FORMULA_MC);
-    fprintf(stdout, "\n \t \t Graph Type: \t\t ");
-    _print_mc_graph_choose();
+    if(!LTLMC){
+        fprintf(stdout, "\n \t \t Graph Type: \t\t ");
+        _print_mc_graph_choose();
+    }
     fprintf(stdout, "\n");
 }
 
@@ -406,6 +445,14 @@ void _command_help(){
     fprintf(stdout, "-b 0    marking is an vector of bits  (max 1 token)    \n");
     fprintf(stdout, "-b 1    marking is an vector of chars (max 125 tokens) \n");
     fprintf(stdout, "-b 2    marking is an linked list                      \n");
+    fprintf(stdout, "transition enabling:                                   1\n");
+    fprintf(stdout, "-guard 0      linked list of conditions                \n");
+    fprintf(stdout, "-guard 1      compiled guards                          \n");
+    fprintf(stdout, "-guard 2      compiled guards, SIMD (AVX2) if available\n");
+    fprintf(stdout, "-guard_bench  benchmark of the enabling checkers       \n");
+    fprintf(stdout, "state hashing:                                         1\n");
+    fprintf(stdout, "-hash 0       hash driver (lookup3/lookup8/Murmur)     \n");
+    fprintf(stdout, "-hash 1       incremental, from the parent state       \n");
     #ifdef TESTING_VERSION
     fprintf(stdout, "parallel configurations for Localization Table:        0\n");
     fprintf(stdout, "-smode 0      ASYNCHRONOUS                             \n");
@@ -415,6 +462,8 @@ void _command_help(){
     fprintf(stdout, "-smode 4      MIXTE_STATIC                             \n");
     #endif
     fprintf(stdout, "-th n         number of threads                        2\n");
+    fprintf(stdout, "-lockfree     shared lock-free hash table (size -Hts)  \n");
+    fprintf(stdout, "-tree         shared tree compression table (size -Hts)  \n");
     fprintf(stdout, "bloom configurations:                                  \n");
     fprintf(stdout, "-bls n        Bloom Filter Size in bits                32\n");
     fprintf(stdout, "-blk n        Number of Bloom Keys                     8\n");
@@ -430,14 +479,28 @@ void _command_help(){
     //fprintf(stdout, "-bdc     n    Size difference(in bits) in cascade      1\n");
     fprintf(stdout, "-bcache       Enabled State Caching for Probabilistic   \n");
     fprintf(stdout, "              and Disk mode                             \n");
+    fprintf(stdout, "disk mode (-disc):                                      \n");
+    fprintf(stdout, "-disc_io n    partition I/O threads (0: synchronous)   1\n");
+    fprintf(stdout, "-disc_bfs     breadth first, delayed duplicate detection\n");
+    fprintf(stdout, "              (spill buffers size -bls)                 \n");
+    fprintf(stdout, "-checkpoint d checkpoint every round in directory d     \n");
+    fprintf(stdout, "-resume d     resume from the checkpoint in directory d \n");
+    fprintf(stdout, "              (same options as the checkpointed run)    \n");
+    fprintf(stdout, "-mem_budget g memory budget of -disc in GiB (or MiB: gM),\n");
+    fprintf(stdout, "              sizes partitions, collision tables, stacks\n");
     //fprintf(stdout, "-baprox  n    approximate number of keys                \n");
     //fprintf(stdout, "-bifp         ignore false positive states              \n");
     fprintf(stdout, "Memory configurations:                                  \n");
     fprintf(stdout, "-Hts n        Global Hash Table Size in bits          25\n");
     fprintf(stdout, "              Force smode 2 (Mixted)                    \n");
+    fprintf(stdout, "-mem_spill g  spill the local tables to disc past g GiB\n");
+    fprintf(stdout, "              resident (or MiB: gM)                     \n");
+    fprintf(stdout, "-malloc       allocate states with malloc, not with the\n");
+    fprintf(stdout, "              thread arenas (ignored by -f -graph 0)    \n");
     //fprintf(stdout, "-hts n        Local Hash Table Size in bits           25\n");
     fprintf(stdout, "-sc n (0|1|2|3) State Compression                      0\n");
     fprintf(stdout, "    0:No_Compression  1:Huffman  2:RLE                  \n");
+    fprintf(stdout, "    -disc: sorted delta encoded partitions (n > 0)      \n");
     fprintf(stdout, "-align         Force state memory alignment             \n");
     fprintf(stdout, "Work Load Sharing Options:                              \n");
     fprintf(stdout, "-adp          Adaptative work load enabled              \n");
@@ -445,6 +508,9 @@ void _command_help(){
     fprintf(stdout, "-f 'formula'  Enable ctl mchecking for the given formula\n");
     fprintf(stdout, "-graph (0|1)  Type of graph                             \n");
     fprintf(stdout, "    0:Reverse  1:Parental  2:No Graph Relations         \n");
+    fprintf(stdout, "-blevel       backward search by levels (-graph 0)      \n");
+    fprintf(stdout, "LTL model Checking:\n");
+    fprintf(stdout, "-ltl 'formula' on-the-fly ltl mchecking (nested dfs)    \n");
     fprintf(stdout, "input net format flags:                                 \n");
     fprintf(stdout, "-NET          textual net input                     -TPN\n");
     fprintf(stdout, "-TTS          textual net input with data (.so)         \n");
@@ -575,7 +641,10 @@ void command_parse(int argc, char** argv){
             "-e", "-mec", "-alt", "-k", "-ktz", "-NET","-th","-blk","-bls","-smode",/*26*/
             "-hts","-sc","-adp","-bchances","-bdc","-bcache","-baprox","-bifp","-f","-brc",/*36*/
             "-graph", "-aprox", "-b", "-Hts", "-onetable", "-hc", "-hs","-disc", /*44*/
-            "-disc_sequential", "-disc_async", "-disc_factor", "-tbb", "-disc_cl_sequential"};/*49*/
+            "-disc_sequential", "-disc_async", "-disc_factor", "-tbb", "-disc_cl_sequential",/*49*/
+            "-guard", "-guard_bench", "-hash", "-lockfree",
+            "-tree", "-disc_io", "-disc_bfs", "-checkpoint", "-resume", "-mem_budget",
+            "-mem_spill", "-malloc", "-blevel", "-ltl"};/*63*/
             unsigned int id = _command_s_(argv[j], comp_commands);
             switch (id){
                 case 1:/*-h*/
@@ -685,6 +754,7 @@ void command_parse(int argc, char** argv){
                     bool_get_next_arg = 1;
                     bool_arg_string_case = 35;
                     ENABLECTLMC =1;
+                    LTLMC = 0;
                     break;
                 case 36: /*For Probabilistic -brc: ignore collisions*/
                     bool_get_next_arg = 0;
@@ -787,6 +857,74 @@ void command_parse(int argc, char** argv){
                     bool_get_next_arg = 0;
                     bool_arg_string_case = 49;    
                     break;
+                case 50: /*-guard n => transition enabling checker*/
+                    bool_get_next_arg = 1;
+                    bool_arg_string_case = 50;
+                    break;
+                case 51: /*-guard_bench => enabling checkers benchmark*/
+                    GUARDBENCH = 1;
+                    bool_get_next_arg = 0;
+                    bool_arg_string_case = 51;
+                    break;
+                case 52: /*-hash n => state hashing*/
+                    bool_get_next_arg = 1;
+                    bool_arg_string_case = 52;
+                    break;
+                case 53: /*-lockfree => shared lock-free hash table*/
+                    DICTIONARY = HASH_TABLE_LOCKFREE;
+                    bool_get_next_arg = 0;
+                    bool_arg_string_case = 53;
+                    break;
+                case 54: /*-tree => shared tree compression table*/
+                    DICTIONARY = TREE_COMPRESSION;
+                    bool_get_next_arg = 0;
+                    bool_arg_string_case = 54;
+                    break;
+                case 55: /*-disc_io n => number of partition I/O threads*/
+                    bool_get_next_arg = 1;
+                    bool_arg_string_case = 55;
+                    break;
+                case 56: /*-disc_bfs => breadth first, delayed duplicate detection*/
+                    bool_get_next_arg = 0;
+                    bool_arg_string_case = 56;
+                    DICTIONARY = PARTITION_SSD;
+                    DICTIONARYSTATEDATA = PARTITION_SSD;
+                    GRAPHMC = NO_GRAPH;
+                    ENABLECTLMC = 0;
+                    DISCBFS = 1;
+                    break;
+                case 57: /*-checkpoint dir => checkpoints of the disc exploration*/
+                    bool_get_next_arg = 1;
+                    bool_arg_string_case = 57;
+                    break;
+                case 58: /*-resume dir => resume from the checkpoint in dir*/
+                    bool_get_next_arg = 1;
+                    bool_arg_string_case = 58;
+                    break;
+                case 59: /*-mem_budget g => size the disc exploration from g GiB*/
+                    bool_get_next_arg = 1;
+                    bool_arg_string_case = 59;
+                    break;
+                case 60: /*-mem_spill g => spill the local tables past g GiB*/
+                    bool_get_next_arg = 1;
+                    bool_arg_string_case = 60;
+                    break;
+                case 61: /*-malloc => states allocated by malloc, not by arenas*/
+                    STATEARENA = 0;
+                    bool_get_next_arg = 0;
+                    bool_arg_string_case = 61;
+                    break;
+                case 62: /*-blevel => backward search by levels*/
+                    BACKWARDLEVEL = 1;
+                    bool_get_next_arg = 0;
+                    bool_arg_string_case = 62;
+                    break;
+                case 63: /*-ltl => LTL model checking*/
+                    bool_get_next_arg = 1;
+                    bool_arg_string_case = 63;
+                    LTLMC = 1;
+                    ENABLECTLMC = 0;
+                    break;
                 default:
                     command_banner();
                     fprintf(stdout, "Error: bad command line");
@@ -1007,6 +1145,96 @@ void command_parse(int argc, char** argv){
                     bool_get_next_arg = 0;
                     break;
                }
+               case 50:{ /*-guard*/
+                   switch ((int) atoi(argv[j])){
+                       case 0:
+                           GUARDTYPE = GUARD_LIST;
+                           break;
+                       case 1:
+                           GUARDTYPE = GUARD_COMPILED;
+                           break;
+                       case 2:
+                           GUARDTYPE = GUARD_SIMD;
+                           break;
+                       default:
+                        fprintf(stdout, "Error: bad command line -guard ");
+                        _command_usage_print();
+                        exit(EXIT_SUCCESS);
+                   }
+                   bool_get_next_arg = 0;
+                   break;
+               }
+               case 55:{ /*-disc_io*/
+                    DISCIOTHREADS = (int) atoi(argv[j]);
+                    if(DISCIOTHREADS < 0 || DISCIOTHREADS > MAX_NUMBER_OF_THREADS){
+                       fprintf(stdout, "Error: Number of I/O threads must be between 0 and %d\n", MAX_NUMBER_OF_THREADS);
+                       fprintf(stdout, "Error: bad command line\n");
+                       _command_usage_print();
+                       exit(EXIT_SUCCESS);
+                    }
+                    bool_get_next_arg = 0;
+                    break;
+               }
+               case 57: /*-checkpoint*/
+               case 58:{ /*-resume*/
+                   CHECKPOINTDIR = (char *) malloc((strlen(argv[j]) + 1)*sizeof(char));
+                   strcpy(CHECKPOINTDIR, argv[j]);
+                   RESUME = (bool_arg_string_case == 58);
+                   bool_get_next_arg = 0;
+                   break;
+               }
+               case 59:{ /*-mem_budget*/
+                    //GiB, or MiB with the suffix M (a dot is taken as a file)
+                    char *unit = NULL;
+                    MEMBUDGET = strtod(argv[j], &unit);
+                    if(unit && (*unit=='M' || *unit=='m'))
+                        MEMBUDGET = MEMBUDGET/1024;
+                    if(MEMBUDGET <= 0){
+                       fprintf(stdout, "Error: The memory budget must be a positive number of GiB\n");
+                       fprintf(stdout, "Error: bad command line\n");
+                       _command_usage_print();
+                       exit(EXIT_SUCCESS);
+                    }
+                    bool_get_next_arg = 0;
+                    break;
+               }
+               case 60:{ /*-mem_spill*/
+                    //GiB, or MiB with the suffix M (a dot is taken as a file)
+                    char *unit = NULL;
+                    MEMSPILL = strtod(argv[j], &unit);
+                    if(unit && (*unit=='M' || *unit=='m'))
+                        MEMSPILL = MEMSPILL/1024;
+                    if(MEMSPILL <= 0){
+                       fprintf(stdout, "Error: The spill threshold must be a positive number of GiB\n");
+                       fprintf(stdout, "Error: bad command line\n");
+                       _command_usage_print();
+                       exit(EXIT_SUCCESS);
+                    }
+                    bool_get_next_arg = 0;
+                    break;
+               }
+               case 63:{ /*-ltl*/
+                   CTLFORMULA = (char *) malloc((strlen(argv[j]) + 1)*sizeof(char));
+                   strcpy(CTLFORMULA, argv[j]);
+                   bool_get_next_arg = 0;
+                   break;
+               }
+               case 52:{ /*-hash*/
+                   switch ((int) atoi(argv[j])){
+                       case 0:
+                           HASHMODE = HASH_DRIVER;
+                           break;
+                       case 1:
+                           HASHMODE = HASH_INCREMENTAL;
+                           break;
+                       default:
+                        fprintf(stdout, "Error: bad command line -hash ");
+                        _command_usage_print();
+                        exit(EXIT_SUCCESS);
+                   }
+                   bool_get_next_arg = 0;
+                   break;
+               }
                default:
                     command_banner();
                     fprintf(stdout, "Error: bad command line");
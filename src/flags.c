@@ -72,6 +72,11 @@ long int BLOOMSIZE = BLOOM_SIZE;
 DicType DICTIONARY = LOCALIZATION_TABLE;
 DicType DICTIONARYSTATEDATA = LOCALIZATION_TABLE;
 MultType MULTITYPESET = MULTI_ARRAY;
+/*Transition enabling checker - default is the compiled guard program*/
+GuardType GUARDTYPE = GUARD_COMPILED;
+int GUARDBENCH = 0;
+/*State hashing - default is the hash driver (lookup3/lookup8/Murmur)*/
+HashMode HASHMODE = HASH_DRIVER;
 /*Sync mode - default is MIXTE, old was ASYNCHRONOUS (0)*/
 int SYNCMODE = 2;
 
@@ -96,11 +101,20 @@ int REJECTCOLLISIONS = REJECT_COLLISIONS;
 int NUMBEROFPARTITIONS = MAX_PARTITION_SLOTS;
 int DISCMEMORYFACTOR= DISC_MEMORY_FACTOR;
 int DISCCLSEQUENTIAL= 0;
+int DISCIOTHREADS= DISC_IO_THREADS;
+int DISCBFS= 0;
+char *CHECKPOINTDIR = NULL;
+int RESUME = 0;
+double MEMBUDGET = 0;
+double MEMSPILL = 0;
+int STATEARENA = 1;
 
 //For CTL Model Checking
 int ENABLECTLMC = ENABLE_CTL_MC;
 char *CTLFORMULA = NULL;
 int GRAPHMC = REVERSE_GRAPH;
+int BACKWARDLEVEL = 0;
+int LTLMC = 0;
 void /*<Formula>*/ *FORMULA_MC = NULL;
 
 /*State compression*/
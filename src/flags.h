@@ -297,6 +297,7 @@
 #define DISC_PARALLEL_SEQUENTIAL 0 
 #define DISC_COLLISION_ASYNC 0
 #define DISC_MEMORY_FACTOR 2
+#define DISC_IO_THREADS 1
 #define STATE_PER_PARTITION 50000//65536
 #define STATE_PER_PARTITION_BITS 20 //19
 #define STATE_PER_COLLISION_PARTITION 52000//16384
@@ -408,6 +409,25 @@ extern DicType DICTIONARYSTATEDATA;
  */
 extern MultType MULTITYPESET; 
 
+/**
+ * Transition enabling checker: linked list of conditions (GUARD_LIST), compiled
+ * guard program (GUARD_COMPILED) or its vectorised checker (GUARD_SIMD).
+ * Compiled guards are only used by vector markings (multiset array).
+ */
+extern GuardType GUARDTYPE;
+
+/**
+ * Runs the enabling checkers micro-benchmark instead of the exploration
+ */
+extern int GUARDBENCH;
+
+/**
+ * State hashing: full hash of the marking with the hash driver (HASH_DRIVER)
+ * or incremental hash derived from the parent state (HASH_INCREMENTAL). The
+ * incremental hash is only used by vector markings without data or compression.
+ */
+extern HashMode HASHMODE;
+
 /*
  * For Probabilistic bloom
  * Number of chances per slot
@@ -452,6 +472,15 @@ extern int ENABLECTLMC;
  * The default is the reverse graph.
  */
 extern int GRAPHMC;
+/**
+ * Backward search of the reverse graph by levels, all threads on the same
+ * level (-blevel). The default is the depth-first search with work stealing.
+ */
+extern int BACKWARDLEVEL;
+/**
+ * On-the-fly LTL model checking of the formula (-ltl), see reachgraph_ltl.h.
+ */
+extern int LTLMC;
 extern char *CTLFORMULA;
 
 /**
@@ -567,6 +596,19 @@ extern int STATEPERCOLLISIONPARTITION;
 extern int COLLISIONTABLESIZE;
 extern int NUMBEROFPARTITIONS;
 extern int DISCCLSEQUENTIAL;
+extern int DISCIOTHREADS;
+extern int DISCBFS;
+//Checkpoints of -disc are written to this directory (-checkpoint, -resume)
+extern char *CHECKPOINTDIR;
+extern int RESUME;
+//Memory budget of -disc in GiB, 0 for the fixed sizes (-mem_budget)
+extern double MEMBUDGET;
+//Resident memory in GiB past which the local tables spill to disc, 0 to 
+//never spill (-mem_spill)
+extern double MEMSPILL;
+//States of the Localization Table are allocated from per-thread arenas, 0 for
+//malloc (-malloc)
+extern int STATEARENA;
 
 /**
  * File input.
@@ -0,0 +1,131 @@
+/*
+ * File:    frontier.c
+ * Author:  Rodrigo Tacla Saad
+ * Email:   rodrigo.tacla.saad@gmail.com
+ * Company: LAAS-CNRS / Vertics
+ * Created  on October 18, 2026, 11:20 PM
+ *
+ * LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * DESCRIPTION
+ *
+ * Chunked frontier of a level-synchronous search. See frontier.h
+ */
+
+#include "reset_define_includes.h"
+#define ASSERTLIB
+#define STDLIB
+#define ERRORLIB
+#define STDIOLIB
+#define PTHREADLIB
+#include "frontier.h"
+#include "atomic_interface.h"
+
+//Initial number of chunks of a level
+#define FRONTIER_CAPACITY 64
+
+Frontier * frontier_create(){
+    Frontier *frontier = (Frontier *) calloc(1, sizeof(Frontier));
+    if(frontier==NULL)
+        ERRORMACRO(" frontier: Impossible to create the frontier\n");
+    frontier->level_capacity = FRONTIER_CAPACITY;
+    frontier->next_capacity = FRONTIER_CAPACITY;
+    frontier->level = (FrontierChunk **) malloc(FRONTIER_CAPACITY*sizeof(FrontierChunk *));
+    frontier->next = (FrontierChunk **) malloc(FRONTIER_CAPACITY*sizeof(FrontierChunk *));
+    if(frontier->level==NULL || frontier->next==NULL)
+        ERRORMACRO(" frontier: Impossible to create the frontier\n");
+    pthread_mutex_init(&frontier->mutex, NULL);
+    return frontier;
+}
+
+FrontierChunk * frontier_chunk_new(){
+    FrontierChunk *chunk = (FrontierChunk *) malloc(sizeof(FrontierChunk));
+    if(chunk==NULL)
+        ERRORMACRO(" frontier: Impossible to create a new chunk\n");
+    chunk->size = 0;
+    return chunk;
+}
+
+void frontier_chunk_free(FrontierChunk *chunk){
+    free(chunk);
+}
+
+void frontier_publish(Frontier *frontier, FrontierChunk *chunk){
+    assert(frontier && chunk);
+    if(chunk->size==0){
+        free(chunk);
+        return;
+    }
+    pthread_mutex_lock(&frontier->mutex);
+    if(frontier->next_size==frontier->next_capacity){
+        //The level being processed is not touched, it is read by the others
+        FrontierChunk **next = (FrontierChunk **) realloc(frontier->next,
+                2*frontier->next_capacity*sizeof(FrontierChunk *));
+        if(next==NULL)
+            ERRORMACRO(" frontier: Impossible to extend the frontier\n");
+        frontier->next = next;
+        frontier->next_capacity *= 2;
+    }
+    frontier->next[frontier->next_size++] = chunk;
+    pthread_mutex_unlock(&frontier->mutex);
+}
+
+FrontierChunk * frontier_claim(Frontier *frontier){
+    assert(frontier);
+    if(frontier->level_claimed >= frontier->level_size)
+        return NULL;
+    const ub8 claimed = _interface_atomic_add_64(&frontier->level_claimed, 1);
+    if(claimed >= frontier->level_size)
+        return NULL;
+    return frontier->level[claimed];
+}
+
+ub8 frontier_next_level(Frontier *frontier){
+    assert(frontier);
+    //Chunks not claimed are lost: only when the search stops
+    while(frontier->level_claimed < frontier->level_size)
+        free(frontier->level[frontier->level_claimed++]);
+    FrontierChunk **level = frontier->level;
+    const ub8 capacity = frontier->level_capacity;
+    frontier->level = frontier->next;
+    frontier->level_capacity = frontier->next_capacity;
+    frontier->level_size = frontier->next_size;
+    frontier->level_claimed = 0;
+    frontier->next = level;
+    frontier->next_capacity = capacity;
+    frontier->next_size = 0;
+    return frontier->level_size;
+}
+
+void frontier_free(Frontier *frontier){
+    if(frontier==NULL)
+        return;
+    frontier_next_level(frontier);
+    frontier_next_level(frontier);
+    free(frontier->level);
+    free(frontier->next);
+    pthread_mutex_destroy(&frontier->mutex);
+    free(frontier);
+}
@@ -0,0 +1,107 @@
+/**
+ * @file        frontier.h
+ * @author      Rodrigo Tacla Saad
+ * @email       rodrigo.tacla.saad@gmail.com
+ * @company:    LAAS-CNRS / Vertics
+ * @created     on October 18, 2026, 11:20 PM
+ *
+ * @section LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Chunked frontier of a level-synchronous search. The states of a level are
+ * kept by chunks of handles: a thread fills its own chunk without lock and
+ * publishes it to the next level when full (one lock per chunk). Once all 
+ * threads are done with a level, one of them moves the chunks published to
+ * the level being processed (frontier_next_level), the threads then claim its
+ * chunks with an atomic counter.
+ *
+ */
+
+#ifndef _FRONTIER_H
+#define	_FRONTIER_H
+
+#include "standard_includes.h"
+#include "state_arena.h"
+
+//States per chunk
+#define FRONTIER_CHUNK 4096
+
+typedef struct FrontierChunkStruct{
+    ub4 size;
+    StateHandle states[FRONTIER_CHUNK];
+}FrontierChunk;
+
+typedef struct FrontierStruct{
+    FrontierChunk **level;              //Chunks of the level being processed
+    ub8 level_size;
+    ub8 level_capacity;
+    volatile ub8 level_claimed;         //Next chunk to claim
+    FrontierChunk **next;               //Chunks published for the next level
+    ub8 next_size;
+    ub8 next_capacity;
+    pthread_mutex_t mutex;
+}Frontier;
+
+/**
+ * Creates an empty frontier.
+ */
+extern Frontier * frontier_create();
+
+/**
+ * Returns a new empty chunk, owned by the calling thread until published.
+ */
+extern FrontierChunk * frontier_chunk_new();
+
+/**
+ * Releases a chunk claimed from the frontier.
+ */
+extern void frontier_chunk_free(FrontierChunk *chunk);
+
+/**
+ * Publishes a chunk for the next level, released if empty. The caller gives
+ * the chunk up.
+ */
+extern void frontier_publish(Frontier *frontier, FrontierChunk *chunk);
+
+/**
+ * Claims the next chunk of the level being processed.
+ * @return the chunk, NULL if all chunks are claimed
+ */
+extern FrontierChunk * frontier_claim(Frontier *frontier);
+
+/**
+ * Moves the chunks published to the level to process. Called by one thread, 
+ * when no other thread uses the frontier.
+ * @return number of chunks of the new level, 0 at the fixpoint
+ */
+extern ub8 frontier_next_level(Frontier *frontier);
+
+/**
+ * Releases the frontier and its chunks.
+ */
+extern void frontier_free(Frontier *frontier);
+
+#endif	/* _FRONTIER_H */
@@ -0,0 +1,263 @@
+/*
+ * File:    guard.c
+ * Author:  Rodrigo Tacla Saad
+ * Email:   rodrigo.tacla.saad@gmail.com
+ * Company: LAAS-CNRS / Vertics
+ * Created  on October 18, 2026, 5:10 PM
+ *
+ * LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * DESCRIPTION
+ *
+ * Compiled guard program for transition enabling. The firing conditions of a
+ * net (linked lists of LL/LH nodes, see multiset.h) are flattened at load time
+ * into contiguous arrays (structure of arrays): for each condition the place
+ * and the interval [lower, upper) its marking must belong to. Transitions are
+ * contiguous ranges of conditions. Two checkers are provided over vector
+ * markings (one char per place): a scalar one and a vectorised one (AVX2
+ * gather and compare) that tests eight conditions at a time. The latter is
+ * only used when the processor supports it.
+ */
+
+#include "reset_define_includes.h"
+#define ASSERTLIB
+#define STDLIB
+#define ERRORLIB
+#define STRINGLIB
+#include "guard.h"
+
+#include <limits.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #include <immintrin.h>
+    #define GUARD_AVX2 1
+#endif
+
+//Per thread buffers of the vectorised checker: marking widened to ints and
+//one result bit per condition
+__thread int *guard_marking = NULL;
+__thread unsigned int *guard_bits = NULL;
+__thread int guard_buffers_places = 0;
+__thread int guard_buffers_conditions = 0;
+
+static int _guard_padded(int conditions){
+    return ((conditions + GUARD_LANES - 1) / GUARD_LANES) * GUARD_LANES;
+}
+
+static GuardProgramType * _guard_new(int transitions, int conditions, int places){
+    errno = 0;
+    GuardProgramType *guard = (GuardProgramType *) malloc(sizeof(GuardProgramType));
+    if(!guard || errno != 0){
+        ERRORMACRO(" guard: Impossible to create the guard program\n");
+    }
+    const int padded = _guard_padded(conditions);
+    guard->transitions = transitions;
+    guard->conditions = conditions;
+    guard->places = places;
+    guard->offset = (int *) malloc((transitions + 1)*sizeof(int));
+    guard->place = (int *) malloc((padded + 1)*sizeof(int));
+    guard->lower = (int *) malloc((padded + 1)*sizeof(int));
+    guard->upper = (int *) malloc((padded + 1)*sizeof(int));
+    if(!guard->offset || !guard->place || !guard->lower || !guard->upper
+            || errno != 0){
+        ERRORMACRO(" guard: Impossible to create the guard program\n");
+    }
+    return guard;
+}
+
+GuardProgramType * guard_compile(const VectorType *trans_cond, int places){
+    assert(trans_cond && places > 0);
+    const int transitions = trans_cond->size;
+    register int t, i = 0;
+    //Count conditions, the list ends at the first node that is neither LL
+    //nor LH (see marking_enabled_transitions)
+    const ConditionType *cc;
+    for(t = 0; t < transitions; t++){
+        cc = (const ConditionType *) trans_cond->vector[t];
+        while(cc != NULL && (cc->condition_type == LL || cc->condition_type == LH)){
+            i++;
+            cc = cc->link;
+        }
+    }
+    GuardProgramType *guard = _guard_new(transitions, i, places);
+    i = 0;
+    for(t = 0; t < transitions; t++){
+        guard->offset[t] = i;
+        cc = (const ConditionType *) trans_cond->vector[t];
+        while(cc != NULL && (cc->condition_type == LL || cc->condition_type == LH)){
+            if(cc->condition_type == LL){
+                guard->place[i] = cc->condition.ll.place;
+                guard->lower[i] = cc->condition.ll.weight;
+                guard->upper[i] = INT_MAX;
+            } else {
+                guard->place[i] = cc->condition.lh.place;
+                guard->lower[i] = cc->condition.lh.weight_great_than;
+                guard->upper[i] = cc->condition.lh.weight_smaller_than;
+            }
+            i++;
+            cc = cc->link;
+        }
+    }
+    guard->offset[transitions] = i;
+    //Padding, always true
+    for(; i < _guard_padded(guard->conditions); i++){
+        guard->place[i] = 0;
+        guard->lower[i] = INT_MIN;
+        guard->upper[i] = INT_MAX;
+    }
+    return guard;
+}
+
+GuardProgramType * guard_copy(const GuardProgramType *guard){
+    assert(guard);
+    GuardProgramType *new = _guard_new(guard->transitions, guard->conditions,
+            guard->places);
+    const int padded = _guard_padded(guard->conditions);
+    memcpy(new->offset, guard->offset, (guard->transitions + 1)*sizeof(int));
+    memcpy(new->place, guard->place, padded*sizeof(int));
+    memcpy(new->lower, guard->lower, padded*sizeof(int));
+    memcpy(new->upper, guard->upper, padded*sizeof(int));
+    return new;
+}
+
+void guard_free(GuardProgramType *guard){
+    if(!guard)
+        return;
+    free(guard->offset);
+    free(guard->place);
+    free(guard->lower);
+    free(guard->upper);
+    free(guard);
+}
+
+int guard_simd_supported(){
+#ifdef GUARD_AVX2
+    static int supported = -1;
+    if(supported < 0)
+        supported = __builtin_cpu_supports("avx2") ? 1 : 0;
+    return supported;
+#else
+    return 0;
+#endif
+}
+
+static int _guard_enabled_transitions_scalar(StackInteger *stack,
+        const char *m, const GuardProgramType *guard){
+    register int t, size = 0;
+    for(t = 0; t < guard->transitions; t++){
+        if(guard_transition_enabled(m, guard, t)){
+            stack_int_push(stack, t);
+            size++;
+        }
+    }
+    return size;
+}
+
+#ifdef GUARD_AVX2
+static void _guard_buffers(const GuardProgramType *guard){
+    if(guard_buffers_places < guard->places){
+        free(guard_marking);
+        errno = 0;
+        guard_marking = (int *) malloc(guard->places*sizeof(int));
+        if(!guard_marking || errno != 0){
+            ERRORMACRO(" guard: Impossible to create the marking buffer\n");
+        }
+        guard_buffers_places = guard->places;
+    }
+    if(guard_buffers_conditions < guard->conditions + 1){
+        free(guard_bits);
+        errno = 0;
+        guard_bits = (unsigned int *) malloc(
+                (_guard_padded(guard->conditions) / 32 + 2)*sizeof(unsigned int));
+        if(!guard_bits || errno != 0){
+            ERRORMACRO(" guard: Impossible to create the result buffer\n");
+        }
+        guard_buffers_conditions = guard->conditions + 1;
+    }
+}
+
+//Tests if the bits [from, to) are all set
+static inline int _guard_all_set(const unsigned int *bits, int from, int to){
+    while(from < to){
+        const int word = from >> 5, bit = from & 31;
+        const int n = MINMACRO(32 - bit, to - from);
+        const unsigned int mask = (n == 32) ? 0xffffffffu
+                : (((1u << n) - 1) << bit);
+        if((bits[word] & mask) != mask)
+            return 0;
+        from += n;
+    }
+    return 1;
+}
+
+__attribute__((target("avx2")))
+static int _guard_enabled_transitions_avx2(StackInteger *stack,
+        const char *m, const GuardProgramType *guard){
+    register int i, t, size = 0;
+    _guard_buffers(guard);
+    int *wm = guard_marking;
+    unsigned char *bytes = (unsigned char *) guard_bits;
+    //Widen the marking (sign extension of chars)
+    for(i = 0; i + 16 <= guard->places; i += 16){
+        __m128i c = _mm_loadu_si128((const __m128i *) (m + i));
+        _mm256_storeu_si256((__m256i *) (wm + i), _mm256_cvtepi8_epi32(c));
+        _mm256_storeu_si256((__m256i *) (wm + i + 8),
+                _mm256_cvtepi8_epi32(_mm_srli_si128(c, 8)));
+    }
+    for(; i < guard->places; i++)
+        wm[i] = m[i];
+    //Gather and compare, eight conditions at once
+    const int padded = _guard_padded(guard->conditions);
+    for(i = 0; i < padded; i += GUARD_LANES){
+        __m256i p = _mm256_loadu_si256((const __m256i *) (guard->place + i));
+        __m256i w = _mm256_i32gather_epi32(wm, p, 4);
+        __m256i lo = _mm256_loadu_si256((const __m256i *) (guard->lower + i));
+        __m256i hi = _mm256_loadu_si256((const __m256i *) (guard->upper + i));
+        //Fails if lower > w or w >= upper
+        __m256i ok = _mm256_andnot_si256(_mm256_cmpgt_epi32(lo, w),
+                _mm256_cmpgt_epi32(hi, w));
+        bytes[i / GUARD_LANES] = (unsigned char)
+                _mm256_movemask_ps(_mm256_castsi256_ps(ok));
+    }
+    //A transition is enabled if all its conditions hold
+    for(t = 0; t < guard->transitions; t++){
+        if(_guard_all_set(guard_bits, guard->offset[t], guard->offset[t + 1])){
+            stack_int_push(stack, t);
+            size++;
+        }
+    }
+    return size;
+}
+#endif
+
+int guard_enabled_transitions(StackInteger *stack, const char *m,
+        const GuardProgramType *guard, GuardType type){
+    assert(stack && m && guard);
+#ifdef GUARD_AVX2
+    if(type == GUARD_SIMD && guard_simd_supported())
+        return _guard_enabled_transitions_avx2(stack, m, guard);
+#endif
+    return _guard_enabled_transitions_scalar(stack, m, guard);
+}
@@ -0,0 +1,131 @@
+/**
+ * @file        guard.h
+ * @author      Rodrigo Tacla Saad
+ * @email       rodrigo.tacla.saad@gmail.com
+ * @company:    LAAS-CNRS / Vertics
+ * @created     on October 18, 2026, 5:10 PM
+ *
+ * @section LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Compiled guard program for transition enabling. The firing conditions of a
+ * net (linked lists of LL/LH nodes, see multiset.h) are flattened at load time
+ * into contiguous arrays (structure of arrays): for each condition the place
+ * and the interval [lower, upper) its marking must belong to. Transitions are
+ * contiguous ranges of conditions. Two checkers are provided over vector
+ * markings (one char per place): a scalar one and a vectorised one (AVX2
+ * gather and compare) that tests eight conditions at a time. The latter is
+ * only used when the processor supports it.
+ *
+ */
+
+#ifndef _GUARD_H
+#define	_GUARD_H
+
+#include "standard_includes.h"
+
+#include "vector.h"
+#include "stack.h"
+#include "multiset.h"
+
+/**
+ * Number of conditions tested at once by the vectorised checker. Condition
+ * arrays are padded to a multiple of it with conditions that always hold.
+ */
+#define GUARD_LANES 8
+
+/**
+ * Guard program. Conditions of transition t are in [offset[t], offset[t+1]),
+ * condition i holds iff lower[i] <= m[place[i]] < upper[i].
+ */
+typedef struct GuardProgramStruct{
+    int transitions;
+    int conditions;             //Without padding
+    int places;
+    int *offset;
+    int *place;
+    int *lower;
+    int *upper;
+}GuardProgramType;
+
+/**
+ * Compiles the firing conditions of a net.
+ * @param trans_cond Firing conditions <ConditionType>
+ * @param places Number of places
+ * @return Guard program
+ */
+extern GuardProgramType * guard_compile(const VectorType *trans_cond, int places);
+
+/**
+ * @param guard Guard program
+ * @return a copy of guard
+ */
+extern GuardProgramType * guard_copy(const GuardProgramType *guard);
+
+/**
+ * Release memory.
+ * @param guard Guard program
+ */
+extern void guard_free(GuardProgramType *guard);
+
+/**
+ * @return 1 if the vectorised checker can be used on this processor
+ */
+extern int guard_simd_supported();
+
+/**
+ * Tests the firing condition of a single transition.
+ * @param m Vector marking (one char per place)
+ * @param guard Guard program
+ * @param trans Transition index
+ * @return 1 if enabled
+ */
+static inline int guard_transition_enabled(const char *m,
+        const GuardProgramType *guard, int trans){
+    register int i;
+    const int end = guard->offset[trans + 1];
+    for(i = guard->offset[trans]; i < end; i++){
+        const int w = m[guard->place[i]];
+        if(w < guard->lower[i] || w >= guard->upper[i])
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * Pushes into stack the transitions enabled by m, in ascending order.
+ * @param stack Stack to store the enabled transitions
+ * @param m Vector marking (one char per place)
+ * @param guard Guard program
+ * @param type GUARD_COMPILED or GUARD_SIMD (falls back to GUARD_COMPILED if
+ *             not supported)
+ * @return number of enabled transitions
+ */
+extern int guard_enabled_transitions(StackInteger *stack, const char *m,
+        const GuardProgramType *guard, GuardType type);
+
+#endif	/* _GUARD_H */
+
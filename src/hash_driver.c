@@ -38,6 +38,7 @@
 
 
 #include "reset_define_includes.h"
+#define STRINGLIB
 #include "hash_driver.h"
 
 
@@ -143,3 +144,89 @@ HashWord hash_data_char(ub1 *key, size_t len, HashWord initval){
         return (MurmurHash64A(key, len, initval));
     #endif
 }
+
+/*64 bits finalizer from MurmurHash3: a bijection that only maps 0 to 0*/
+#define HASH_GOLDEN 0x9E3779B97F4A7C15ULL
+
+static inline ub8 _hash_fmix64(ub8 k){
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+static inline ub8 _hash_rotl64(ub8 x, int r){
+    return (x << r) | (x >> (64 - r));
+}
+
+void hash_data_wide_for_char(ub1 *key, size_t len, int arg_seed,
+        HashWide *wide){
+    const ub8 c1 = 0x87c37b91114253d5ULL;
+    const ub8 c2 = 0x4cf5ad432745937fULL;
+    const size_t nblocks = len / 16;
+    ub8 h1 = (ub8) hash_seed[arg_seed], h2 = (ub8) hash_seed[arg_seed];
+    ub8 k1, k2;
+    size_t i;
+    //Body
+    for (i = 0; i < nblocks; i++) {
+        memcpy(&k1, key + i*16, sizeof (ub8));
+        memcpy(&k2, key + i*16 + 8, sizeof (ub8));
+        k1 *= c1; k1 = _hash_rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = _hash_rotl64(h1, 27); h1 += h2; h1 = h1*5 + 0x52dce729;
+        k2 *= c2; k2 = _hash_rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = _hash_rotl64(h2, 31); h2 += h1; h2 = h2*5 + 0x38495ab5;
+    }
+    //Tail
+    const ub1 *tail = key + nblocks*16;
+    k1 = 0; k2 = 0;
+    switch (len & 15) {
+        case 15: k2 ^= ((ub8) tail[14]) << 48;
+        case 14: k2 ^= ((ub8) tail[13]) << 40;
+        case 13: k2 ^= ((ub8) tail[12]) << 32;
+        case 12: k2 ^= ((ub8) tail[11]) << 24;
+        case 11: k2 ^= ((ub8) tail[10]) << 16;
+        case 10: k2 ^= ((ub8) tail[ 9]) << 8;
+        case  9: k2 ^= ((ub8) tail[ 8]);
+            k2 *= c2; k2 = _hash_rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        case  8: k1 ^= ((ub8) tail[ 7]) << 56;
+        case  7: k1 ^= ((ub8) tail[ 6]) << 48;
+        case  6: k1 ^= ((ub8) tail[ 5]) << 40;
+        case  5: k1 ^= ((ub8) tail[ 4]) << 32;
+        case  4: k1 ^= ((ub8) tail[ 3]) << 24;
+        case  3: k1 ^= ((ub8) tail[ 2]) << 16;
+        case  2: k1 ^= ((ub8) tail[ 1]) << 8;
+        case  1: k1 ^= ((ub8) tail[ 0]);
+            k1 *= c1; k1 = _hash_rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+    //Finalization
+    h1 ^= len; h2 ^= len;
+    h1 += h2; h2 += h1;
+    h1 = _hash_fmix64(h1);
+    h2 = _hash_fmix64(h2);
+    h1 += h2; h2 += h1;
+    wide->h1 = h1;
+    //Odd step: h1 + k*h2 visits distinct slots of a power of 2 table
+    wide->h2 = h2 | 1;
+}
+
+ub8 hash_word(ub8 key){
+    return _hash_fmix64(key + HASH_GOLDEN);
+}
+
+/*Incremental hashing*/
+ub8 hash_incremental_key(int place, int value){
+    if(!value)
+        return 0;
+    return _hash_fmix64(((((ub8) place << 8) | (ub1) value) + 1) * HASH_GOLDEN);
+}
+
+HashWord hash_incremental_derive(ub8 base, int arg_seed){
+    return (HashWord) _hash_fmix64(base + ((ub8) arg_seed + 1) * HASH_GOLDEN);
+}
+
+void hash_incremental_wide(ub8 base, HashWide *wide){
+    wide->h1 = _hash_fmix64(base + HASH_GOLDEN);
+    wide->h2 = _hash_fmix64(base + 2 * HASH_GOLDEN) | 1;
+}
@@ -48,6 +48,15 @@ typedef ub4 HashWord;
 typedef ub8 HashWord;
 #endif
 
+/**
+ * Wide hash value (128 bits). Any number of hash values can be derived from it
+ * with hash_wide_k (Kirsch-Mitzenmacher double hashing).
+ */
+typedef struct HashWideStruct{
+    ub8 h1;
+    ub8 h2;     //Always odd
+}HashWide;
+
 
 /**
  * Generates a hash value for the element "k" with size "length" using the
@@ -89,6 +98,63 @@ extern HashWord hash_data(HashWord *k, size_t length, HashWord initval);
  */
 extern HashWord hash_data_char(ub1 *k, size_t length, HashWord initval);
 
+/**
+ * Incremental (Zobrist-style) hashing. The base hash of a vector is the XOR of
+ * one key per non null position, so changing a few positions only costs a few
+ * keys: base ^= key(p, old) ^ key(p, new).
+ * Returns the key of a position/value pair. The key of a null value is 0.
+ * @param place Position in the vector
+ * @param value Value stored at the position
+ * @return Key of type ub8
+ */
+extern ub8 hash_incremental_key(int place, int value);
+
+/**
+ * Derives the kth hash value from an incremental base hash. Each seed index
+ * gives an independent value (used by the Localization Table, Bloom tables and
+ * hash compact probes).
+ * @param base Incremental base hash
+ * @param arg_seed Seed index
+ * @return Hash value of type HashWord
+ */
+extern HashWord hash_incremental_derive(ub8 base, int arg_seed);
+
+/**
+ * Generates a 128 bits hash value (MurmurHash3 x64 128) for the element "k"
+ * with size "length" using the hash_seed["arg_seed"] seed value.
+ * @param k element pointer of type ub1 (one byte)
+ * @param lenght Size in bytes
+ * @param arg_seed hash_seed Array index
+ * @param wide Returned hash value
+ */
+extern void hash_data_wide_for_char(ub1 *k, size_t length, int arg_seed,
+        HashWide *wide);
+
+/**
+ * Wide hash value from an incremental base hash.
+ * @param base Incremental base hash
+ * @param wide Returned hash value
+ */
+extern void hash_incremental_wide(ub8 base, HashWide *wide);
+
+/**
+ * Hash of a 64 bits word (MurmurHash3 finalizer). Used to index tables whose
+ * keys are single words.
+ * @param key Word to hash
+ * @return Hash value of type ub8
+ */
+extern ub8 hash_word(ub8 key);
+
+/**
+ * Returns the kth hash value derived from a wide hash: h1 + k*h2.
+ * @param wide Wide hash value
+ * @param number Index of the derived value
+ * @return Hash value of type HashWord
+ */
+static inline HashWord hash_wide_k(const HashWide *wide, int number){
+    return (HashWord) (wide->h1 + (ub8) number * wide->h2);
+}
+
 #endif	/* _HASH_DRIVER_H */
 
 
@@ -133,6 +133,8 @@ int hash_table_create(HashTableType type, int size, HashTable ** table,
     new->hash_table_compare = func_compare;
     new->hash_table_get_key = func_gekey;
     new->hash_table_free = func_free;
+    new->hash_table_miss = NULL;
+    new->hash_table_alloc = NULL;
 
     //Resize is not allowed by default
     //It is allowed only for the hash table with pointers
@@ -263,6 +265,33 @@ HashTableConcurrentStatus hash_table_in_place_get_status(HashTable *table){
 }
 */
 
+void hash_table_set_miss(HashTable *table, HashTableMiss func_miss){
+    table->hash_table_miss = func_miss;
+}
+
+void hash_table_set_alloc(HashTable *table, HashTableAlloc func_alloc){
+    table->hash_table_alloc = func_alloc;
+}
+
+ub8 hash_table_evict(HashTable *table, HashTableEvict func_evict){
+    switch(table->type){
+        case HASH_TABLE_OF_POINTERS:
+            return hash_table_of_pointers_evict(table, func_evict);
+        default:
+            ERRORMACRO(" hash_table_evict: option not supported\n");
+    }
+}
+
+void hash_table_free_retired(HashTable *table){
+    switch(table->type){
+        case HASH_TABLE_OF_POINTERS:
+            hash_table_of_pointers_free_retired(table);
+            break;
+        default:
+            ERRORMACRO(" hash_table_free_retired: option not supported\n");
+    }
+}
+
 void hash_table_lock(HashTable *table){
      //Check table status
     HashTableConcurrentStatus status = _interface_atomic_cas_8(table->status, HASH_TABLE_OPEN, HASH_TABLE_LOCKED);
@@ -556,6 +585,9 @@ void * hash_table_iterate_next_not_locked(HashTable *table){
     //Iterate - Find next non empty place
     HashTableUnit *table_pos = NULL;
     uint64_tt pos = 0;
+    //All the elements have to be in the current array
+    if(table->iterator == 0 && table->type == HASH_TABLE_OF_POINTERS)
+        hash_table_of_pointers_finish_resize(table);
     for(pos=table->iterator; pos <= table->mask; pos++){
         switch (table->type){
             case HASH_TABLE_IN_PLACE:
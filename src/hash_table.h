@@ -123,6 +123,29 @@ typedef void (*HashTableFree)(void *item);
 typedef void (*HashTableCopy)(void *item_to, const void *item_from, int slot_size);
 typedef void (*HashTableCopyToReference)(void **item_to, const void *item_from);
 
+/**
+ * Tests an item that is not in the table against the items moved out of it
+ * (see hash_table_evict). Only for HASH_TABLE_OF_POINTERS.
+ * @param item a HashItem reference about to be inserted
+ * @return 1 if the item had been inserted before, otherwise 0
+ */
+typedef int (*HashTableMiss)(void *item);
+
+/**
+ * Allocates the space of an item copied into the table (recopy modes), in 
+ * place of malloc. Only for HASH_TABLE_OF_POINTERS.
+ * @return a space of (at least) the slot size
+ */
+typedef void * (*HashTableAlloc)();
+
+/**
+ * Selects the items moved out of the table by hash_table_evict. The items
+ * selected belong to the caller from then on.
+ * @param item a HashItem reference of the table
+ * @return 1 to move the item out of the table, otherwise 0
+ */
+typedef int (*HashTableEvict)(void *item);
+
 typedef enum HashTableConcurrentStatusEnum{HASH_TABLE_OPEN, HASH_TABLE_LOCKED, HASH_TABLE_CLOSED}HashTableConcurrentStatus;
 
 //HASH_TABLE_NO_RECOPY  Just set the table pointer to the new value
@@ -160,6 +183,8 @@ typedef struct HashTableStruct
   HashTableFree     hash_table_free;     /*Function to release item memory*/
   HashTableCopy     hash_table_copy;     /*Recopy function: for HT_of_pointers*/
   HashTableCopyToReference hash_table_copy_to_reference; /*Recopy function passing the reference: for HT_of_pointers*/
+  HashTableMiss     hash_table_miss;     /*Items evicted before: for HT_of_pointers*/
+  HashTableAlloc    hash_table_alloc;    /*Space of the copies: for HT_of_pointers*/
   //Control vars
   word          logsize;                /* log of size of table */
   word          logsize_init;           /* initial log of size*/
@@ -230,6 +255,43 @@ HashTable * hash_table_local_handler(HashTable *table);
 extern int hash_table_insert(void * item,
         HashTable *table);
 
+/**
+ * Sets the function testing the items not found against the evicted ones. An
+ * item it reports is inserted again but the insertion returns 0 (found). Must
+ * be set before the local handlers are created.
+ * @param table the hash table reference
+ * @param func_miss the test, NULL to disable it
+ */
+extern void hash_table_set_miss(HashTable *table, HashTableMiss func_miss);
+
+/**
+ * Sets the allocator of the items copied into the table (HASH_TABLE_RECOPY 
+ * and HASH_TABLE_RECOPY_WITH_FUNCTION). The free function of the table must
+ * release them accordingly. Must be set before the local handlers are created.
+ * @param table the hash table reference
+ * @param func_alloc the allocator, NULL for malloc
+ */
+extern void hash_table_set_alloc(HashTable *table, HashTableAlloc func_alloc);
+
+/**
+ * Moves the items selected by func_evict out of the table. The table is 
+ * rebuilt without them at the same size: concurrent readers find them until 
+ * the next resize (or eviction), when their memory may be released. Only for 
+ * HASH_TABLE_OF_POINTERS, the caller holds the table lock.
+ * @param table the hash table reference
+ * @param func_evict the selection
+ * @return the number of items moved out
+ */
+extern ub8 hash_table_evict(HashTable *table, HashTableEvict func_evict);
+
+/**
+ * Releases the array replaced by the last resize (or eviction) before the 
+ * next one does. The caller holds the table lock and knows that no reader is
+ * walking the old array any more. Only for HASH_TABLE_OF_POINTERS.
+ * @param table the hash table reference
+ */
+extern void hash_table_free_retired(HashTable *table);
+
 /**
  * Lock the hash table
  * @param table the hash table reference to be locked
@@ -0,0 +1,208 @@
+/*
+ * File:    hash_table_lockfree.c
+ * Author:  Rodrigo Tacla Saad
+ * Email:   rodrigo.tacla.saad@gmail.com
+ * Company: LAAS-CNRS / Vertics
+ * Created  on October 18, 2026, 9:12 AM
+ *
+ * LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * DESCRIPTION
+ *
+ * Lock-free shared hash table (open addressing with linear probing) for the
+ * parallel exploration. All threads share one table: a bucket is claimed with a
+ * compare-and-swap and holds a 16 bits memoized hash tag and a pointer to the
+ * element, which is copied into memory owned by the inserting thread. Elements
+ * are never moved nor deleted. The tag avoids most element comparisons and the
+ * table does not need any routing between threads (see bloom_localization_table).
+ */
+
+#include "reset_define_includes.h"
+#define ASSERTLIB
+#define STDLIB
+#define ERRORLIB
+#define STRINGLIB
+#define STDIOLIB
+#include "hash_table_lockfree.h"
+#include "atomic_interface.h"
+
+#define HT_LOCKFREE_TAG_SHIFT 48
+#define HT_LOCKFREE_POINTER_MASK ((((ub8) 1) << HT_LOCKFREE_TAG_SHIFT) - 1)
+#define HT_LOCKFREE_BUSY ((ub8) 1)
+//Elements per memory chunk of a thread
+#define HT_LOCKFREE_CHUNK 4096
+
+//Thread memory chunk for the inserted elements
+__thread ub1 *hash_table_lockfree_chunk = NULL;
+__thread long hash_table_lockfree_chunk_free = 0;
+
+static inline void * _hash_table_lockfree_alloc(HashTableLockFree *table){
+    if(!hash_table_lockfree_chunk_free){
+        errno = 0;
+        hash_table_lockfree_chunk =
+                (ub1 *) malloc(HT_LOCKFREE_CHUNK * table->element_size);
+        if(!hash_table_lockfree_chunk || errno != 0)
+            ERRORMACRO(" Lock-free hash table: Impossible to allocate elements\n");
+        hash_table_lockfree_chunk_free = HT_LOCKFREE_CHUNK;
+    }
+    hash_table_lockfree_chunk_free--;
+    void *element = hash_table_lockfree_chunk;
+    hash_table_lockfree_chunk += table->element_size;
+    return element;
+}
+
+//Tag: upper 16 bits of the hash, never 0 (0 is an empty bucket)
+static inline ub8 _hash_table_lockfree_tag(ub8 hash){
+    ub8 tag = hash >> HT_LOCKFREE_TAG_SHIFT;
+    return (tag ? tag : 1) << HT_LOCKFREE_TAG_SHIFT;
+}
+
+HashTableLockFree * hash_table_lockfree_create(int size,
+        int element_size, HashTableLockFreeGetKey hash_function,
+        HashTableLockFreeCompare compare_function){
+    assert(size > 0 && element_size > 0 && hash_function && compare_function);
+    HashTableLockFree *table = NULL;
+    errno = 0;
+    table = (HashTableLockFree *) malloc(sizeof (HashTableLockFree));
+    if(!table || errno != 0)
+        ERRORMACRO(" Lock-free hash table: Impossible to create the table\n");
+    memset(table, 0, sizeof (HashTableLockFree));
+    table->mask = (((ub8) 1) << size) - 1;
+    table->element_size = element_size;
+    table->hash_function = hash_function;
+    table->compare_function = compare_function;
+    errno = 0;
+    table->table = (ub8 *) calloc(table->mask + 1, sizeof (ub8));
+    if(!table->table || errno != 0)
+        ERRORMACRO(" Lock-free hash table: Impossible to allocate buckets\n");
+    return table;
+}
+
+int hash_table_lockfree_find_or_put(void *element,
+        HashTableLockFree *table, int id, void **stored){
+    assert(element && table);
+    HashWide wide;
+    (*table->hash_function)(element, &wide);
+    const ub8 tag = _hash_table_lockfree_tag(wide.h1);
+    ub8 index = wide.h2 & table->mask;
+    volatile ub8 *buckets = (volatile ub8 *) table->table;
+    HashTableLockFreeStats *stats = &table->stats[id];
+    stats->lookups++;
+    ub8 probe;
+    for (probe = 0; probe <= table->mask; probe++) {
+        ub8 bucket = buckets[index];
+        if(!bucket){
+            //Empty: try to claim it
+            bucket = _interface_atomic_cas_64(&table->table[index],
+                    (ub8) 0, tag | HT_LOCKFREE_BUSY);
+            if(!bucket){
+                void *new = _hash_table_lockfree_alloc(table);
+                memcpy(new, element, table->element_size);
+                //Publish: the copy must be visible before the pointer
+                __sync_synchronize();
+                buckets[index] = tag | (ub8) new;
+                stats->inserted++;
+                stats->probes += probe + 1;
+                *stored = new;
+                return 1;
+            }
+            //Lost the race, bucket holds the winner
+        }
+        if((bucket & ~HT_LOCKFREE_POINTER_MASK) == tag){
+            //Same tag, wait for the writer and compare
+            while((bucket & HT_LOCKFREE_POINTER_MASK) == HT_LOCKFREE_BUSY)
+                bucket = buckets[index];
+            stats->comparisons++;
+            void *old = (void *) (bucket & HT_LOCKFREE_POINTER_MASK);
+            if((*table->compare_function)(old, element)){
+                stats->probes += probe + 1;
+                *stored = old;
+                return 0;
+            }
+        }
+        index = (index + 1) & table->mask;
+    }
+    ERRORMACRO(" Lock-free hash table: FULL TABLE, increase it with -Hts\n");
+    return 0;
+}
+
+void * hash_table_lockfree_find(void *element, HashTableLockFree *table){
+    assert(element && table);
+    HashWide wide;
+    (*table->hash_function)(element, &wide);
+    const ub8 tag = _hash_table_lockfree_tag(wide.h1);
+    ub8 index = wide.h2 & table->mask;
+    volatile ub8 *buckets = (volatile ub8 *) table->table;
+    ub8 probe;
+    for (probe = 0; probe <= table->mask; probe++) {
+        ub8 bucket = buckets[index];
+        if(!bucket)
+            return NULL;
+        if((bucket & ~HT_LOCKFREE_POINTER_MASK) == tag){
+            while((bucket & HT_LOCKFREE_POINTER_MASK) == HT_LOCKFREE_BUSY)
+                bucket = buckets[index];
+            void *old = (void *) (bucket & HT_LOCKFREE_POINTER_MASK);
+            if((*table->compare_function)(old, element))
+                return old;
+        }
+        index = (index + 1) & table->mask;
+    }
+    return NULL;
+}
+
+long hash_table_lockfree_overhead(HashTableLockFree *table){
+    return (long) ((table->mask + 1) * sizeof (ub8));
+}
+
+void hash_table_lockfree_print(HashTableLockFree *table,
+        int number_of_threads){
+    long long inserted = 0, lookups = 0, probes = 0, comparisons = 0;
+    int i;
+    for (i = 0; i < number_of_threads; i++) {
+        inserted += table->stats[i].inserted;
+        lookups += table->stats[i].lookups;
+        probes += table->stats[i].probes;
+        comparisons += table->stats[i].comparisons;
+    }
+    const double load = (double) inserted / (double) (table->mask + 1);
+    fprintf(stdout, "\n Lock-free Hash Table:\t\t\t");
+    fprintf(stdout, "\n \t Buckets:\t \t \t %llu \t",
+            (unsigned long long) (table->mask + 1));
+    fprintf(stdout, "\n \t Load factor:\t \t \t %.3f \t", load);
+    fprintf(stdout, "\n \t Probes per lookup:\t \t %.3f \t",
+            lookups ? (double) probes / (double) lookups : 0.0);
+    fprintf(stdout, "\n \t Element comparisons:\t \t %lld \t", comparisons);
+    for (i = 0; i < number_of_threads; i++)
+        fprintf(stdout, "\n \t Thread %d - Inserted:\t \t %lld \t", i,
+                table->stats[i].inserted);
+    fprintf(stdout, "\n");
+}
+
+void hash_table_lockfree_free(HashTableLockFree *table){
+    if(!table)
+        return;
+    free(table->table);
+    free(table);
+}
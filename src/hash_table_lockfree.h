@@ -0,0 +1,141 @@
+/**
+ * @file        hash_table_lockfree.h
+ * @author      Rodrigo Tacla Saad
+ * @email       rodrigo.tacla.saad@gmail.com
+ * @company:    LAAS-CNRS / Vertics
+ * @created     on October 18, 2026, 9:12 AM
+ *
+ * @section LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Lock-free shared hash table (open addressing with linear probing) for the
+ * parallel exploration. All threads share one table: a bucket is claimed with a
+ * compare-and-swap and holds a 16 bits memoized hash tag and a pointer to the
+ * element, which is copied into memory owned by the inserting thread. Elements
+ * are never moved nor deleted. The tag avoids most element comparisons and the
+ * table does not need any routing between threads (see bloom_localization_table).
+ *
+ */
+
+#ifndef _HASH_TABLE_LOCKFREE_H
+#define	_HASH_TABLE_LOCKFREE_H
+
+#include "flags.h"
+#include "standard_includes.h"
+#include "hash_driver.h"
+
+/**
+ * Wide hash of an element (see hash_driver.h).
+ */
+typedef void (*HashTableLockFreeGetKey)(void *element, HashWide *wide);
+
+/**
+ * Compares two elements, returns 1 if they are equal.
+ */
+typedef int (*HashTableLockFreeCompare)(void *element_table, void *element);
+
+/**
+ * Per thread statistics
+ */
+typedef struct HashTableLockFreeStatsStruct{
+    long long inserted;                     //New elements
+    long long lookups;                      //Calls to find_or_put
+    long long probes;                       //Buckets visited
+    long long comparisons;                  //Elements compared (same tag)
+    char padding[32];
+}HashTableLockFreeStats;
+
+/**
+ * Lock-free hash table. Each bucket is a word with the memoized tag in the
+ * upper 16 bits and the element pointer in the lower 48 bits. A bucket being
+ * written holds its tag and the pointer value 1 (busy).
+ */
+typedef struct HashTableLockFreeStruct{
+    ub8 *table;                             //Buckets
+    ub8 mask;                               //Number of buckets - 1
+    int element_size;                       //Size in bytes of the elements
+    HashTableLockFreeGetKey hash_function;
+    HashTableLockFreeCompare compare_function;
+    //For stats, one cache line per thread
+    HashTableLockFreeStats stats[MAX_NUMBER_OF_THREADS];
+}HashTableLockFree;
+
+/**
+ * Creates a lock-free hash table.
+ * @param size The number of buckets in bits
+ * @param element_size Size in bytes of the elements
+ * @param hash_function Function to hash the elements
+ * @param compare_function Function to compare the elements
+ * @return A HashTableLockFree reference
+ */
+extern HashTableLockFree * hash_table_lockfree_create(int size,
+        int element_size, HashTableLockFreeGetKey hash_function,
+        HashTableLockFreeCompare compare_function);
+
+/**
+ * Searches an element and inserts a copy of it if it is not part of the table.
+ * The copy is stored into memory owned by the calling thread.
+ * @param element Element to be searched
+ * @param table The HashTableLockFree reference
+ * @param id Thread id (for stats)
+ * @param stored Returns the element stored into the table
+ * @return 1 if the element was inserted (new), 0 if it was already there
+ */
+extern int hash_table_lockfree_find_or_put(void *element,
+        HashTableLockFree *table, int id, void **stored);
+
+/**
+ * Searches an element.
+ * @param element Element to be searched
+ * @param table The HashTableLockFree reference
+ * @return The element stored into the table or NULL if it is not there
+ */
+extern void * hash_table_lockfree_find(void *element, HashTableLockFree *table);
+
+/**
+ * Returns the memory space used by the buckets (elements not included).
+ * @param table The HashTableLockFree reference
+ * @return Size in bytes
+ */
+extern long hash_table_lockfree_overhead(HashTableLockFree *table);
+
+/**
+ * Prints statistics about the table.
+ * @param table The HashTableLockFree reference
+ * @param number_of_threads Number of threads that used the table
+ */
+extern void hash_table_lockfree_print(HashTableLockFree *table,
+        int number_of_threads);
+
+/**
+ * Releases the buckets. The stored elements are not released, they belong to
+ * the threads memory buckets.
+ * @param table The HashTableLockFree reference
+ */
+extern void hash_table_lockfree_free(HashTableLockFree *table);
+
+#endif	/* _HASH_TABLE_LOCKFREE_H */
+
@@ -55,8 +55,16 @@ extern __thread struct timespec   ts;
 __thread const ub8 jump_mask_of_pointers = ((ub8)1<<32) - 1;
 __thread const ub8 memoization_mask_of_pointers = (((ub8)1<<32) - 1) << 32;
 
+/*Number of old buckets moved by each insert while the table is migrating.
+ *The table doubles at 80% of load, so the owner inserts at least 0.8*old_size
+ *elements before the next resize: any chunk larger than 2 buckets finishes
+ *the migration in time.*/
+#define HASH_TABLE_MIGRATION_CHUNK 64
+
 /*Prototype for intenal (hidden) functions*/
 int _hash_table_grow(HashTable *old_table);
+static int _hash_table_of_pointers_put(void * item, HashTable *table);
+static void _hash_table_of_pointers_migrate(HashTable *table, ub8 buckets);
 
 /*Functions declarations*/
 
@@ -92,33 +100,81 @@ int hash_table_of_pointers_init(int size, HashTable *table, HashTableRecopyType
         hash_table_message = NO_MEMORY;
         return 0;
     }
+    //Shared resize state
+    table->table.of_pointers.pos_slots = *(table->table.of_pointers.slots);
+    table->table.of_pointers.resize =
+            (HashTableOfPointersResize *) malloc(sizeof(HashTableOfPointersResize));
+    if(table->table.of_pointers.resize == NULL){
+        WARNINGMACRO("hash_table_create: Impossible to create new table.\n");
+        hash_table_message = NO_MEMORY;
+        return 0;
+    }
+    table->table.of_pointers.resize->logsize = table->logsize;
+    table->table.of_pointers.resize->old_slots = NULL;
+    table->table.of_pointers.resize->old_mask = 0;
+    table->table.of_pointers.resize->next = 0;
+    table->table.of_pointers.resize->retired = NULL;
     return 1;
 }
 
-int _hash_table_grow(HashTable *table){
-    //Should never happen
-/*
-    if(*(table->status)==HASH_TABLE_CLOSED){
-        ERRORMACRO("hash_table_grow: Impossible to resize Table - Table is not properly locked.\n");
-        hash_table_message = IMPOSSIBLE_TO_RESIZE;
-        return 0;
+//Handlers of other threads keep their own mask, update it after a resize.
+//The new array is published before the new size, so a stale mask only
+//addresses the lower half of the new array.
+static inline void _hash_table_of_pointers_sync(HashTable *table){
+    const word logsize = table->table.of_pointers.resize->logsize;
+    if(table->logsize != logsize){
+        table->logsize = logsize;
+        table->mask = ((ub8)1 << logsize) - 1;
     }
-*/
-    //Maybe HASH_TABLE_CLOSED or HASH_TABLE_LOCKED
-    //Should never happen
-/*    if(*(table->status)==HASH_TABLE_OPEN){
-        ERRORMACRO("hash_table_grow: Impossible to resize Table - Table is not properly locked.\n");
-        hash_table_message = IMPOSSIBLE_TO_RESIZE;
-        return 0;
-    }*
- */
-    
-    //Close Table for Reading
-    //Close table
-    const HashTableConcurrentStatus old_status = *(table->status);
-    _interface_atomic_swap_8(table->status, HASH_TABLE_CLOSED); //*(table->status)=HASH_TABLE_CLOSED;
+}
+
+//Moves the next "buckets" buckets of the migrating array into the current one.
+//Must be called by a thread that may write into the table.
+static void _hash_table_of_pointers_migrate(HashTable *table, ub8 buckets){
+    HashTableOfPointersResize *resize = table->table.of_pointers.resize;
+    HashTableOfPointersItem *old_slots = resize->old_slots;
+    if(!old_slots)
+        return;
+    //Items are moved, not copied, and they do not count as new insertions
+    HashTable mover;
+    memcpy(&mover, table, sizeof(HashTable));
+    mover.table.of_pointers.recopy_when_insert = HASH_TABLE_NO_RECOPY;
+    mover.allow_resize = HASH_TABLE_NO_RESIZE;
+    mover.hash_table_miss = NULL;
+    ub8 end = resize->next + buckets;
+    if(end > resize->old_mask + 1 || end < resize->next)
+        end = resize->old_mask + 1;
+    ub8 pos;
+    for(pos = resize->next; pos < end; pos++){
+        if(old_slots[pos].item)
+            _hash_table_of_pointers_put(old_slots[pos].item, &mover);
+    }
+    resize->next = end;
+    if(end > resize->old_mask){
+        //Migration over. Readers may still be walking the old array, it is
+        //released on the next resize.
+        resize->retired = old_slots;
+        __sync_synchronize();
+        resize->old_slots = NULL;
+        WARNINGMACRO(" Local Table migrated");
+    }
+}
+
+void hash_table_of_pointers_finish_resize(HashTable *table){
+    assert(table);
+    _hash_table_of_pointers_sync(table);
+    _hash_table_of_pointers_migrate(table, ~((ub8) 0));
+}
+
+int _hash_table_grow(HashTable *table){
+    HashTableOfPointersResize *resize = table->table.of_pointers.resize;
+    _hash_table_of_pointers_sync(table);
+    //Only one migration at a time: finish the pending one
+    _hash_table_of_pointers_migrate(table, ~((ub8) 0));
+    //Nobody can be reading the array migrated before the previous resize
+    free(resize->retired);
+    resize->retired = NULL;
     WARNINGMACRO(" Resizing Local Table");
-          
 
     word new_size = table->logsize + 1;
     /*Resolve address space in number of buckets*/
@@ -130,108 +186,92 @@ int _hash_table_grow(HashTable *table){
     //Alloc new table
     errno = 0;
     HashTableOfPointersItem *new_table = NULL;
-    if(ALIGNMENT)
-        posix_memalign((void **) &new_table, Mbit, (table_size+1)*sizeof(HashTableOfPointersItem));
-    else
+    if(ALIGNMENT){
+        if(!posix_memalign((void **) &new_table, Mbit, (table_size+1)*sizeof(HashTableOfPointersItem)))
+            memset(new_table, 0, (table_size+1)*sizeof(HashTableOfPointersItem));
+    } else
         new_table =
             (HashTableOfPointersItem *) calloc(table_size+1, sizeof(HashTableOfPointersItem));
-    
-    if(errno!=0 || table->table.of_pointers.slots == NULL){
+    if(errno!=0 || new_table == NULL){
         ERRORMACRO("hash_table_create: Impossible to create new table.");
     }
-    //Create a temporary handler for the new table
-    HashTable *temp_handler =  hash_table_of_pointers_local_handler(table);
-    //Update the table reference
-    //Do not recopy again states, only the reference is moving
-    temp_handler->table.of_pointers.recopy_when_insert  = HASH_TABLE_NO_RECOPY;//table->table.of_pointers.recopy_when_insert;
-    temp_handler->table.of_pointers.slot_size = table->table.of_pointers.slot_size;
-    //Create a dummy reference
-    temp_handler->table.of_pointers.slots = (HashTableOfPointersItem **) malloc(sizeof(HashTableOfPointersItem *));
-    *(temp_handler->table.of_pointers.slots)=new_table;
-    temp_handler->mask = new_mask;
-    temp_handler->logsize = new_size;
-    temp_handler->collisions = 0;
-    temp_handler->count = 0;
-    temp_handler->distance = 0;
-    temp_handler->jumps = 0;
-    //Temporally closed
-    *(temp_handler->status) = HASH_TABLE_CLOSED;
-    //Iterate the old table
-    table->iterator = 0;
-
-    WARNINGMACRO(" Updating elements");
-    //Iterate - Find next non empty place
-    HashTableOfPointersItem *table_pos = NULL;
-    long long pos = 0;
-    hash_table_reset_iterator(table);
-    void *result = result = hash_table_iterate_next_not_locked(table);
-    while(result){
-        
-        //table_pos = hash_table_of_pointers_get_pos(table, pos);
-        //if(table_pos){
-            hash_table_of_pointers_insert(result , temp_handler);
-        //}
-        result = hash_table_iterate_next_not_locked(table);
-    }
 
-    WARNINGMACRO(" Updating handlers");
-    //Update Old handler to new table
-    HashTableOfPointersItem *old_table = *(table->table.of_pointers.slots);
+    //Publish the migration before the new array: a reader that sees the new
+    //array also sees the old one
+    resize->old_mask = table->mask;
+    resize->next = 0;
+    resize->old_slots = *(table->table.of_pointers.slots);
+    __sync_synchronize();
     *(table->table.of_pointers.slots) = new_table;
-    table->mask = temp_handler->mask;
-    table->logsize = temp_handler->logsize;
-    //Reset statistics, otherwise the update_count value does not work.
-    table->collisions = 0;
-    table->count = 0;
-    table->distance = 0;
-    table->jumps = 0;
+    __sync_synchronize();
+    resize->logsize = new_size;
+    table->mask = new_mask;
+    table->logsize = new_size;
     //Count the number of resizing
     table->number_of_resize+=1;
-
-    //Update all local handlers
-    int i=0;
-    for(i=0; i < *(table->number_of_handlers); i++){
-        HashTable * local_handler = NULL;
-        local_handler = *(table->list_of_handlers + i);
-        if (local_handler!=table)
-            memcpy(local_handler, table, sizeof(HashTable));
-        /*else if(local_handler==table)
-            //update list
-            *(table->list_of_handlers + i) = table;*/
-    }
-
-    //Update local statistics
-    table->collisions = temp_handler->collisions;
-    table->count = temp_handler->count;
-    table->distance = temp_handler->distance;
-    table->jumps = temp_handler->jumps;
-    WARNINGMACRO( " Table Released");
-    
-    //Update status
-    //Return to old status
-    _interface_atomic_swap_8(table->status, old_status);  //*(table->status) = HASH_TABLE_LOCKED;
-    //Release Table
-    //Change status to open and notify if somebody is waiting
-    /*if(*(table->waiting) != 0 ){
-        pthread_mutex_lock(table->mutex_block);
-        *(table->status) = HASH_TABLE_OPEN;
-        pthread_cond_broadcast(table->cond_block);        
-        pthread_mutex_unlock(table->mutex_block);
-    } else{
-        pthread_mutex_lock(table->mutex_block);
-        *(table->status) = HASH_TABLE_OPEN;;
-        pthread_mutex_unlock(table->mutex_block);
-    }*/
-    //Release old memory
-    free(old_table);
-    //free(temp_handler->table.of_pointers.slots);
-    free(temp_handler);
     return 1;
 }
 
+ub8 hash_table_of_pointers_evict(HashTable *table, HashTableEvict func_evict){
+    assert(table && func_evict);
+    HashTableOfPointersResize *resize = table->table.of_pointers.resize;
+    _hash_table_of_pointers_sync(table);
+    //Same protocol as _hash_table_grow, with an array of the same size
+    _hash_table_of_pointers_migrate(table, ~((ub8) 0));
+    free(resize->retired);
+    resize->retired = NULL;
 
+    ub8 table_size = table->mask + 1;
+    errno = 0;
+    HashTableOfPointersItem *new_table = NULL;
+    if(ALIGNMENT){
+        if(!posix_memalign((void **) &new_table, Mbit, (table_size+1)*sizeof(HashTableOfPointersItem)))
+            memset(new_table, 0, (table_size+1)*sizeof(HashTableOfPointersItem));
+    } else
+        new_table =
+            (HashTableOfPointersItem *) calloc(table_size+1, sizeof(HashTableOfPointersItem));
+    if(errno!=0 || new_table == NULL){
+        ERRORMACRO("hash_table_evict: Impossible to create new table.");
+    }
+    HashTableOfPointersItem *old_slots = *(table->table.of_pointers.slots);
+    resize->old_mask = table->mask;
+    resize->next = 0;
+    resize->old_slots = old_slots;
+    __sync_synchronize();
+    *(table->table.of_pointers.slots) = new_table;
+    __sync_synchronize();
+
+    //Keep the items not selected, the others are handed to the caller
+    HashTable mover;
+    memcpy(&mover, table, sizeof(HashTable));
+    mover.table.of_pointers.recopy_when_insert = HASH_TABLE_NO_RECOPY;
+    mover.allow_resize = HASH_TABLE_NO_RESIZE;
+    mover.hash_table_miss = NULL;
+    ub8 evicted = 0;
+    ub8 pos;
+    for(pos = 0; pos <= resize->old_mask; pos++){
+        if(old_slots[pos].item){
+            if((*func_evict)(old_slots[pos].item))
+                evicted++;
+            else
+                _hash_table_of_pointers_put(old_slots[pos].item, &mover);
+        }
+    }
+    resize->next = resize->old_mask + 1;
+    resize->retired = old_slots;
+    __sync_synchronize();
+    resize->old_slots = NULL;
+    table->count = (table->count > evicted) ? table->count - evicted : 0;
+    return evicted;
+}
 
 
+void hash_table_of_pointers_free_retired(HashTable *table){
+    assert(table);
+    HashTableOfPointersResize *resize = table->table.of_pointers.resize;
+    free(resize->retired);
+    resize->retired = NULL;
+}
 
 /*Creates a local handler to isolate some variables (pos for instance).*/
 HashTable * hash_table_of_pointers_local_handler(HashTable *table){
@@ -255,9 +295,70 @@ HashTable * hash_table_of_pointers_local_handler(HashTable *table){
     return new;    
 }
 
+//Search "item" in the array "slots" of size "mask"+1. Sets table->pos only if
+//the item is found.
+static int _hash_table_of_pointers_lookup(void * item, HashTable *table,
+        HashTableOfPointersItem *slots, ub8 mask, ub8 key){
+    HashTableCompare hash_table_compare = table->hash_table_compare;
+    //Get index
+    uint64_tt index = mask & key;
+    //Test the positions
+    HashTableOfPointersItem * table_slot = slots + index;
+    //Get memoization
+    ub8 memoization_item = (ub8) (memoization_mask_of_pointers & key);
+    //Jump
+    ub8 jump_slot = (ub8) 0;
+    ub8 memoization_slot = (ub8) 0;
+    do{
+        //Get Slot memoization for test
+        memoization_slot = (ub8) (memoization_mask_of_pointers & table_slot->memoization_and_next_position);
+        //Get jump for next slot
+        jump_slot = (ub8) (jump_mask_of_pointers & table_slot->memoization_and_next_position);
+        if(table_slot->item || jump_slot || memoization_slot) {
+            //if item is equal to slot memoization then compare itens
+            if(memoization_item==memoization_slot
+                    && (*hash_table_compare)(table_slot->item, item)){
+                //Already part of the set
+                table->pos = index;
+                return 1;
+            } else if(jump_slot){
+                //Collision, Get next position - Jump like in a linked list
+                index = jump_slot;
+                table_slot = slots + index;
+            } else
+                return 0;
+        } else
+            return 0;
+    } while(table_slot->item);
+    return 0;
+}
+
 int hash_table_of_pointers_insert(void * item,
         HashTable *table){
     assert(item && table);
+    _hash_table_of_pointers_sync(table);
+    HashTableOfPointersResize *resize = table->table.of_pointers.resize;
+    HashTableOfPointersItem *old_slots = resize->old_slots;
+    if(old_slots){
+        //Migrating: the item may still be only in the old array
+        if(_hash_table_of_pointers_lookup(item, table, old_slots,
+                resize->old_mask, (*table->hash_table_get_key)(item))){
+            table->table.of_pointers.pos_slots = old_slots;
+            hash_table_message = FOUND;
+            return 0;
+        }
+        const int result = _hash_table_of_pointers_put(item, table);
+        //Every insert pays for a chunk of the migration
+        _hash_table_of_pointers_migrate(table, HASH_TABLE_MIGRATION_CHUNK);
+        return result;
+    }
+    return _hash_table_of_pointers_put(item, table);
+}
+
+static int _hash_table_of_pointers_put(void * item,
+        HashTable *table){
+    //Position refers to the current array
+    table->table.of_pointers.pos_slots = *(table->table.of_pointers.slots);
     //Set local pointers
     HashTableCompare hash_table_compare = table->hash_table_compare;
     HashTableGetKey hash_table_get_key = table->hash_table_get_key;
@@ -362,6 +463,10 @@ int hash_table_of_pointers_insert(void * item,
             break;
         }
     } while(table_slot->item);
+
+    //An item moved out of the table is inserted again, but it is not new
+    const int evicted = table->hash_table_miss
+            && (*table->hash_table_miss)(item);
     
     //Set Memoization first
     table_slot->memoization_and_next_position = memoization_item;
@@ -385,7 +490,10 @@ int hash_table_of_pointers_insert(void * item,
             //The item is copied locally
             errno=0;
             void *new_item = NULL;
-            new_item = (void *) malloc(table->table.of_pointers.slot_size);
+            if(table->hash_table_alloc)
+                new_item = (*table->hash_table_alloc)();
+            else
+                new_item = (void *) malloc(table->table.of_pointers.slot_size);
             if(errno!=0 || new_item==NULL){
                 hash_table_message = NO_MEMORY;
                 ERRORMACRO("hash_table_insert: Impossible to recopy item.\n");
@@ -417,10 +525,12 @@ int hash_table_of_pointers_insert(void * item,
     if(number_of_jumps > 20)
         first_handler = hash_table_update_table_stats(table);
 
-    //See Load Factor
+    //See Load Factor (against the shared size, the first handler mask may be
+    //stale)
     if((table->allow_resize==HASH_TABLE_RESIZE 
             && *(table->status)!=HASH_TABLE_CLOSED) //Avoid double resize
-            && ((first_handler->count*10/first_handler->mask > first_handler ->max_load_factor)
+            && ((first_handler->count*10/(((ub8)1 << table->table.of_pointers.resize->logsize) - 1)
+                > first_handler ->max_load_factor)
             /*|| (number_of_jumps > 40) */)){
         //This resize works only when LT is set for ASYNCHRONOUS or STATIC mode
         //It does not work for Mixed or SYNCHRONOUS because the table->count 
@@ -431,55 +541,35 @@ int hash_table_of_pointers_insert(void * item,
         //Update position for the last item inserted
         hash_table_of_pointers_search(item, table);
     }
+    if(evicted){
+        hash_table_message = FOUND;
+        return 0;
+    }
     return 1;
 }
 
 
 int hash_table_of_pointers_search(void * item, HashTable *table){
     assert(item && table);
-    //Set local pointers
-    HashTableCompare hash_table_compare = table->hash_table_compare;
-    HashTableGetKey hash_table_get_key = table->hash_table_get_key;
+    _hash_table_of_pointers_sync(table);
+    HashTableOfPointersResize *resize = table->table.of_pointers.resize;
+    //Read the array once, a resize may publish a new one meanwhile
+    HashTableOfPointersItem *slots = *(table->table.of_pointers.slots);
     //Get hash value from item
-    ub8 key = (*hash_table_get_key)(item);
-    //Get index
-    uint64_tt index = table->mask & key;
-    //Test the positions
-    HashTableOfPointersItem * table_slot = NULL;
-    table_slot = (*table->table.of_pointers.slots + index);
-    //Get memoization
-    ub8 memoization_item = (ub8) (memoization_mask_of_pointers & key);
-    //Jump
-    ub8 jump_slot = (ub8) 0;
-    ub8 memoization_slot = (ub8) 0;
-    do{
-        //Get Slot memoization for test
-        memoization_slot = (ub8) (memoization_mask_of_pointers & table_slot->memoization_and_next_position);
-        //Get jump for next slot
-        jump_slot = (ub8) (jump_mask_of_pointers & table_slot->memoization_and_next_position);
-        if(table_slot->item || jump_slot || memoization_slot) {
-            //if item is equal to slot memoization then compare itens
-            if(memoization_item==memoization_slot
-                    && (*hash_table_compare)(table_slot->item, item)){
-                //Already part of the set
-                table->pos = index;
-                hash_table_message = FOUND;
-                return 1;
-            } else if(jump_slot){
-                //Collision, Get next position - Jump like in a linked list
-                index = jump_slot;
-                table_slot = (*table->table.of_pointers.slots + index);
-            } else {
-                //Item not found
-                hash_table_message = NOT_FOUND;
-                return 0;
-            }
-        } else{
-            //Item not found
-            hash_table_message = NOT_FOUND;
-            return 0;
-        }
-    } while(table_slot->item);
+    ub8 key = (*table->hash_table_get_key)(item);
+    if(_hash_table_of_pointers_lookup(item, table, slots, table->mask, key)){
+        table->table.of_pointers.pos_slots = slots;
+        hash_table_message = FOUND;
+        return 1;
+    }
+    //Not migrated yet?
+    HashTableOfPointersItem *old_slots = resize->old_slots;
+    if(old_slots && _hash_table_of_pointers_lookup(item, table, old_slots,
+            resize->old_mask, key)){
+        table->table.of_pointers.pos_slots = old_slots;
+        hash_table_message = FOUND;
+        return 1;
+    }
     //Item not found
     hash_table_message = NOT_FOUND;
     return 0;
@@ -488,7 +578,8 @@ int hash_table_of_pointers_search(void * item, HashTable *table){
 HashItemValue *hash_table_of_pointers_get(HashTable *table){
     assert(table);
     //Return element pointed by index table->pos (found by last search or insert)
-    return  (*(table->table.of_pointers.slots))[table->pos].item;
+    //in the array where it was found
+    return table->table.of_pointers.pos_slots[table->pos].item;
 }
 
 HashItemValue *hash_table_of_pointers_get_pos(HashTable *table, uint64_tt pos){
@@ -559,6 +650,7 @@ int hash_table_of_pointers_delete(void * item, HashTable *table){
 
 void hash_table_of_pointers_destroy(HashTable *table){
     assert(table);
+    hash_table_of_pointers_finish_resize(table);
     HashTableFree hash_table_free = table->hash_table_free;
     register long long j=0;
     for(j=0; j < table->mask; j++){
@@ -570,6 +662,8 @@ void hash_table_of_pointers_destroy(HashTable *table){
         }
     }
     //Release memory
+    free(table->table.of_pointers.resize->retired);
+    free(table->table.of_pointers.resize);
     free(table->table.of_pointers.slots);
     free(table);
 }
@@ -592,6 +686,10 @@ int hash_table_of_pointers_get_slot_size(HashTable *table){
 }
 
 long hash_table_of_pointers_overhead(HashTable *table){
+    _hash_table_of_pointers_sync(table);
+    if(table->table.of_pointers.resize->old_slots)
+        return (sizeof(HashTableOfPointersItem)
+                *(table->mask + table->table.of_pointers.resize->old_mask));
     return (sizeof(HashTableOfPointersItem)*table->mask);
 }
 
@@ -64,6 +64,31 @@ extern int hash_table_of_pointers_init(int size, HashTable *table,
  */
 HashTable * hash_table_of_pointers_local_handler(HashTable *table);
 
+/**
+ * Moves the remaining buckets of a pending resize into the current array. The
+ * table grows incrementally (every insertion migrates a chunk of the old
+ * array), this function completes the migration at once. It must be called by
+ * a thread allowed to insert into the table.
+ * @param table the hash table reference
+ */
+extern void hash_table_of_pointers_finish_resize(HashTable *table);
+
+/**
+ * Rebuilds the table without the items selected by func_evict, see
+ * hash_table_evict.
+ * @param table the hash table reference
+ * @param func_evict the selection
+ * @return the number of items moved out
+ */
+extern ub8 hash_table_of_pointers_evict(HashTable *table, HashTableEvict func_evict);
+
+/**
+ * Releases the array replaced by the last resize (or eviction), see 
+ * hash_table_free_retired.
+ * @param table the hash table reference
+ */
+extern void hash_table_of_pointers_free_retired(HashTable *table);
+
 /**
  * Insert an item into the hash table. This function must be called only by the
  * table owners (thread that created the table).
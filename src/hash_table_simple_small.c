@@ -256,11 +256,16 @@ HashTable * hash_table_in_place_local_handler(HashTable *table){
 int hash_table_in_place_insert(void * item,
         HashTable *table){
     assert(item && table);
+    //Get hash value from item
+    return hash_table_in_place_insert_key(item, (*table->hash_table_get_key)(item), 
+                                            table);
+}
+
+int hash_table_in_place_insert_key(void * item, ub8 key,
+        HashTable *table){
+    assert(item && table);
     //Set local pointers
     HashTableCompare hash_table_compare = table->hash_table_compare;
-    HashTableGetKey hash_table_get_key = table->hash_table_get_key;
-    //Get hash value from item
-    ub8 key = (*hash_table_get_key)(item);
     //Get index
     uint64_tt index = table->mask & key;
     //Test the positions
@@ -343,7 +348,7 @@ int hash_table_in_place_insert(void * item,
                         // resize hash table
                         _hash_table_in_place_grow(table);
                         //Insert element and return
-                        return hash_table_in_place_insert( item,table);
+                        return hash_table_in_place_insert_key(item, key, table);
                     } else {
                         //No slot available
                         hash_table_message = FULL_TABLE;
@@ -76,6 +76,13 @@ HashTable * hash_table_in_place_local_handler(HashTable *table);
 extern int hash_table_in_place_insert(void * item,
         HashTable *table);
 
+/**
+ * Same as hash_table_in_place_insert, with the hash value of the item already
+ * computed (hash_table_get_key).
+ */
+extern int hash_table_in_place_insert_key(void * item, ub8 key,
+        HashTable *table);
+
 /**
  * Search for a item in the hash table
  * @param item a HashItem reference to be (hashed and) searched
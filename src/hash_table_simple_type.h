@@ -62,11 +62,30 @@ typedef struct HashTableOfPointersItemStruct{
                          * a pair (key, data).*/
 }HashTableOfPointersItem;
 
+/**
+ * Resize state shared by all handlers of a table. The table grows
+ * incrementally: the new array is published at once and the buckets of the
+ * old one are moved in chunks by the threads that insert into the table.
+ * Until the migration is over, lookups consult both arrays. The old array is
+ * kept read-only and it is only released on the next resize, when no reader
+ * can be using it anymore.
+ */
+typedef struct HashTableOfPointersResizeStruct{
+    volatile word               logsize;    /*Current size; handlers resync their mask from it*/
+    HashTableOfPointersItem * volatile old_slots; /*Array being migrated, NULL if none*/
+    ub8                         old_mask;
+    ub8                         next;       /*Next old bucket to be migrated*/
+    HashTableOfPointersItem     *retired;   /*Migrated array, released on the next resize*/
+}HashTableOfPointersResize;
+
 typedef struct HashTableOfPointersStruct{
     int recopy_when_insert;  //1 - recopy the data locally, 0 - do nothing.
     int slot_size;                           //mandatory if recopy is available. Slot size is
                                              //the data size.
     HashTableOfPointersItem **slots;
+    HashTableOfPointersItem *pos_slots;      //Array "pos" refers to (the current or
+                                             //the migrating one)
+    HashTableOfPointersResize *resize;       //Shared resize state
 }HashTableOfPointers;
 
 
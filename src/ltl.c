@@ -0,0 +1,432 @@
+/*
+ * File:    ltl.c
+ * Author:  Rodrigo Tacla Saad
+ * Email:   rodrigo.tacla.saad@gmail.com
+ * Company: LAAS-CNRS / Vertics
+ * Created  on October 18, 2026, 11:50 PM
+ *
+ * LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * DESCRIPTION
+ *
+ * Buchi automata of LTL formulas. See ltl.h
+ */
+
+#include "reset_define_includes.h"
+#define ASSERTLIB
+#define STDLIB
+#define ERRORLIB
+#define STDIOLIB
+#define STRINGLIB
+#include "ltl.h"
+
+#define LTL_BIT(i) (((ub8) 1) << (i))
+//Incoming edge of the initial nodes
+#define LTL_INIT -1
+
+typedef enum LtlOperatorEnum {LTL_TRUE, LTL_FALSE, LTL_ATOM, LTL_AND, LTL_OR,
+    LTL_NEXT, LTL_UNTIL, LTL_RELEASE} LtlOperator;
+
+//Subformula in negation normal form, the arguments are indexes of the closure
+typedef struct LtlSubformulaStruct{
+    LtlOperator op;
+    Expression *exp;                    //Atoms
+    int negated;
+    int arg1;
+    int arg2;
+}LtlSubformula;
+
+//Node of the tableau, sets of subformulas are bit sets of the closure
+typedef struct LtlNodeStruct{
+    ub8 new;                            //Still to process
+    ub8 old;                            //Processed, hold in the node
+    ub8 next;                           //Must hold in the successors
+    int *incoming;                      //Predecessors, LTL_INIT if initial
+    int incoming_size;
+    int incoming_capacity;
+}LtlNode;
+
+//The automaton is built by one thread, before the search
+static LtlSubformula _ltl_closure[LTL_MAX_SUBFORMULAS];
+static int _ltl_closure_size = 0;
+static ub8 _ltl_complement[LTL_MAX_SUBFORMULAS];
+static LtlNode *_ltl_nodes = NULL;
+static int _ltl_nodes_size = 0;
+static int _ltl_nodes_capacity = 0;
+
+//Returns the index of a subformula, equal subformulas share the same index
+static int _ltl_subformula(LtlOperator op, Expression *exp, int negated,
+        int arg1, int arg2){
+    int i;
+    for(i=0; i < _ltl_closure_size; i++){
+        const LtlSubformula *sub = &_ltl_closure[i];
+        if(sub->op==op && sub->exp==exp && sub->negated==negated
+                && sub->arg1==arg1 && sub->arg2==arg2)
+            return i;
+    }
+    if(_ltl_closure_size==LTL_MAX_SUBFORMULAS)
+        ERRORMACRO(" LTL: Formula too large (64 subformulas at most)\n");
+    LtlSubformula *sub = &_ltl_closure[_ltl_closure_size];
+    sub->op = op;
+    sub->exp = exp;
+    sub->negated = negated;
+    sub->arg1 = arg1;
+    sub->arg2 = arg2;
+    return _ltl_closure_size++;
+}
+
+//Negation normal form of the formula (or of its negation)
+static int _ltl_convert(Formula *formula, int negated){
+    if(formula==NULL)
+        //Empty left argument of <> and []
+        return _ltl_subformula(negated ? LTL_FALSE : LTL_TRUE, NULL, 0, -1, -1);
+    switch(formula->type){
+        case L_EXPRESSION:
+            return _ltl_subformula(LTL_ATOM, formula->get.exp, negated, -1, -1);
+        case L_UNARY:{
+            Formula *arg = formula->get.unary.arg;
+            switch(formula->get.unary.logic){
+                case L_NEGATION:
+                    return _ltl_convert(arg, !negated);
+                case L_NEXT:
+                    //Paths are infinite (deadlocks stutter): not X f = X not f
+                    return _ltl_subformula(LTL_NEXT, NULL, 0,
+                            _ltl_convert(arg, negated), -1);
+                case L_GLOBAL:
+                case L_EXISTENTIAL:
+                    //Inner path quantifiers are ignored
+                    return _ltl_convert(arg, negated);
+            }
+            break;
+        }
+        case L_BINARY:{
+            Formula *arg1 = formula->get.binary.arg1;
+            Formula *arg2 = formula->get.binary.arg2;
+            switch(formula->get.binary.logic){
+                case L_UNTIL:
+                    if(!negated)
+                        return _ltl_subformula(LTL_UNTIL, NULL, 0,
+                                _ltl_convert(arg1, 0), _ltl_convert(arg2, 0));
+                    //not (f U g) = (not f) R (not g)
+                    return _ltl_subformula(LTL_RELEASE, NULL, 0,
+                            _ltl_convert(arg1, 1), _ltl_convert(arg2, 1));
+                case L_LEADSTO:{
+                    const int true_ = _ltl_subformula(LTL_TRUE, NULL, 0, -1, -1);
+                    const int false_ = _ltl_subformula(LTL_FALSE, NULL, 0, -1, -1);
+                    if(!negated){
+                        //G (not p or F q)
+                        const int eventually = _ltl_subformula(LTL_UNTIL, NULL, 0,
+                                true_, _ltl_convert(arg2, 0));
+                        const int either = _ltl_subformula(LTL_OR, NULL, 0,
+                                _ltl_convert(arg1, 1), eventually);
+                        return _ltl_subformula(LTL_RELEASE, NULL, 0, false_, either);
+                    }
+                    //F (p and G not q)
+                    const int always = _ltl_subformula(LTL_RELEASE, NULL, 0,
+                            false_, _ltl_convert(arg2, 1));
+                    const int both = _ltl_subformula(LTL_AND, NULL, 0,
+                            _ltl_convert(arg1, 0), always);
+                    return _ltl_subformula(LTL_UNTIL, NULL, 0, true_, both);
+                }
+            }
+            break;
+        }
+    }
+    ERRORMACRO(" LTL: Operator not supported\n");
+    return -1;
+}
+
+static void _ltl_incoming_add(LtlNode *node, int from){
+    int i;
+    for(i=0; i < node->incoming_size; i++)
+        if(node->incoming[i]==from)
+            return;
+    if(node->incoming_size==node->incoming_capacity){
+        node->incoming_capacity = node->incoming_capacity ? 2*node->incoming_capacity : 4;
+        node->incoming = (int *) realloc(node->incoming,
+                node->incoming_capacity*sizeof(int));
+        if(node->incoming==NULL)
+            ERRORMACRO(" LTL: Impossible to create the tableau\n");
+    }
+    node->incoming[node->incoming_size++] = from;
+}
+
+static LtlNode _ltl_node_copy(const LtlNode *node){
+    LtlNode copy = *node;
+    copy.incoming = (int *) malloc(node->incoming_capacity*sizeof(int));
+    if(copy.incoming==NULL)
+        ERRORMACRO(" LTL: Impossible to create the tableau\n");
+    memcpy(copy.incoming, node->incoming, node->incoming_size*sizeof(int));
+    return copy;
+}
+
+//Tableau expansion (Gerth, Peled, Vardi and Wolper). The node is given up.
+static void _ltl_expand(LtlNode node){
+    if(!node.new){
+        //Fully expanded: merge it with an equal node or keep it
+        int i;
+        for(i=0; i < _ltl_nodes_size; i++){
+            LtlNode *done = &_ltl_nodes[i];
+            if(done->old==node.old && done->next==node.next){
+                int j;
+                for(j=0; j < node.incoming_size; j++)
+                    _ltl_incoming_add(done, node.incoming[j]);
+                free(node.incoming);
+                return;
+            }
+        }
+        if(_ltl_nodes_size==_ltl_nodes_capacity){
+            _ltl_nodes_capacity = _ltl_nodes_capacity ? 2*_ltl_nodes_capacity : 64;
+            _ltl_nodes = (LtlNode *) realloc(_ltl_nodes,
+                    _ltl_nodes_capacity*sizeof(LtlNode));
+            if(_ltl_nodes==NULL)
+                ERRORMACRO(" LTL: Impossible to create the tableau\n");
+        }
+        const int id = _ltl_nodes_size;
+        _ltl_nodes[_ltl_nodes_size++] = node;
+        LtlNode successor = {node.next, 0, 0, NULL, 0, 0};
+        _ltl_incoming_add(&successor, id);
+        _ltl_expand(successor);
+        return;
+    }
+    const int eta = __builtin_ctzll(node.new);
+    const ub8 bit = LTL_BIT(eta);
+    const LtlSubformula *sub = &_ltl_closure[eta];
+    node.new &= ~bit;
+    switch(sub->op){
+        case LTL_FALSE:
+            free(node.incoming);
+            return;
+        case LTL_ATOM:
+            if(node.old & _ltl_complement[eta]){
+                //Contradiction
+                free(node.incoming);
+                return;
+            }
+            //Consistent literal, kept in the label
+        case LTL_TRUE:
+            node.old |= bit;
+            _ltl_expand(node);
+            return;
+        case LTL_AND:
+            node.new |= (LTL_BIT(sub->arg1) | LTL_BIT(sub->arg2)) & ~node.old;
+            node.old |= bit;
+            _ltl_expand(node);
+            return;
+        case LTL_NEXT:
+            node.old |= bit;
+            node.next |= LTL_BIT(sub->arg1);
+            _ltl_expand(node);
+            return;
+        case LTL_OR:
+        case LTL_UNTIL:
+        case LTL_RELEASE:{
+            //Split
+            LtlNode second = _ltl_node_copy(&node);
+            node.old |= bit;
+            second.old |= bit;
+            if(sub->op==LTL_OR){
+                node.new |= LTL_BIT(sub->arg1) & ~node.old;
+                second.new |= LTL_BIT(sub->arg2) & ~second.old;
+            } else if(sub->op==LTL_UNTIL){
+                //f U g = g or (f and X (f U g))
+                node.new |= LTL_BIT(sub->arg1) & ~node.old;
+                node.next |= bit;
+                second.new |= LTL_BIT(sub->arg2) & ~second.old;
+            } else {
+                //f R g = (f and g) or (g and X (f R g))
+                node.new |= LTL_BIT(sub->arg2) & ~node.old;
+                node.next |= bit;
+                second.new |= (LTL_BIT(sub->arg1) | LTL_BIT(sub->arg2)) & ~second.old;
+            }
+            _ltl_expand(node);
+            _ltl_expand(second);
+            return;
+        }
+    }
+}
+
+static int _ltl_with_dead(Expression *exp){
+    if(exp==NULL)
+        return 0;
+    switch(exp->type){
+        case L_PROPERTY:
+            return exp->get.property.source==L_DEAD;
+        case L_BINARY_EXPRESSION:
+            return _ltl_with_dead(exp->get.binary_exp.arg1)
+                    || _ltl_with_dead(exp->get.binary_exp.arg2);
+        case L_UNARY_EXPRESSION:
+            return _ltl_with_dead(exp->get.unary_exp);
+        default:
+            return 0;
+    }
+}
+
+LtlAutomaton * ltl_automaton_create(Formula *formula){
+    assert(formula);
+    LtlAutomaton *automaton = (LtlAutomaton *) calloc(1, sizeof(LtlAutomaton));
+    if(automaton==NULL)
+        ERRORMACRO(" LTL: Impossible to create the automaton\n");
+    //Top level negations and path quantifier
+    int negations = 0, universal = 1;
+    Formula *body = formula;
+    while(body->type==L_UNARY && body->get.unary.logic==L_NEGATION){
+        negations++;
+        body = body->get.unary.arg;
+    }
+    if(body->type==L_UNARY && (body->get.unary.logic==L_GLOBAL
+            || body->get.unary.logic==L_EXISTENTIAL)){
+        universal = body->get.unary.logic==L_GLOBAL;
+        body = body->get.unary.arg;
+    } else {
+        //No quantifier: for all paths, negations are part of the path formula
+        negations = 0;
+        body = formula;
+    }
+    //A lasso is a counterexample of A f, or a witness of E f
+    automaton->lasso_result = (universal == (negations % 2));
+    _ltl_closure_size = 0;
+    const int root = _ltl_convert(body, universal);
+    automaton->subformulas = _ltl_closure_size;
+
+    //Complementary literals
+    int i, j;
+    for(i=0; i < _ltl_closure_size; i++){
+        _ltl_complement[i] = 0;
+        for(j=0; j < _ltl_closure_size; j++)
+            if(_ltl_closure[i].op==LTL_ATOM && _ltl_closure[j].op==LTL_ATOM
+                    && _ltl_closure[i].exp==_ltl_closure[j].exp
+                    && _ltl_closure[i].negated!=_ltl_closure[j].negated)
+                _ltl_complement[i] |= LTL_BIT(j);
+    }
+
+    //Generalized automaton: the tableau nodes
+    _ltl_nodes_size = 0;
+    LtlNode init = {LTL_BIT(root), 0, 0, NULL, 0, 0};
+    _ltl_incoming_add(&init, LTL_INIT);
+    _ltl_expand(init);
+    const int nodes = _ltl_nodes_size;
+    automaton->tableau_nodes = nodes;
+
+    //One acceptance set per until: f U g is not pending or g holds
+    int untils[LTL_MAX_SUBFORMULAS];
+    int sets = 0;
+    for(i=0; i < _ltl_closure_size; i++)
+        if(_ltl_closure[i].op==LTL_UNTIL)
+            untils[sets++] = i;
+    automaton->acceptance_sets = sets;
+    ub8 *accept = (ub8 *) calloc(nodes + 1, sizeof(ub8));
+    int *out_size = (int *) calloc(nodes + 1, sizeof(int));
+    if(accept==NULL || out_size==NULL)
+        ERRORMACRO(" LTL: Impossible to create the automaton\n");
+    for(i=0; i < nodes; i++){
+        const ub8 old = _ltl_nodes[i].old;
+        for(j=0; j < sets; j++)
+            if(!(old & LTL_BIT(untils[j]))
+                    || (old & LTL_BIT(_ltl_closure[untils[j]].arg2)))
+                accept[i] |= LTL_BIT(j);
+        for(j=0; j < _ltl_nodes[i].incoming_size; j++)
+            if(_ltl_nodes[i].incoming[j]!=LTL_INIT)
+                out_size[_ltl_nodes[i].incoming[j]]++;
+            else
+                automaton->initial_size++;
+    }
+
+    //Degeneralization: a counter waits for each set in turn, the states of
+    //the first set are accepting when the counter is 0
+    const int counters = sets ? sets : 1;
+    automaton->size = nodes*counters;
+    automaton->states = (LtlAutomatonState *) calloc(automaton->size + 1,
+            sizeof(LtlAutomatonState));
+    automaton->initial = (int *) malloc((automaton->initial_size + 1)*sizeof(int));
+    if(automaton->states==NULL || automaton->initial==NULL)
+        ERRORMACRO(" LTL: Impossible to create the automaton\n");
+    int c, initial = 0;
+    for(i=0; i < nodes; i++)
+        for(c=0; c < counters; c++){
+            LtlAutomatonState *state = &automaton->states[i*counters + c];
+            state->accepting = (c==0 && (!sets || (accept[i] & 1)));
+            for(j=0; j < _ltl_closure_size; j++)
+                if(_ltl_closure[j].op==LTL_ATOM && (_ltl_nodes[i].old & LTL_BIT(j)))
+                    state->label_size++;
+            state->label = (LtlLiteral *) malloc((state->label_size + 1)*sizeof(LtlLiteral));
+            state->successors = (int *) malloc((out_size[i] + 1)*sizeof(int));
+            if(state->label==NULL || state->successors==NULL)
+                ERRORMACRO(" LTL: Impossible to create the automaton\n");
+            state->label_size = 0;
+            for(j=0; j < _ltl_closure_size; j++)
+                if(_ltl_closure[j].op==LTL_ATOM && (_ltl_nodes[i].old & LTL_BIT(j))){
+                    state->label[state->label_size].exp = _ltl_closure[j].exp;
+                    state->label[state->label_size].negated = _ltl_closure[j].negated;
+                    state->label_size++;
+                    automaton->with_dead |= _ltl_with_dead(_ltl_closure[j].exp);
+                }
+        }
+    for(i=0; i < nodes; i++)
+        for(j=0; j < _ltl_nodes[i].incoming_size; j++){
+            const int from = _ltl_nodes[i].incoming[j];
+            if(from==LTL_INIT){
+                automaton->initial[initial++] = i*counters;
+                continue;
+            }
+            for(c=0; c < counters; c++){
+                const int next = (sets && (accept[from] & LTL_BIT(c))) ?
+                    (c + 1) % counters : c;
+                LtlAutomatonState *state = &automaton->states[from*counters + c];
+                state->successors[state->successors_size++] = i*counters + next;
+            }
+        }
+
+    for(i=0; i < nodes; i++)
+        free(_ltl_nodes[i].incoming);
+    free(_ltl_nodes);
+    _ltl_nodes = NULL;
+    _ltl_nodes_capacity = 0;
+    free(accept);
+    free(out_size);
+    return automaton;
+}
+
+void ltl_automaton_print(LtlAutomaton *automaton){
+    assert(automaton);
+    fprintf(stdout, "\n Buchi automaton:\t %d states (%d initial)",
+            automaton->size, automaton->initial_size);
+    fprintf(stdout, "\n \t Subformulas:\t\t %d", automaton->subformulas);
+    fprintf(stdout, "\n \t Tableau nodes:\t\t %d", automaton->tableau_nodes);
+    fprintf(stdout, "\n \t Acceptance sets:\t %d\n", automaton->acceptance_sets);
+}
+
+void ltl_automaton_free(LtlAutomaton *automaton){
+    if(automaton==NULL)
+        return;
+    int i;
+    for(i=0; i < automaton->size; i++){
+        free(automaton->states[i].label);
+        free(automaton->states[i].successors);
+    }
+    free(automaton->states);
+    free(automaton->initial);
+    free(automaton);
+}
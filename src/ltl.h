@@ -0,0 +1,101 @@
+/**
+ * @file        ltl.h
+ * @author      Rodrigo Tacla Saad
+ * @email       rodrigo.tacla.saad@gmail.com
+ * @company:    LAAS-CNRS / Vertics
+ * @created     on October 18, 2026, 11:50 PM
+ *
+ * @section LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Buchi automata of LTL formulas for the on-the-fly LTL model checker (see
+ * reachgraph_ltl.h). The formulas are written with the syntax of the CTL
+ * parser (logics.y) and read as LTL: the first path quantifier tells whether
+ * the formula holds for all paths (A) or for some path (E), the inner ones are
+ * ignored. For instance, "A [] A <> p" is G F p and "p ==> q" is G (p -> F q).
+ *
+ * The automaton is the one of the negation of the formula for A (a path
+ * satisfying it is a counterexample) and of the formula itself for E (a path 
+ * satisfying it is a witness). It is built with the tableau of Gerth, Peled,
+ * Vardi and Wolper, then degeneralized with a counter of acceptance sets.
+ * States are labelled with a conjunction of literals, checked on the state 
+ * of the net the automaton enters.
+ */
+
+#ifndef _LTL_H
+#define	_LTL_H
+
+#include "standard_includes.h"
+#include "logics_struct.h"
+
+//Subformulas are sets of 64 bits
+#define LTL_MAX_SUBFORMULAS 64
+
+typedef struct LtlLiteralStruct{
+    Expression *exp;
+    int negated;
+}LtlLiteral;
+
+typedef struct LtlAutomatonStateStruct{
+    int accepting;
+    int label_size;                     //Conjunction of literals
+    LtlLiteral *label;
+    int successors_size;
+    int *successors;
+}LtlAutomatonState;
+
+typedef struct LtlAutomatonStruct{
+    int size;
+    LtlAutomatonState *states;
+    int initial_size;
+    int *initial;
+    int with_dead;                      //Labels need the number of successors
+    int lasso_result;                   //Formula result if an accepting lasso
+                                        //of the product exists
+    //For stats
+    int subformulas;
+    int tableau_nodes;
+    int acceptance_sets;
+}LtlAutomaton;
+
+/**
+ * Builds the Buchi automaton of a formula parsed by logics.y.
+ * @param formula The parsed formula (FORMULA_MC)
+ * @return The automaton
+ */
+extern LtlAutomaton * ltl_automaton_create(Formula *formula);
+
+/**
+ * Prints the size of the automaton.
+ */
+extern void ltl_automaton_print(LtlAutomaton *automaton);
+
+/**
+ * Releases the automaton. The expressions belong to the formula.
+ */
+extern void ltl_automaton_free(LtlAutomaton *automaton);
+
+#endif	/* _LTL_H */
@@ -118,6 +118,8 @@
 #include "petri_net_printer.h"
 #include "logics_struct.h"
 #include "reachgraph_ssd.h"
+#include "reachgraph_ddd.h"
+#include "reachgraph_ltl.h"
 
 extern int  yyparse();
 extern FILE *yyin;
@@ -159,7 +161,7 @@ int main(int argc, char** argv){
         net_parser_free(net);
 
         
-        if(ENABLECTLMC){
+        if(ENABLECTLMC || LTLMC){
             //Parse formula
             parsed_net = struct_net;
             void * my_string_buffer = logics_scan_string(CTLFORMULA);
@@ -175,11 +177,19 @@ int main(int argc, char** argv){
             #endif
         } else if(PRINTER==NON_VERBOSE)
             petri_net_print_net_resume(struct_net);
+        /*Enabling checkers benchmark*/
+        if (GUARDBENCH)
+            marking_guard_benchmark(struct_net);
+        /*On-the-fly LTL model checking*/
+        else if (LTLMC)
+            reachgraph_ltl_start(struct_net);
         /*State Class Construction*/
-        if (REACHAB!=0){
+        else if (REACHAB!=0){
             //if(NUMBEROFTHREADS > 1)
             if(DICTIONARY!=PARTITION_SSD)
                 reachgraph_start(struct_net, DFIRST, MODE);
+            else if(DISCBFS)
+                reachgraph_ddd_start(struct_net, DFIRST, MODE);
             else
                 reachgraph_ssd_start(struct_net, DFIRST, MODE);
 /*
@@ -49,6 +49,9 @@
 #include "marking.h"
 
 #include "multiset.h"
+#include "multiset_array.h"
+
+#include <time.h>
 
 void marking_set_tls(){
     multiset_set_tls_features();
@@ -73,46 +76,166 @@ int marking_get_prop(Marking mark, int index){
     return multiset_get(index, mark);
 }
 
-int marking_enabled_transitions(StackInteger *stack, const Marking m, const Net *net){
-    if (m==NULL){        
-        return 0; //Empty Marking
-    }    
-    //Reset Stack
-    stack_int_reset(stack);
+//Incremental enabling, only for MULTI_ARRAY markings (one char per place).
+//Last marking tested (the parent) and its enabled transitions.
+__thread char *marking_parent = NULL;
+__thread int *marking_parent_enabled = NULL;
+__thread int marking_parent_enabled_size = -1;
+__thread int *marking_child_enabled = NULL;
+
+//Tests the firing condition of a transition
+static inline int _marking_condition(const ConditionType *cc, const Marking m){
+    int w;
+    while(cc!=NULL){
+        if (cc->condition_type==LL){
+            w = multiset_get(cc->condition.ll.place, m);
+            if (w < cc->condition.ll.weight)
+                return 0;
+            cc = cc->link;
+        } else if(cc->condition_type==LH){
+            w = multiset_get(cc->condition.lh.place, m);
+            if (w >= cc->condition.lh.weight_smaller_than || w < cc->condition.lh.weight_great_than)
+                return 0;
+            cc = cc->link;
+        } else
+            cc = NULL;
+    }
+    return 1;
+}
+
+//Saves m as the new parent
+static void _marking_save_parent(const char *m, const int *enabled, int size,
+        const Net *net){
+    const int places = net->place_names->size;
+    if(!marking_parent){
+        const int transitions = net->trans_cond->size;
+        errno = 0;
+        marking_parent = (char *) malloc(places + 1);
+        marking_parent_enabled = (int *) malloc((transitions + 1)*sizeof(int));
+        marking_child_enabled = (int *) malloc((transitions + 1)*sizeof(int));
+        if(!marking_parent || !marking_parent_enabled
+                || !marking_child_enabled || errno != 0){
+            ERRORMACRO(" marking: Impossible to create the enabling cache\n");
+        }
+    }
+    memcpy(marking_parent, m, places);
+    if(enabled != marking_parent_enabled)
+        memcpy(marking_parent_enabled, enabled, size*sizeof(int));
+    marking_parent_enabled_size = size;
+}
+
+//Derives the enabled transitions of m from the parent ones if m is a
+//successor of the parent (m = parent + delta(t), t enabled by the parent).
+//Only the transitions that depend on t are tested again. Returns -1 if m is
+//not a successor.
+static int _marking_enabled_transitions_incremental(StackInteger *stack,
+        const char *m, const Net *net){
+    const int places = net->place_names->size;
+    register int i, j;
+    int diff = 0, first = -1;
+    //Places that differ from the parent
+    for(i = 0; i < places; i++){
+        if(m[i] != marking_parent[i]){
+            if(first < 0)
+                first = i;
+            diff++;
+        }
+    }
+    int *enabled = marking_parent_enabled;
+    int size = marking_parent_enabled_size;
+    if(diff){
+        //Look for the fired transition among the ones enabled by the parent
+        NetIndexType *delta = NULL;
+        for(j = 0; j < marking_parent_enabled_size; j++){
+            delta = (NetIndexType *) net->trans_delta_places->vector[marking_parent_enabled[j]];
+            if(delta->size != diff || delta->index[0] > first)
+                continue;
+            for(i = 0; i < delta->size; i++){
+                const int p = delta->index[i];
+                if(m[p] != marking_parent[p] + delta->weight[i])
+                    break;
+            }
+            if(i == delta->size)
+                break;
+        }
+        if(j == marking_parent_enabled_size)
+            return -1;
+        //Merge parent enabled transitions with the dependent ones
+        const NetIndexType *dependency = (NetIndexType *)
+                net->trans_dependency->vector[marking_parent_enabled[j]];
+        const int *dep = dependency->index;
+        const int dep_size = dependency->size;
+        int e = 0, d = 0;
+        size = 0;
+        enabled = marking_child_enabled;
+        while(e < marking_parent_enabled_size || d < dep_size){
+            if(d == dep_size || (e < marking_parent_enabled_size
+                    && marking_parent_enabled[e] < dep[d])){
+                enabled[size++] = marking_parent_enabled[e++];
+            } else {
+                if(e < marking_parent_enabled_size
+                        && marking_parent_enabled[e] == dep[d])
+                    e++;
+                if((GUARDTYPE != GUARD_LIST)
+                        ? guard_transition_enabled(m, net->trans_guard, dep[d])
+                        : _marking_condition((ConditionType *)
+                        net->trans_cond->vector[dep[d]], (const Marking) m))
+                    enabled[size++] = dep[d];
+                d++;
+            }
+        }
+        //The child becomes the new parent
+        marking_child_enabled = marking_parent_enabled;
+        marking_parent_enabled = enabled;
+    }
+    _marking_save_parent(m, enabled, size, net);
+    for(i = 0; i < size; i++)
+        stack_int_push(stack, enabled[i]);
+    return size;
+}
 
+//Walks the linked list of conditions of each transition
+static int _marking_enabled_transitions_list(StackInteger *stack,
+        const Marking m, const Net *net){
+    register int j, size=0;
     //Set multiset marking vector, important only for multiset list
     multiset_marking_vector(m, net->place_names->size);
 
-    register int j, size=0;
-    int ok;
-    int w;
-    ConditionType *cc=NULL;
     for (j = 0; j < net->trans_cond->size; j++) {
-        ok=1;
-        cc = (ConditionType *)(net->trans_cond->vector[j]);
-        while(cc!=NULL){
-            if (cc->condition_type==LL){                
-                    w = multiset_get(cc->condition.ll.place, m);
-                if (w < cc->condition.ll.weight){
-                    ok=0;
-                    cc = NULL;
-                } else
-                    cc = cc->link;
-            } else if(cc->condition_type==LH){
-                    w = multiset_get(cc->condition.lh.place, m);
-                if (w >= cc->condition.lh.weight_smaller_than || w < cc->condition.lh.weight_great_than){
-                    ok=0;
-                    cc = NULL;
-                } else
-                    cc = cc->link;
-            } else
-                cc = NULL;
-        }
-        if(ok){
+        if(_marking_condition((ConditionType *)(net->trans_cond->vector[j]), m)){
             stack_int_push(stack, j);
             size +=1;
         }
-    }   
+    }
+    return size;
+}
+
+int marking_enabled_transitions(StackInteger *stack, const Marking m, const Net *net){
+    if (m==NULL){        
+        return 0; //Empty Marking
+    }    
+    //Reset Stack
+    stack_int_reset(stack);
+
+    register int size=0;
+    const int incremental = (MULTITYPESET == MULTI_ARRAY
+                                && net->trans_dependency);
+    if(incremental && marking_parent_enabled_size >= 0){
+        size = _marking_enabled_transitions_incremental(stack,
+                (const char *) m, net);
+        if(size >= 0)
+            return size;
+        size = 0;
+    }
+
+    if(MULTITYPESET == MULTI_ARRAY && GUARDTYPE != GUARD_LIST){
+        //Compiled guard program
+        size = guard_enabled_transitions(stack, (const char *) m,
+                net->trans_guard, GUARDTYPE);
+    } else
+        size = _marking_enabled_transitions_list(stack, m, net);
+    if(incremental)
+        _marking_save_parent((const char *) m, stack->vector, size, net);
     return size;
 }
 
@@ -157,6 +280,11 @@ int marking_enabled_transitions_reverse(StackInteger *stack, const Marking m, co
 }
 
 Marking marking_fire(const Marking m, const Net *net, const int trans){
+    if(MULTITYPESET == MULTI_ARRAY){
+        Marking new = marking_init();
+        marking_fire_temp_state(m, net, trans, new);
+        return new;
+    }
     return multiset_add( m, (Marking ) net->trans_delta->vector[trans]);    
 }
 
@@ -166,6 +294,15 @@ Marking marking_fire_reverse(const Marking m, const Net *net, const int trans){
 
 void marking_fire_temp_state(const Marking m, const Net *net,
         const int trans, Marking new){
+    if(MULTITYPESET == MULTI_ARRAY){
+        //Sparse firing: copy the marking and patch only the changed places
+        const NetIndexType *delta =
+                (NetIndexType *) net->trans_delta_places->vector[trans];
+        multiset_array_add_sparse_temp_state((MultisetTypeArray *) m,
+                delta->index, delta->weight, delta->size,
+                (MultisetTypeArray *) new);
+        return;
+    }
     multiset_add_temp_state( m, (Marking ) net->trans_delta->vector[trans], new);
 }
 
@@ -204,6 +341,22 @@ HashWord marking_hash_k(const int number, const Marking m){
     return multiset_hash(m, number);
 }
 
+void marking_hash_wide(const Marking m, HashWide *wide){
+    multiset_hash_wide(m, HASHNUMBER+1, wide);
+}
+
+ub8 marking_hash_incremental(const Marking m){
+    return multiset_array_hash_incremental((MultisetTypeArray *) m);
+}
+
+ub8 marking_hash_incremental_fire(ub8 base, const Marking m, const Net *net,
+        const int trans){
+    const NetIndexType *delta =
+            (NetIndexType *) net->trans_delta_places->vector[trans];
+    return multiset_array_hash_incremental_add(base, (MultisetTypeArray *) m,
+            delta->index, delta->weight, delta->size);
+}
+
 int * marking_to_vector(const Marking multi, int size){
     return multiset_marking_vector((Marking ) multi, size);
 }
@@ -225,3 +378,94 @@ void marking_print(const Marking multi, const Net *net){
     strcpy(c_end, ")");
     multiset_print_list(start, between, c_end, multi, net->place_names);
 }
+
+//Guard benchmark: markings sampled by a random walk from the initial marking
+#define MARKING_BENCH_SAMPLES 4096
+#define MARKING_BENCH_WALK 256
+#define MARKING_BENCH_ROUNDS 64
+
+static double _marking_bench_time(){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static double _marking_bench_run(StackInteger *stack, Marking *samples,
+        const Net *net, GuardType type, long *checksum){
+    register int i, r;
+    long sum = 0;
+    const double start = _marking_bench_time();
+    for(r = 0; r < MARKING_BENCH_ROUNDS; r++){
+        for(i = 0; i < MARKING_BENCH_SAMPLES; i++){
+            int n;
+            stack_int_reset(stack);
+            if(type == GUARD_LIST)
+                n = _marking_enabled_transitions_list(stack, samples[i], net);
+            else
+                n = guard_enabled_transitions(stack,
+                        (const char *) samples[i], net->trans_guard, type);
+            //Count and last enabled transition, to compare the checkers
+            sum += n;
+            if(n > 0)
+                sum += (long) stack->vector[n - 1] << 16;
+        }
+    }
+    const double end = _marking_bench_time();
+    *checksum = sum;
+    return (end - start) * 1e9 / ((double) MARKING_BENCH_SAMPLES * MARKING_BENCH_ROUNDS);
+}
+
+void marking_guard_benchmark(const Net *net){
+    if(MULTITYPESET != MULTI_ARRAY)
+        ERRORMACRO(" Guard benchmark: only available for vector markings (-b 1)");
+    register int i;
+    errno = 0;
+    Marking *samples = (Marking *) malloc(MARKING_BENCH_SAMPLES*sizeof(Marking));
+    if(!samples || errno != 0){
+        ERRORMACRO(" Guard benchmark: Impossible to create samples\n");
+    }
+    StackInteger *stack = stack_int_init();
+    Marking current = marking_copy(net->init_marking);
+    unsigned int seed = 1;
+    //Random walk, restarts from the initial marking at dead markings
+    for(i = 0; i < MARKING_BENCH_SAMPLES; i++){
+        samples[i] = marking_copy(current);
+        stack_int_reset(stack);
+        const int n = _marking_enabled_transitions_list(stack, current, net);
+        if(n == 0 || (i % MARKING_BENCH_WALK) == MARKING_BENCH_WALK - 1)
+            marking_copy_to(net->init_marking, current);
+        else
+            marking_fire_temp_state(current, net,
+                    stack->vector[rand_r(&seed) % n], current);
+    }
+    fprintf(stdout, "\n Guard benchmark:\t\t\t");
+    fprintf(stdout, "\n \t Markings:\t \t \t %d x %d \t",
+            MARKING_BENCH_SAMPLES, MARKING_BENCH_ROUNDS);
+    fprintf(stdout, "\n \t Conditions:\t \t \t %d \t",
+            net->trans_guard->conditions);
+    long list_sum = 0, sum = 0;
+    const double list = _marking_bench_run(stack, samples, net, GUARD_LIST,
+            &list_sum);
+    fprintf(stdout, "\n \t List walker:\t \t \t %.1f ns/marking \t", list);
+    const double compiled = _marking_bench_run(stack, samples, net,
+            GUARD_COMPILED, &sum);
+    if(sum != list_sum)
+        ERRORMACRO(" Guard benchmark: compiled guards disagree with the list walker");
+    fprintf(stdout, "\n \t Compiled:\t \t \t %.1f ns/marking (x%.2f) \t",
+            compiled, list / compiled);
+    if(guard_simd_supported()){
+        const double simd = _marking_bench_run(stack, samples, net,
+                GUARD_SIMD, &sum);
+        if(sum != list_sum)
+            ERRORMACRO(" Guard benchmark: SIMD guards disagree with the list walker");
+        fprintf(stdout, "\n \t Compiled SIMD:\t \t %.1f ns/marking (x%.2f) \t",
+                simd, list / simd);
+    } else
+        fprintf(stdout, "\n \t Compiled SIMD:\t \t not supported \t");
+    fprintf(stdout, "\n");
+    for(i = 0; i < MARKING_BENCH_SAMPLES; i++)
+        marking_free(samples[i]);
+    free(samples);
+    marking_free(current);
+    stack_int_delete_all(stack);
+}
@@ -96,7 +96,9 @@ extern int marking_get_prop(Marking mark, int index);
 /*
  * Returns the set of transitions enabled by the argument marking m. The set of
  * transitions is stored into the argument stack and the function returns the
- * its size.
+ * its size. For vector markings, the set is derived from the last marking
+ * tested by the thread (its parent) when m is one of its successors: only the
+ * transitions that depend on the fired one are tested again.
  * @param stack Stack to store the enabled transitions
  * @param m Marking
  * @param net Petri Net reference
@@ -197,6 +199,35 @@ extern HashWord marking_hash_from_seed(const Marking m, HashWord seed);
 extern HashWord marking_hash_k(const int number, const Marking m);
 
 
+/**
+ * Hash the marking and returns a wide (128 bits) hash value. The hash values
+ * are derived with hash_wide_k.
+ * @param m Marking
+ * @param wide Returned hash value
+ */
+extern void marking_hash_wide(const Marking m, HashWide *wide);
+
+/**
+ * Incremental base hash of the marking (see hash_driver.h). Only for vector
+ * markings. The hash values are derived with hash_incremental_derive.
+ * @param m Marking
+ * @return Base hash value
+ */
+extern ub8 marking_hash_incremental(const Marking m);
+
+/**
+ * Incremental base hash of the marking reached by firing trans over m, given
+ * the base hash of m. It only visits the places changed by the transition.
+ * @param base Base hash of m
+ * @param m Marking
+ * @param net Petri Net reference
+ * @param trans Transition index from the Petri Net structure
+ * @return Base hash value of the new marking
+ */
+extern ub8 marking_hash_incremental_fire(ub8 base, const Marking m,
+        const Net *net, const int trans);
+
+
 /**
  * Deprecated
  * Similar to marking_hash_from_seed but it returns a set of "bloom_keys" hash
@@ -248,4 +279,12 @@ extern void marking_print(const Marking multi, const Net *net);
  */
 extern int marking_size();
 
+/*
+ * Micro-benchmark of the transition enabling checkers (list walker, compiled
+ * guards and compiled SIMD guards) over markings sampled by a random walk from
+ * the initial marking. Only for vector markings.
+ * @param net Petri Net reference
+ */
+extern void marking_guard_benchmark(const Net *net);
+
 #endif	/* _MARKING_H */
@@ -714,6 +714,24 @@ HashWord multiset_hash(const MultisetType *multi, int arg_seed){
     }
 }
 
+void multiset_hash_wide(const MultisetType *multi, int arg_seed,
+        HashWide *wide){
+    switch (multi_type){
+        case MULTI_ARRAY:
+            multiset_array_hash_wide((const MultisetTypeArray *) multi,
+                    arg_seed, wide);
+            break;
+        case MULTI_BIT:
+        case MULTI_LIST:
+            //Two seeded hashes
+            wide->h1 = multiset_hash(multi, arg_seed);
+            wide->h2 = multiset_hash(multi, arg_seed + 1) | 1;
+            break;
+        default:
+            ERRORMACRO(" Multiset option not supported");
+    }
+}
+
 HashWord multiset_hash_from_seed(const MultisetType *multi, HashWord arg_seed){
     switch (multi_type){
         case MULTI_ARRAY:
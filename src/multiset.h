@@ -375,6 +375,15 @@ extern int * multiset_marking_vector(const MultisetType *multi, int size);
  */
 extern HashWord multiset_hash(const MultisetType *multi, int arg_seed);
 
+/**
+ * Hash the multiset and returns a wide (128 bits) hash value.
+ * @param multi Multiset pointer
+ * @param arg_seed Seed index for hash function.
+ * @param wide Returned hash value
+ */
+extern void multiset_hash_wide(const MultisetType *multi, int arg_seed,
+        HashWide *wide);
+
 /**
  * Hash the multiset and returns the hash value.
  * @param multi Multiset pointer
@@ -189,6 +189,24 @@ void multiset_array_add_temp_state(const MultisetTypeArray *d1, const MultisetTy
     }
 }
 
+void multiset_array_add_sparse_temp_state(const MultisetTypeArray *d1,
+        const int *place, const int *delta, const int size,
+        MultisetTypeArray *new) {
+    assert(d1 && new && (size == 0 || (place && delta)));
+    register int i=0;
+    //Copy the marking and patch only the places changed by the delta
+    if(d1 != new)
+        memcpy(new, d1, multisetSizeArray - multisetArrayAlignment);
+    for (i = 0; i < size; i++) {
+        const int value = d1[place[i]] + delta[i];
+        if(value >= M_ARRAY_MAX_VALUE)
+            ERRORMACRO(" Multiset Char overflow: marking place > 125");
+        if(value <= -M_ARRAY_MAX_VALUE)
+            ERRORMACRO(" Multiset Char overflow: marking place < -125");
+        new[place[i]] = value;
+    }
+}
+
 MultisetTypeArray * multiset_array_add(const MultisetTypeArray *d1, const MultisetTypeArray *d2) {
     assert(d1 && d2);
     MultisetTypeArray *new = NULL;
@@ -372,3 +390,29 @@ HashWord multiset_array_hash_from_seed(const MultisetTypeArray *multi, HashWord
     return hash_data_char((ub1 *) multi, multisetSizeArray, arg_seed);
 }
 
+void multiset_array_hash_wide(const MultisetTypeArray *multi, int arg_seed,
+        HashWide *wide){
+    hash_data_wide_for_char((ub1 *) multi, multisetSizeArray, arg_seed, wide);
+}
+
+ub8 multiset_array_hash_incremental(const MultisetTypeArray *multi){
+    register int i=0;
+    ub8 base = 0;
+    for (i = 0; i < multisetSizeArray - multisetArrayAlignment; i++) {
+        if(multi[i])
+            base ^= hash_incremental_key(i, multi[i]);
+    }
+    return base;
+}
+
+ub8 multiset_array_hash_incremental_add(ub8 base, const MultisetTypeArray *d1,
+        const int *place, const int *delta, const int size){
+    register int i=0;
+    for (i = 0; i < size; i++) {
+        const int p = place[i];
+        base ^= hash_incremental_key(p, d1[p])
+                ^ hash_incremental_key(p, d1[p] + delta[i]);
+    }
+    return base;
+}
+
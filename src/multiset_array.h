@@ -58,6 +58,10 @@ extern void multiset_array_insert(MultisetTypeArray *plist, int place, int weigh
 extern MultisetTypeArray * multiset_array_add(const MultisetTypeArray *m1, const MultisetTypeArray *m2);
 extern void multiset_array_add_temp_state(const MultisetTypeArray *d1, const MultisetTypeArray *d2,
         MultisetTypeArray *new);
+/*Adds a sparse delta: copies d1 into new and patches only the delta places*/
+extern void multiset_array_add_sparse_temp_state(const MultisetTypeArray *d1,
+        const int *place, const int *delta, const int size,
+        MultisetTypeArray *new);
 extern MultisetTypeArray * multiset_array_sub(const MultisetTypeArray *m1, const MultisetTypeArray *m2);
 extern MultisetTypeArray * multiset_array_sub_r(const MultisetTypeArray *m1, const MultisetTypeArray *m2);
 /*lexicographic >. note: ge m m' /\ m <> m' implies sup m m*/
@@ -87,6 +91,14 @@ extern int multiset_array_to_key(bloom_slot *key, const MultisetTypeArray *m);
 extern int * multiset_array_marking_vector(const MultisetTypeArray *multi, int size);
 extern HashWord multiset_array_hash(const MultisetTypeArray *multi, int arg_seed);
 extern HashWord multiset_array_hash_from_seed(const MultisetTypeArray *multi, HashWord arg_seed);
+extern void multiset_array_hash_wide(const MultisetTypeArray *multi,
+        int arg_seed, HashWide *wide);
+/*Incremental base hash (see hash_driver.h) of the whole multiset*/
+extern ub8 multiset_array_hash_incremental(const MultisetTypeArray *multi);
+/*Incremental base hash of d1 plus a sparse delta, given the base hash of d1*/
+extern ub8 multiset_array_hash_incremental_add(ub8 base,
+        const MultisetTypeArray *d1, const int *place, const int *delta,
+        const int size);
 
 extern int multiset_array_size();
 
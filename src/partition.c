@@ -35,6 +35,10 @@
  * 
  */
 
+//fallocate
+#ifndef _GNU_SOURCE
+#   define _GNU_SOURCE
+#endif
 #include "reset_define_includes.h"
 #define STRINGLIB
 #define ERRORLIB
@@ -42,25 +46,35 @@
 #define STDLIB
 #define MAXMACRO 
 #define UNISTD
+#define PTHREADLIB
 #define MATHLIB
 #include "partition.h"
 
 #include <stdarg.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <time.h>
 #include "atomic_interface.h"
 #include "hash_driver.h"
-#include "tpl.h"                                //Serialization Library
 #include "generic.h"
 #include "hash_table_simple_small_type.h"
 #include "hash_table.h"
 #include "disc_access.h"
-#include "data_compression.h"                        
-#include "data_compression.h"
+#include "hash_table_simple_small.h"
 
 
 #define CYCLE_TO_WAIT_PARTITION 100
+//Bloom summary of a partition of states: bits per slot and hash functions
+#define PARTITION_SUMMARY_BITS_PER_SLOT 8
+#define PARTITION_SUMMARY_HASHES 4
 
-__thread CompressionContainer *compression_states = NULL;
-__thread CompressionContainer *compression_collisions = NULL;
+//States of a sorted block and states decoded in parallel per thread
+#define PARTITION_BLOCK_STATES 256
+#define PARTITION_SORT_INSERTION 16
+#define PARTITION_DECODE_HELPERS 7
+#define PARTITION_DECODE_BLOCKS_PER_THREAD 4
+//Sorted runs of a partition before they are merged
+#define PARTITION_SEARCH_RUNS 8
 
 /*Private Functions*/
 
@@ -70,9 +84,699 @@ static void _partition_cycle_wait(){
         cl++;
     }
 }
+/*Segment file*/
+
+/**
+ * Encodings of a record:
+ * SLOTS: occupancy bitmap of the num_slot slots of the table, the memo of the
+ * occupied slots and their data, restored slot by slot.
+ * PLAIN: the occupied states one after the other (logs of collisions).
+ * SORTED (-sc): the states sorted and cut in blocks of PARTITION_BLOCK_STATES.
+ * Each state is XORed with the previous one of its block and zero runs are
+ * written as a zero byte and the run length. The offsets of the blocks come 
+ * first so that they are decoded independently.
+ * PLAIN and SORTED records are rehashed into the table when read.
+ */
+typedef enum PartitionEncodingEnum{PARTITION_ENCODING_SLOTS, PARTITION_ENCODING_PLAIN, 
+            PARTITION_ENCODING_SORTED}PartitionEncoding;
+
+typedef struct PartitionRecordHeaderStruct{
+    ub4 slot_size;
+    ub4 num_slot;
+    ub8 count;
+    ub8 occupied;
+    ub8 partition_number;
+    ub8 size_encoded;       //Bytes of the blocks (SORTED)
+    ub4 encoding;
+    ub4 blocks;
+}PartitionRecordHeader;
+
+#define PARTITION_HEADER_SIZE ((sizeof(PartitionRecordHeader) + 63) & ~((ub8) 63))
+#define PARTITION_BITMAP_WORDS(num_slot) (((ub8)(num_slot) + 63) >> 6)
+
+//Thread buffer used to pack a record before writing it
+__thread ub1 *partition_buffer = NULL;
+__thread ub8 partition_buffer_size = 0;
+//Thread buffer of the last log read (partition_get_log)
+__thread ub1 *partition_log_buffer = NULL;
+__thread ub8 partition_log_buffer_size = 0;
+//Thread buffers of the states to sort and of the decoded states and keys
+__thread ub1 **partition_sort_buffer = NULL;
+__thread ub8 partition_sort_buffer_size = 0;
+__thread ub1 *partition_decode_buffer = NULL;
+__thread ub8 partition_decode_buffer_size = 0;
+__thread ub8 *partition_key_buffer = NULL;
+__thread ub8 partition_key_buffer_size = 0;
+//Thread buffer of the blocks (or records) of the runs read back
+__thread ub1 *partition_block_buffer = NULL;
+__thread ub8 partition_block_buffer_size = 0;
+
+static ub8 _partition_align(ub8 size, ub8 page_size){
+    return (size + page_size - 1) & ~(page_size - 1);
+}
+
+/*Largest record of a table with num_slot slots (all occupied)*/
+static ub8 _partition_record_capacity(int slot_size, ub8 num_slot){
+    return PARTITION_HEADER_SIZE + PARTITION_BITMAP_WORDS(num_slot)*sizeof(ub8)
+            + num_slot*(sizeof(HashMemo) + slot_size) + sizeof(int);
+}
+
+static void _partition_buffer_reserve(ub8 size){
+    if(partition_buffer_size >= size)
+        return;
+    free(partition_buffer);
+    partition_buffer = NULL;
+    if(posix_memalign((void **) &partition_buffer, 4096, size) || partition_buffer==NULL)
+        ERRORMACRO("partition: Impossible to allocate the record buffer");
+    partition_buffer_size = size;
+}
+
+/*Grows a thread buffer to size bytes at least*/
+static void* _partition_reserve(void *buffer, ub8 *buffer_size, ub8 size){
+    if(*buffer_size >= size)
+        return buffer;
+    free(buffer);
+    errno = 0;
+    buffer = malloc(size);
+    if(buffer==NULL || errno)
+        ERRORMACRO("partition: Impossible to allocate a thread buffer");
+    *buffer_size = size;
+    return buffer;
+}
+
+static void _partition_pwrite(PartitionTable* table, ub1 *buffer, ub8 size, ub8 offset){
+    while(size > 0){
+        errno = 0;
+        ssize_t written = pwrite(table->segment_fd, buffer, size, offset);
+        if(written < 0 && errno==EINTR)
+            continue;
+        if(written <= 0)
+            ERRORMACRO("partition_write: Unable to write the segment file");
+        buffer += written;
+        offset += written;
+        size -= written;
+    }
+}
+
+/*Releases the disc space of a record that will not be read again*/
+static void _partition_discard(PartitionTable* table, PartitionRecord record){
+    //A record of the last checkpoint is kept until the next one is written
+    if(record.offset < table->checkpoint_end){
+        pthread_mutex_lock(&table->retired_lock);
+        if(table->retired_count==table->retired_capacity){
+            table->retired_capacity = (table->retired_capacity > 0) ? 
+                                            2*table->retired_capacity : 64;
+            table->retired = (PartitionRecord *) realloc(table->retired, 
+                                table->retired_capacity*sizeof(PartitionRecord));
+            if(table->retired==NULL)
+                ERRORMACRO("partition: Impossible to grow the retired records");
+        }
+        table->retired[table->retired_count++] = record;
+        pthread_mutex_unlock(&table->retired_lock);
+        return;
+    }
+#ifdef FALLOC_FL_PUNCH_HOLE
+    fallocate(table->segment_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+            record.offset, _partition_align(record.size, table->page_size));
+#endif
+}
+
+/*
+ * Sorts the states byte by byte from depth (MSD radix sort). Bytes shared by
+ * all states are skipped, small buckets are finished by insertion.
+ */
+static void _partition_sort(ub1 **states, ub8 count, int depth, int slot_size, 
+        ub1 **scratch){
+    ub8 i, j;
+    while(count > PARTITION_SORT_INSERTION && depth < slot_size){
+        ub8 counts[256];
+        memset(counts, 0, sizeof(counts));
+        for(i=0; i < count; i++)
+            counts[states[i][depth]]++;
+        if(counts[states[0][depth]]==count){
+            depth++;
+            continue;
+        }
+        ub8 offsets[256], start = 0;
+        for(i=0; i < 256; i++){
+            offsets[i] = start;
+            start += counts[i];
+        }
+        for(i=0; i < count; i++)
+            scratch[offsets[states[i][depth]]++] = states[i];
+        memcpy(states, scratch, count*sizeof(ub1 *));
+        for(i=0, start=0; i < 256; start += counts[i], i++)
+            if(counts[i] > 1)
+                _partition_sort(states + start, counts[i], depth + 1, slot_size, scratch);
+        return;
+    }
+    if(depth >= slot_size)
+        return;
+    for(i=1; i < count; i++){
+        ub1 *state = states[i];
+        for(j=i; j > 0 && memcmp(states[j - 1] + depth, state + depth, slot_size - depth) > 0; j--)
+            states[j] = states[j - 1];
+        states[j] = state;
+    }
+}
+
+/*
+ * Delta encodes the sorted states of a block. The first state is written as
+ * is; each next one as the length of the prefix it shares with the previous
+ * state (varint), a bitmap of the bytes that differ after the prefix and 
+ * these bytes XORed with the previous state. Returns 0 if the block does not
+ * fit in limit bytes.
+ */
+static ub8 _partition_encode_block(ub1 **states, ub8 count, int slot_size, 
+        ub1 *out, ub8 limit){
+    if(count==0)
+        return 0;
+    ub8 i, o = slot_size;
+    if(o > limit)
+        return 0;
+    memcpy(out, states[0], slot_size);
+    for(i=1; i < count; i++){
+        ub1 *state = states[i], *previous = states[i - 1];
+        int k = 0, prefix;
+        while(k + 8 <= slot_size && !memcmp(state + k, previous + k, 8))
+            k += 8;
+        while(k < slot_size && state[k]==previous[k])
+            k++;
+        prefix = k;
+        int left = slot_size - prefix, mask_size = (left + 7) >> 3;
+        if(o + 3 + mask_size + left > limit)
+            return 0;
+        do{
+            out[o++] = (prefix & 127) | ((prefix >= 128) ? 128 : 0);
+            prefix >>= 7;
+        } while(prefix);
+        ub1 *mask = out + o;
+        memset(mask, 0, mask_size);
+        o += mask_size;
+        for(; k < slot_size; k++){
+            ub1 delta = state[k] ^ previous[k];
+            if(delta){
+                int bit = k - (slot_size - left);
+                mask[bit >> 3] |= 1 << (bit & 7);
+                out[o++] = delta;
+            }
+        }
+    }
+    return o;
+}
+
+static void _partition_decode_block(const ub1 *in, ub8 count, int slot_size, ub1 *states){
+    ub8 i;
+    memcpy(states, in, slot_size);
+    in += slot_size;
+    for(i=1; i < count; i++){
+        ub1 *state = states + i*slot_size;
+        int prefix = 0, shift = 0, k;
+        ub1 byte;
+        do{
+            byte = *in++;
+            prefix |= (byte & 127) << shift;
+            shift += 7;
+        } while(byte & 128);
+        memcpy(state, state - slot_size, slot_size);
+        int left = slot_size - prefix, mask_size = (left + 7) >> 3;
+        const ub1 *mask = in;
+        in += mask_size;
+        for(k=0; k < mask_size; k++){
+            unsigned int bits = mask[k];
+            while(bits){
+                state[prefix + (k << 3) + __builtin_ctz(bits)] ^= *in++;
+                bits &= bits - 1;
+            }
+        }
+    }
+}
+
+/*Decodes a block up to state, the states of a block are sorted*/
+static int _partition_decode_search(const ub1 *in, ub8 count, int slot_size, 
+        ub1 *states, const ub1 *state){
+    ub8 i;
+    memcpy(states, in, slot_size);
+    in += slot_size;
+    for(i=1; i < count; i++){
+        ub1 *current = states + i*slot_size;
+        int prefix = 0, shift = 0, k;
+        ub1 byte;
+        do{
+            byte = *in++;
+            prefix |= (byte & 127) << shift;
+            shift += 7;
+        } while(byte & 128);
+        memcpy(current, current - slot_size, slot_size);
+        int left = slot_size - prefix, mask_size = (left + 7) >> 3;
+        const ub1 *mask = in;
+        in += mask_size;
+        for(k=0; k < mask_size; k++){
+            unsigned int bits = mask[k];
+            while(bits){
+                current[prefix + (k << 3) + __builtin_ctz(bits)] ^= *in++;
+                bits &= bits - 1;
+            }
+        }
+        int compare = memcmp(current, state, slot_size);
+        if(compare >= 0)
+            return compare==0;
+    }
+    return 0;
+}
+
+/*
+ * Packs count states into the thread buffer as a SORTED record (PLAIN if the
+ * encoding does not pay off) and returns the record size. The states are
+ * sorted in place, states must have room for 2*count references.
+ */
+static ub8 _partition_pack_sorted(ub1 **states, ub8 count, int slot_size){
+    ub8 blocks = (count + PARTITION_BLOCK_STATES - 1)/PARTITION_BLOCK_STATES;
+    ub8 limit = count*slot_size;
+    _partition_buffer_reserve(PARTITION_HEADER_SIZE + blocks*sizeof(ub8) + limit);
+    PartitionRecordHeader *header = (PartitionRecordHeader *) partition_buffer;
+    _partition_sort(states, count, 0, slot_size, states + count);
+    
+    ub8 *offsets = (ub8 *) (partition_buffer + PARTITION_HEADER_SIZE);
+    ub1 *data = (ub1 *) (offsets + blocks);
+    ub8 b = 0, o = 0;
+    for(b=(blocks*sizeof(ub8) < limit) ? 0 : blocks; b < blocks; b++){
+        ub8 first = b*PARTITION_BLOCK_STATES;
+        ub8 size = _partition_encode_block(states + first, 
+                (count - first < PARTITION_BLOCK_STATES) ? count - first : PARTITION_BLOCK_STATES,
+                slot_size, data + o, limit - blocks*sizeof(ub8) - o);
+        if(size==0 || blocks*sizeof(ub8) + o + size > limit)
+            break;
+        offsets[b] = o;
+        o += size;
+    }
+    if(b==blocks && blocks > 0){
+        header->encoding = PARTITION_ENCODING_SORTED;
+        header->blocks = blocks;
+        header->size_encoded = o;
+        return PARTITION_HEADER_SIZE + blocks*sizeof(ub8) + o;
+    }
+    data = partition_buffer + PARTITION_HEADER_SIZE;
+    for(b=0; b < count; b++)
+        memcpy(data + b*slot_size, states[b], slot_size);
+    header->encoding = PARTITION_ENCODING_PLAIN;
+    header->blocks = 0;
+    header->size_encoded = 0;
+    return PARTITION_HEADER_SIZE + limit;
+}
+
+/*
+ * Packs the occupied slots of table_data into the thread buffer and returns
+ * the record size.
+ */
+static ub8 _partition_pack(HashTable* table_data, unsigned long partition_number){
+    int slot_size = table_data->table.in_place.slot_size;
+    ub8 num_slot = table_data->mask + 2;
+    ub8 words = PARTITION_BITMAP_WORDS(num_slot);
+    HashMemo *table_memo = table_data->table.in_place.memo;
+    HashTableUnit *table_slots = table_data->table.in_place.data;
+    ub8 i, occupied = 0, size = 0;
+    
+    if(STATECOMPRESSIONSSD){
+        partition_sort_buffer = (ub1 **) _partition_reserve(partition_sort_buffer, 
+                    &partition_sort_buffer_size, 2*num_slot*sizeof(ub1 *));
+        for(i=0; i < num_slot; i++)
+            if(table_memo[i] || hash_table_in_place_mem_is_set(table_slots + i*slot_size, table_data))
+                partition_sort_buffer[occupied++] = table_slots + i*slot_size;
+        size = _partition_pack_sorted(partition_sort_buffer, occupied, slot_size);
+    } else {
+        _partition_buffer_reserve(_partition_record_capacity(slot_size, num_slot));
+        ub8 *bitmap = (ub8 *) (partition_buffer + PARTITION_HEADER_SIZE);
+        HashMemo *memo = (HashMemo *) (bitmap + words);
+        memset(bitmap, 0, words*sizeof(ub8));
+
+        //Bitmap and memo of the occupied slots
+        for(i=0; i < num_slot; i++){
+            if(table_memo[i] || hash_table_in_place_mem_is_set(table_slots + i*slot_size, table_data)){
+                bitmap[i >> 6] |= ((ub8) 1) << (i & 63);
+                memo[occupied++] = table_memo[i];
+            }
+        }
+        //Slot data
+        ub1 *data = (ub1 *) (memo + occupied);
+        ub1 *pos = data;
+        ub8 w;
+        for(w=0; w < words; w++){
+            ub8 bits = bitmap[w];
+            while(bits){
+                i = (w << 6) + __builtin_ctzll(bits);
+                memcpy(pos, table_slots + i*slot_size, slot_size);
+                pos += slot_size;
+                bits &= bits - 1;
+            }
+        }
+        PartitionRecordHeader *header = (PartitionRecordHeader *) partition_buffer;
+        header->encoding = PARTITION_ENCODING_SLOTS;
+        header->blocks = 0;
+        header->size_encoded = 0;
+        size = (pos - partition_buffer);
+    }
+    
+    PartitionRecordHeader *header = (PartitionRecordHeader *) partition_buffer;
+    header->slot_size = slot_size;
+    header->num_slot = num_slot;
+    header->count = table_data->count;
+    header->occupied = occupied;
+    header->partition_number = partition_number;
+    return size;
+}
+
+/*Packs a log of collisions into the thread buffer and returns the record size*/
+static ub8 _partition_pack_log(ub1 *states, int count, int slot_size, 
+        unsigned long partition_number){
+    ub8 i, size = 0;
+    if(STATECOMPRESSIONSSD){
+        partition_sort_buffer = (ub1 **) _partition_reserve(partition_sort_buffer, 
+                    &partition_sort_buffer_size, 2*count*sizeof(ub1 *));
+        for(i=0; i < count; i++)
+            partition_sort_buffer[i] = states + i*slot_size;
+        size = _partition_pack_sorted(partition_sort_buffer, count, slot_size);
+    } else {
+        size = PARTITION_HEADER_SIZE + ((ub8) count)*slot_size;
+        _partition_buffer_reserve(size);
+        memcpy(partition_buffer + PARTITION_HEADER_SIZE, states, ((ub8) count)*slot_size);
+        PartitionRecordHeader *header = (PartitionRecordHeader *) partition_buffer;
+        header->encoding = PARTITION_ENCODING_PLAIN;
+        header->blocks = 0;
+        header->size_encoded = 0;
+    }
+    PartitionRecordHeader *header = (PartitionRecordHeader *) partition_buffer;
+    header->slot_size = slot_size;
+    header->num_slot = 0;
+    header->count = count;
+    header->occupied = count;
+    header->partition_number = partition_number;
+    return size;
+}
+
+/*Blocks of a record decoded (and hashed) by several threads*/
+typedef struct PartitionDecodeStruct{
+    const ub1* record;
+    ub1* states;                //Decoded states (SORTED)
+    ub8* keys;
+    HashTableGetKey get_key;
+    ub8 blocks;
+    volatile ub8 next;
+}PartitionDecode;
+
+static void* _partition_decode_blocks(void *arg){
+    PartitionDecode *decode = (PartitionDecode *) arg;
+    const PartitionRecordHeader *header = (const PartitionRecordHeader *) decode->record;
+    int slot_size = header->slot_size;
+    ub8 b;
+    while((b = _interface_atomic_add_64(&(decode->next), 1)) < decode->blocks){
+        ub8 first = b*PARTITION_BLOCK_STATES, i;
+        ub8 count = (header->occupied - first < PARTITION_BLOCK_STATES) ? 
+                header->occupied - first : PARTITION_BLOCK_STATES;
+        ub1 *states = decode->states + first*slot_size;
+        if(header->encoding==PARTITION_ENCODING_SORTED){
+            const ub8 *offsets = (const ub8 *) (decode->record + PARTITION_HEADER_SIZE);
+            const ub1 *data = (const ub1 *) (offsets + header->blocks);
+            _partition_decode_block(data + offsets[b], count, slot_size, states);
+        }
+        if(decode->keys!=NULL)
+            for(i=0; i < count; i++)
+                decode->keys[first + i] = decode->get_key(states + i*slot_size);
+    }
+    return NULL;
+}
+
+static void * _partition_decode_thread(void * args){
+    PartitionTable* table = (PartitionTable*) args;
+    if(table->decode_init)
+        table->decode_init(table->decode_init_arg);
+    int generation = 0;
+    pthread_mutex_lock(&table->decode_lock);
+    for(;;){
+        while(!table->decode_stop && table->decode_generation==generation)
+            pthread_cond_wait(&table->decode_ready, &table->decode_lock);
+        if(table->decode_stop)
+            break;
+        generation = table->decode_generation;
+        PartitionDecode *decode = (PartitionDecode *) table->decode_job;
+        pthread_mutex_unlock(&table->decode_lock);
+        _partition_decode_blocks(decode);
+        pthread_mutex_lock(&table->decode_lock);
+        if(--table->decode_working==0)
+            pthread_cond_signal(&table->decode_done);
+    }
+    pthread_mutex_unlock(&table->decode_lock);
+    return NULL;
+}
+
+/*Decodes the blocks with the helpers if they are not working for another reader*/
+static void _partition_decode(PartitionTable* table, PartitionDecode* decode){
+    if(table==NULL || table->decode_threads==0 
+            || decode->blocks < PARTITION_DECODE_BLOCKS_PER_THREAD*(table->decode_threads + 1)
+            || _interface_atomic_cas_8(&(table->decode_busy), 0, 1)!=0){
+        _partition_decode_blocks(decode);
+        return;
+    }
+    pthread_mutex_lock(&table->decode_lock);
+    table->decode_job = decode;
+    table->decode_working = table->decode_threads;
+    table->decode_generation++;
+    pthread_cond_broadcast(&table->decode_ready);
+    pthread_mutex_unlock(&table->decode_lock);
+    _partition_decode_blocks(decode);
+    pthread_mutex_lock(&table->decode_lock);
+    while(table->decode_working > 0)
+        pthread_cond_wait(&table->decode_done, &table->decode_lock);
+    table->decode_job = NULL;
+    pthread_mutex_unlock(&table->decode_lock);
+    _interface_atomic_swap_8(&(table->decode_busy), 0);
+}
+
+/*
+ * Returns the occupied states of a PLAIN or SORTED record, one after the other,
+ * and their keys if get_key is given. SORTED records are decoded into the 
+ * thread buffer, PLAIN states are read where they are.
+ */
+static ub1* _partition_record_states(PartitionTable* table, const ub1 *record, 
+        HashTableGetKey get_key){
+    const PartitionRecordHeader *header = (const PartitionRecordHeader *) record;
+    ub8 count = header->occupied;
+    PartitionDecode decode;
+    decode.record = record;
+    decode.get_key = get_key;
+    decode.next = 0;
+    decode.blocks = (count + PARTITION_BLOCK_STATES - 1)/PARTITION_BLOCK_STATES;
+    decode.keys = NULL;
+    if(get_key!=NULL){
+        partition_key_buffer = (ub8 *) _partition_reserve(partition_key_buffer, 
+                    &partition_key_buffer_size, count*sizeof(ub8));
+        decode.keys = partition_key_buffer;
+    }
+    if(header->encoding==PARTITION_ENCODING_SORTED){
+        partition_decode_buffer = (ub1 *) _partition_reserve(partition_decode_buffer, 
+                    &partition_decode_buffer_size, count*header->slot_size);
+        decode.states = partition_decode_buffer;
+    } else {
+        decode.states = (ub1 *) record + PARTITION_HEADER_SIZE;
+        if(get_key==NULL)
+            return decode.states;
+    }
+    _partition_decode(table, &decode);
+    return decode.states;
+}
+
+/*Restores the record mapped at record into table_data*/
+static void _partition_unpack(PartitionTable* table, ub1 *record, HashTable* table_data){
+    PartitionRecordHeader *header = (PartitionRecordHeader *) record;
+    int slot_size = header->slot_size;
+    ub8 num_slot = header->num_slot;
+    
+    if(slot_size != table_data->table.in_place.slot_size)
+        ERRORMACRO("partition_get: partition slot_size disagrees with hash table")
+    if(num_slot  > ((ub8) 1 << table_data->logsize) + 2 )
+        ERRORMACRO("partition_get: partition exceeds hash table size\n");
+    
+    HashMemo *table_memo = table_data->table.in_place.memo;
+    HashTableUnit *table_slots = table_data->table.in_place.data;
+    table_data->mask = num_slot - 2;
+    memset(table_memo, 0, num_slot*sizeof(HashMemo));
+    memset(table_slots, 0, num_slot*slot_size);
+    
+    if(header->encoding!=PARTITION_ENCODING_SLOTS){
+        //Rehashed, the keys are computed with the decoding
+        ub1 *states = _partition_record_states(table, record, table_data->hash_table_get_key);
+        ub8 j;
+        table_data->count = 0;
+        for(j=0; j < header->occupied; j++)
+            hash_table_in_place_insert_key(states + j*slot_size, partition_key_buffer[j], 
+                                            table_data);
+        return;
+    }
+    
+    ub8 words = PARTITION_BITMAP_WORDS(num_slot);
+    ub8 *bitmap = (ub8 *) (record + PARTITION_HEADER_SIZE);
+    HashMemo *memo = (HashMemo *) (bitmap + words);
+    ub1 *data = (ub1 *) (memo + header->occupied);
+    table_data->count = header->count;
+    ub8 w, i, j = 0;
+    for(w=0; w < words; w++){
+        ub8 bits = bitmap[w];
+        while(bits){
+            i = (w << 6) + __builtin_ctzll(bits);
+            table_memo[i] = memo[j];
+            memcpy(table_slots + i*slot_size, data + j*slot_size, slot_size);
+            j++;
+            bits &= bits - 1;
+        }
+    }
+}
+
+/*Returns the record of a partition, removing it if it is a collision one*/
+static PartitionRecord _partition_take_record(PartitionTable* table, 
+        unsigned long partition_number, PartitionType type, int sequence_collision_number){
+    PartitionRecord record = {0, 0};
+    if(type==PARTITION_OF_STATES)
+        return table->state_records[partition_number];
+    pthread_mutex_lock(&table->collision_records_lock);
+    if(sequence_collision_number < table->collision_records_size[partition_number]){
+        PartitionRecord *slot = table->collision_records[partition_number] 
+                                                + sequence_collision_number;
+        record = *slot;
+        slot->size = 0;
+    }
+    pthread_mutex_unlock(&table->collision_records_lock);
+    return record;
+}
+
+static void _partition_put_collision_record(PartitionTable* table, 
+        unsigned long partition_number, int sequence_collision_number, 
+        PartitionRecord record){
+    pthread_mutex_lock(&table->collision_records_lock);
+    int size = table->collision_records_size[partition_number];
+    if(sequence_collision_number >= size){
+        int new_size = (2*size > sequence_collision_number) ? 2*size 
+                                        : sequence_collision_number + 1;
+        table->collision_records[partition_number] = (PartitionRecord *) realloc(
+                table->collision_records[partition_number], new_size*sizeof(PartitionRecord));
+        if(table->collision_records[partition_number]==NULL)
+            ERRORMACRO("partition_write: Impossible to grow the collision records");
+        memset(table->collision_records[partition_number] + size, 0, 
+                (new_size - size)*sizeof(PartitionRecord));
+        table->collision_records_size[partition_number] = new_size;
+    }
+    PartitionRecord *slot = table->collision_records[partition_number] 
+                                                + sequence_collision_number;
+    //A record that was never read back is discarded
+    if(slot->size)
+        _partition_discard(table, *slot);
+    *slot = record;
+    pthread_mutex_unlock(&table->collision_records_lock);
+}
+
+/*Summaries*/
+
+static void _partition_summary_add(PartitionTable* table, ub8 *summary, ub1 *state){
+    ub8 hash = hash_data_char(state, table->slot_size, 0);
+    ub8 step = (hash >> 32) | 1;
+    int i;
+    for(i=0; i < PARTITION_SUMMARY_HASHES; i++, hash += step)
+        summary[(hash & table->summary_mask) >> 6] |= ((ub8) 1) << (hash & 63);
+}
+
+static int _partition_summary_contains(PartitionTable* table, ub8 *summary, ub1 *state){
+    ub8 hash = hash_data_char(state, table->slot_size, 0);
+    ub8 step = (hash >> 32) | 1;
+    int i;
+    for(i=0; i < PARTITION_SUMMARY_HASHES; i++, hash += step)
+        if(!(summary[(hash & table->summary_mask) >> 6] & (((ub8) 1) << (hash & 63))))
+            return 0;
+    return 1;
+}
+
+/*Adds the occupied slots of table_data to a summary*/
+static void _partition_summary_add_table(PartitionTable* table, ub8 *summary, 
+        HashTable* table_data){
+    int slot_size = table_data->table.in_place.slot_size;
+    ub8 i, num_slot = table_data->mask + 2;
+    HashMemo *table_memo = table_data->table.in_place.memo;
+    HashTableUnit *table_slots = table_data->table.in_place.data;
+    for(i=0; i < num_slot; i++)
+        if(table_memo[i] || hash_table_in_place_mem_is_set(table_slots + i*slot_size, table_data))
+            _partition_summary_add(table, summary, table_slots + i*slot_size);
+}
+
+/*Rebuilds the summary of a partition of states from its table*/
+static void _partition_summary_build(PartitionTable* table, 
+        unsigned long partition_number, HashTable* table_data){
+    ub8 size = (table->summary_mask + 1) >> 3;
+    if(table->summaries[partition_number]==NULL){
+        table->summaries[partition_number] = (ub8 *) malloc(size);
+        if(table->summaries[partition_number]==NULL)
+            ERRORMACRO("partition_write: Impossible to create the partition summary");
+    }
+    memset(table->summaries[partition_number], 0, size);
+    _partition_summary_add_table(table, table->summaries[partition_number], table_data);
+}
+
+/*Inserts the states of a record of appended states into table_data*/
+static void _partition_insert_record(PartitionTable* table, ub1 *record, 
+        HashTable* table_data){
+    PartitionRecordHeader *header = (PartitionRecordHeader *) record;
+    int slot_size = header->slot_size;
+    ub8 j;
+    if(header->encoding==PARTITION_ENCODING_SLOTS){
+        ub8 words = PARTITION_BITMAP_WORDS(header->num_slot);
+        HashMemo *memo = (HashMemo *) (record + PARTITION_HEADER_SIZE + words*sizeof(ub8));
+        ub1 *data = (ub1 *) (memo + header->occupied);
+        for(j=0; j < header->occupied; j++)
+            hash_table_insert(data + j*slot_size, table_data);
+        return;
+    }
+    ub1 *states = _partition_record_states(table, record, table_data->hash_table_get_key);
+    for(j=0; j < header->occupied; j++)
+        hash_table_in_place_insert_key(states + j*slot_size, partition_key_buffer[j], 
+                                            table_data);
+}
+
+/*
+ * Merges the states appended to a partition into its table. The records are
+ * kept until the partition of states is written again.
+ */
+static void _partition_merge_appended(PartitionTable* table, 
+        unsigned long partition_number, HashTable* table_data){
+    pthread_mutex_lock(&table->collision_records_lock);
+    int i, count = table->appended_records_count[partition_number];
+    PartitionRecord records[count];
+    for(i=0; i < count; i++)
+        records[i] = table->appended_records[partition_number][i];
+    pthread_mutex_unlock(&table->collision_records_lock);
+    for(i=0; i < count; i++){
+        errno = 0;
+        ub1 *mapped = (ub1 *) mmap(NULL, records[i].size, PROT_READ, MAP_PRIVATE, 
+                                        table->segment_fd, records[i].offset);
+        if(mapped==MAP_FAILED)
+            ERRORMACRO("partition_get: Unable to map the segment file");
+        _partition_insert_record(table, mapped, table_data);
+        munmap(mapped, records[i].size);
+        _interface_atomic_add_64(&(table->bytes_read), records[i].size);
+    }
+}
+
+/*The partition of states was written with its appended states*/
+static void _partition_drop_appended(PartitionTable* table, 
+        unsigned long partition_number){
+    pthread_mutex_lock(&table->collision_records_lock);
+    int i;
+    for(i=0; i < table->appended_records_count[partition_number]; i++)
+        _partition_discard(table, table->appended_records[partition_number][i]);
+    table->appended_records_count[partition_number] = 0;
+    pthread_mutex_unlock(&table->collision_records_lock);
+}
+
 /*Public functions*/
 
-PartitionTable* partition_table_init(char* prefix, char* path, long number_of_partitions){
+PartitionTable* partition_table_init(char* prefix, char* path, long number_of_partitions,
+        int slot_size, int table_size){
     //assert(prefix!=NULL && path!=NULL)
     
     errno = 0;
@@ -121,6 +825,85 @@ PartitionTable* partition_table_init(char* prefix, char* path, long number_of_pa
     
     new->last_collision_assigned = 0;
     
+    //Segment file: one fixed record per partition of states (numbers start
+    //at 1), followed by the partitions of collisions
+    new->slot_size = slot_size;
+    new->page_size = sysconf(_SC_PAGESIZE);
+    new->record_size = _partition_align(_partition_record_capacity(slot_size, 
+                                ((ub8) 1 << table_size) + 2), new->page_size);
+    new->segment_end = (number_of_partitions + 1)*new->record_size;
+    new->segment_name = (char*) malloc(sizeof(char)*(strlen(prefix) + 5));
+    sprintf(new->segment_name, "%s.seg", prefix);
+    errno = 0;
+    //A resumed run keeps the records of the checkpoint
+    new->segment_fd = open(new->segment_name, O_RDWR | O_CREAT | (RESUME ? 0 : O_TRUNC), 0644);
+    if(new->segment_fd < 0 || (!RESUME && ftruncate(new->segment_fd, new->segment_end)))
+        ERRORMACRO("partition_table_init: Impossible to create the segment file");
+    new->checkpoint_end = 0;
+    new->retired = NULL;
+    new->retired_count = 0;
+    new->retired_capacity = 0;
+    pthread_mutex_init(&new->retired_lock, NULL);
+    new->state_records = (PartitionRecord *) calloc(number_of_partitions + 1, 
+                                                    sizeof(PartitionRecord));
+    new->collision_records = (PartitionRecord **) calloc(number_of_partitions + 1, 
+                                                    sizeof(PartitionRecord *));
+    new->collision_records_size = (int *) calloc(number_of_partitions + 1, sizeof(int));
+    new->appended_records = (PartitionRecord **) calloc(number_of_partitions + 1, 
+                                                    sizeof(PartitionRecord *));
+    new->appended_records_count = (int *) calloc(number_of_partitions + 1, sizeof(int));
+    new->appended_records_capacity = (int *) calloc(number_of_partitions + 1, sizeof(int));
+    new->summaries = (ub8 **) calloc(number_of_partitions + 1, sizeof(ub8 *));
+    new->runs = (PartitionRun **) calloc(number_of_partitions + 1, sizeof(PartitionRun *));
+    new->runs_count = (int *) calloc(number_of_partitions + 1, sizeof(int));
+    new->runs_capacity = (int *) calloc(number_of_partitions + 1, sizeof(int));
+    if(!new->state_records || !new->collision_records || !new->collision_records_size
+            || !new->appended_records || !new->appended_records_count 
+            || !new->appended_records_capacity || !new->summaries
+            || !new->runs || !new->runs_count || !new->runs_capacity)
+        ERRORMACRO("partition_table_init: Impossible to create the partition records");
+    //Bits of a summary: PARTITION_SUMMARY_BITS_PER_SLOT per slot of the table
+    new->summary_mask = (((ub8) 1) << table_size)*PARTITION_SUMMARY_BITS_PER_SLOT - 1;
+    pthread_mutex_init(&new->collision_records_lock, NULL);
+    new->bytes_written = 0;
+    new->bytes_read = 0;
+    new->records_written = 0;
+    new->summary_negatives = 0;
+    new->summary_positives = 0;
+    new->records_appended = 0;
+    new->runs_merged = 0;
+    new->blocks_read = 0;
+    
+    //Synchronous until partition_table_start_io
+    new->io_threads = 0;
+    new->io_stop = 0;
+    new->io_thread_ids = NULL;
+    pthread_mutex_init(&new->io_lock, NULL);
+    pthread_cond_init(&new->io_job_ready, NULL);
+    pthread_cond_init(&new->io_job_done, NULL);
+    new->decode_threads = 0;
+    new->decode_stop = 0;
+    new->decode_thread_ids = NULL;
+    new->decode_job = NULL;
+    new->decode_generation = 0;
+    new->decode_working = 0;
+    new->decode_busy = 0;
+    pthread_mutex_init(&new->decode_lock, NULL);
+    pthread_cond_init(&new->decode_ready, NULL);
+    pthread_cond_init(&new->decode_done, NULL);
+    new->jobs = NULL;
+    new->jobs_head = 0;
+    new->jobs_count = 0;
+    new->jobs_capacity = 0;
+    memset(&new->pool_states, 0, sizeof(PartitionTablePool));
+    memset(&new->pool_logs, 0, sizeof(PartitionTablePool));
+    new->pending_states = (volatile int *) calloc(number_of_partitions + 1, sizeof(int));
+    new->pending_collisions = (volatile int *) calloc(number_of_partitions + 1, sizeof(int));
+    if(!new->pending_states || !new->pending_collisions)
+        ERRORMACRO("partition_table_init: Impossible to create the partition records");
+    new->io_blocked_ns = 0;
+    new->io_busy_ns = 0;
+    
     if(DISCPARALLELSEQUENTIAL)
         disc_access_init();    
     
@@ -129,12 +912,11 @@ PartitionTable* partition_table_init(char* prefix, char* path, long number_of_pa
 }
 
 void partition_table_init_local(int state_table, int collision_table){
-    if(STATECOMPRESSIONSSD){
-        compression_states = data_compression_init(state_table,
-                                                        STATECOMPRESSIONSSD);
-        compression_collisions = data_compression_init(collision_table,
-                                                        STATECOMPRESSIONSSD);
-    }
+    if(STATECOMPRESSIONSSD)
+        partition_decode_buffer = (ub1 *) _partition_reserve(partition_decode_buffer, 
+                    &partition_decode_buffer_size, state_table);
+    partition_log_buffer = (ub1 *) _partition_reserve(partition_log_buffer, 
+                &partition_log_buffer_size, collision_table);
 }
 
 long partition_get_number(PartitionTable* table){
@@ -144,283 +926,850 @@ long partition_get_number(PartitionTable* table){
         return -1;
 }
 
-void partition_write(PartitionTable* table, unsigned long partition_number, 
-        HashTable* table_data, PartitionType type, ...){
+static void _partition_write(PartitionTable* table, unsigned long partition_number, 
+        HashTable* table_data){
+    ub8 size = _partition_pack(table_data, partition_number);
+    PartitionRecord record;
+    record.size = size;
+    if(!CHECKPOINTDIR){
+        if(size > table->record_size)
+            ERRORMACRO("partition_write: partition exceeds the segment record size");
+        record.offset = partition_number*table->record_size;
+    } else {
+        //With checkpoints, the records on disc are never overwritten
+        record.offset = _interface_atomic_add_64(&(table->segment_end), 
+                                _partition_align(size, table->page_size));
+    }
+    _partition_summary_build(table, partition_number, table_data);
     
-        
     if(DISCPARALLELSEQUENTIAL)
         disc_access_lock();
-        
-        //unsigned int slot_size, unsigned int num_slot,
-        //ub1* data, HashMemo *memo){ 
-    assert(table!=NULL  && table_data->type==HASH_TABLE_IN_PLACE
-            &&  partition_number <= table->last_number && table_data!=NULL);        
+    _partition_pwrite(table, partition_buffer, size, record.offset);
+    if(DISCPARALLELSEQUENTIAL)
+        disc_access_unlock();
     
-    char* suffix_collision = NULL;
-    
-    if(type==PARTITION_OF_COLLISIONS){
-        suffix_collision = (char*) malloc(sizeof(char)*20);
-        strcpy(suffix_collision, "_cl_");
-        va_list ap;
-        int sequence_collision_number = 0;
-        va_start(ap, type); //last fixed parameter
-        sequence_collision_number = va_arg(ap, int); //Get the slot size if present
-        va_end(ap);  
-        char *num =  itoa(sequence_collision_number);
-        strcat(suffix_collision,num);
-        free(num);
-        //strcat(suffix_collision, "_");
-    }
-    
-    char* file_name = (char*) malloc(sizeof(char)*(strlen(table->path) + strlen(table->prefix_name) + 150));
-    char* file_name_head = (char*) malloc(sizeof(char)*(strlen(file_name)+ 150));
-    char* file_name_memo = (char*) malloc(sizeof(char)*(strlen(file_name)+ 150));
-    //Set file name
-    strcpy(file_name, "");
-    strcpy(file_name_head, "");
-    strcpy(file_name_memo, "");
-    char *num_p =   itoa(partition_number);
-    //strcat(file_name, table->path);
-   // strcat(file_name, "/");
-    strcat(file_name, table->prefix_name);
-    strcat(file_name,num_p);
-    free(num_p);
-    
-    strcat(file_name_memo, file_name); 
-    
-    //File Head
-    strcat(file_name_head, file_name);
-    //strcat(file_name_memo, file_name);
-    
-    if(type==PARTITION_OF_COLLISIONS)
-         strcat(file_name_head, suffix_collision);
-    
-    
-    strcat(file_name_head, "_h.tpl");
-    //Dump to file head
-    int slot_size, num_slot, count, size_compressed = 0;
-    slot_size = table_data->table.in_place.slot_size;
-    num_slot = table_data->mask+2;//hash_table_size(table_data);
-    
-    //Check if compression mode is enabled
-    //Compress
-    HashTableUnit* data = table_data->table.in_place.data; 
-    if(STATECOMPRESSIONSSD){
-        if(type==PARTITION_OF_COLLISIONS){
-            data = data_compression_compress(compression_collisions, 
-                        table_data->table.in_place.data, slot_size*num_slot);
-            size_compressed = compression_collisions->size_buffer_compressed;
+    PartitionRecord old = table->state_records[partition_number];
+    table->state_records[partition_number] = record;
+    _partition_drop_appended(table, partition_number);
+    if(old.size && old.offset!=record.offset)
+        _partition_discard(table, old);
+    _interface_atomic_add_64(&(table->bytes_written), size);
+    _interface_atomic_inc_64(&(table->records_written));
+}
+
+/*Logs are always appended*/
+static void _partition_write_log(PartitionTable* table, unsigned long partition_number, 
+        ub1* states, int count, int sequence_collision_number){
+    PartitionRecord record;
+    record.size = _partition_pack_log(states, count, table->slot_size, partition_number);
+    record.offset = _interface_atomic_add_64(&(table->segment_end), 
+                                _partition_align(record.size, table->page_size));
+    if(DISCPARALLELSEQUENTIAL)
+        disc_access_lock();
+    _partition_pwrite(table, partition_buffer, record.size, record.offset);
+    if(DISCPARALLELSEQUENTIAL)
+        disc_access_unlock();
+    _partition_put_collision_record(table, partition_number, 
+                                sequence_collision_number, record);
+    _interface_atomic_add_64(&(table->bytes_written), record.size);
+    _interface_atomic_inc_64(&(table->records_written));
+}
+
+/*Asynchronous I/O*/
+
+static ub8 _partition_now(){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (ub8) now.tv_sec*1000000000ULL + now.tv_nsec;
+}
+
+static volatile int* _partition_pending(PartitionTable* table, 
+        unsigned long partition_number, PartitionType type){
+    if(type==PARTITION_OF_STATES)
+        return table->pending_states + partition_number;
+    return table->pending_collisions + partition_number;
+}
+
+/*Waits until the asynchronous writes of a partition are on disc*/
+static void _partition_wait_pending(PartitionTable* table, 
+        unsigned long partition_number, PartitionType type){
+    volatile int *pending = _partition_pending(table, partition_number, type);
+    if(*pending==0)
+        return;
+    pthread_mutex_lock(&table->io_lock);
+    while(*pending > 0)
+        pthread_cond_wait(&table->io_job_done, &table->io_lock);
+    pthread_mutex_unlock(&table->io_lock);
+}
+
+static PartitionTablePool* _partition_pool(PartitionTable* table, PartitionType type){
+    if(type==PARTITION_OF_STATES)
+        return &(table->pool_states);
+    return &(table->pool_logs);
+}
+
+/*Largest log of collisions, in states*/
+static ub8 _partition_log_capacity(){
+    return ((ub8) 1) << COLLISIONTABLESIZE;
+}
+
+/*
+ * Takes a spare table shaped like prototype (or a log buffer if prototype is
+ * NULL), creating it while the pool is not full. Called with io_lock held.
+ */
+static void* _partition_pool_take(PartitionTable* table, PartitionTablePool* pool,
+        HashTable* prototype){
+    while(pool->count==0 && pool->created >= pool->capacity)
+        pthread_cond_wait(&table->io_job_done, &table->io_lock);
+    if(pool->count > 0)
+        return pool->free[--pool->count];
+    pool->created++;
+    pthread_mutex_unlock(&table->io_lock);
+    void *new = NULL;
+    if(prototype!=NULL)
+        hash_table_create(HASH_TABLE_IN_PLACE, prototype->logsize, (HashTable **) &new, 
+                prototype->hash_table_compare, prototype->hash_table_get_key, 
+                prototype->hash_table_free, prototype->table.in_place.slot_size);
+    else
+        new = malloc(_partition_log_capacity()*table->slot_size);
+    pthread_mutex_lock(&table->io_lock);
+    if(new==NULL)
+        ERRORMACRO("partition_write_async: Impossible to create a spare table");
+    return new;
+}
+
+static void _partition_pool_release(PartitionType type, void* item){
+    if(type==PARTITION_OF_STATES)
+        hash_table_destroy((HashTable *) item);
+    else
+        free(item);
+}
+
+static void * _partition_io_thread(void * args){
+    PartitionTable* table = (PartitionTable*) args;
+    partition_table_init_local(((ub8) 1 << TABLESIZE)*table->slot_size, 
+                                ((ub8) 1 << COLLISIONTABLESIZE)*table->slot_size);
+    pthread_mutex_lock(&table->io_lock);
+    for(;;){
+        while(table->jobs_count==0 && !table->io_stop)
+            pthread_cond_wait(&table->io_job_ready, &table->io_lock);
+        if(table->jobs_count==0)
+            break;
+        PartitionJob job = table->jobs[table->jobs_head];
+        table->jobs_head = (table->jobs_head + 1) % table->jobs_capacity;
+        table->jobs_count--;
+        pthread_mutex_unlock(&table->io_lock);
+        
+        ub8 start = _partition_now();
+        void *item = NULL;
+        if(job.type==PARTITION_OF_STATES){
+            _partition_write(table, job.partition_number, job.table_data);
+            hash_table_reset(job.table_data);
+            item = job.table_data;
         } else {
-            data = data_compression_compress(compression_states, 
-                        table_data->table.in_place.data, slot_size*num_slot);
-            size_compressed = compression_states->size_buffer_compressed;
+            _partition_write_log(table, job.partition_number, job.log, job.log_count,
+                            job.sequence_collision_number);
+            item = job.log;
         }
+        _interface_atomic_add_64(&(table->io_busy_ns), _partition_now() - start);
+        
+        pthread_mutex_lock(&table->io_lock);
+        PartitionTablePool *pool = _partition_pool(table, job.type);
+        if(pool->created > pool->capacity){
+            //Lowered by partition_table_set_spare_tables
+            _partition_pool_release(job.type, item);
+            pool->created--;
+        } else
+            pool->free[pool->count++] = item;
+        (*_partition_pending(table, job.partition_number, job.type))--;
+        pthread_cond_broadcast(&table->io_job_done);
     }
+    pthread_mutex_unlock(&table->io_lock);
+    return NULL;
+}
+
+void partition_table_start_io(PartitionTable* table, int io_threads, 
+        int spare_tables){
+    assert(table!=NULL);
+    if(io_threads <= 0)
+        return;
+    table->pool_states.free = (void**) malloc(sizeof(void*)*spare_tables);
+    table->pool_states.capacity = spare_tables;
+    table->pool_logs.free = (void**) malloc(sizeof(void*)*spare_tables);
+    table->pool_logs.capacity = spare_tables;
+    //Every job holds a spare table
+    table->jobs_capacity = 2*spare_tables;
+    table->jobs = (PartitionJob*) malloc(sizeof(PartitionJob)*table->jobs_capacity);
+    table->io_thread_ids = (pthread_t*) malloc(sizeof(pthread_t)*io_threads);
+    if(!table->pool_states.free || !table->pool_logs.free || !table->jobs 
+            || !table->io_thread_ids)
+        ERRORMACRO("partition_table_start_io: Impossible to create the I/O structures");
+    table->io_stop = 0;
+    table->io_threads = io_threads;
+    int i;
+    for(i=0; i < io_threads; i++)
+        if(pthread_create(table->io_thread_ids + i, NULL, &_partition_io_thread, table))
+            ERRORMACRO("partition_table_start_io: Impossible to create the I/O threads");
+}
+
+static void _partition_pool_trim(PartitionTablePool* pool, PartitionType type){
+    while(pool->created > pool->capacity && pool->count > 0){
+        _partition_pool_release(type, pool->free[--pool->count]);
+        pool->created--;
+    }
+}
+
+void partition_table_set_spare_tables(PartitionTable* table, int spare_tables){
+    assert(table!=NULL);
+    if(table->io_thread_ids==NULL)
+        return;
+    //The ring of jobs was sized for the initial number
+    if(spare_tables > table->jobs_capacity/2)
+        spare_tables = table->jobs_capacity/2;
+    if(spare_tables < 1)
+        spare_tables = 1;
+    pthread_mutex_lock(&table->io_lock);
+    table->pool_states.capacity = spare_tables;
+    table->pool_logs.capacity = spare_tables;
+    _partition_pool_trim(&table->pool_states, PARTITION_OF_STATES);
+    _partition_pool_trim(&table->pool_logs, PARTITION_OF_COLLISIONS);
+    pthread_cond_broadcast(&table->io_job_done);
+    pthread_mutex_unlock(&table->io_lock);
+}
+
+void partition_table_stop_io(PartitionTable* table){
+    assert(table!=NULL);
+    if(table->io_thread_ids==NULL)
+        return;
+    pthread_mutex_lock(&table->io_lock);
+    table->io_stop = 1;
+    pthread_cond_broadcast(&table->io_job_ready);
+    pthread_mutex_unlock(&table->io_lock);
+    int i;
+    for(i=0; i < table->io_threads; i++)
+        pthread_join(table->io_thread_ids[i], NULL);
+    free(table->io_thread_ids);
+    table->io_thread_ids = NULL;
+}
+
+void partition_table_start_decoders(PartitionTable* table, int busy_threads,
+        void (*init)(void*), void* arg){
+    assert(table!=NULL);
+    long helpers = sysconf(_SC_NPROCESSORS_ONLN) - busy_threads;
+    if(helpers > PARTITION_DECODE_HELPERS)
+        helpers = PARTITION_DECODE_HELPERS;
+    if(!STATECOMPRESSIONSSD || helpers <= 0)
+        return;
+    table->decode_thread_ids = (pthread_t*) malloc(sizeof(pthread_t)*helpers);
+    if(!table->decode_thread_ids)
+        ERRORMACRO("partition_table_start_decoders: Impossible to create the decoders");
+    table->decode_init = init;
+    table->decode_init_arg = arg;
+    table->decode_stop = 0;
+    int i;
+    for(i=0; i < helpers; i++)
+        if(pthread_create(table->decode_thread_ids + i, NULL, &_partition_decode_thread, table))
+            ERRORMACRO("partition_table_start_decoders: Impossible to create the decoders");
+    table->decode_threads = helpers;
+}
+
+void partition_table_stop_decoders(PartitionTable* table){
+    assert(table!=NULL);
+    if(table->decode_thread_ids==NULL)
+        return;
+    pthread_mutex_lock(&table->decode_lock);
+    table->decode_stop = 1;
+    pthread_cond_broadcast(&table->decode_ready);
+    pthread_mutex_unlock(&table->decode_lock);
+    int i;
+    for(i=0; i < table->decode_threads; i++)
+        pthread_join(table->decode_thread_ids[i], NULL);
+    free(table->decode_thread_ids);
+    table->decode_thread_ids = NULL;
+    table->decode_threads = 0;
+}
+
+void partition_table_sync(PartitionTable* table){
+    assert(table!=NULL);
+    unsigned long p;
+    for(p=0; p <= table->last_number && p <= table->lock_table_size; p++){
+        _partition_wait_pending(table, p, PARTITION_OF_STATES);
+        _partition_wait_pending(table, p, PARTITION_OF_COLLISIONS);
+    }
+}
+
+/*Checkpoint file*/
+
+static void _partition_checkpoint_write(FILE* file, const void* data, ub8 size){
+    errno = 0;
+    if(size > 0 && fwrite(data, 1, size, file)!=size)
+        ERRORMACRO("partition_table_checkpoint: Unable to write the checkpoint");
+}
+
+static void _partition_checkpoint_read(FILE* file, void* data, ub8 size){
+    errno = 0;
+    if(size > 0 && fread(data, 1, size, file)!=size)
+        ERRORMACRO("partition_table_restore: Unable to read the checkpoint");
+}
+
+ub8 partition_table_checkpoint(PartitionTable* table, FILE* file){
+    assert(table!=NULL && file!=NULL);
+    partition_table_sync(table);
+    errno = 0;
+    if(fsync(table->segment_fd))
+        ERRORMACRO("partition_table_checkpoint: Unable to sync the segment file");
+    long start = ftell(file);
+    ub8 header[6] = {table->lock_table_size, table->slot_size, table->record_size,
+            table->segment_end, table->last_number, table->last_collision_assigned};
+    _partition_checkpoint_write(file, header, sizeof(header));
+    _partition_checkpoint_write(file, table->lock_table, table->lock_table_size);
+    _partition_checkpoint_write(file, table->collision_num_write_table, 
+                                    sizeof(int)*table->lock_table_size);
+    unsigned long p, n = table->lock_table_size + 1;
+    _partition_checkpoint_write(file, table->state_records, sizeof(PartitionRecord)*n);
+    for(p=0; p < n; p++){
+        _partition_checkpoint_write(file, table->collision_records_size + p, sizeof(int));
+        _partition_checkpoint_write(file, table->collision_records[p], 
+                sizeof(PartitionRecord)*table->collision_records_size[p]);
+        _partition_checkpoint_write(file, table->appended_records_count + p, sizeof(int));
+        _partition_checkpoint_write(file, table->appended_records[p], 
+                sizeof(PartitionRecord)*table->appended_records_count[p]);
+    }
+    ub8 stats[4] = {table->bytes_written, table->bytes_read, table->records_written,
+            table->records_appended};
+    _partition_checkpoint_write(file, stats, sizeof(stats));
+    return ftell(file) - start;
+}
+
+void partition_table_commit(PartitionTable* table){
+    assert(table!=NULL);
+    pthread_mutex_lock(&table->retired_lock);
+    int i, count = table->retired_count;
+    table->retired_count = 0;
+    //Later discards of the records of this checkpoint are deferred
+    table->checkpoint_end = table->segment_end;
+    pthread_mutex_unlock(&table->retired_lock);
+#ifdef FALLOC_FL_PUNCH_HOLE
+    for(i=0; i < count; i++)
+        fallocate(table->segment_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+            table->retired[i].offset, _partition_align(table->retired[i].size, 
+                                                        table->page_size));
+#endif
+}
+
+void partition_table_restore(PartitionTable* table, FILE* file){
+    assert(table!=NULL && file!=NULL);
+    ub8 header[6];
+    _partition_checkpoint_read(file, header, sizeof(header));
+    if(header[0]!=table->lock_table_size || header[1]!=table->slot_size 
+            || header[2]!=table->record_size)
+        ERRORMACRO("partition_table_restore: The checkpoint has a different partition geometry");
+    table->segment_end = header[3];
+    table->last_number = header[4];
+    table->last_collision_assigned = header[5];
+    _partition_checkpoint_read(file, table->lock_table, table->lock_table_size);
+    _partition_checkpoint_read(file, table->collision_num_write_table, 
+                                    sizeof(int)*table->lock_table_size);
+    unsigned long p, n = table->lock_table_size + 1;
+    _partition_checkpoint_read(file, table->state_records, sizeof(PartitionRecord)*n);
+    for(p=0; p < n; p++){
+        int size;
+        _partition_checkpoint_read(file, &size, sizeof(int));
+        table->collision_records[p] = (PartitionRecord *) realloc(
+                table->collision_records[p], sizeof(PartitionRecord)*(size > 0 ? size : 1));
+        _partition_checkpoint_read(file, table->collision_records[p], 
+                                    sizeof(PartitionRecord)*size);
+        table->collision_records_size[p] = size;
+        _partition_checkpoint_read(file, &size, sizeof(int));
+        table->appended_records[p] = (PartitionRecord *) realloc(
+                table->appended_records[p], sizeof(PartitionRecord)*(size > 0 ? size : 1));
+        _partition_checkpoint_read(file, table->appended_records[p], 
+                                    sizeof(PartitionRecord)*size);
+        table->appended_records_count[p] = size;
+        table->appended_records_capacity[p] = (size > 0 ? size : 1);
+        if(!table->collision_records[p] || !table->appended_records[p])
+            ERRORMACRO("partition_table_restore: Impossible to create the partition records");
+    }
+    ub8 stats[4];
+    _partition_checkpoint_read(file, stats, sizeof(stats));
+    table->bytes_written = stats[0];
+    table->bytes_read = stats[1];
+    table->records_written = stats[2];
+    table->records_appended = stats[3];
+    //Drop what was written after the checkpoint
+    errno = 0;
+    if(ftruncate(table->segment_fd, table->segment_end))
+        ERRORMACRO("partition_table_restore: Unable to truncate the segment file");
+    table->checkpoint_end = table->segment_end;
+}
+
+void partition_write(PartitionTable* table, unsigned long partition_number, 
+        HashTable* table_data, PartitionType type, ...){
     
-    count = table_data->count;
-    tpl_node *node_head;
-    node_head = tpl_map("iiiii", &slot_size, &num_slot, &count, &partition_number, &size_compressed);
-    tpl_pack(node_head, 0);
-    tpl_dump(node_head, TPL_FILE, file_name_head);    
-    tpl_free(node_head);       
-    
-    //Write data
-    
-    //Write memo
-    //File data
-    
-    
-    
-    if(type==PARTITION_OF_COLLISIONS)
-         strcat(file_name_memo, suffix_collision);
-    
-    strcat(file_name_memo, "_m.tpl");
-    //Dump to file
-    HashMemo* memo = table_data->table.in_place.memo;
-    tpl_node *node_memo;
-    node_memo = tpl_map("c#", memo, sizeof(HashMemo)*num_slot);
-    tpl_pack(node_memo, 0);
-    tpl_dump(node_memo, TPL_FILE, file_name_memo);
-    tpl_free(node_memo); 
-    
-    //File data
-    if(type==PARTITION_OF_COLLISIONS)
-         strcat(file_name, suffix_collision);
-    
-    strcat(file_name, ".tpl"); 
+    assert(table!=NULL  && table_data->type==HASH_TABLE_IN_PLACE
+            &&  partition_number <= table->last_number && table_data!=NULL);        
+    if(type!=PARTITION_OF_STATES)
+        ERRORMACRO("partition_write: collisions are written as logs");
+    
+    ub8 start = _partition_now();
+    //A partition of states is rewritten at the same offset, one write at a time
+    _partition_wait_pending(table, partition_number, type);
+    _partition_write(table, partition_number, table_data);
+    _interface_atomic_add_64(&(table->io_blocked_ns), _partition_now() - start);
+}
+
+/*Queues a job, the item is owned by the I/O threads from now on*/
+static void _partition_queue_job(PartitionTable* table, PartitionJob* new_job){
+    PartitionJob *job = table->jobs + 
+            (table->jobs_head + table->jobs_count) % table->jobs_capacity;
+    *job = *new_job;
+    table->jobs_count++;
+    (*_partition_pending(table, job->partition_number, job->type))++;
+    pthread_cond_signal(&table->io_job_ready);
+}
+
+void partition_write_async(PartitionTable* table, unsigned long partition_number, 
+        HashTable** table_data, PartitionType type, ...){
+    
+    assert(table!=NULL  && table_data!=NULL && (*table_data)->type==HASH_TABLE_IN_PLACE
+            &&  partition_number <= table->last_number);        
+    if(type!=PARTITION_OF_STATES)
+        ERRORMACRO("partition_write_async: collisions are written as logs");
+    
+    if(table->io_threads==0 || table->io_stop){
+        partition_write(table, partition_number, *table_data, type);
+        hash_table_reset(*table_data);
+        return;
+    }
     
-    int size_data = slot_size*num_slot;
-    if(STATECOMPRESSIONSSD)
-        size_data = size_compressed;
-    tpl_node *node;
-    node = tpl_map("c#", data, size_data);
+    ub8 start = _partition_now();
+    pthread_mutex_lock(&table->io_lock);
+    while(table->pending_states[partition_number] > 0)
+        pthread_cond_wait(&table->io_job_done, &table->io_lock);
+    HashTable *spare = (HashTable *) _partition_pool_take(table, 
+                                &table->pool_states, *table_data);
+    PartitionJob job;
+    memset(&job, 0, sizeof(PartitionJob));
+    job.partition_number = partition_number;
+    job.type = type;
+    job.table_data = *table_data;
+    _partition_queue_job(table, &job);
+    pthread_mutex_unlock(&table->io_lock);
+    _interface_atomic_add_64(&(table->io_blocked_ns), _partition_now() - start);
+    
+    *table_data = spare;
+}
+
+void partition_write_log(PartitionTable* table, unsigned long partition_number, 
+        ub1* states, int count, int sequence_collision_number){
+    assert(table!=NULL && states!=NULL && partition_number <= table->last_number);
+    ub8 start = _partition_now();
+    _partition_write_log(table, partition_number, states, count, 
+                                sequence_collision_number);
+    _interface_atomic_add_64(&(table->io_blocked_ns), _partition_now() - start);
+}
+
+void partition_write_log_async(PartitionTable* table, unsigned long partition_number, 
+        ub1* states, int count, int sequence_collision_number){
+    assert(table!=NULL && states!=NULL && partition_number <= table->last_number
+            && count <= _partition_log_capacity());
+    
+    if(table->io_threads==0 || table->io_stop){
+        partition_write_log(table, partition_number, states, count, 
+                                sequence_collision_number);
+        return;
+    }
     
-    tpl_pack(node, 0);
-    tpl_dump(node, TPL_FILE, file_name);
-    tpl_free(node); 
+    ub8 start = _partition_now();
+    pthread_mutex_lock(&table->io_lock);
+    ub1 *log = (ub1 *) _partition_pool_take(table, &table->pool_logs, NULL);
+    pthread_mutex_unlock(&table->io_lock);
+    memcpy(log, states, ((ub8) count)*table->slot_size);
+    
+    PartitionJob job;
+    memset(&job, 0, sizeof(PartitionJob));
+    job.partition_number = partition_number;
+    job.type = PARTITION_OF_COLLISIONS;
+    job.sequence_collision_number = sequence_collision_number;
+    job.log = log;
+    job.log_count = count;
+    pthread_mutex_lock(&table->io_lock);
+    _partition_queue_job(table, &job);
+    pthread_mutex_unlock(&table->io_lock);
+    _interface_atomic_add_64(&(table->io_blocked_ns), _partition_now() - start);
+}
+
+ub1* partition_get_log(PartitionTable* table, unsigned long partition_number, 
+        int sequence_collision_number, int* count){
+    assert(table!=NULL && count!=NULL && partition_number <= table->last_number);
+    
+    ub8 start = _partition_now();
+    *count = 0;
+    _partition_wait_pending(table, partition_number, PARTITION_OF_COLLISIONS);
+    PartitionRecord record = _partition_take_record(table, partition_number, 
+                            PARTITION_OF_COLLISIONS, sequence_collision_number);
+    if(record.size==0){
+        _interface_atomic_add_64(&(table->io_blocked_ns), _partition_now() - start);
+        return NULL;
+    }
     
+    if(DISCPARALLELSEQUENTIAL)
+        disc_access_lock();
+    errno = 0;
+    ub1 *mapped = (ub1 *) mmap(NULL, record.size, PROT_READ, MAP_PRIVATE, 
+                                    table->segment_fd, record.offset);
+    if(mapped==MAP_FAILED)
+        ERRORMACRO("partition_get_log: Unable to map the segment file");
+    posix_madvise(mapped, record.size, POSIX_MADV_SEQUENTIAL);
+    PartitionRecordHeader *header = (PartitionRecordHeader *) mapped;
+    if(header->slot_size != table->slot_size || header->num_slot != 0)
+        ERRORMACRO("partition_get_log: record is not a log of collisions");
+    ub8 size_data = header->occupied*table->slot_size;
+    ub1 *data = _partition_record_states(table, mapped, NULL);
+    partition_log_buffer = (ub1 *) _partition_reserve(partition_log_buffer, 
+                &partition_log_buffer_size, size_data);
+    memcpy(partition_log_buffer, data, size_data);
+    *count = header->occupied;
+    munmap(mapped, record.size);
     if(DISCPARALLELSEQUENTIAL)
         disc_access_unlock();
     
-    free(suffix_collision);
-    free(file_name);
-    free(file_name_head);
-    free(file_name_memo); 
-    
-    
+    _partition_discard(table, record);
+    _interface_atomic_add_64(&(table->bytes_read), record.size);
+    _interface_atomic_add_64(&(table->io_blocked_ns), _partition_now() - start);
+    return partition_log_buffer;
 }
 
-//private function to get partition from file
-int _partition_get(PartitionTable* table, unsigned long partition_number, 
-        HashTable* table_data, PartitionType type, int sequence_collision_number){ 
-    
-        if(DISCPARALLELSEQUENTIAL)
+ub8 partition_log_size(PartitionTable* table, unsigned long partition_number){
+    assert(table!=NULL && partition_number <= table->last_number);
+    ub8 size = 0;
+    int i;
+    pthread_mutex_lock(&table->collision_records_lock);
+    for(i=0; i < table->collision_records_size[partition_number]; i++)
+        size += table->collision_records[partition_number][i].size;
+    pthread_mutex_unlock(&table->collision_records_lock);
+    return size;
+}
+
+void partition_prefetch(PartitionTable* table, unsigned long partition_number, 
+        PartitionType type){
+    assert(table!=NULL);
+    if(partition_number==0 || partition_number > table->last_number)
+        return;
+    if(type==PARTITION_OF_STATES){
+        PartitionRecord record = table->state_records[partition_number];
+        if(record.size)
+            posix_fadvise(table->segment_fd, record.offset, record.size, 
+                                POSIX_FADV_WILLNEED);
+        return;
+    }
+    pthread_mutex_lock(&table->collision_records_lock);
+    int i;
+    for(i=0; i < table->collision_records_size[partition_number]; i++){
+        PartitionRecord record = table->collision_records[partition_number][i];
+        if(record.size)
+            posix_fadvise(table->segment_fd, record.offset, record.size, 
+                                POSIX_FADV_WILLNEED);
+    }
+    pthread_mutex_unlock(&table->collision_records_lock);
+}
+
+int partition_summary_test(PartitionTable* table, unsigned long partition_number, 
+        void* state){
+    assert(table!=NULL && partition_number <= table->last_number);
+    //The summary is rebuilt by the writes of the partition
+    _partition_wait_pending(table, partition_number, PARTITION_OF_STATES);
+    if(table->summaries[partition_number]==NULL)
+        return 1;
+    if(_partition_summary_contains(table, table->summaries[partition_number], 
+            (ub1 *) state)){
+        _interface_atomic_inc_64(&(table->summary_positives));
+        return 1;
+    }
+    _interface_atomic_inc_64(&(table->summary_negatives));
+    return 0;
+}
+
+void partition_append_states(PartitionTable* table, unsigned long partition_number, 
+        HashTable* table_data){
+    assert(table!=NULL && table_data!=NULL && partition_number <= table->last_number
+            && table->summaries[partition_number]!=NULL);
+    if(table_data->count==0)
+        return;
+    ub8 start = _partition_now();
+    //Packed as a partition of collisions (same table size)
+    PartitionRecord record;
+    record.size = _partition_pack(table_data, partition_number);
+    record.offset = _interface_atomic_add_64(&(table->segment_end), 
+                                _partition_align(record.size, table->page_size));
+    if(DISCPARALLELSEQUENTIAL)
         disc_access_lock();
-    
-    char* suffix_collision = NULL;
-    int suffix_size = 0;
-    if(type==PARTITION_OF_COLLISIONS){
-        suffix_collision = (char*) malloc(sizeof(char)*30); 
-        strcpy(suffix_collision, "_cl_");
-        char *num =   itoa(sequence_collision_number);
-        strcat(suffix_collision, num);
-        free(num);
-        suffix_size = strlen(suffix_collision);
-        //strcat(suffix_collision, "_");
-    }
-       
-    //Get header
-    //Set file name
-    char* file_name = (char*) malloc(sizeof(char)*(strlen(table->path) 
-                                        + strlen(table->prefix_name)  
-                                        + suffix_size + 150));
-    char* file_name_header = (char*) malloc(sizeof(char)*(strlen(file_name)+100));
-    char* file_name_memo = (char*) malloc(sizeof(char)*(strlen(file_name) +100));
-    
-     //Set file name
-    strcpy(file_name, "");
-    strcpy(file_name_header, "");
-    strcpy(file_name_memo, "");
-    
-    char *num_p =   itoa(partition_number);
-    
-    //strcat(file_name, table->path);
-   // strcat(file_name, "/"); 
-    strcat(file_name, table->prefix_name);
-    strcat(file_name, num_p);
-    
-    free(num_p);
-    
-    strcat(file_name_header, file_name);
-    strcat(file_name_memo, file_name);
-    
-    
-    if(type==PARTITION_OF_COLLISIONS)
-         strcat(file_name_header, suffix_collision);
-    
-    strcat(file_name_header, "_h.tpl");
-    
-    //Check presence of file
-    if(access(file_name_header, F_OK) == -1){
-        //Halt
-        /*if(type==PARTITION_OF_STATES)
-            ERRORMACRO(" Unable to find partition of states");*/
-        return 0;
+    _partition_pwrite(table, partition_buffer, record.size, record.offset);
+    if(DISCPARALLELSEQUENTIAL)
+        disc_access_unlock();
+    _partition_summary_add_table(table, table->summaries[partition_number], table_data);
+    
+    pthread_mutex_lock(&table->collision_records_lock);
+    int count = table->appended_records_count[partition_number];
+    if(count == table->appended_records_capacity[partition_number]){
+        int new_size = (count > 0) ? 2*count : 4;
+        table->appended_records[partition_number] = (PartitionRecord *) realloc(
+                table->appended_records[partition_number], new_size*sizeof(PartitionRecord));
+        if(table->appended_records[partition_number]==NULL)
+            ERRORMACRO("partition_append_states: Impossible to grow the appended records");
+        table->appended_records_capacity[partition_number] = new_size;
     }
-    
-    //Get partition
-    tpl_node* node_head;
-    int slot_size = 0, num_slot = 0, p_number = 0, count = 0, size_compressed = 0;
-    node_head = tpl_map("iiiii", &slot_size, &num_slot, &count,
-                                &p_number, &size_compressed);    
-    tpl_load(node_head, TPL_FILE, file_name_header);
-    tpl_unpack(node_head, 0);
-    tpl_free(node_head);
-    
-    if(type==PARTITION_OF_COLLISIONS){
-        remove(file_name_header);
+    table->appended_records[partition_number][count] = record;
+    table->appended_records_count[partition_number]++;
+    pthread_mutex_unlock(&table->collision_records_lock);
+    
+    _interface_atomic_add_64(&(table->bytes_written), record.size);
+    _interface_atomic_inc_64(&(table->records_written));
+    _interface_atomic_inc_64(&(table->records_appended));
+    _interface_atomic_add_64(&(table->io_blocked_ns), _partition_now() - start);
+}
+
+/*Sorted runs*/
+
+static void _partition_pread(PartitionTable* table, ub1 *buffer, ub8 size, ub8 offset){
+    while(size > 0){
+        errno = 0;
+        ssize_t done = pread(table->segment_fd, buffer, size, offset);
+        if(done < 0 && errno==EINTR)
+            continue;
+        if(done <= 0)
+            ERRORMACRO("partition_search: Unable to read the segment file");
+        buffer += done;
+        offset += done;
+        size -= done;
     }
-    
-    if(slot_size != table_data->table.in_place.slot_size)
-        ERRORMACRO("partition_get: partition slot_size disagrees with hash table")
-    if(num_slot  > (1 << table_data->logsize) + 2 )
-        ERRORMACRO("partition_get: partition exceeds hash table size\n");
-        
-    table_data->count = count;
-    table_data->mask = num_slot - 2;
-    //Hash table OK
-    
-    
-    //Get memo
-    
-    
-    if(type==PARTITION_OF_COLLISIONS)
-         strcat(file_name_memo, suffix_collision);
-    
-    strcat(file_name_memo, "_m.tpl");
-    tpl_node* node_memo;
-    HashMemo * memo = table_data->table.in_place.memo;
-    node_memo = tpl_map("c#", memo, 
-                                sizeof(HashMemo)*num_slot);    
-    tpl_load(node_memo, TPL_FILE, file_name_memo);
-    tpl_unpack(node_memo, 0);     
-    tpl_free(node_memo);
-    
-    if(type==PARTITION_OF_COLLISIONS){
-        remove(file_name_memo);
+}
+
+/*Adds the record packed in the thread buffer, written at record, as a run*/
+static void _partition_run_add(PartitionTable* table, unsigned long partition_number, 
+        PartitionRecord record){
+    const PartitionRecordHeader *header = (const PartitionRecordHeader *) partition_buffer;
+    int slot_size = header->slot_size;
+    PartitionRun run;
+    run.record = record;
+    run.count = header->occupied;
+    run.encoding = header->encoding;
+    run.blocks = (run.count + PARTITION_BLOCK_STATES - 1)/PARTITION_BLOCK_STATES;
+    run.offsets = (ub8 *) malloc((run.blocks + 1)*sizeof(ub8));
+    run.fences = (ub1 *) malloc(run.blocks*slot_size);
+    if(run.offsets==NULL || run.fences==NULL)
+        ERRORMACRO("partition_append_sorted: Impossible to index the run");
+    ub8 b;
+    if(run.encoding==PARTITION_ENCODING_SORTED){
+        const ub8 *offsets = (const ub8 *) (partition_buffer + PARTITION_HEADER_SIZE);
+        ub8 data = PARTITION_HEADER_SIZE + run.blocks*sizeof(ub8);
+        for(b=0; b < run.blocks; b++)
+            run.offsets[b] = data + offsets[b];
+        run.offsets[run.blocks] = data + header->size_encoded;
+    } else {
+        for(b=0; b < run.blocks; b++)
+            run.offsets[b] = PARTITION_HEADER_SIZE + b*PARTITION_BLOCK_STATES*slot_size;
+        run.offsets[run.blocks] = PARTITION_HEADER_SIZE + run.count*slot_size;
     }
+    //The first state of a block is stored as is
+    for(b=0; b < run.blocks; b++)
+        memcpy(run.fences + b*slot_size, partition_buffer + run.offsets[b], slot_size);
+    
+    int count = table->runs_count[partition_number];
+    if(count==table->runs_capacity[partition_number]){
+        int new_size = (count > 0) ? 2*count : PARTITION_SEARCH_RUNS + 1;
+        table->runs[partition_number] = (PartitionRun *) realloc(
+                table->runs[partition_number], new_size*sizeof(PartitionRun));
+        if(table->runs[partition_number]==NULL)
+            ERRORMACRO("partition_append_sorted: Impossible to grow the runs");
+        table->runs_capacity[partition_number] = new_size;
+    }
+    table->runs[partition_number][count] = run;
+    table->runs_count[partition_number]++;
+}
+
+/*Searches the only block of a run that may hold state*/
+static int _partition_run_search(PartitionTable* table, PartitionRun *run, 
+        const ub1 *state){
+    int slot_size = table->slot_size;
+    //Last block whose fence is not greater than the state
+    ub8 low = 0, high = run->blocks, middle;
+    while(low < high){
+        middle = (low + high) >> 1;
+        if(memcmp(run->fences + middle*slot_size, state, slot_size) <= 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    if(low==0)
+        return 0;
+    ub8 b = low - 1;
+    if(!memcmp(run->fences + b*slot_size, state, slot_size))
+        return 1;
     
-    //GEt data
-    if(type==PARTITION_OF_COLLISIONS)
-         strcat(file_name, suffix_collision);
-    
-    strcat(file_name, ".tpl");
-    tpl_node* node;
-    ub1 * value = NULL;
-    if(size_compressed > 0){
-        //Compression enabled
-        if(type==PARTITION_OF_COLLISIONS){
-            value = compression_collisions->buffer_compressed;
-        } else {
-            value = compression_states->buffer_compressed;
+    ub8 first = b*PARTITION_BLOCK_STATES;
+    ub8 count = (run->count - first < PARTITION_BLOCK_STATES) ? 
+            run->count - first : PARTITION_BLOCK_STATES;
+    ub8 size = run->offsets[b + 1] - run->offsets[b];
+    partition_block_buffer = (ub1 *) _partition_reserve(partition_block_buffer, 
+                &partition_block_buffer_size, size + count*slot_size);
+    if(DISCPARALLELSEQUENTIAL)
+        disc_access_lock();
+    _partition_pread(table, partition_block_buffer, size, run->record.offset + run->offsets[b]);
+    if(DISCPARALLELSEQUENTIAL)
+        disc_access_unlock();
+    _interface_atomic_add_64(&(table->bytes_read), size);
+    _interface_atomic_inc_64(&(table->blocks_read));
+    if(run->encoding==PARTITION_ENCODING_SORTED)
+        return _partition_decode_search(partition_block_buffer, count, slot_size, 
+                    partition_block_buffer + size, state);
+    
+    //The states of the block are sorted
+    ub1 *states = partition_block_buffer;
+    low = 1;
+    high = count;
+    while(low < high){
+        middle = (low + high) >> 1;
+        int compare = memcmp(states + middle*slot_size, state, slot_size);
+        if(compare==0)
+            return 1;
+        if(compare < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return 0;
+}
+
+void partition_append_sorted(PartitionTable* table, unsigned long partition_number, 
+        ub1** states, ub8 count){
+    assert(table!=NULL && states!=NULL && partition_number <= table->last_number);
+    if(count==0)
+        return;
+    ub8 start = _partition_now();
+    int slot_size = table->slot_size;
+    ub8 i;
+    if(table->summaries[partition_number]==NULL){
+        table->summaries[partition_number] = (ub8 *) calloc((table->summary_mask + 1) >> 3, 1);
+        if(table->summaries[partition_number]==NULL)
+            ERRORMACRO("partition_append_sorted: Impossible to create the partition summary");
+    }
+    for(i=0; i < count; i++)
+        _partition_summary_add(table, table->summaries[partition_number], states[i]);
+    
+    ub1 *merged = NULL;
+    ub1 **references = states;
+    if(table->runs_count[partition_number] >= PARTITION_SEARCH_RUNS){
+        //Merges the runs and the new states into one run
+        PartitionRun *runs = table->runs[partition_number];
+        int r, number_of_runs = table->runs_count[partition_number];
+        ub8 total = count, n = 0;
+        for(r=0; r < number_of_runs; r++)
+            total += runs[r].count;
+        merged = (ub1 *) malloc(total*slot_size);
+        references = (ub1 **) malloc(2*total*sizeof(ub1 *));
+        if(merged==NULL || references==NULL)
+            ERRORMACRO("partition_append_sorted: Impossible to merge the runs");
+        for(r=0; r < number_of_runs; r++){
+            partition_block_buffer = (ub1 *) _partition_reserve(partition_block_buffer, 
+                        &partition_block_buffer_size, runs[r].record.size);
+            _partition_pread(table, partition_block_buffer, runs[r].record.size, 
+                        runs[r].record.offset);
+            memcpy(merged + n*slot_size, 
+                    _partition_record_states(table, partition_block_buffer, NULL), 
+                    runs[r].count*slot_size);
+            n += runs[r].count;
+            _interface_atomic_add_64(&(table->bytes_read), runs[r].record.size);
+            _partition_discard(table, runs[r].record);
+            free(runs[r].offsets);
+            free(runs[r].fences);
         }
-        node = tpl_map("c#", value, size_compressed);  
-    } else {
-        //Compression disabled
-        value = table_data->table.in_place.data;
-        node = tpl_map("c#", value, slot_size*num_slot);    
+        for(i=0; i < count; i++)
+            memcpy(merged + (n + i)*slot_size, states[i], slot_size);
+        for(i=0; i < total; i++)
+            references[i] = merged + i*slot_size;
+        //A state written again after it was read back is kept once
+        _partition_sort(references, total, 0, slot_size, references + total);
+        for(i=1, n=1; i < total; i++)
+            if(memcmp(references[i], references[n - 1], slot_size))
+                references[n++] = references[i];
+        count = n;
+        table->runs_count[partition_number] = 0;
+        _interface_atomic_inc_64(&(table->runs_merged));
     }
-    tpl_load(node, TPL_FILE, file_name); 
-    tpl_unpack(node, 0);      
-    tpl_free(node);
     
-    if(STATECOMPRESSIONSSD){
-        if(type==PARTITION_OF_COLLISIONS){
-             void * decompressed_data = NULL;
-             int size = data_compression_decompress(compression_collisions, value, &decompressed_data);
-             memcpy(table_data->table.in_place.data, decompressed_data, size-(2*slot_size));            
-        } else {
-             void * decompressed_data = NULL;
-             int size = data_compression_decompress(compression_states, value, &decompressed_data);
-             memcpy(table_data->table.in_place.data, decompressed_data, size-(2*slot_size));
-        }
-    } 
+    PartitionRecord record;
+    record.size = _partition_pack_sorted(references, count, slot_size);
+    PartitionRecordHeader *header = (PartitionRecordHeader *) partition_buffer;
+    header->slot_size = slot_size;
+    header->num_slot = 0;
+    header->count = count;
+    header->occupied = count;
+    header->partition_number = partition_number;
+    record.offset = _interface_atomic_add_64(&(table->segment_end), 
+                                _partition_align(record.size, table->page_size));
+    if(DISCPARALLELSEQUENTIAL)
+        disc_access_lock();
+    _partition_pwrite(table, partition_buffer, record.size, record.offset);
+    if(DISCPARALLELSEQUENTIAL)
+        disc_access_unlock();
+    _partition_run_add(table, partition_number, record);
+    free(merged);
+    if(references!=states)
+        free(references);
+    
+    _interface_atomic_add_64(&(table->bytes_written), record.size);
+    _interface_atomic_inc_64(&(table->records_written));
+    _interface_atomic_add_64(&(table->io_blocked_ns), _partition_now() - start);
+}
+
+int partition_search(PartitionTable* table, unsigned long partition_number, 
+        void* state){
+    assert(table!=NULL && state!=NULL && partition_number <= table->last_number);
+    int r = table->runs_count[partition_number];
+    if(r==0 || !partition_summary_test(table, partition_number, state))
+        return 0;
+    //The newest states are the likeliest to be probed again
+    for(r--; r >= 0; r--)
+        if(_partition_run_search(table, table->runs[partition_number] + r, 
+                    (const ub1 *) state))
+            return 1;
+    return 0;
+}
+
+//private function to get partition from file
+int _partition_get(PartitionTable* table, unsigned long partition_number, 
+        HashTable* table_data){ 
     
-    if(type==PARTITION_OF_COLLISIONS){
-        remove(file_name);
+    ub8 start = _partition_now();
+    _partition_wait_pending(table, partition_number, PARTITION_OF_STATES);
+    PartitionRecord record = table->state_records[partition_number];
+    if(record.size==0){
+        _interface_atomic_add_64(&(table->io_blocked_ns), _partition_now() - start);
+        return 0;
     }
     
     if(DISCPARALLELSEQUENTIAL)
-        disc_access_unlock();
+        disc_access_lock();
     
-    free(suffix_collision);
-    free(file_name);
-    free(file_name_header);
-    free(file_name_memo);
+    //Records are page aligned, map it and restore the occupied slots
+    errno = 0;
+    ub1 *mapped = (ub1 *) mmap(NULL, record.size, PROT_READ, MAP_PRIVATE, 
+                                    table->segment_fd, record.offset);
+    if(mapped==MAP_FAILED)
+        ERRORMACRO("partition_get: Unable to map the segment file");
+    posix_madvise(mapped, record.size, POSIX_MADV_SEQUENTIAL);
+    _partition_unpack(table, mapped, table_data);
+    munmap(mapped, record.size);
+    _partition_merge_appended(table, partition_number, table_data);
     
+    if(DISCPARALLELSEQUENTIAL)
+        disc_access_unlock();
+    
+    _interface_atomic_add_64(&(table->bytes_read), record.size);
+    _interface_atomic_add_64(&(table->io_blocked_ns), _partition_now() - start);
     
     return 1;
-    //*partition_return = partition;
     
 }
 
@@ -429,20 +1778,13 @@ int partition_get(PartitionTable* table, unsigned long partition_number,
         HashTable* table_data, PartitionType type, ...){
     assert(table!=NULL && table_data->type==HASH_TABLE_IN_PLACE 
             && partition_number <= table->last_number);
-    
-    int sequence_collision_number = 0;
-    if(type==PARTITION_OF_COLLISIONS){ 
-        va_list ap; 
-        va_start(ap, type); //last fixed parameter
-        sequence_collision_number = va_arg(ap, int); //Get the slot size if present
-        va_end(ap);  
-    }
-    
+    if(type!=PARTITION_OF_STATES)
+        ERRORMACRO("partition_get: collisions are read as logs");
     
     //Get partition lock
     //partition_lock(table, partition_number);
     
-    return _partition_get(table, partition_number, table_data, type, sequence_collision_number);
+    return _partition_get(table, partition_number, table_data);
     
 }
 
@@ -451,18 +1793,12 @@ int partition_try_get(PartitionTable* table, unsigned long partition_number,
         HashTable* table_data, PartitionType type, ...){
     assert(table!=NULL && table_data->type==HASH_TABLE_IN_PLACE
             && partition_number <= table->last_number);
-    
-    int sequence_collision_number = 0;
-    if(type==PARTITION_OF_COLLISIONS){ 
-        va_list ap; 
-        va_start(ap, type); //last fixed parameter
-        sequence_collision_number = va_arg(ap, int); //Get the slot size if present
-        va_end(ap);  
-    }
+    if(type!=PARTITION_OF_STATES)
+        ERRORMACRO("partition_try_get: collisions are read as logs");
     
     //Try partition lock
     if(partition_try_lock(table, partition_number))
-        return partition_get(table, partition_number, table_data, type, sequence_collision_number);
+        return partition_get(table, partition_number, table_data, type);
     else
         return 0;
 }
@@ -569,4 +1905,28 @@ int partition_release(PartitionTable* partition_table, long partition_number){
             return 1;
         _partition_cycle_wait();
     }while(locked);
-}
\ No newline at end of file
+}
+
+void partition_stats(PartitionTable* partition_table){
+    assert(partition_table!=NULL);
+    
+    fprintf(stdout, "\n\tPartition Stats:\t");
+    fprintf(stdout, "\n\tSegment file:\t %s", partition_table->segment_name);
+    fprintf(stdout, "\n\tRecords written:\t %llu", partition_table->records_written);
+    fprintf(stdout, "\n\tBytes written:\t %llu", partition_table->bytes_written);
+    fprintf(stdout, "\n\tBytes read:\t %llu", partition_table->bytes_read);
+    fprintf(stdout, "\n\tSummary negatives:\t %llu (of %llu tests)", 
+            partition_table->summary_negatives,
+            partition_table->summary_negatives + partition_table->summary_positives);
+    fprintf(stdout, "\n\tRecords of appended states:\t %llu", 
+            partition_table->records_appended);
+    if(partition_table->blocks_read || partition_table->runs_merged)
+        fprintf(stdout, "\n\tBlocks of sorted runs read:\t %llu (%llu merges)", 
+                partition_table->blocks_read, partition_table->runs_merged);
+    fprintf(stdout, "\n\tI/O threads:\t %d", partition_table->io_threads);
+    fprintf(stdout, "\n\tTime blocked on I/O:\t %f s", 
+            partition_table->io_blocked_ns/1e9);
+    fprintf(stdout, "\n\tTime writing in background:\t %f s", 
+            partition_table->io_busy_ns/1e9);
+    fflush(stdout);
+}
@@ -31,7 +31,17 @@
  * 
  * @section DESCRIPTION
  *
- * TODO
+ * Serialized partitions of the disc based exploration (-disc). All partitions
+ * of a run are stored in a single segment file (<prefix>.seg). Partitions of
+ * states have a fixed, page-aligned record each at the beginning of the file;
+ * logs of collisions (states found by other partitions, appended as they
+ * come) are written after them and their space is released once they are 
+ * read back. A record of states holds only the occupied slots of the in-place
+ * hash table (bitmap, memo and slot data).
+ * Each partition of states written has an in-memory Bloom summary of its
+ * states. States that the summary rules out can be added to the partition
+ * without reading it: they are appended as records that partition_get merges
+ * into the partition until it is written again.
  * 
  */
 
@@ -43,6 +53,54 @@
 
 typedef enum PartitionTypeEnum{PARTITION_OF_STATES, PARTITION_OF_COLLISIONS}PartitionType;
 
+/**
+ * Location of a serialized partition inside the segment file. A record of
+ * size zero is not present.
+ */
+typedef struct PartitionRecordStruct{
+    ub8 offset;
+    ub8 size;
+}PartitionRecord;
+
+/**
+ * Sorted record of states searched one block at a time (partition_search).
+ * The first state of every block (its fence) and the offsets of the blocks
+ * in the record are kept in memory.
+ */
+typedef struct PartitionRunStruct{
+    PartitionRecord record;
+    ub8 count;
+    ub8 blocks;
+    ub4 encoding;
+    ub8* offsets;       //blocks + 1 offsets in the record
+    ub1* fences;
+}PartitionRun;
+
+/**
+ * Asynchronous write handed to the I/O threads. The table (or the log buffer)
+ * belongs to the job until it is written, then it is returned to the pool.
+ */
+typedef struct PartitionJobStruct{
+    unsigned long partition_number;
+    PartitionType type;
+    int sequence_collision_number;
+    HashTable* table_data;      //PARTITION_OF_STATES
+    ub1* log;                   //PARTITION_OF_COLLISIONS
+    int log_count;
+}PartitionJob;
+
+/**
+ * Pool of spare hash tables of one size (partitions of states), handed to the 
+ * threads in exchange of the tables they write asynchronously, or of buffers 
+ * the logs of collisions are copied to.
+ */
+typedef struct PartitionTablePoolStruct{
+    void** free;
+    int count;
+    int created;
+    int capacity;
+}PartitionTablePool;
+
 /**
  * Partition structure. Control the concurrent access to the serialized 
  * partitions.
@@ -57,6 +115,71 @@ typedef struct PartitionTableStruct{
     int*        collision_num_write_table;
     unsigned long        lock_table_size;
     unsigned int         slot_size;  //State size
+    //Segment file
+    char*       segment_name;
+    int         segment_fd;
+    ub8         page_size;
+    ub8         record_size;        //Fixed record size of a partition of states
+    volatile ub8 segment_end;       //Append offset for partitions of collisions
+    PartitionRecord*  state_records;
+    PartitionRecord** collision_records;    //Logs, indexed by write number
+    int*        collision_records_size;
+    PartitionRecord** appended_records;     //States added without a read
+    int*        appended_records_count;
+    int*        appended_records_capacity;
+    PartitionRun** runs;                    //Sorted runs (partition_search)
+    int*        runs_count;
+    int*        runs_capacity;
+    pthread_mutex_t collision_records_lock;
+    //Checkpoints (-checkpoint): the records below checkpoint_end belong to
+    //the last checkpoint, their space is released by the next one
+    ub8         checkpoint_end;
+    PartitionRecord* retired;
+    int         retired_count;
+    int         retired_capacity;
+    pthread_mutex_t retired_lock;
+    //Bloom summaries of the partitions of states
+    ub8**       summaries;
+    ub8         summary_mask;       //Number of bits - 1
+    //Asynchronous I/O (-disc_io)
+    int         io_threads;
+    int         io_stop;
+    pthread_t*  io_thread_ids;
+    pthread_mutex_t io_lock;
+    pthread_cond_t  io_job_ready;
+    pthread_cond_t  io_job_done;
+    PartitionJob*   jobs;           //Ring of pending jobs
+    int         jobs_head;
+    int         jobs_count;
+    int         jobs_capacity;
+    PartitionTablePool pool_states;
+    PartitionTablePool pool_logs;
+    volatile int* pending_states;       //Per partition writes not on disc yet
+    volatile int* pending_collisions;
+    //Helpers decoding the SORTED records read back (-sc), one job at a time
+    int         decode_threads;
+    int         decode_stop;
+    pthread_t*  decode_thread_ids;
+    pthread_mutex_t decode_lock;
+    pthread_cond_t  decode_ready;
+    pthread_cond_t  decode_done;
+    void*       decode_job;
+    int         decode_generation;
+    int         decode_working;
+    volatile ub1 decode_busy;
+    void        (*decode_init)(void*);
+    void*       decode_init_arg;
+    //Statistics
+    volatile ub8 io_blocked_ns;     //Time the exploration threads waited for I/O
+    volatile ub8 io_busy_ns;        //Time the I/O threads spent writing
+    volatile ub8 bytes_written;
+    volatile ub8 bytes_read;
+    volatile ub8 records_written;
+    volatile ub8 summary_negatives;
+    volatile ub8 summary_positives;
+    volatile ub8 records_appended;
+    volatile ub8 runs_merged;
+    volatile ub8 blocks_read;
 }PartitionTable;
 
 typedef struct PartitionStruct{
@@ -67,14 +190,158 @@ typedef struct PartitionStruct{
     HashMemo* memo;
 }Partition;
 
+/**
+ * Creates the partition table and its segment file.
+ * @param prefix Prefix of the segment file name
+ * @param number_of_partitions Maximum number of partitions of states
+ * @param slot_size State size in bytes
+ * @param table_size Size in bits of the hash table of a partition of states
+ */
 extern PartitionTable* partition_table_init(char* prefix, char* path, 
-        long number_of_partitions);
+        long number_of_partitions, int slot_size, int table_size);
 
 extern void partition_table_init_local(int state_table, int collision_table);
 
+/**
+ * Starts the I/O threads used by partition_write_async. With zero threads
+ * every write is synchronous.
+ * @param io_threads Number of I/O threads
+ * @param spare_tables Number of spare tables of each size (states and
+ * collisions) that may be in flight
+ */
+extern void partition_table_start_io(PartitionTable* table, int io_threads, 
+        int spare_tables);
+
+/**
+ * Waits for the pending writes and stops the I/O threads.
+ */
+extern void partition_table_stop_io(PartitionTable* table);
+
+/**
+ * Starts the threads that help the readers to decode and hash the partitions
+ * of states (-sc), one per core left by the busy_threads of the exploration.
+ * @param init Called first by each helper with arg (thread local storage of
+ * the states)
+ */
+extern void partition_table_start_decoders(PartitionTable* table, int busy_threads,
+        void (*init)(void*), void* arg);
+
+extern void partition_table_stop_decoders(PartitionTable* table);
+
+/**
+ * Changes the number of spare tables of each size that may be in flight
+ * (memory budget). The tables over the new number are released as soon as
+ * they are written. It cannot exceed the number given to 
+ * partition_table_start_io.
+ */
+extern void partition_table_set_spare_tables(PartitionTable* table, int spare_tables);
+
+/**
+ * Waits until every asynchronous write is on disc.
+ */
+extern void partition_table_sync(PartitionTable* table);
+
+/**
+ * Writes the records and counters of the table to a checkpoint file, after 
+ * the pending writes. No thread may be using the table.
+ * @return the number of bytes written
+ */
+extern ub8 partition_table_checkpoint(PartitionTable* table, FILE* file);
+
+/**
+ * Called once the checkpoint file is safely on disc: releases the space of 
+ * the records that only the previous checkpoint referenced.
+ */
+extern void partition_table_commit(PartitionTable* table);
+
+/**
+ * Restores the records and counters written by partition_table_checkpoint.
+ * The table must have been created with the same geometry while RESUME was 
+ * set, so that the segment file is not truncated.
+ */
+extern void partition_table_restore(PartitionTable* table, FILE* file);
+
 extern void partition_write(PartitionTable* table, unsigned long partition_number, 
                 HashTable* table_data, PartitionType type, ...);
 
+/**
+ * Hands the table over to the I/O threads and replaces it with an empty one
+ * taken from the pool. The table must not be used by the caller anymore.
+ */
+extern void partition_write_async(PartitionTable* table, unsigned long partition_number, 
+                HashTable** table_data, PartitionType type, ...);
+
+/**
+ * Writes a log of collisions of a partition: count states of slot_size bytes,
+ * that are checked against the partition by the collision resolution.
+ * @param sequence_collision_number Write number of the log 
+ * (partition_get_new_write_number_collision)
+ */
+extern void partition_write_log(PartitionTable* table, unsigned long partition_number, 
+                ub1* states, int count, int sequence_collision_number);
+
+/**
+ * Copies the log to a spare buffer written by the I/O threads, the caller may
+ * reuse its states at once. At most 2^COLLISIONTABLESIZE states.
+ */
+extern void partition_write_log_async(PartitionTable* table, unsigned long partition_number, 
+                ub1* states, int count, int sequence_collision_number);
+
+/**
+ * Reads a log of collisions and releases its space. The states are valid 
+ * until the next call of the thread.
+ * @param count Returns the number of states
+ * @return the states, or NULL if the log is not present
+ */
+extern ub1* partition_get_log(PartitionTable* table, unsigned long partition_number, 
+                int sequence_collision_number, int* count);
+
+/**
+ * Size in bytes of the logs of collisions of a partition that are on disc.
+ */
+extern ub8 partition_log_size(PartitionTable* table, unsigned long partition_number);
+
+/**
+ * Asks the kernel to read ahead the records of a partition that will be
+ * needed soon.
+ */
+extern void partition_prefetch(PartitionTable* table, unsigned long partition_number, 
+                PartitionType type);
+
+/**
+ * Tests a state against the summary of a partition of states. Returns 0 only
+ * if the state is not in the partition (1 if the partition has no summary).
+ */
+extern int partition_summary_test(PartitionTable* table, unsigned long partition_number, 
+                void* state);
+
+/**
+ * Adds the states of table_data, that the summary ruled out, to a partition
+ * of states without reading it. They are merged into the table of every
+ * partition_get of the partition until it is written again.
+ */
+extern void partition_append_states(PartitionTable* table, unsigned long partition_number, 
+                HashTable* table_data);
+
+/**
+ * Adds count states, that are not in the partition yet, as a sorted run. The 
+ * runs are merged into one when there are too many of them. The calls on a
+ * partition are serialised by the caller.
+ * @param states References to the states, sorted in place. It must have room
+ * for 2*count references.
+ */
+extern void partition_append_sorted(PartitionTable* table, unsigned long partition_number, 
+                ub1** states, ub8 count);
+
+/**
+ * Looks for a state in the sorted runs of a partition: its summary first, 
+ * then at most one block of each run, the newest first. It must not run 
+ * concurrently with partition_append_sorted on the same partition.
+ * @return 1 if the state is in the partition, otherwise 0
+ */
+extern int partition_search(PartitionTable* table, unsigned long partition_number, 
+                void* state);
+
 extern long partition_get_number(PartitionTable* table);
 
 extern int partition_get_write_number_collision(PartitionTable* table, 
@@ -112,6 +379,8 @@ extern void partition_force_lock(PartitionTable* partition_table, long partition
 extern int partition_check_if_locked(PartitionTable* partition_table, long partition_number);
 
 extern int partition_release(PartitionTable* partition_table, long partition_number);
+
+extern void partition_stats(PartitionTable* partition_table);
 /*extern int partition_collision_insert(PartitionTable *table, StateType state);
 
 
@@ -231,6 +231,22 @@ MultisetType * net_trans_delta(int trans, Net *n) {
     return multi;
 }
 
+NetIndexType * net_trans_delta_places(int trans, const Net *n) {
+    if (n == NULL || trans < 0) {
+        ERRORMACRO("net_trans_delta_places: NULL Args\n");
+    }
+    return (NetIndexType *) vector_sub(n->trans_delta_places, trans);
+}
+
+NetIndexType * net_trans_dependency(int trans, const Net *n) {
+    if (n == NULL || trans < 0) {
+        ERRORMACRO("net_trans_dependency: NULL Args\n");
+    }
+    if (n->trans_dependency == NULL)
+        return NULL;
+    return (NetIndexType *) vector_sub(n->trans_dependency, trans);
+}
+
 /*Net Creation private functions*/
 
 /*Global Temporary var. */
@@ -483,6 +499,120 @@ void _net_marking(DataHolder data) {
     }
 }
 
+NetIndexType * _net_index_new(int size, int with_weight) {
+    errno = 0;
+    NetIndexType *index = (NetIndexType *) malloc(sizeof (NetIndexType));
+    if (index == NULL || errno != 0) {
+        ERRORMACRO("_net_index_new: Impossible to create new index\n");
+    }
+    index->size = size;
+    index->index = (int *) malloc((size + 1) * sizeof (int));
+    index->weight = NULL;
+    if (with_weight)
+        index->weight = (int *) malloc((size + 1) * sizeof (int));
+    if (index->index == NULL || (with_weight && index->weight == NULL)
+            || errno != 0) {
+        ERRORMACRO("_net_index_new: Impossible to create new index\n");
+    }
+    return index;
+}
+
+void * _net_index_copy(void *data) {
+    NetIndexType *index = (NetIndexType *) data;
+    NetIndexType *new = _net_index_new(index->size, index->weight != NULL);
+    memcpy(new->index, index->index, index->size * sizeof (int));
+    if (index->weight)
+        memcpy(new->weight, index->weight, index->size * sizeof (int));
+    return new;
+}
+
+void _net_index_free(void *data) {
+    NetIndexType *index = (NetIndexType *) data;
+    free(index->index);
+    free(index->weight);
+    free(index);
+}
+
+/*Places changed by each transition and dependency index between transitions*/
+void _net_dependency_index() {
+    const int places = _net->place_names->size;
+    const int transitions = _net->trans_names->size;
+    int t, p, i;
+    long total_dependents = 0;
+    _net->trans_delta_places = vector_init(transitions);
+    _net->trans_dependency = vector_init(transitions);
+    //Readers: transitions whose condition tests place p
+    errno = 0;
+    int *readers_size = (int *) calloc(places, sizeof (int));
+    int **readers = (int **) calloc(places, sizeof (int *));
+    int *buffer = (int *) malloc((places + transitions + 1) * sizeof (int));
+    int *mark = (int *) malloc((transitions + 1) * sizeof (int));
+    if (!readers_size || !readers || !buffer || !mark || errno != 0) {
+        ERRORMACRO("_net_dependency_index: Impossible to create the index\n");
+    }
+    for (t = 0; t < transitions; t++) {
+        mark[t] = -1;
+        ConditionType *cc = (ConditionType *) _net->trans_cond->vector[t];
+        while (cc != NULL) {
+            if (cc->condition_type == LL || cc->condition_type == LH) {
+                p = (cc->condition_type == LL) ? cc->condition.ll.place
+                        : cc->condition.lh.place;
+                readers[p] = (int *) realloc(readers[p],
+                        (readers_size[p] + 1) * sizeof (int));
+                readers[p][readers_size[p]++] = t;
+                cc = cc->link;
+            } else
+                cc = NULL;
+        }
+    }
+    for (t = 0; t < transitions; t++) {
+        //Delta places
+        MultisetType *delta = (MultisetType *) _net->trans_delta->vector[t];
+        int size = 0;
+        for (p = 0; p < places; p++) {
+            if (multiset_get(p, delta) != 0)
+                buffer[size++] = p;
+        }
+        NetIndexType *delta_places = _net_index_new(size, 1);
+        for (i = 0; i < size; i++) {
+            delta_places->index[i] = buffer[i];
+            delta_places->weight[i] = multiset_get(buffer[i], delta);
+        }
+        vector_set(_net->trans_delta_places, t, delta_places);
+        //Dependent transitions (mark avoids duplicates)
+        int dependents = 0, j;
+        for (i = 0; i < delta_places->size; i++) {
+            p = delta_places->index[i];
+            for (j = 0; j < readers_size[p]; j++) {
+                if (mark[readers[p][j]] != t) {
+                    mark[readers[p][j]] = t;
+                    dependents++;
+                }
+            }
+        }
+        total_dependents += dependents;
+        NetIndexType *dependency = _net_index_new(dependents, 0);
+        //Ascending order, the same order of marking_enabled_transitions
+        j = 0;
+        for (i = 0; i < transitions && j < dependents; i++) {
+            if (mark[i] == t)
+                dependency->index[j++] = i;
+        }
+        vector_set(_net->trans_dependency, t, dependency);
+    }
+    //Not worth when firings affect more than a quarter of the transitions
+    if (4 * total_dependents > (long) transitions * transitions) {
+        vector_free(_net->trans_dependency, &_net_index_free);
+        _net->trans_dependency = NULL;
+    }
+    for (p = 0; p < places; p++)
+        free(readers[p]);
+    free(readers);
+    free(readers_size);
+    free(buffer);
+    free(mark);
+}
+
 /*Net*/
 Net * parse_net_struct(NetParserType *net) {
     if (net == NULL) {
@@ -510,6 +640,10 @@ Net * parse_net_struct(NetParserType *net) {
     /*Transition Delta*/
     _net->trans_delta = vector_init(vector_size(_net->trans_names));
     avl_app(net->transitions, &_net_delta);
+    /*Delta places and dependency index for incremental enabling*/
+    _net_dependency_index();
+    /*Compiled guard program*/
+    _net->trans_guard = guard_compile(_net->trans_cond, _net->place_names->size);
     if(GRAPHMC==NO_GRAPH){
         /*Reveser Relationship for transitions*/
         _net_cond_reverse(_net->trans_cond, _net->trans_delta);
@@ -556,6 +690,11 @@ void petri_net_free(Net *net) {
     vector_free(net->trans_input, &multiset_free);
     /*Free Deltas*/
     vector_free(net->trans_delta, &multiset_free);
+    /*Free Dependency index*/
+    vector_free(net->trans_delta_places, &_net_index_free);
+    if (net->trans_dependency)
+        vector_free(net->trans_dependency, &_net_index_free);
+    guard_free(net->trans_guard);
     /*Free data handler*/
 
 }
@@ -591,6 +730,15 @@ Net * petri_net_copy(const Net *net) {
     new_net->trans_input = vector_map(net->trans_input, &multiset_copy);
     /*Copy Deltas*/
     new_net->trans_delta = vector_map(net->trans_delta, &multiset_copy_delta);
+    /*Copy Dependency index*/
+    new_net->trans_delta_places = vector_map(net->trans_delta_places,
+                                            &_net_index_copy);
+    new_net->trans_dependency = NULL;
+    if (net->trans_dependency)
+        new_net->trans_dependency = vector_map(net->trans_dependency,
+                                                &_net_index_copy);
+    /*Copy guard program*/
+    new_net->trans_guard = guard_copy(net->trans_guard);
     /*Parse .so file if necessary*/
     /*Independent handlers for each net*/
     if(STATEWITHDATA){
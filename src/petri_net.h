@@ -49,6 +49,7 @@
 #include "dstruct.h"
 #include "state_data.h"
 #include "multiset.h"
+#include "guard.h"
 
 
 
@@ -60,6 +61,16 @@ typedef struct Labels {
     VectorType/*<String>*/  *ln;
 } Labels;
 
+/**
+ * Index attached to a transition: a list of places (with their weights) or a
+ * list of transitions. Entries are sorted in ascending order.
+ */
+typedef struct NetIndexStruct {
+    int size;
+    int *index;
+    int *weight;    //NULL if the index has no weights
+} NetIndexType;
+
 /**
  * Petri Net type definition.
  */
@@ -98,6 +109,21 @@ typedef struct NetStr {
      * Delta (output minus input tokens) for transitions
      */
     VectorType/*<MultisetType>*/                *trans_delta;
+    /**
+     * Places changed by each transition (non null delta) and the delta value
+     */
+    VectorType/*<NetIndexType>*/                *trans_delta_places;
+    /**
+     * Dependency index. For each transition t, the transitions whose firing
+     * condition reads a place changed by t. They are the only ones that may
+     * change their enabling status after firing t. NULL if the transitions
+     * are too dependent for the index to pay off.
+     */
+    VectorType/*<NetIndexType>*/                *trans_dependency;
+    /**
+     * Firing conditions compiled into flat arrays (see guard.h)
+     */
+    GuardProgramType                            *trans_guard;
     /**
      * Initial marking (state)
      */
@@ -261,6 +287,26 @@ extern MultisetType* net_trans_input(int trans, Net *n);
  */
 extern MultisetType* net_trans_delta(int trans, Net *n);
 
+/**
+ * (Getter) Get the places changed by a given transition index, with their
+ * delta values.
+ *
+ * @param trans Transition index
+ * @param n Petri Net Structure
+ * @return Index of places <NetIndexType>
+ */
+extern NetIndexType* net_trans_delta_places(int trans, const Net *n);
+
+/**
+ * (Getter) Get the transitions that depend on a given transition index, that
+ * is to say, the ones that have to be tested again after its firing.
+ *
+ * @param trans Transition index
+ * @param n Petri Net Structure
+ * @return Index of transitions <NetIndexType>, NULL if there is no index
+ */
+extern NetIndexType* net_trans_dependency(int trans, const Net *n);
+
 
 //Not Used
 extern Labels * net_place_labels(Net *n);
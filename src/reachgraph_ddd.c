@@ -0,0 +1,699 @@
+/*
+ * File:    reachgraph_ddd.c
+ * Author:  Rodrigo Tacla Saad
+ * Email:   rodrigo.tacla.saad@gmail.com
+ * Company: LAAS-CNRS / Vertics
+ * Created  on October 18, 2026, 4:05 PM
+ *
+ * LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * DESCRIPTION
+ *
+ * External memory breadth first exploration with delayed duplicate detection.
+ * The exploration is level synchronous. The successors of a level are not
+ * looked up when they are generated: they are hash partitioned into buckets,
+ * sorted in memory and spilled as sorted runs. Once the level is expanded, the
+ * runs of each bucket are merged and the states already visited are removed by
+ * a merge against the sorted segments of the bucket's visited set; what remains
+ * is written as a new segment, which is the frontier of the next level. All the
+ * file accesses are sequential.
+ */
+
+#include "reachgraph_ddd.h"
+
+#include <fcntl.h>
+#include "atomic_interface.h"
+#include "state.h"
+#include "work_stealing.h"
+
+//Bytes per sequential read and write request
+#define DDD_IO_BLOCK (1 << 16)
+//Bytes between two fences of a segment
+#define DDD_FENCE_BLOCK 4096
+//Minimal number of records of the spill buffer of a thread
+#define DDD_MIN_BUFFER_RECORDS (1 << 16)
+//Two segments are merged when the newest holds at least 1/ratio of the other
+#define DDD_SEGMENT_RATIO 2
+
+//A record is the state hash followed by the state
+#define DDD_RECORD_HASH(record) (*((ub8 *) (record)))
+#define DDD_RECORD_STATE(record) ((StateType *) (((ub1 *) (record)) + sizeof(ub8)))
+
+/**
+ * Sequential reader of a file region.
+ */
+typedef struct DDDReaderStruct{
+    int fd;
+    ub8 offset;                             //Next byte to load
+    ub8 end;
+    ub1 *buffer;
+    ub8 capacity;
+    ub8 size;                               //Bytes loaded
+    ub8 pos;                                //Current record
+}DDDReader;
+
+/**
+ * Lookup position in a segment. Lookups of a merge are in increasing order,
+ * so a cursor only moves forward. The loaded window doubles while the cursor
+ * reads contiguous records and falls back to one fence block after a jump.
+ */
+typedef struct DDDCursorStruct{
+    ub1 *buffer;
+    ub8 start;                              //First record loaded
+    ub8 count;                              //Records loaded
+    ub8 pos;                                //Current record
+    ub8 window;                             //Fence blocks per load
+}DDDCursor;
+
+//Shared Data
+static const Net *net_shared;
+static char *_ddd_prefix;
+static DDDBucket *_ddd_buckets;
+static int _ddd_number_of_buckets;
+static int _ddd_state_size;
+static int _ddd_record_size;
+static ub8 _ddd_fence_records;
+static ub8 _ddd_block_records;              //Multiple of the fence records
+static ub8 _ddd_block_size;
+static ub8 _ddd_buffer_records;             //Spill buffer records per bucket
+static volatile ub8 _ddd_next_bucket;
+static volatile int _ddd_done;
+static time_t *global_start_time;
+
+//Level statistics
+static int _ddd_level;
+static volatile ub8 _ddd_level_expanded;
+static volatile ub8 _ddd_level_transitions;
+static volatile ub8 _ddd_level_new;
+static volatile ub8 _ddd_level_bytes_read;
+static volatile ub8 _ddd_level_bytes_written;
+static ub8 _ddd_max_level_states;
+
+//Global statistics
+static ub8 states_processed = 0;
+static ub8 transitions_processed = 0;
+static ub8 bytes_read = 0;
+static ub8 bytes_written = 0;
+
+__thread Net * _ddd_local_net;
+
+
+static void _ddd_pwrite(int fd, const void *data, ub8 size, ub8 offset){
+    const ub1 *p = (const ub1 *) data;
+    _interface_atomic_add_64(&_ddd_level_bytes_written, size);
+    while(size > 0){
+        ssize_t written = pwrite(fd, p, size, offset);
+        if(written <= 0)
+            ERRORMACRO("DDD: Impossible to write to disk");
+        p += written; size -= written; offset += written;
+    }
+}
+
+static void _ddd_pread(int fd, void *data, ub8 size, ub8 offset){
+    ub1 *p = (ub1 *) data;
+    _interface_atomic_add_64(&_ddd_level_bytes_read, size);
+    while(size > 0){
+        ssize_t read = pread(fd, p, size, offset);
+        if(read <= 0)
+            ERRORMACRO("DDD: Impossible to read from disk");
+        p += read; size -= read; offset += read;
+    }
+}
+
+static int _ddd_compare(const void *a, const void *b){
+    ub8 hash_a = DDD_RECORD_HASH(a), hash_b = DDD_RECORD_HASH(b);
+    if(hash_a != hash_b)
+        return (hash_a < hash_b) ? -1 : 1;
+    return memcmp(DDD_RECORD_STATE(a), DDD_RECORD_STATE(b), _ddd_state_size);
+}
+
+static int _ddd_open(int bucket, int seq){
+    char name[strlen(_ddd_prefix) + 32];
+    if(seq < 0)
+        sprintf(name, "%s.bfs.%d.run", _ddd_prefix, bucket);
+    else
+        sprintf(name, "%s.bfs.%d.%d", _ddd_prefix, bucket, seq);
+    errno = 0;
+    int fd = open(name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)
+        ERRORMACRO("DDD: Impossible to create bucket file");
+    return fd;
+}
+
+static void _ddd_unlink(int bucket, int seq){
+    char name[strlen(_ddd_prefix) + 32];
+    if(seq < 0)
+        sprintf(name, "%s.bfs.%d.run", _ddd_prefix, bucket);
+    else
+        sprintf(name, "%s.bfs.%d.%d", _ddd_prefix, bucket, seq);
+    unlink(name);
+}
+
+static void _ddd_reader_init(DDDReader *reader, int fd, ub8 offset, ub8 count,
+        ub1 *buffer, ub8 capacity){
+    reader->fd = fd;
+    reader->offset = offset;
+    reader->end = offset + count*_ddd_record_size;
+    reader->buffer = buffer;
+    //Whole records only
+    reader->capacity = (capacity/_ddd_record_size)*_ddd_record_size;
+    reader->size = 0;
+    reader->pos = 0;
+}
+
+static ub1 *_ddd_reader_current(DDDReader *reader){
+    if(reader->pos >= reader->size){
+        if(reader->offset >= reader->end)
+            return NULL;
+        reader->size = MINMACRO(reader->capacity, reader->end - reader->offset);
+        _ddd_pread(reader->fd, reader->buffer, reader->size, reader->offset);
+        reader->offset += reader->size;
+        reader->pos = 0;
+    }
+    return reader->buffer + reader->pos;
+}
+
+static void _ddd_reader_next(DDDReader *reader){
+    reader->pos += _ddd_record_size;
+}
+
+/**
+ * Segment writer: records are buffered by blocks and the fence of each block
+ * is kept.
+ */
+static void _ddd_segment_create(DDDSegment *segment, int bucket, int seq){
+    segment->fd = _ddd_open(bucket, seq);
+    segment->seq = seq;
+    segment->count = 0;
+    segment->blocks = 0;
+    segment->fence_capacity = 16;
+    segment->fence = (ub8 *) malloc(segment->fence_capacity*sizeof(ub8));
+    if(!segment->fence)
+        ERRORMACRO("DDD: Impossible to create segment");
+}
+
+static void _ddd_segment_flush(DDDSegment *segment, ub1 *block){
+    ub8 first = ((segment->count - 1)/_ddd_block_records)*_ddd_block_records;
+    _ddd_pwrite(segment->fd, block, (segment->count - first)*_ddd_record_size,
+            first*_ddd_record_size);
+}
+
+static void _ddd_segment_append(DDDSegment *segment, ub1 *block, const ub1 *record){
+    ub8 in_block = segment->count % _ddd_block_records;
+    if(in_block == 0 && segment->count)
+        _ddd_segment_flush(segment, block);
+    if(segment->count % _ddd_fence_records == 0){
+        if(segment->blocks == segment->fence_capacity){
+            segment->fence_capacity *= 2;
+            segment->fence = (ub8 *) realloc(segment->fence,
+                    segment->fence_capacity*sizeof(ub8));
+            if(!segment->fence)
+                ERRORMACRO("DDD: Impossible to grow segment fences");
+        }
+        segment->fence[segment->blocks++] = DDD_RECORD_HASH(record);
+    }
+    memcpy(block + in_block*_ddd_record_size, record, _ddd_record_size);
+    segment->count++;
+}
+
+static void _ddd_segment_close(DDDSegment *segment, ub1 *block){
+    if(segment->count)
+        _ddd_segment_flush(segment, block);
+}
+
+static void _ddd_segment_free(DDDSegment *segment, int bucket){
+    close(segment->fd);
+    _ddd_unlink(bucket, segment->seq);
+    free(segment->fence);
+}
+
+static void _ddd_bucket_push_segment(DDDBucket *bucket, DDDSegment *segment){
+    if(bucket->segment_count == bucket->segment_capacity){
+        bucket->segment_capacity = bucket->segment_capacity ? 2*bucket->segment_capacity : 8;
+        bucket->segments = (DDDSegment *) realloc(bucket->segments,
+                bucket->segment_capacity*sizeof(DDDSegment));
+        if(!bucket->segments)
+            ERRORMACRO("DDD: Impossible to grow bucket segments");
+    }
+    bucket->segments[bucket->segment_count++] = *segment;
+}
+
+/**
+ * Search a record in a segment. The fences give the first block that may hold
+ * it, the records before the cursor were already discarded by smaller records.
+ */
+static int _ddd_segment_contains(DDDSegment *segment, DDDCursor *cursor,
+        const ub1 *record){
+    ub8 hash = DDD_RECORD_HASH(record);
+    //Last block starting with a smaller hash
+    sb8 low = 0, high = segment->blocks - 1;
+    while(low < high){
+        sb8 middle = (low + high + 1)/2;
+        if(segment->fence[middle] < hash)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    if(cursor->pos < low*_ddd_fence_records)
+        cursor->pos = low*_ddd_fence_records;
+    for(;;){
+        if(cursor->pos >= segment->count)
+            return 0;
+        if(cursor->pos >= cursor->start + cursor->count){
+            if(cursor->pos == cursor->start + cursor->count && cursor->count)
+                cursor->window = MINMACRO(2*cursor->window,
+                        _ddd_block_records/_ddd_fence_records);
+            else
+                cursor->window = 1;
+            cursor->start = cursor->pos;
+            cursor->count = MINMACRO(cursor->window*_ddd_fence_records,
+                    segment->count - cursor->pos);
+            _ddd_pread(segment->fd, cursor->buffer, cursor->count*_ddd_record_size,
+                    cursor->start*_ddd_record_size);
+        }
+        int cmp = _ddd_compare(cursor->buffer
+                + (cursor->pos - cursor->start)*_ddd_record_size, record);
+        if(cmp >= 0)
+            return cmp == 0;
+        cursor->pos++;
+    }
+}
+
+/**
+ * Merge the two newest segments of a bucket. Segments hold disjoint sets. The
+ * memory holds three blocks: two readers and the output.
+ */
+static void _ddd_segment_merge(DDDBucket *bucket, int bucket_id, ub1 *memory){
+    DDDSegment *older = &bucket->segments[bucket->segment_count - 2];
+    DDDSegment *newer = &bucket->segments[bucket->segment_count - 1];
+    DDDReader reader_older, reader_newer;
+    _ddd_reader_init(&reader_older, older->fd, 0, older->count, memory, _ddd_block_size);
+    _ddd_reader_init(&reader_newer, newer->fd, 0, newer->count, memory + _ddd_block_size,
+            _ddd_block_size);
+    ub1 *block = memory + 2*_ddd_block_size;
+    DDDSegment merged;
+    _ddd_segment_create(&merged, bucket_id, bucket->segment_seq++);
+    ub1 *a = _ddd_reader_current(&reader_older);
+    ub1 *b = _ddd_reader_current(&reader_newer);
+    while(a || b){
+        if(!b || (a && _ddd_compare(a, b) < 0)){
+            _ddd_segment_append(&merged, block, a);
+            _ddd_reader_next(&reader_older);
+            a = _ddd_reader_current(&reader_older);
+        } else {
+            _ddd_segment_append(&merged, block, b);
+            _ddd_reader_next(&reader_newer);
+            b = _ddd_reader_current(&reader_newer);
+        }
+    }
+    _ddd_segment_close(&merged, block);
+    _ddd_segment_free(older, bucket_id);
+    _ddd_segment_free(newer, bucket_id);
+    bucket->segment_count -= 2;
+    _ddd_bucket_push_segment(bucket, &merged);
+}
+
+/**
+ * Sort a spill buffer, drop its duplicates and append it to the bucket's run
+ * file.
+ */
+static void _ddd_spill(int bucket_id, ub1 *buffer, ub8 count){
+    if(count == 0)
+        return;
+    DDDBucket *bucket = &_ddd_buckets[bucket_id];
+    qsort(buffer, count, _ddd_record_size, &_ddd_compare);
+    ub8 i, unique = 1;
+    for(i = 1; i < count; i++){
+        ub1 *record = buffer + i*_ddd_record_size;
+        if(_ddd_compare(record, buffer + (unique - 1)*_ddd_record_size) != 0){
+            if(i != unique)
+                memcpy(buffer + unique*_ddd_record_size, record, _ddd_record_size);
+            unique++;
+        }
+    }
+    ub8 size = unique*_ddd_record_size;
+    ub8 offset = _interface_atomic_add_64(&bucket->run_end, size);
+    _ddd_pwrite(bucket->run_fd, buffer, size, offset);
+    pthread_mutex_lock(&bucket->run_lock);
+    if(bucket->run_count == bucket->run_capacity){
+        bucket->run_capacity = bucket->run_capacity ? 2*bucket->run_capacity : 16;
+        bucket->runs = (DDDRun *) realloc(bucket->runs,
+                bucket->run_capacity*sizeof(DDDRun));
+        if(!bucket->runs)
+            ERRORMACRO("DDD: Impossible to grow bucket runs");
+    }
+    bucket->runs[bucket->run_count].offset = offset;
+    bucket->runs[bucket->run_count].count = unique;
+    bucket->run_count++;
+    pthread_mutex_unlock(&bucket->run_lock);
+}
+
+/**
+ * Expand the frontier of a bucket. Successors go to the spill buffers of the
+ * thread, a full buffer is spilled as a run.
+ */
+static void _ddd_expand(int bucket_id, ub1 **buffers, ub8 *fill, ub1 *io_buffer,
+        StackInteger *enabled_transitions, StateType *temp_state){
+    DDDBucket *bucket = &_ddd_buckets[bucket_id];
+    if(!bucket->frontier)
+        return;
+    DDDSegment *frontier = &bucket->segments[bucket->segment_count - 1];
+    DDDReader reader;
+    _ddd_reader_init(&reader, frontier->fd, 0, frontier->count, io_buffer,
+            _ddd_block_size);
+    ub8 expanded = 0, transitions = 0;
+    ub1 *record;
+    while((record = _ddd_reader_current(&reader))){
+        StateType *state = DDD_RECORD_STATE(record);
+        int size = state_get_descendents(enabled_transitions, state, _ddd_local_net);
+        expanded++;
+        transitions += size;
+        register int i;
+        for (i = size - 1; i >= 0 ; i--) {
+            StateType *state_new = state_fire_temp(stack_int_pop(enabled_transitions),
+                    state, _ddd_local_net, temp_state);
+            ub8 hash = state_hash(state_new, _ddd_local_net);
+            int target = hash % _ddd_number_of_buckets;
+            ub1 *slot = buffers[target] + fill[target]*_ddd_record_size;
+            DDD_RECORD_HASH(slot) = hash;
+            memcpy(DDD_RECORD_STATE(slot), state_new, _ddd_state_size);
+            if(++fill[target] == _ddd_buffer_records){
+                _ddd_spill(target, buffers[target], fill[target]);
+                fill[target] = 0;
+            }
+        }
+        _ddd_reader_next(&reader);
+    }
+    _interface_atomic_add_64(&_ddd_level_expanded, expanded);
+    _interface_atomic_add_64(&_ddd_level_transitions, transitions);
+}
+
+static void _ddd_heap_down(int *heap, int size, int i, DDDReader *readers){
+    for(;;){
+        int smallest = i, l = 2*i + 1, r = 2*i + 2;
+        if(l < size && _ddd_compare(_ddd_reader_current(&readers[heap[l]]),
+                _ddd_reader_current(&readers[heap[smallest]])) < 0)
+            smallest = l;
+        if(r < size && _ddd_compare(_ddd_reader_current(&readers[heap[r]]),
+                _ddd_reader_current(&readers[heap[smallest]])) < 0)
+            smallest = r;
+        if(smallest == i)
+            return;
+        int t = heap[i]; heap[i] = heap[smallest]; heap[smallest] = t;
+        i = smallest;
+    }
+}
+
+/**
+ * Delayed duplicate detection of a bucket: compact its visited segments, merge
+ * its runs and keep the states that no segment holds. They are written as the
+ * new frontier segment.
+ */
+static void _ddd_merge(int bucket_id, ub1 *memory, ub8 memory_size, ub1 *io_buffer){
+    DDDBucket *bucket = &_ddd_buckets[bucket_id];
+    //The frontier was expanded, it can be merged with the older segments
+    bucket->frontier = 0;
+    while(bucket->segment_count >= 2
+            && bucket->segments[bucket->segment_count - 1].count*DDD_SEGMENT_RATIO
+            >= bucket->segments[bucket->segment_count - 2].count)
+        _ddd_segment_merge(bucket, bucket_id, io_buffer);
+    if(bucket->run_count == 0)
+        return;
+    //The spill memory is shared by the run readers
+    int runs = bucket->run_count, segments = bucket->segment_count, i;
+    ub8 run_slice = memory_size/runs;
+    if(run_slice < (ub8) _ddd_record_size)
+        ERRORMACRO("DDD: Not enough memory to merge the runs, increase -bls");
+    //Segment cursors, output block and last record
+    ub1 *merge_memory = (ub1 *) malloc((segments + 1)*_ddd_block_size + _ddd_record_size);
+    if(!merge_memory)
+        ERRORMACRO("DDD: Impossible to create segment cursors");
+    ub1 *block = merge_memory + segments*_ddd_block_size;
+    ub1 *last = block + _ddd_block_size;
+    DDDCursor cursors[segments + 1];
+    for(i = 0; i < segments; i++){
+        cursors[i].buffer = merge_memory + i*_ddd_block_size;
+        cursors[i].start = 0;
+        cursors[i].count = 0;
+        cursors[i].pos = 0;
+        cursors[i].window = 1;
+    }
+    DDDReader *readers = (DDDReader *) malloc(runs*sizeof(DDDReader));
+    int *heap = (int *) malloc(runs*sizeof(int));
+    if(!readers || !heap)
+        ERRORMACRO("DDD: Impossible to create run readers");
+    int heap_size = 0;
+    for(i = 0; i < runs; i++){
+        _ddd_reader_init(&readers[i], bucket->run_fd, bucket->runs[i].offset,
+                bucket->runs[i].count, memory + i*run_slice, run_slice);
+        if(_ddd_reader_current(&readers[i]))
+            heap[heap_size++] = i;
+    }
+    for(i = heap_size/2 - 1; i >= 0; i--)
+        _ddd_heap_down(heap, heap_size, i, readers);
+    DDDSegment frontier;
+    _ddd_segment_create(&frontier, bucket_id, bucket->segment_seq++);
+    int has_last = 0;
+    while(heap_size > 0){
+        DDDReader *reader = &readers[heap[0]];
+        ub1 *record = _ddd_reader_current(reader);
+        if(!has_last || _ddd_compare(record, last) != 0){
+            memcpy(last, record, _ddd_record_size);
+            has_last = 1;
+            int visited = 0, s;
+            for(s = segments - 1; s >= 0 && !visited; s--)
+                visited = _ddd_segment_contains(&bucket->segments[s], &cursors[s], last);
+            if(!visited)
+                _ddd_segment_append(&frontier, block, last);
+        }
+        _ddd_reader_next(reader);
+        if(!_ddd_reader_current(reader))
+            heap[0] = heap[--heap_size];
+        _ddd_heap_down(heap, heap_size, 0, readers);
+    }
+    free(readers);
+    free(heap);
+    _ddd_segment_close(&frontier, block);
+    free(merge_memory);
+    if(frontier.count){
+        _interface_atomic_add_64(&_ddd_level_new, frontier.count);
+        _ddd_bucket_push_segment(bucket, &frontier);
+        bucket->frontier = 1;
+    } else
+        _ddd_segment_free(&frontier, bucket_id);
+    //Runs of the next level
+    bucket->run_count = 0;
+    bucket->run_end = 0;
+    if(ftruncate(bucket->run_fd, 0) != 0)
+        ERRORMACRO("DDD: Impossible to truncate run file");
+}
+
+static void _ddd_level_report(){
+    states_processed += _ddd_level_new;
+    transitions_processed += _ddd_level_transitions;
+    bytes_read += _ddd_level_bytes_read;
+    bytes_written += _ddd_level_bytes_written;
+    if(_ddd_level_new > _ddd_max_level_states)
+        _ddd_max_level_states = _ddd_level_new;
+    if(STATS == STAT_COMPLETE){
+        fprintf(stdout, " Level %d: %llu expanded, %llu successors, %llu new,"
+                " %.2f MB written, %.2f MB read\n", _ddd_level,
+                (unsigned long long) _ddd_level_expanded,
+                (unsigned long long) _ddd_level_transitions,
+                (unsigned long long) _ddd_level_new,
+                _ddd_level_bytes_written/1048576.0, _ddd_level_bytes_read/1048576.0);
+        fflush(stdout);
+    }
+    _ddd_level_expanded = 0;
+    _ddd_level_transitions = 0;
+    _ddd_level_new = 0;
+    _ddd_level_bytes_read = 0;
+    _ddd_level_bytes_written = 0;
+}
+
+static void * _reachgraph_ddd(void * args) {
+    ParallelThreadArgsDDD *thread_arg = (ParallelThreadArgsDDD *) args;
+    int id = thread_arg->id;
+    //Create a local copy of net structure
+    _ddd_local_net = petri_net_copy(thread_arg->net);
+    state_set_tls(id, _ddd_local_net);
+
+    StateType * temp_state = state_empty(_ddd_local_net);
+    StackInteger *enabled_transitions = stack_int_init();
+    //Spill buffers, reused by the merges once they are spilled
+    ub8 memory_size = _ddd_buffer_records*_ddd_number_of_buckets*_ddd_record_size;
+    ub1 *memory = (ub1 *) calloc(1, memory_size);
+    ub1 **buffers = (ub1 **) malloc(_ddd_number_of_buckets*sizeof(ub1 *));
+    ub8 *fill = (ub8 *) calloc(_ddd_number_of_buckets, sizeof(ub8));
+    //Frontier reader and segment compaction (two readers and an output block)
+    ub1 *io_buffer = (ub1 *) malloc(3*_ddd_block_size);
+    if(!memory || !buffers || !fill || !io_buffer)
+        ERRORMACRO("DDD: Impossible to allocate the spill buffers");
+    int i;
+    for(i = 0; i < _ddd_number_of_buckets; i++)
+        buffers[i] = memory + i*_ddd_buffer_records*_ddd_record_size;
+
+    if(work_stealing_barrier(id)){
+        //Level 0: the initial state
+        StateType *state = state_initial(_ddd_local_net);
+        ub8 hash = state_hash(state, _ddd_local_net);
+        int bucket_id = hash % _ddd_number_of_buckets;
+        DDD_RECORD_HASH(memory) = hash;
+        memcpy(DDD_RECORD_STATE(memory), state, _ddd_state_size);
+        DDDSegment segment;
+        _ddd_segment_create(&segment, bucket_id, _ddd_buckets[bucket_id].segment_seq++);
+        _ddd_segment_append(&segment, io_buffer, memory);
+        _ddd_segment_close(&segment, io_buffer);
+        _ddd_bucket_push_segment(&_ddd_buckets[bucket_id], &segment);
+        _ddd_buckets[bucket_id].frontier = 1;
+        _ddd_level_new = 1;
+        _ddd_level_report();
+        memset(memory, 0, _ddd_record_size);
+        work_stealing_broadcast();
+    }
+
+    while(!_ddd_done){
+        //Expand the frontier of the level
+        int bucket_id;
+        while((bucket_id = _interface_atomic_add_64(&_ddd_next_bucket, 1))
+                < _ddd_number_of_buckets)
+            _ddd_expand(bucket_id, buffers, fill, io_buffer,
+                    enabled_transitions, temp_state);
+        for(i = 0; i < _ddd_number_of_buckets; i++){
+            _ddd_spill(i, buffers[i], fill[i]);
+            fill[i] = 0;
+        }
+        if(work_stealing_barrier(id)){
+            _ddd_next_bucket = 0;
+            work_stealing_broadcast();
+        }
+        //Remove the duplicates
+        while((bucket_id = _interface_atomic_add_64(&_ddd_next_bucket, 1))
+                < _ddd_number_of_buckets)
+            _ddd_merge(bucket_id, memory, memory_size, io_buffer);
+        if(work_stealing_barrier(id)){
+            _ddd_done = (_ddd_level_new == 0);
+            _ddd_level++;
+            _ddd_level_report();
+            _ddd_next_bucket = 0;
+            work_stealing_broadcast();
+        }
+    }
+
+    free(memory);
+    free(buffers);
+    free(fill);
+    free(io_buffer);
+    return NULL;
+}
+
+//Print statistics function
+static void _print_statistics(ParallelStatistics type){
+    time_t end;
+    time(&end);
+    double total_time = difftime(end, *global_start_time);
+    fprintf(stdout, "\n\n Time: %fs\n", total_time);
+    fprintf(stdout, "\n\n##Total##\n #States:%llu ", states_processed);
+    fprintf(stdout, "\n #Transitions:%llu ", transitions_processed);
+    if(type == STAT_COMPLETE){
+        fprintf(stdout, "\n#Levels: %d (largest %llu states)", _ddd_level - 1,
+                _ddd_max_level_states);
+        fprintf(stdout, "\n#Buckets: %d (spill buffer of %llu states per bucket and thread)",
+                _ddd_number_of_buckets, _ddd_buffer_records);
+        fprintf(stdout, "\n#Disk: %.2f MB written, %.2f MB read (%.1f bytes per state)",
+                bytes_written/1048576.0, bytes_read/1048576.0,
+                states_processed ? (double) bytes_written/states_processed : 0);
+        fprintf(stdout, "\n\nTotal Time: %fs\n", total_time);
+    }
+    fprintf(stdout, "\n");
+}
+
+//Start the exploration
+void reachgraph_ddd_start(const Net *net, const int dfirst, const ModeEnum mode) {
+
+    fprintf(stdout, "\n");
+
+    net_shared = net;
+    time_t start;
+    global_start_time = &start;
+    time(&start);
+
+    state_set_dictionary(DICTIONARY, DICTIONARYSTATEDATA, net);
+    _ddd_state_size = state_size();
+    //Records are aligned to the hash word
+    _ddd_record_size = (sizeof(ub8) + _ddd_state_size + sizeof(ub8) - 1)
+            & ~(sizeof(ub8) - 1);
+    _ddd_fence_records = MAXMACRO(1, DDD_FENCE_BLOCK/_ddd_record_size);
+    _ddd_block_records = _ddd_fence_records
+            *MAXMACRO(1, DDD_IO_BLOCK/(_ddd_fence_records*_ddd_record_size));
+    _ddd_block_size = _ddd_block_records*_ddd_record_size;
+    _ddd_prefix = net->name;
+
+    //Buckets and spill buffers: the buffers of all threads hold 2^HASHSIZE states
+    _ddd_number_of_buckets = NUMBEROFPARTITIONS;
+    ub8 thread_records = pow(2, HASHSIZE)/NUMBEROFTHREADS;
+    if(thread_records < DDD_MIN_BUFFER_RECORDS)
+        thread_records = DDD_MIN_BUFFER_RECORDS;
+    _ddd_buffer_records = MAXMACRO(thread_records/_ddd_number_of_buckets, 1);
+    _ddd_buckets = (DDDBucket *) calloc(_ddd_number_of_buckets, sizeof(DDDBucket));
+    if(!_ddd_buckets)
+        ERRORMACRO("DDD: Impossible to create buckets");
+    int i;
+    for(i = 0; i < _ddd_number_of_buckets; i++){
+        _ddd_buckets[i].run_fd = _ddd_open(i, -1);
+        pthread_mutex_init(&_ddd_buckets[i].run_lock, NULL);
+    }
+    _ddd_level = 0;
+    _ddd_done = 0;
+    _ddd_next_bucket = 0;
+
+    //Start pthread barriers
+    work_stealing_config(NUMBEROFTHREADS);
+
+    ParallelThreadArgsDDD thread_args[NUMBEROFTHREADS];
+    pthread_t thread_id[MAX_NUMBER_OF_THREADS];
+    for (i = 0; i < NUMBEROFTHREADS; i++) {
+        thread_args[i].net = net;
+        thread_args[i].id = i;
+        pthread_create(&thread_id[i], NULL, &_reachgraph_ddd, &thread_args[i]);
+    }
+    for (i = 0; i < NUMBEROFTHREADS; i++)
+        pthread_join(thread_id[i], NULL);
+
+    //Remove the bucket files
+    for(i = 0; i < _ddd_number_of_buckets; i++){
+        DDDBucket *bucket = &_ddd_buckets[i];
+        int s;
+        for(s = 0; s < bucket->segment_count; s++)
+            _ddd_segment_free(&bucket->segments[s], i);
+        close(bucket->run_fd);
+        _ddd_unlink(i, -1);
+        free(bucket->segments);
+        free(bucket->runs);
+    }
+    free(_ddd_buckets);
+
+    _print_statistics(STATS);
+}
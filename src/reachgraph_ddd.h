@@ -0,0 +1,114 @@
+/**
+ * @file        reachgraph_ddd.h
+ * @author      Rodrigo Tacla Saad
+ * @email       rodrigo.tacla.saad@gmail.com
+ * @company:    LAAS-CNRS / Vertics
+ * @created     on October 18, 2026, 4:05 PM
+ *
+ * @section LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * External memory breadth first exploration with delayed duplicate detection.
+ * The exploration is level synchronous. The successors of a level are not
+ * looked up when they are generated: they are hash partitioned into buckets,
+ * sorted in memory and spilled as sorted runs. Once the level is expanded, the
+ * runs of each bucket are merged and the states already visited are removed by
+ * a merge against the sorted segments of the bucket's visited set; what remains
+ * is written as a new segment, which is the frontier of the next level. All the
+ * file accesses are sequential.
+ *
+ */
+
+#ifndef REACHGRAPH_DDD_H
+#define	REACHGRAPH_DDD_H
+
+#include "reset_define_includes.h"
+#define ASSERTLIB
+#define ERRORLIB
+#define MATHLIB
+#define STDIOLIB
+#define STDLIB
+#define STRINGLIB
+#define UNISTD
+#define PTHREADLIB
+#include "standard_includes.h"
+
+#include "stack.h"
+#include "petri_net.h"
+#include "flags.h"
+
+/**
+ * Region of a bucket's run file holding one sorted run.
+ */
+typedef struct DDDRunStruct{
+    ub8 offset;                             //Offset in bytes
+    ub8 count;                              //Number of records
+}DDDRun;
+
+/**
+ * Sorted file of visited states. The hash of the first record of each block
+ * (fence) is kept in memory, the lookups skip the blocks that cannot hold
+ * the searched record.
+ */
+typedef struct DDDSegmentStruct{
+    int fd;
+    int seq;                                //File name sequence
+    ub8 count;                              //Number of records
+    ub8 *fence;                             //First hash of each block
+    ub8 blocks;
+    ub8 fence_capacity;
+}DDDSegment;
+
+/**
+ * Bucket of the hash partition: the runs spilled during the current level and
+ * the segments of visited states, from the oldest (largest) to the newest.
+ */
+typedef struct DDDBucketStruct{
+    int run_fd;
+    volatile ub8 run_end;                   //Next free byte of the run file
+    pthread_mutex_t run_lock;
+    DDDRun *runs;
+    int run_count;
+    int run_capacity;
+    DDDSegment *segments;
+    int segment_count;
+    int segment_capacity;
+    int segment_seq;
+    int frontier;                           //Last segment is the frontier
+}DDDBucket;
+
+/**
+ * Argument type for thread functions.
+ */
+typedef struct ParallelThreadArgsDDDStruct {
+    const Net *net;
+    int id;
+} ParallelThreadArgsDDD;
+
+//Initiates the breadth first exploration with delayed duplicate detection
+extern void reachgraph_ddd_start(const Net *net, const int dfirst, const ModeEnum mode);
+
+#endif	/* REACHGRAPH_DDD_H */
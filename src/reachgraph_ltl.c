@@ -0,0 +1,431 @@
+/*
+ * File:    reachgraph_ltl.c
+ * Author:  Rodrigo Tacla Saad
+ * Email:   rodrigo.tacla.saad@gmail.com
+ * Company: LAAS-CNRS / Vertics
+ * Created  on October 18, 2026, 11:55 PM
+ *
+ * LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * DESCRIPTION
+ *
+ * On-the-fly LTL model checking with a parallel nested depth first search.
+ * See reachgraph_ltl.h
+ */
+
+#include "reachgraph_ltl.h"
+
+#include <sched.h>
+#include "atomic_interface.h"
+#include "state.h"
+#include "checker.h"
+#include "ltl.h"
+#include "hash_table_lockfree.h"
+
+//Initial sizes of the stacks of a thread
+#define LTL_FRAMES 1024
+#define LTL_SUCCESSORS 4096
+
+#define LTL_THREAD(id) (((ub8) 1) << (id))
+
+typedef enum LtlResultEnum {LTL_RUNNING, LTL_NO_LASSO, LTL_LASSO} LtlResult;
+
+//Product state, followed by the state of the net
+typedef struct LtlProductStruct{
+    ub4 automaton;                      //State of the Buchi automaton
+    volatile ub1 blue;                  //Explored by a blue search
+    volatile ub1 red;                   //Not on an accepting cycle
+    volatile ub8 cyan;                  //On the blue stack of the threads
+    volatile ub8 pink;                  //Met by the red search of the threads
+}LtlProduct;
+
+#define LTL_PRODUCT_STATE(product) \
+        ((StateType *) (((ub1 *) (product)) + sizeof(LtlProduct)))
+
+//Product state being searched, its successors are kept on a vector
+typedef struct LtlFrameStruct{
+    LtlProduct *product;
+    ub8 first;                          //First successor on the vector
+    ub8 size;
+    ub8 next;                           //Next successor to visit
+}LtlFrame;
+
+//Search of a thread: the blue stack, then the red stack on top of it
+typedef struct LtlSearchStruct{
+    int id;
+    const Net *net;
+    LtlFrame *frames;
+    ub8 frames_size;
+    ub8 frames_capacity;
+    LtlProduct **successors;
+    ub8 successors_size;
+    ub8 successors_capacity;
+    LtlProduct **red;                   //States of the red search
+    ub8 red_size;
+    ub8 red_capacity;
+    StateType **states;                 //Successors of a state of the net
+    int states_capacity;
+    StackInteger *enabled;
+    LtlProduct *key;                    //Product state to search
+    //For stats
+    ub8 inserted;
+    ub8 transitions;
+    ub8 depth;
+}LtlSearch;
+
+static const Net *ltl_net = NULL;
+static LtlAutomaton *ltl_automaton = NULL;
+static HashTableLockFree *ltl_table = NULL;
+static int ltl_element_size = 0;
+static volatile int ltl_result = LTL_RUNNING;
+//Thread that found the accepting cycle and the length of its stack
+static int ltl_lasso_thread = -1;
+static ub8 ltl_lasso_depth = 0;
+
+static void _ltl_product_hash(void *element, HashWide *wide){
+    const LtlProduct *product = (const LtlProduct *) element;
+    state_hash_wide(LTL_PRODUCT_STATE(product), wide);
+    //Mix the state of the automaton
+    const ub8 mix = ((ub8) product->automaton + 1)*0x9E3779B97F4A7C15ULL;
+    wide->h1 ^= mix;
+    wide->h2 = (wide->h2 ^ mix) | 1;
+}
+
+static int _ltl_product_compare(void *element_table, void *element){
+    const LtlProduct *old = (const LtlProduct *) element_table;
+    const LtlProduct *new = (const LtlProduct *) element;
+    return old->automaton==new->automaton
+            && state_compare(LTL_PRODUCT_STATE(old), LTL_PRODUCT_STATE(new), ltl_net)==0;
+}
+
+static inline int _ltl_accepting(const LtlProduct *product){
+    return ltl_automaton->states[product->automaton].accepting;
+}
+
+//Tests the label of a state of the automaton on a state of the net
+static int _ltl_label(const LtlAutomatonState *automaton, StateType *state,
+        const Net *net, int number_of_successors){
+    int i;
+    for(i=0; i < automaton->label_size; i++)
+        if((checker_evaluate(automaton->label[i].exp, state, net,
+                number_of_successors)!=0)==automaton->label[i].negated)
+            return 0;
+    return 1;
+}
+
+//Number of successors of a state, for the dead property
+static int _ltl_number_of_successors(LtlSearch *search, StateType *state){
+    if(!ltl_automaton->with_dead)
+        return -1;
+    const int size = state_get_descendents(search->enabled, state, search->net);
+    stack_int_reset(search->enabled);
+    return size;
+}
+
+static LtlProduct * _ltl_find_or_put(LtlSearch *search, StateType *state,
+        int automaton){
+    LtlProduct *key = search->key;
+    key->automaton = automaton;
+    state_copy_to(state, LTL_PRODUCT_STATE(key), search->net);
+    void *stored = NULL;
+    if(hash_table_lockfree_find_or_put(key, ltl_table, search->id, &stored))
+        search->inserted++;
+    return (LtlProduct *) stored;
+}
+
+//Pushes the successors of a product state onto the vector
+static ub8 _ltl_successors(LtlSearch *search, LtlProduct *product){
+    StateType *state = LTL_PRODUCT_STATE(product);
+    const Net *net = search->net;
+    int size = state_get_descendents(search->enabled, state, net);
+    if(search->states_capacity < size || !search->states_capacity){
+        search->states = (StateType **) realloc(search->states,
+                (size + 1)*sizeof(StateType *));
+        if(search->states==NULL)
+            ERRORMACRO(" LTL: Impossible to allocate the successors\n");
+        while(search->states_capacity < size + 1)
+            search->states[search->states_capacity++] = state_empty(net);
+    }
+    int i, j;
+    if(!size){
+        //Deadlocks stutter
+        state_copy_to(state, search->states[0], net);
+        size = 1;
+    } else
+        for(i=0; i < size; i++)
+            state_fire_temp(stack_int_pop(search->enabled), state, net,
+                    search->states[i]);
+    const LtlAutomatonState *from = &ltl_automaton->states[product->automaton];
+    const ub8 first = search->successors_size;
+    for(i=0; i < size; i++){
+        //Threads visit the successors in different orders
+        StateType *next = search->states[(i + search->id) % size];
+        const int number_of_successors = _ltl_number_of_successors(search, next);
+        for(j=0; j < from->successors_size; j++){
+            const int automaton = from->successors[j];
+            if(!_ltl_label(&ltl_automaton->states[automaton], next, net,
+                    number_of_successors))
+                continue;
+            if(search->successors_size==search->successors_capacity){
+                search->successors_capacity *= 2;
+                search->successors = (LtlProduct **) realloc(search->successors,
+                        search->successors_capacity*sizeof(LtlProduct *));
+                if(search->successors==NULL)
+                    ERRORMACRO(" LTL: Impossible to allocate the successors\n");
+            }
+            search->successors[search->successors_size++] =
+                    _ltl_find_or_put(search, next, automaton);
+        }
+    }
+    search->transitions += search->successors_size - first;
+    return search->successors_size - first;
+}
+
+static void _ltl_push(LtlSearch *search, LtlProduct *product){
+    if(search->frames_size==search->frames_capacity){
+        search->frames_capacity *= 2;
+        search->frames = (LtlFrame *) realloc(search->frames,
+                search->frames_capacity*sizeof(LtlFrame));
+        if(search->frames==NULL)
+            ERRORMACRO(" LTL: Impossible to extend the stack\n");
+    }
+    LtlFrame *frame = &search->frames[search->frames_size++];
+    frame->product = product;
+    frame->first = search->successors_size;
+    frame->next = 0;
+    frame->size = _ltl_successors(search, product);
+    if(search->frames_size > search->depth)
+        search->depth = search->frames_size;
+}
+
+static void _ltl_pop(LtlSearch *search){
+    search->successors_size = search->frames[--search->frames_size].first;
+}
+
+//Red search from an accepting state, returns 1 if it closes a cycle
+static int _ltl_red(LtlSearch *search, LtlProduct *seed){
+    const ub8 me = LTL_THREAD(search->id);
+    const ub8 base = search->frames_size;
+    search->red_size = 0;
+    LtlProduct *product = seed;
+    do {
+        //Visit
+        _interface_atomic_or_64(&product->pink, me);
+        if(search->red_size==search->red_capacity){
+            search->red_capacity *= 2;
+            search->red = (LtlProduct **) realloc(search->red,
+                    search->red_capacity*sizeof(LtlProduct *));
+            if(search->red==NULL)
+                ERRORMACRO(" LTL: Impossible to extend the red search\n");
+        }
+        search->red[search->red_size++] = product;
+        _ltl_push(search, product);
+        product = NULL;
+        while(!product && search->frames_size > base){
+            if(ltl_result!=LTL_RUNNING)
+                return 0;
+            LtlFrame *frame = &search->frames[search->frames_size - 1];
+            if(frame->next==frame->size){
+                _ltl_pop(search);
+                continue;
+            }
+            LtlProduct *next = search->successors[frame->first + frame->next++];
+            if(next->cyan & me)
+                //Back to the blue stack
+                return 1;
+            if(!(next->pink & me) && !next->red)
+                product = next;
+        }
+    } while(product);
+    //The accepting states met are seeds of other red searches: wait for them
+    ub8 i;
+    for(i=0; i < search->red_size; i++){
+        LtlProduct *met = search->red[i];
+        if(met!=seed && _ltl_accepting(met))
+            while(!met->red){
+                if(ltl_result!=LTL_RUNNING)
+                    return 0;
+                sched_yield();
+            }
+    }
+    for(i=0; i < search->red_size; i++)
+        search->red[i]->red = 1;
+    return 0;
+}
+
+//Blue search from a product state, returns 1 if it finds an accepting cycle
+static int _ltl_blue(LtlSearch *search, LtlProduct *root){
+    const ub8 me = LTL_THREAD(search->id);
+    _interface_atomic_or_64(&root->cyan, me);
+    _ltl_push(search, root);
+    while(search->frames_size){
+        if(ltl_result!=LTL_RUNNING)
+            return 0;
+        LtlFrame *frame = &search->frames[search->frames_size - 1];
+        LtlProduct *product = frame->product;
+        if(frame->next < frame->size){
+            LtlProduct *next = search->successors[frame->first + frame->next++];
+            if(next->cyan & me){
+                //Cycle on the stack
+                if(_ltl_accepting(product) || _ltl_accepting(next))
+                    return 1;
+            } else if(!next->blue){
+                _interface_atomic_or_64(&next->cyan, me);
+                _ltl_push(search, next);
+            }
+            continue;
+        }
+        //Backtrack
+        product->blue = 1;
+        if(_ltl_accepting(product) && _ltl_red(search, product))
+            return 1;
+        _interface_atomic_and_64(&product->cyan, ~me);
+        _ltl_pop(search);
+    }
+    return 0;
+}
+
+static void * _reachgraph_ltl(void * args){
+    ParallelThreadArgsLTL *thread_arg = (ParallelThreadArgsLTL *) args;
+    const int id = thread_arg->id;
+    const Net *net = petri_net_copy(thread_arg->net);
+    state_set_tls(id, net);
+
+    LtlSearch search;
+    memset(&search, 0, sizeof(LtlSearch));
+    search.id = id;
+    search.net = net;
+    search.frames_capacity = LTL_FRAMES;
+    search.frames = (LtlFrame *) malloc(LTL_FRAMES*sizeof(LtlFrame));
+    search.successors_capacity = LTL_SUCCESSORS;
+    search.successors = (LtlProduct **) malloc(LTL_SUCCESSORS*sizeof(LtlProduct *));
+    search.red_capacity = LTL_FRAMES;
+    search.red = (LtlProduct **) malloc(LTL_FRAMES*sizeof(LtlProduct *));
+    search.key = (LtlProduct *) calloc(1, ltl_element_size);
+    search.enabled = stack_int_init();
+    if(!search.frames || !search.successors || !search.red || !search.key)
+        ERRORMACRO(" LTL: Impossible to create the search\n");
+
+    //Initial states of the product
+    StateType *initial = state_initial(net);
+    const int number_of_successors = _ltl_number_of_successors(&search, initial);
+    int i, found = 0;
+    for(i=0; i < ltl_automaton->initial_size && !found
+            && ltl_result==LTL_RUNNING; i++){
+        const int automaton =
+                ltl_automaton->initial[(i + id) % ltl_automaton->initial_size];
+        if(!_ltl_label(&ltl_automaton->states[automaton], initial, net,
+                number_of_successors))
+            continue;
+        LtlProduct *root = _ltl_find_or_put(&search, initial, automaton);
+        if(!root->blue)
+            found = _ltl_blue(&search, root);
+    }
+    if(found){
+        if(_interface_atomic_cas_32(&ltl_result, LTL_RUNNING, LTL_LASSO)==LTL_RUNNING){
+            ltl_lasso_thread = id;
+            ltl_lasso_depth = search.frames_size;
+        }
+    } else
+        //Stopped by another thread or the search is complete
+        _interface_atomic_cas_32(&ltl_result, LTL_RUNNING, LTL_NO_LASSO);
+
+    thread_arg->states = search.inserted;
+    thread_arg->transitions = search.transitions;
+    thread_arg->depth = search.depth;
+    for(i=0; i < search.states_capacity; i++)
+        state_free(search.states[i]);
+    state_free(initial);
+    free(search.states);
+    free(search.frames);
+    free(search.successors);
+    free(search.red);
+    free(search.key);
+    stack_int_delete_all(search.enabled);
+    return NULL;
+}
+
+void reachgraph_ltl_start(const Net *net){
+    time_t start, end;
+    time(&start);
+    if(NUMBEROFTHREADS > LTL_MAX_THREADS)
+        ERRORMACRO(" LTL: 64 threads at most\n");
+    ltl_net = net;
+    //The product keeps the states
+    state_set_dictionary(NO_DICTIONARY, DICTIONARYSTATEDATA, net);
+    ltl_automaton = ltl_automaton_create((Formula *) FORMULA_MC);
+    if(PRINTER==TXT || PRINTER==NON_VERBOSE)
+        ltl_automaton_print(ltl_automaton);
+    ltl_element_size = (sizeof(LtlProduct) + state_size() + sizeof(ub8) - 1)
+            & ~(sizeof(ub8) - 1);
+    ltl_table = hash_table_lockfree_create(GLOBALTABLESIZE, ltl_element_size,
+            &_ltl_product_hash, &_ltl_product_compare);
+    ltl_result = LTL_RUNNING;
+
+    ParallelThreadArgsLTL thread_args[NUMBEROFTHREADS];
+    pthread_t thread_id[MAX_NUMBER_OF_THREADS];
+    int i;
+    for (i = 0; i < NUMBEROFTHREADS; i++) {
+        memset(&thread_args[i], 0, sizeof(ParallelThreadArgsLTL));
+        thread_args[i].net = net;
+        thread_args[i].id = i;
+        pthread_create(&thread_id[i], NULL, &_reachgraph_ltl, &thread_args[i]);
+    }
+    for (i = 0; i < NUMBEROFTHREADS; i++)
+        pthread_join(thread_id[i], NULL);
+    time(&end);
+
+    //A lasso is a counterexample of A f, or a witness of E f
+    int result = ltl_automaton->lasso_result;
+    if(ltl_result==LTL_LASSO)
+        fprintf(stdout, "\nAccepting cycle found by thread %d (stack of %llu states)",
+                ltl_lasso_thread, ltl_lasso_depth);
+    else
+        result = !result;
+    if(result)
+        fprintf(stdout, "\nFormula %s is TRUE\n", CTLFORMULA);
+    else
+        fprintf(stdout, "\nFormula %s is FALSE\n", CTLFORMULA);
+
+    ub8 states = 0, transitions = 0, depth = 0;
+    for (i = 0; i < NUMBEROFTHREADS; i++) {
+        states += thread_args[i].states;
+        transitions += thread_args[i].transitions;
+        if(thread_args[i].depth > depth)
+            depth = thread_args[i].depth;
+    }
+    fprintf(stdout, "\n\n Time: %fs\n", difftime(end, start));
+    fprintf(stdout, "\n\n##Total##\n #States:%llu ", states);
+    fprintf(stdout, "\n #Transitions:%llu ", transitions);
+    if(STATS == STAT_COMPLETE){
+        fprintf(stdout, "\n#Product states: %d bytes", ltl_element_size);
+        fprintf(stdout, "\n#Deepest stack: %llu states", depth);
+        hash_table_lockfree_print(ltl_table, NUMBEROFTHREADS);
+    }
+    fprintf(stdout, "\n");
+
+    hash_table_lockfree_free(ltl_table);
+    ltl_automaton_free(ltl_automaton);
+}
@@ -0,0 +1,81 @@
+/**
+ * @file        reachgraph_ltl.h
+ * @author      Rodrigo Tacla Saad
+ * @email       rodrigo.tacla.saad@gmail.com
+ * @company:    LAAS-CNRS / Vertics
+ * @created     on October 18, 2026, 11:55 PM
+ *
+ * @section LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * On-the-fly LTL model checking with a parallel nested depth first search
+ * (CNDFS, Evangelista, Laarman, Petrucci and van de Pol). The product of the
+ * state space with the Buchi automaton of the formula (see ltl.h) is built
+ * while it is searched for an accepting cycle, deadlocks stutter. All threads
+ * run the nested search from the initial states, with their own order of the
+ * successors, and share the product states in the lock-free table: a state
+ * explored by a blue search is not visited again by the blue searches of the
+ * others, and a state of a red search that completed is not on an accepting 
+ * cycle. The first thread that finds an accepting cycle, or that completes its
+ * search, stops the others.
+ *
+ */
+
+#ifndef REACHGRAPH_LTL_H
+#define	REACHGRAPH_LTL_H
+
+#include "reset_define_includes.h"
+#define ASSERTLIB
+#define ERRORLIB
+#define STDIOLIB
+#define STDLIB
+#define STRINGLIB
+#define PTHREADLIB
+#include "standard_includes.h"
+
+#include "stack.h"
+#include "petri_net.h"
+#include "flags.h"
+
+//Threads are bits of the colours of the product states
+#define LTL_MAX_THREADS 64
+
+/**
+ * Argument type for thread functions.
+ */
+typedef struct ParallelThreadArgsLTLStruct {
+    const Net *net;
+    int id;
+    //For stats
+    ub8 states;                             //Product states inserted
+    ub8 transitions;                        //Product successors generated
+    ub8 depth;                              //Deepest blue and red stacks
+} ParallelThreadArgsLTL;
+
+//Checks the LTL formula (FORMULA_MC) on the fly
+extern void reachgraph_ltl_start(const Net *net);
+
+#endif	/* REACHGRAPH_LTL_H */
@@ -40,6 +40,9 @@
 #include "state_data.h"
 #include "checker.h"
 #include "atomic_interface.h"
+#include "state_spill.h"
+#include "state_arena.h"
+#include "reverse_link.h"
 
 
 #ifdef __SUNPRO_C
@@ -154,7 +157,7 @@ static void _parallel_print_statistics(ParallelStatistics type){
         //Print stack overhead
         fprintf(stdout, "\n#Exploration Overhead: %llu bytes", stack_overhead);
         fprintf(stdout, "\n#Data Structure Overhead: %llu bytes", state_overhead());
-        if(DICTIONARY==LOCALIZATION_TABLE){
+        if(DICTIONARY==LOCALIZATION_TABLE || DICTIONARY==HASH_TABLE_LOCKFREE){
             fprintf(stdout, "\n#State memory footprint: %llu bytes", state_size()*states_num);
             fprintf(stdout, "\n#Obs: State are aslo taking into account in the exploration overhead\n");
         }
@@ -167,6 +170,19 @@ static void _parallel_print_statistics(ParallelStatistics type){
     fprintf(stdout, "\n");
 }
 
+//Published work for the termination detection: shared deques of all threads
+//and the false positive stack of "id" (all stacks if id is -1)
+static int _explorer_work_pending(int id) {
+    int i = 0;
+    for (i = 0; i < NUMBEROFTHREADS; i++) {
+        if (!work_deque_empty(shared_stack[i]))
+            return 1;
+        if ((id < 0 || i == id) && !state_localization_table_stack_empty(i))
+            return 1;
+    }
+    return 0;
+}
+
 static void _parallel_init_essential(const Net *net) {
     //Init Store 
     state_set_dictionary(DICTIONARY, DICTIONARYSTATEDATA, net);
@@ -180,15 +196,12 @@ static void _parallel_init_essential(const Net *net) {
     arrived_threads = 0;
     //Call init functions for pthreads and semaphores variables.
     //Mutex
-    pthread_mutex_init(&mutex_idle_vector, NULL);
-    pthread_mutex_init(&mutex_sleep, NULL);
     pthread_mutex_init(&mutex_return_graph, NULL);
     pthread_mutex_init(&mutex_end, NULL);
     pthread_mutex_init(&mutex_state, NULL);
     pthread_mutex_init(&mutex_threads_arrived, NULL);    
        
     //Conds
-    pthread_cond_init(&cond_sleep, NULL);
     pthread_cond_init(&cond_return_graph, NULL);
     pthread_cond_init(&cond_threads_arrived, NULL);
     pthread_cond_init(&cond_end, NULL);    
@@ -196,49 +209,15 @@ static void _parallel_init_essential(const Net *net) {
     int i;
     for (i = 0; i < NUMBEROFTHREADS; i++) {
         //sem_init(&sem_shared_queue[i], 0, 0);
-        pthread_mutex_init(&mutex_shared_queue[i], NULL);
         //ATTR
         pthread_attr_init(&attr_thread[i]);
         pthread_attr_setschedpolicy(&attr_thread[i], SCHED_FIFO);
-        idle_vector[i]=0;
         //Only for Distributed Table OR Static Distribution
         pthread_mutex_init(&mutex_false_positive_queue[i], NULL);
     }
-}
-
-static int _not_end_yet(const int nth) {
-    //Lock Idle_vector
-    //pthread_mutex_lock(&mutex_idle_vector);
-    int i = 0;
-    while (i < nth) {
-        if (!idle_vector[i]){            
-            return 1;
-        }
-        i += 1;
-    }   
-    
-    if(SYNCMODE == 3){
-        int j = 0; 
-        for(j=0; j < NUMBEROFTHREADS ;j++){
-            if(!state_localization_table_stack_empty(j)){
-                return 1;
-            }
-        }
-    }
-    
-    return 0;
-}
-
-static int _some_one_is_sleeping(const int nth) {
-    //Lock Idle_vector    
-    int i = 0;
-    while (i < nth) {
-        if (idle_vector[i]){            
-            return 1;
-        }
-        i += 1;
-    }    
-    return 0;
+    //Termination detection, all threads start busy
+    termination_init(&explorer_termination, NUMBEROFTHREADS,
+            &_explorer_work_pending);
 }
 
 static void _parallel_kill_all(){
@@ -312,8 +291,15 @@ static void * _reachgraph_df(void * args) {
     /*Stack of unexpanded states*/
     StackType *stack = NULL;
     StateType *state = NULL, *state_new = NULL, *init_state = NULL;
-    stack = stack_init();
-    shared_stack[id] = *(stack_init());
+    if(state_handles()){
+        //Pending states as 32-bit handles
+        stack = stack_init_handles(&state_arena_handle, &state_arena_pointer);
+        shared_stack[id] = work_deque_init_handles(&state_arena_handle,
+                &state_arena_pointer);
+    } else {
+        stack = stack_init();
+        shared_stack[id] = work_deque_init();
+    }
     //false_positive_stack[id] = *(stack_init());
     
     //For enabled transitions
@@ -351,7 +337,7 @@ static void * _reachgraph_df(void * args) {
         if(enable_mc){
              //Check if someone had already (dis)proof  the formula
             if(checker_is_over())
-                goto sleep_mc;
+                goto mc_backward_search;
             //Number of successors
             size = state_get_descendents(enabled_transitions, state_new, net);
             //In order to be expanded, the state have to be checked first
@@ -385,19 +371,15 @@ static void * _reachgraph_df(void * args) {
          private_work +=break_i;
         //Others sons are made public -- workstealing
         i = break_i;
-        if (i < size){
-            pthread_mutex_lock(&mutex_shared_queue[id]);
-            while (i < size) {
-                state_new = state_fire_temp(stack_int_pop(enabled_transitions),
-                                                state, net, temp_state);
-                state_new = _explorer_search_and_insert(state_new);
-                if(state_new){
-                    stack_push(&shared_stack[id],state_new);
-                }
-                i += 1;
-           }
-           pthread_mutex_unlock(&mutex_shared_queue[id]);
-        }      
+        while (i < size) {
+            state_new = state_fire_temp(stack_int_pop(enabled_transitions),
+                                            state, net, temp_state);
+            state_new = _explorer_search_and_insert(state_new);
+            if(state_new){
+                work_deque_push(shared_stack[id],state_new);
+            }
+            i += 1;
+        }
     }
 
      //Init sequence for Memory Allocation
@@ -435,7 +417,7 @@ static void * _reachgraph_df(void * args) {
             if(enable_mc){
                 //Check if someone had already disproof the formula
                 if(checker_is_over())
-                    goto sleep_mc;
+                    goto mc_backward_search;
                 //Number of successors
                 size = state_get_descendents(enabled_transitions,
                              state, net);
@@ -460,7 +442,7 @@ static void * _reachgraph_df(void * args) {
                 
                 //Work_load percentage of sons will be stored into the private queue
                 register int i;                
-                if ((stack_empty(&shared_stack[id]) 
+                if ((work_deque_empty(shared_stack[id]) 
                             || private_work > PRIVATE_WORK_LOAD)){
                     //For adaptative choice - dynamically set the number of
                     //private and public sons.
@@ -502,8 +484,7 @@ static void * _reachgraph_df(void * args) {
                     }
                     private_work +=break_i;
 
-                    //Others sons are made public
-                    pthread_mutex_lock(&mutex_shared_queue[id]);
+                    //Others sons are made public (lock-free push)
                     i = break_i ;
                     while (i < size) {
                         state_new = NULL;
@@ -511,11 +492,13 @@ static void * _reachgraph_df(void * args) {
                                                     state, net, temp_state);
                             state_new = _explorer_search_and_insert(state_new);
                             if(state_new){
-                            stack_push(&shared_stack[id],state_new);
+                            work_deque_push(shared_stack[id],state_new);
                             }
                         i += 1;
                     }
-                    pthread_mutex_unlock(&mutex_shared_queue[id]);
+                    //Wake up one idle thread for the published batch
+                    if(!work_deque_empty(shared_stack[id]))
+                        termination_notify(&explorer_termination, id);
 
                 } else {
                     //All sons are stored into the private queue                   
@@ -530,24 +513,19 @@ static void * _reachgraph_df(void * args) {
                     }
                     private_work +=size;
                 }               
-
-                //Wake up idle threads
-                if(_some_one_is_sleeping(number_of_threads) && !stack_empty(&shared_stack[id])){ 
-                    pthread_mutex_lock(&mutex_sleep);
-                    pthread_cond_broadcast(&cond_sleep);
-                    pthread_mutex_unlock(&mutex_sleep);
-                }
             }
             
-           if((SYNCMODE==3 || SYNCMODE==4) && _some_one_is_sleeping(number_of_threads)){ 
-               pthread_mutex_lock(&mutex_sleep);
-               pthread_cond_broadcast(&cond_sleep);
-               pthread_mutex_unlock(&mutex_sleep);
-           }
-            
            //Release state if Dictionary type is Probabilistic
            //(Bloom table, Bloom Filter or Hash Compact)
            //state_prob_free(state);
+           //The tree compression table keeps only the roots of the states
+           if(DICTIONARY==TREE_COMPRESSION)
+               state_free(state);
+           //An expanded state may be spilled to disc
+           if(MEMSPILL > 0){
+               state_spill_unpin(state);
+               state_spill_evict();
+           }
 
            if(state_localization_table_check_local_table_open(id)
                    && (((SYNCMODE!=3 /*&& SYNCMODE!=4*/) && state_localization_table_stack_size(id) > 1000)
@@ -570,11 +548,6 @@ static void * _reachgraph_df(void * args) {
         }        
 
         //Go for shared queues 
-        //Set idle state
-        if(SYNCMODE==3)
-                _interface_atomic_swap_16((idle_vector + id), 1);
-        
-        
         if(!state_localization_table_stack_empty(id)){
             StateType **false_positives = NULL;
             int num_false_positives =
@@ -591,18 +564,16 @@ static void * _reachgraph_df(void * args) {
                 }
                 free(false_positives);
             }
-        } else if (!stack_empty(&shared_stack[id])) {
+        } else if (!work_deque_empty(shared_stack[id])) {
             reset_static:
-            //Get work from its own stack
-            pthread_mutex_lock(&mutex_shared_queue[id]);
-            //Work_load percentage of sons will be stored into the private queue
+            //Get work back from its own deque (owner side, lock-free)
             int i = 0;
-            /*Acquire Mutex for shared_stack manipulation*/
-            while (!stack_empty(&shared_stack[id]) && i < GET_SHARED_WORK/*10*/) {
-                stack_push(stack, stack_pop(&shared_stack[id]));
+            StateType *state_shared = NULL;
+            while (i < GET_SHARED_WORK/*10*/
+                    && (state_shared = work_deque_pop(shared_stack[id]))) {
+                stack_push(stack, state_shared);
                 i += 1;
             }
-            pthread_mutex_unlock(&mutex_shared_queue[id]);
         } else  { //Not static smode           
             //Try other threads shared_queues. Starts by its neighbors.
             int not_found_work = 1, i = 1;
@@ -617,110 +588,35 @@ static void * _reachgraph_df(void * args) {
                     n2 -= number_of_threads;
                 else if (n2 < 0)
                     n2 *= -1;
-                /*Acquire Mutex for the manipulation of the nth shared_stack*/
-                pthread_mutex_lock(&mutex_shared_queue[n1]);
-                while (!stack_empty(&shared_stack[n1]) && j < GET_SHARED_WORK/**/) {
-                    stack_push(stack, stack_pop(&shared_stack[n1]));
-                    j += 1;
-                }
-                pthread_mutex_unlock(&mutex_shared_queue[n1]);                
-                if(n1!=id && n2!=id && j < GET_SHARED_WORK && n2!=n1){
-                    //If not enough work had been found, tries another shared queue
-                     /*Acquire Mutex for the manipulation of the nth shared_stack*/
-                    pthread_mutex_lock(&mutex_shared_queue[n2]);                    
-                    while (!stack_empty(&shared_stack[n2]) && j < GET_SHARED_WORK/**/) {
-                        stack_push(stack, stack_pop(&shared_stack[n2]));
-                        j += 1;
-                    }
-                    pthread_mutex_unlock(&mutex_shared_queue[n2]);
+                //Steal half of the nth shared deque (at most GET_SHARED_WORK)
+                j += work_deque_steal_half(shared_stack[n1], stack, GET_SHARED_WORK);
+                if(n1!=id && n2!=id && j == 0 && n2!=n1){
+                    //If no work had been found, tries another shared deque
+                    j += work_deque_steal_half(shared_stack[n2], stack, GET_SHARED_WORK);
                 }
                 if (!stack_empty(stack))
                     not_found_work = 0;
                 i+=1;
             }
-            if (j>0 && idle_vector[id]){
-                //Work Found
-                //Remove its idle state from idle_vector if needed
-                pthread_mutex_lock(&mutex_idle_vector);
-                //idle_vector[id]  = 0;
-                if(SYNCMODE==3)
-                    _interface_atomic_swap_16((idle_vector + id), 0);
-                else 
-                    idle_vector[id]  = 0;
-                pthread_mutex_unlock(&mutex_idle_vector);
-            }            
         }
         //Test if some work has been found
         if (stack_empty(stack)
-                && stack_empty(&shared_stack[id])
+                && work_deque_empty(shared_stack[id])
                 && state_localization_table_stack_empty(id)) {        
             //Did not find work over the shared queues
-            //Set its idle state over idle_vector            
-            int vc_end, cp = 0, i = 0;
-            sleep_mc:
-            vc_end=0;
-            cp=0;
-            i=0;            
-            pthread_mutex_lock(&mutex_idle_vector);
-            if(SYNCMODE!=3){
-                idle_vector[id] = 1;
-                //_interface_atomic_swap_16((idle_vector + id), 1);
-            }
-            while (i < number_of_threads) {
-                if (!idle_vector[i]){
-                    vc_end = 1;
-                    break;
-                }
-                i += 1;
-            } 
-            pthread_mutex_unlock(&mutex_idle_vector);
-            if(vc_end/*not_end_yet()*/){ 
-                
-                sleep:
-                //Enter into sleep mode.
-                
-                if(enable_mc){
-                    //Set idle vector again 
-                    pthread_mutex_lock(&mutex_idle_vector);
-                    if(SYNCMODE!=3)
-                        idle_vector[id] = 1;
-                    else
-                        _interface_atomic_swap_16((idle_vector + id), 1);
-                    pthread_mutex_unlock(&mutex_idle_vector);
-                }
-                
-                time(&end_exploration);
-                pthread_mutex_lock(&mutex_sleep);
-                pthread_cond_wait(&cond_sleep, &mutex_sleep);
-                pthread_mutex_unlock(&mutex_sleep);
-                
-                //Is it over?
-                //MC enabled?
-                if(enable_mc && checker_is_over())
-                    goto mc_backward_search;
-                
-                pthread_mutex_lock(&mutex_state);
-                if(exp_state == GRAPH ){
-                    pthread_mutex_unlock(&mutex_state);
-                    goto return_graph;
-                }
-                pthread_mutex_unlock(&mutex_state);
-                
-                //Not idle anymore, set idle_vector
-                pthread_mutex_lock(&mutex_idle_vector);
-                if(SYNCMODE!=3)
-                    idle_vector[id] = 0;
-                else
-                    _interface_atomic_swap_16((idle_vector + id), 0);
-                pthread_mutex_unlock(&mutex_idle_vector);
-            }
-        } else {
-            //set not idle 
-            if(SYNCMODE==3)
-                _interface_atomic_swap_16((idle_vector + id), 0);
+            //Park until some work is published or everybody is idle
+            time(&end_exploration);
+            if(termination_wait(&explorer_termination, id) == TERMINATION_LAST)
+                //No work left, wake up everybody
+                termination_close(&explorer_termination);
+
+            //Is it over?
+            //MC enabled?
+            if(enable_mc && checker_is_over())
+                goto mc_backward_search;
         }
         
-    } while (_not_end_yet(number_of_threads));
+    } while (!termination_is_closed(&explorer_termination));
        
     mc_backward_search:
     
@@ -733,11 +629,9 @@ static void * _reachgraph_df(void * args) {
         arrived_threads+=1;
 
         if(arrived_threads < number_of_threads){
-            //Maybe someone is sleeping
-            //Wake Up everybody
-            pthread_mutex_lock(&mutex_sleep);
-            pthread_cond_broadcast(&cond_sleep);
-            pthread_mutex_unlock(&mutex_sleep);
+            //Maybe someone is parked or still exploring
+            //Stop exploration and wake Up everybody
+            termination_close(&explorer_termination);
         }        
         
         if(arrived_threads!=number_of_threads){
@@ -788,13 +682,14 @@ static void * _reachgraph_df(void * args) {
     //Save stack peak size for stats
     if(DICTIONARY==PROBABILIST 
             || DICTIONARY==PROBABILIST_HASH_COMPACT
-            || DICTIONARY==PROBABILIST_BT_WITH_HASH_COMPACT)
+            || DICTIONARY==PROBABILIST_BT_WITH_HASH_COMPACT
+            || DICTIONARY==TREE_COMPRESSION)
         //Take into account the state size
         thread_arg->stack_overhead = stack_overhead(stack, state_size(), STACK_OVERHEAD_WITH_STATES)
-            + stack_overhead((shared_stack + id), state_size(), STACK_OVERHEAD_WITH_STATES);
+            + work_deque_overhead(shared_stack[id], state_size(), STACK_OVERHEAD_WITH_STATES);
     else
         thread_arg->stack_overhead = stack_overhead(stack, state_size(), STACK_OVERHEAD_WITHOUT_STATES)
-            + stack_overhead((shared_stack + id), state_size(), STACK_OVERHEAD_WITHOUT_STATES);
+            + work_deque_overhead(shared_stack[id], state_size(), STACK_OVERHEAD_WITHOUT_STATES);
 
     //Get number of collisions and false positive
     long int collisions, false_positives;
@@ -811,11 +706,9 @@ static void * _reachgraph_df(void * args) {
         pthread_mutex_lock(&mutex_state);
         exp_state=GRAPH;
         pthread_mutex_unlock(&mutex_state);
-        //Maybe someone is sleeping
+        //Maybe someone is parked
         //Wake Up everybody
-        pthread_mutex_lock(&mutex_sleep);
-        pthread_cond_broadcast(&cond_sleep);
-        pthread_mutex_unlock(&mutex_sleep);        
+        termination_close(&explorer_termination);
     } else {
         //Wake up master thread
         pthread_mutex_lock(&mutex_return_graph);
@@ -921,9 +814,14 @@ void reachgraph_start(const Net *net, const int dfirst, const ModeEnum mode) {
     }
    
     _parallel_print_statistics(STATS);
+    if(MEMSPILL > 0)
+        state_spill_stop();
 
     //Kill all threads
     _parallel_kill_all();
+    //Release the states at once
+    state_arena_release();
+    reverse_link_release();
     /*for (i = 0; i < NUMBEROFTHREADS; i++) {
         pthread_join(thread_id[i], NULL);        
     }*/
@@ -54,6 +54,8 @@
 
 #include "list.h"
 #include "stack.h"
+#include "work_deque.h"
+#include "termination.h"
 #include "vector.h"
 #include "petri_net.h"
 #include "flags.h"
@@ -103,9 +105,10 @@ ExplorerStateEnum exp_state;
  */
 
 /**
- * Shared stacks, one shared stack per thread.
+ * Shared stacks, one lock-free work-stealing deque per thread. Only the owner
+ * pushes and pops, the other threads steal half of it.
  */
-StackType shared_stack[MAX_NUMBER_OF_THREADS];
+WorkDequeType *shared_stack[MAX_NUMBER_OF_THREADS];
 /**
  * False Positive Stack for Localization Table. One per thread.
  */
@@ -113,9 +116,10 @@ StackType shared_stack[MAX_NUMBER_OF_THREADS];
 
 
 /**
- * State vector: 1-idle, 0-busy
+ * Termination detection: busy threads counter and parking slots. Idle threads
+ * park over their own slot and each published batch wakes up one of them.
  */
-int idle_vector[MAX_NUMBER_OF_THREADS];
+TerminationType explorer_termination;
 /**
  * Control the number of arrived threads. Used to synchronize threads.
  */
@@ -148,24 +152,11 @@ pthread_attr_t attr_thread[MAX_NUMBER_OF_THREADS];
  * Mutex used to synchronize threads.
  */
 pthread_mutex_t mutex_threads_arrived;
-/**
- * Mutex used to manipulate the State vector.
- */
-pthread_mutex_t mutex_idle_vector;
-/**
- * Mutex used to manipulate the shared stacks (or queue). One mutex per queque
- * (or per thread).
- */
-pthread_mutex_t mutex_shared_queue[MAX_NUMBER_OF_THREADS];
 /**
  * Mutex used to manipulate the shared false positive stacks. One mutex per
  * stack (or per thread)·
  */
 pthread_mutex_t mutex_false_positive_queue[MAX_NUMBER_OF_THREADS];
-/**
- * Sleeping Mutex
- */
-pthread_mutex_t mutex_sleep;
 /**
  * Returns the local graph
  */
@@ -181,18 +172,13 @@ pthread_mutex_t mutex_state;
 
 
 /**
- * Conditions for thread sleep mode when all shared queues are empty
- * All Conditions have default attributes
+ * Conditions. All Conditions have default attributes
  */
 
 /**
  * Cond used to wake up sleeping threads.
  */
 pthread_cond_t cond_threads_arrived;
-/**
- * Cond to control sleeping threads.
- */
-pthread_cond_t cond_sleep;
 /**
  * DISABLED
  * Signal master thread for printing (when enabled).
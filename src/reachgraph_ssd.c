@@ -65,6 +65,11 @@
 #include "partition.h"
 #include "stack_partition.h"
 #include "collisions_partition.h" 
+#include "work_stealing.h"
+#include "generic.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 
 //DEPRECATED
@@ -98,6 +103,57 @@ static long long states_processed_tls=0;
 static long long transitions_processed_tls;
 static long long collisions_processed_tls = 0;
 static long long stack_overhead_tls;
+static ub8 thread_time_ns = 0;
+
+//Checkpoints (-checkpoint, -resume)
+#define CHECKPOINT_MAGIC 0x314b5043524d4552ULL
+#define CHECKPOINT_NET_NAME 64
+
+typedef struct CheckpointHeaderStruct{
+    ub8 magic;
+    char net_name[CHECKPOINT_NET_NAME];
+    ub8 state_size;
+    ub8 threads;
+    ub8 partitions;
+    ub8 table_size;
+    ub8 collision_table_size;
+    ub8 hash_size;
+    ub8 hash_number;
+    ub8 compression;
+    ub8 round;
+    long long states;
+    long long transitions;
+}CheckpointHeader;
+
+//Partition of states of each thread at the end of a round
+static unsigned long _partitions[MAX_NUMBER_OF_THREADS];
+static ub8 _round = 0;
+static FILE *_resume_file = NULL;
+static long long _resume_states, _resume_transitions;
+static int checkpoints_written = 0;
+static ub8 checkpoint_ns = 0;
+static ub8 checkpoint_bytes = 0;
+
+//Memory budget (-mem_budget)
+#define BUDGET_HEADROOM 0.9             //Share of the budget given to the sizes
+#define BUDGET_HIGH 0.95                //Stacks and spare tables are cut over it
+#define BUDGET_LOW 0.75                 //and given back under it
+#define BUDGET_LEVELS 4
+#define BUDGET_INTERVAL_US 100000
+#define BUDGET_SETTLE 10                //Intervals between two adjustments
+#define BUDGET_ROUND ((ub8) 16 << 20)
+#define BUDGET_MIN_TABLE_BITS 10
+#define BUDGET_MIN_COLLISION_BITS 8
+#define BUDGET_MIN_STACK (8*STACKSIZE)
+
+static ub8 _budget = 0;
+static long _budget_stack = 0;          //States in memory per stack at level 0
+static int _budget_level = 0;
+static volatile int _budget_stop = 0;
+static volatile int _budget_release = 0; //Release the empty tables of collisions
+static ub8 _budget_peak = 0;
+static int _budget_adjustments = 0;
+static pthread_t _budget_monitor;
 
 //Consts
 static const int SIZESON = 0;// sizeof(NodeSonSmallType);
@@ -120,8 +176,8 @@ __thread StackPartition *_stack;
 
 
 // LT Functions
-static ub8 _state_hash_table_get_key_kth(void * item, int number){
-    return state_hash_k((StateType *) item, number);
+static void _state_hash_table_get_key_wide(void * item, HashWide *wide){
+    state_hash_wide((StateType *) item, wide);
 }
 
 static int _state_hash_table_compare(void *item_table, void *item_new){
@@ -150,46 +206,9 @@ typedef enum ExplorationStepEnum{DISK_EXPLORATION, DISK_COLLISIONS, DISK_END}Exp
 //pthread_mutex_t _mutex_threads_collisions_arrived;
 ExplorationStep _step;
 
-pthread_cond_t _cond_token_ring;
-pthread_mutex_t _mutex_token_ring;
-
 pthread_cond_t _cond_wait_master;
 pthread_mutex_t _mutex_wait_master;
 
-int _token;
-int _num_token;
-
-
-void _token_ring_start(int num_token){
-    _token = 1;
-    _num_token = num_token;
-    //Mutex
-    pthread_mutex_init(&_mutex_token_ring, NULL); 
-    //Conds
-    pthread_cond_init(&_cond_token_ring, NULL);
-           
-}
-
-void _token_ring_release(int id){
-    pthread_mutex_lock(&_mutex_token_ring);
-    if(id!=_token)
-        ERRORMACRO("Token Ring Violation");
-    _token++;
-    if(_token>_num_token){
-        _token = 1;
-    }
-    pthread_cond_broadcast(&_cond_token_ring);
-    pthread_mutex_unlock(&_mutex_token_ring);
-}
-
-void _token_ring_get(int id){
-   
-   pthread_mutex_lock(&_mutex_token_ring);
-   while(_token!=id){
-        pthread_cond_wait(&_cond_token_ring, &_mutex_token_ring); 
-   }
-   pthread_mutex_unlock(&_mutex_token_ring);
-}
 
 static unsigned long _explorer_search_and_insert(int partition_id, 
         StateType *state, StateType** state_return){
@@ -232,6 +251,16 @@ static void _print_statistics(ParallelStatistics type){
         }
         //Print collision partition stats
         collision_partition_stats(partition_table);
+        partition_stats(partition_table);
+        stack_partition_stats(_stack_handler);
+        if(CHECKPOINTDIR)
+            fprintf(stdout, "\n\tCheckpoints:\t %d (%llu bytes, %f s)", checkpoints_written,
+                    checkpoint_bytes, checkpoint_ns/1e9);
+        if(_budget)
+            fprintf(stdout, "\n\tMemory budget:\t %llu MiB (peak %llu MiB resident, %d adjustments)",
+                    _budget >> 20, _budget_peak >> 20, _budget_adjustments);
+        fprintf(stdout, "\n\tThread time:\t %f s (%.1f%% blocked on I/O)", thread_time_ns/1e9,
+                thread_time_ns ? 100.0*partition_table->io_blocked_ns/thread_time_ns : 0);
         fprintf(stdout, "\n\nTotal Time: %fs\n", total_time);
         //state_dictionary_stats();
 
@@ -246,10 +275,243 @@ static void * _reachgraph_bf(void * args) {
     exit(EXIT_FAILURE);
 }
 
+static ub8 _reachgraph_now(){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (ub8) now.tv_sec*1000000000ULL + now.tv_nsec;
+}
+
+static void _reachgraph_checkpoint_header(CheckpointHeader *header, const Net *net){
+    memset(header, 0, sizeof(CheckpointHeader));
+    header->magic = CHECKPOINT_MAGIC;
+    strncpy(header->net_name, net->name, CHECKPOINT_NET_NAME - 1);
+    header->state_size = state_size();
+    header->threads = NUMBEROFTHREADS;
+    header->partitions = NUMBEROFPARTITIONS;
+    header->table_size = TABLESIZE;
+    header->collision_table_size = COLLISIONTABLESIZE;
+    header->hash_size = HASHSIZE;
+    header->hash_number = HASHNUMBER;
+    header->compression = STATECOMPRESSIONSSD;
+}
+
+/*
+ * Writes a checkpoint between two rounds, when all threads are waiting at the
+ * barrier: the partition records, the LT and the states left to explore. The 
+ * file is written aside and renamed, the previous checkpoint stays valid
+ * until then.
+ */
+static void _reachgraph_checkpoint(){
+    ub8 start = _reachgraph_now();
+    char name[strlen(CHECKPOINTDIR) + 32], temp_name[strlen(CHECKPOINTDIR) + 32];
+    sprintf(name, "%s/checkpoint", CHECKPOINTDIR);
+    sprintf(temp_name, "%s/checkpoint.tmp", CHECKPOINTDIR);
+    errno = 0;
+    FILE *file = fopen(temp_name, "wb");
+    if(file==NULL)
+        ERRORMACRO("Checkpoint: Unable to create the checkpoint file");
+    CheckpointHeader header;
+    _reachgraph_checkpoint_header(&header, net_global);
+    header.round = ++_round;
+    header.states = states_processed_tls;
+    header.transitions = transitions_processed_tls;
+    ub8 bytes = sizeof(header) + sizeof(unsigned long)*NUMBEROFTHREADS;
+    if(fwrite(&header, sizeof(header), 1, file)!=1
+            || fwrite(_partitions, sizeof(unsigned long), NUMBEROFTHREADS, file)!=NUMBEROFTHREADS)
+        ERRORMACRO("Checkpoint: Unable to write the checkpoint file");
+    bytes += partition_table_checkpoint(partition_table, file);
+    bytes += localization_table_dump(partition_lt, file);
+    bytes += stack_partition_checkpoint(_stack_handler, file);
+    if(fflush(file) || fsync(fileno(file)) || fclose(file) || rename(temp_name, name))
+        ERRORMACRO("Checkpoint: Unable to write the checkpoint file");
+    int dir = open(CHECKPOINTDIR, O_RDONLY);
+    if(dir >= 0){
+        fsync(dir);
+        close(dir);
+    }
+    partition_table_commit(partition_table);
+    ub8 elapsed = _reachgraph_now() - start;
+    checkpoints_written++;
+    checkpoint_ns += elapsed;
+    checkpoint_bytes += bytes;
+    fprintf(stdout, " Checkpoint %llu: %llu bytes in %fs\n", _round, bytes, elapsed/1e9);
+    fflush(stdout);
+}
+
+/*Restores the shared structures, the stacks are restored by a thread*/
+static void _reachgraph_resume(const Net *net){
+    char name[strlen(CHECKPOINTDIR) + 32];
+    sprintf(name, "%s/checkpoint", CHECKPOINTDIR);
+    errno = 0;
+    FILE *file = fopen(name, "rb");
+    if(file==NULL)
+        ERRORMACRO("Resume: Unable to open the checkpoint file");
+    CheckpointHeader header, expected;
+    _reachgraph_checkpoint_header(&expected, net);
+    if(fread(&header, sizeof(header), 1, file)!=1 || header.magic!=CHECKPOINT_MAGIC)
+        ERRORMACRO("Resume: Not a checkpoint file");
+    expected.round = header.round;
+    expected.states = header.states;
+    expected.transitions = header.transitions;
+    if(memcmp(&header, &expected, sizeof(header))){
+        fprintf(stderr, "\nThe checkpoint of %s was written with %llu threads, %llu partitions "
+                "and a partition table of %llu bits.\n", header.net_name, header.threads, 
+                header.partitions, header.table_size);
+        ERRORMACRO("Resume: The checkpoint was written for another net or other options");
+    }
+    if(fread(_partitions, sizeof(unsigned long), NUMBEROFTHREADS, file)!=NUMBEROFTHREADS)
+        ERRORMACRO("Resume: Unable to read the checkpoint file");
+    partition_table_restore(partition_table, file);
+    localization_table_load(partition_lt, file);
+    _round = header.round;
+    _resume_states = header.states;
+    _resume_transitions = header.transitions;
+    _resume_file = file;
+    fprintf(stdout, " Resuming from checkpoint %llu (%lld states explored)\n", 
+            _round, _resume_states);
+}
+
+//Resident set size of the process in bytes
+static ub8 _reachgraph_rss(){
+    unsigned long pages = 0, resident = 0;
+    FILE *file = fopen("/proc/self/statm", "r");
+    if(file==NULL)
+        return 0;
+    if(fscanf(file, "%lu %lu", &pages, &resident)!=2)
+        resident = 0;
+    fclose(file);
+    return ((ub8) resident)*sysconf(_SC_PAGESIZE);
+}
+
+//Expected footprint of the disc exploration for a partition table of 2^t
+//slots, a collision table of 2^c slots, p partitions and stack states per thread
+static ub8 _reachgraph_budget_cost(int t, int c, long p, long stack){
+    ub8 slot = state_size(), cell = slot + sizeof(HashMemo);
+    ub8 table = ((ub8) 1) << t, collision = ((ub8) 1) << c;
+    ub8 threads = NUMBEROFTHREADS;
+    //Per thread: table of states, read buffers, the table of new states and
+    //the log read back by the collision resolution, at most one log of 
+    //collisions per partition and the stack
+    ub8 thread = table*cell + (table + collision)*slot + collision*cell 
+            + collision*slot + p*collision*slot + 2*stack*slot;
+    if(STATECACHEFORCOLLISION)
+        thread += table*slot;
+    //Sorted records (-sc): decoded states and their keys, references to sort
+    if(STATECOMPRESSIONSSD)
+        thread += table*(slot + sizeof(ub8)) + 2*table*sizeof(ub1 *);
+    //Spare tables, log buffers and read buffers of the I/O threads
+    ub8 io = DISCIOTHREADS ? threads*(table*cell + collision*slot) 
+            + DISCIOTHREADS*(table + collision)*slot : 0;
+    //Localization Table and the Bloom summaries (a byte per slot)
+    ub8 lt = (((ub8) 1) << HASHSIZE)*(p > 256 ? 4 : 2);
+    return threads*thread + io + lt + p*table;
+}
+
+//Sizes the partitions, the tables of collisions and the stacks from the
+//memory budget: the largest partitions (the fewest reads and writes) that fit
+static int _reachgraph_budget_size(){
+    _budget = (ub8) (MEMBUDGET*(((ub8) 1) << 30));
+    ub8 base = (_reachgraph_rss() + BUDGET_ROUND - 1) & ~(BUDGET_ROUND - 1);
+    ub8 target = BUDGET_HEADROOM*_budget;
+    if(target <= base)
+        ERRORMACRO(" Memory budget: The budget is below the memory already in use");
+    target -= base;
+    long min_partitions = INIT_PARTITION_SLOTS*NUMBEROFTHREADS;
+    long p = min_partitions;
+    int t = close_power_of_two(HASHSIZE, min_partitions), c = 0;
+    for(; t >= BUDGET_MIN_TABLE_BITS; t--){
+        p = (long) ceil(pow(2, HASHSIZE - t));
+        if(p < min_partitions)
+            p = min_partitions;
+        if(p > MAX_PARTITION_SLOTS){
+            t = BUDGET_MIN_TABLE_BITS - 1;
+            break;
+        }
+        c = t - (log(p)/log(2));
+        if(c < BUDGET_MIN_COLLISION_BITS)
+            c = BUDGET_MIN_COLLISION_BITS;
+        if(_reachgraph_budget_cost(t, c, p, BUDGET_MIN_STACK) <= target)
+            break;
+    }
+    if(t < BUDGET_MIN_TABLE_BITS)
+        ERRORMACRO(" Memory budget: The budget does not hold the Localization Table (-bls) and the tables of the threads");
+    //Half of what is left goes to the stacks
+    ub8 left = target - _reachgraph_budget_cost(t, c, p, 0);
+    long stack = left/(4*NUMBEROFTHREADS*state_size());
+    if(stack > 256*STACKSIZE)
+        stack = 256*STACKSIZE;
+    if(stack < BUDGET_MIN_STACK)
+        stack = BUDGET_MIN_STACK;
+    _budget_stack = (stack/STACKSIZE)*STACKSIZE;
+    
+    TABLESIZE = t;
+    COLLISIONTABLESIZE = c;
+    NUMBEROFPARTITIONS = p;
+    STATEPERPARTITION = pow(2, TABLESIZE)*(.93);
+    STATEPERCOLLISIONPARTITION = pow(2, COLLISIONTABLESIZE)*(.99);
+    fprintf(stdout, " Memory budget: %.2f GiB (%llu MiB in use)\n", MEMBUDGET, base >> 20);
+    fprintf(stdout, " \t Partition Table:\t %d bits, %d partitions\n", TABLESIZE, NUMBEROFPARTITIONS);
+    fprintf(stdout, " \t Collision Table:\t %d bits\n", COLLISIONTABLESIZE);
+    fprintf(stdout, " \t Stack in memory:\t %ld states per thread\n", _budget_stack);
+    fprintf(stdout, " \t Expected peak:\t %llu MiB\n", 
+            (base + _reachgraph_budget_cost(t, c, p, _budget_stack)) >> 20);
+    return _budget_stack/STACKSIZE;
+}
+
+//Applies a level of memory pressure: each level halves the states the stacks
+//keep in memory and the spare tables of the I/O threads
+static void _reachgraph_budget_apply(ub8 rss){
+    long stack = _budget_stack >> _budget_level;
+    if(stack < BUDGET_MIN_STACK)
+        stack = BUDGET_MIN_STACK;
+    int spare = NUMBEROFTHREADS >> _budget_level;
+    if(spare < 1)
+        spare = 1;
+    stack_partition_set_limit(_stack_handler, stack);
+    partition_table_set_spare_tables(partition_table, spare);
+    _budget_release = (_budget_level > 0);
+    _budget_adjustments++;
+    fprintf(stdout, " Memory budget: %llu MiB resident, %ld states in memory per stack, "
+            "%d spare tables\n", rss >> 20, stack, spare);
+    fflush(stdout);
+}
+
+static void * _reachgraph_budget_monitor(void * args){
+    int settle = 0, warned = 0;
+    while(!_budget_stop){
+        usleep(BUDGET_INTERVAL_US);
+        ub8 rss = _reachgraph_rss();
+        if(rss > _budget_peak)
+            _budget_peak = rss;
+        if(settle > 0){
+            settle--;
+        } else if(rss > BUDGET_HIGH*_budget && _budget_level < BUDGET_LEVELS){
+            _budget_level++;
+            _reachgraph_budget_apply(rss);
+            settle = BUDGET_SETTLE;
+        } else if(rss > _budget && !warned){
+            WARNINGMACRO(" Memory budget: exceeded with the smallest stacks");
+            warned = 1;
+        } else if(rss < BUDGET_LOW*_budget && _budget_level > 0){
+            _budget_level--;
+            _reachgraph_budget_apply(rss);
+            settle = BUDGET_SETTLE;
+        }
+    }
+    return NULL;
+}
+
+//The decoders of the partitions hash the states with the thread local storage
+static void _reachgraph_decoder_init(void * net){
+    _local_net = petri_net_copy((Net *) net);
+    state_set_tls(0, _local_net);
+}
+
 static void * _reachgraph_df(void * args) {
     //For VERBOSE_FASE_SUMMARY
     time_t start_exploration, end_exploration;
     time(&start_exploration);
+    ub8 thread_start = _reachgraph_now();
     
     ParallelThreadArgsSSD *thread_arg = (ParallelThreadArgsSSD *) args;
 
@@ -287,7 +549,7 @@ static void * _reachgraph_df(void * args) {
      
     
     //Collision PArtition init
-    collision_partition_init(_table_of_states, partition_table, _stack, _local_net);
+    collision_partition_init(&_table_of_states, partition_table, _stack, _local_net);
     
     //For enabled transitions
     StackInteger *enabled_transitions= stack_int_init();    
@@ -303,7 +565,21 @@ static void * _reachgraph_df(void * args) {
     //Push initial state into the stack
     transitions_processed_tls = -1; 
     
-    if(work_stealing_barrier()){
+    if(RESUME){
+        if(work_stealing_barrier(id)){
+            states_processed_tls = _resume_states;
+            transitions_processed_tls = _resume_transitions;
+            ub8 states = stack_partition_restore(_stack, _resume_file);
+            fclose(_resume_file);
+            fprintf(stdout, " States to explore: %llu\n", states);
+            work_stealing_broadcast();
+        }
+        //As at the beginning of a round
+        partition = _partitions[id];
+        partition_get(partition_table, partition, _table_of_states, PARTITION_OF_STATES);
+        partition_close(partition_table, partition);
+        state_in_partition = _table_of_states->count;
+    } else if(work_stealing_barrier(id)){
         partition = partition_get_number(partition_table);
         state = state_initial(_local_net);
         state_new = state;
@@ -358,11 +634,10 @@ static void * _reachgraph_df(void * args) {
          
         if(state_in_partition > mask){ 
             //Write Partition   
-            partition_write(partition_table, partition, _table_of_states, PARTITION_OF_STATES);
+            partition_write_async(partition_table, partition, &_table_of_states, PARTITION_OF_STATES);
             partition_open(partition_table, partition);
             partition = partition_get_number(partition_table);
             //state_set_partition_id(partition);
-            hash_table_reset(_table_of_states);
             state_in_partition=0;
             mask = /*_table_of_states->mask -*/ STATEPERPARTITION;
         }
@@ -372,53 +647,54 @@ static void * _reachgraph_df(void * args) {
     ub1* data = _table_of_states->table.in_place.data;
     HashMemo *memo = _table_of_states->table.in_place.memo;
     partition_force_lock(partition_table, partition);
-    partition_write(partition_table, partition, _table_of_states, PARTITION_OF_STATES);
+    partition_write_async(partition_table, partition, &_table_of_states, PARTITION_OF_STATES);
     //partition = partition_get_number(partition_table);
     //state_set_partition_id(partition);
-    hash_table_reset(_table_of_states);
     //state_in_partition=0;
     
-    if(work_stealing_barrier()){ 
+    if(work_stealing_barrier(id)){ 
         _step = DISK_COLLISIONS;
          fprintf(stdout, " Number of Partitions: %d \n", partition_table->last_number);
         work_stealing_broadcast();  
     }   
      
     collision_partition_save_collisions();
+    if(_budget_release)
+        collision_partition_release_logs();
     
-    if(work_stealing_barrier()){
+    if(work_stealing_barrier(id)){
         time(&end_exploration);
         double total_time = difftime(end_exploration, start_exploration);
         fprintf(stdout, " Exploration time %fs \n Starting collision resolution phase\n",
                 total_time);
         fflush(stdout); 
-        if(DISCCLSEQUENTIAL==1){
-            time(&start_exploration);
-                collision_partition_iterate_collisions();
-        }
+        time(&start_exploration);
+        collision_partition_schedule(NUMBEROFTHREADS, DISCCLSEQUENTIAL);
+        if(DISCCLSEQUENTIAL==1)
+            collision_partition_resolve(id);
         work_stealing_broadcast();      
     }
-     
     
-    if(DISCCLSEQUENTIAL==0 && partition > 1){
-        //At least more than one partition
-        time(&start_exploration);
-        collision_partition_iterate_collisions(); 
-    }
+    if(DISCCLSEQUENTIAL==0)
+        collision_partition_resolve(id);
     
     if(!stack_partition_empty(_stack)){
         _step = DISK_EXPLORATION; 
+        //Read ahead the partition recovered after the barrier
+        partition_prefetch(partition_table, partition, PARTITION_OF_STATES);
     }
     
-    if(work_stealing_barrier()){
+    _partitions[id] = partition;
+    if(work_stealing_barrier(id)){
         if(_step ==DISK_COLLISIONS)
             _step = DISK_END;
-        partition_reset_collisions_assigned(partition_table);
         stack_partition_start_again(_stack);
         time(&end_exploration);
         double total_time = difftime(end_exploration, start_exploration);
         fprintf(stdout, " Collision Resolution time %fs\n", total_time);
         fflush(stdout);
+        if(CHECKPOINTDIR && _step==DISK_EXPLORATION)
+            _reachgraph_checkpoint();
         work_stealing_broadcast();  
     }
     
@@ -437,10 +713,10 @@ static void * _reachgraph_df(void * args) {
     
     //_step = DISK_END;
     
-    
+    _interface_atomic_add_64(&thread_time_ns, _reachgraph_now() - thread_start);
     fflush(stdout);
     
-    if(work_stealing_barrier()){
+    if(work_stealing_barrier(id)){
         pthread_mutex_lock(&_mutex_wait_master); 
         pthread_cond_broadcast(&_cond_wait_master);
         pthread_mutex_unlock(&_mutex_wait_master);
@@ -473,6 +749,8 @@ void reachgraph_ssd_start(const Net *net, const int dfirst, const ModeEnum mode)
     state_set_dictionary(DICTIONARY, DICTIONARYSTATEDATA, net);
     
     int stack_threshold = ROUNDMACRO(pow(2, TABLESIZE)/(STACKSIZE));
+    if(MEMBUDGET > 0)
+        stack_threshold = _reachgraph_budget_size();
     
     _stack_handler = stack_partition_init(state_size(), stack_threshold, 
             "stack", NUMBEROFTHREADS);
@@ -485,21 +763,38 @@ void reachgraph_ssd_start(const Net *net, const int dfirst, const ModeEnum mode)
     
      partition_lt = localization_table_create(HASHSIZE,
                     HASHNUMBER, MEMOIZATION_ON, sl,
-                    (HashFunctionPointer) &_state_hash_table_get_key_kth);
+                    (HashFunctionPointer) &_state_hash_table_get_key_wide);
     
     
     
     _table_of_states = (HashTable* ) state_get_local_dictionary();
     
-    //Partitions
-    partition_table = partition_table_init(net->name, "/partition", NUMBEROFPARTITIONS); 
+    //Partitions, in the checkpoint directory if any
+    char prefix[strlen(net->name) + (CHECKPOINTDIR ? strlen(CHECKPOINTDIR) : 0) + 2];
+    if(CHECKPOINTDIR){
+        if(!RESUME)
+            mkdir(CHECKPOINTDIR, 0755);
+        sprintf(prefix, "%s/%s", CHECKPOINTDIR, net->name);
+    } else 
+        strcpy(prefix, net->name);
+    partition_table = partition_table_init(prefix, "/partition", NUMBEROFPARTITIONS,
+                                            state_size(), TABLESIZE); 
+    if(RESUME)
+        _reachgraph_resume(net);
+    partition_table_start_io(partition_table, DISCIOTHREADS, NUMBEROFTHREADS);
+    partition_table_start_decoders(partition_table, NUMBEROFTHREADS + DISCIOTHREADS,
+                                    &_reachgraph_decoder_init, (void *) net);
+    if(_budget){
+        stack_partition_set_limit(_stack_handler, _budget_stack);
+        if(pthread_create(&_budget_monitor, NULL, &_reachgraph_budget_monitor, NULL))
+            ERRORMACRO(" Memory budget: Impossible to create the monitor");
+    }
     
     
     
     //Start pthread barriers
     work_stealing_config(NUMBEROFTHREADS);
 
-    _token_ring_start(NUMBEROFTHREADS); //exploration and master collision thread
     
     //Wait to finish 
     //Mutex
@@ -568,6 +863,13 @@ void reachgraph_ssd_start(const Net *net, const int dfirst, const ModeEnum mode)
     
    
     time(&end);
+    if(_budget){
+        _budget_stop = 1;
+        pthread_join(_budget_monitor, NULL);
+    }
+    partition_table_stop_io(partition_table);
+    partition_table_stop_decoders(partition_table);
+    stack_partition_stop(_stack_handler);
    
     _print_statistics(STATS);
     
@@ -0,0 +1,221 @@
+/*
+ * File:    reverse_link.c
+ * Author:  Rodrigo Tacla Saad
+ * Email:   rodrigo.tacla.saad@gmail.com
+ * Company: LAAS-CNRS / Vertics
+ * Created  on October 18, 2026, 9:40 PM
+ *
+ * LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * DESCRIPTION
+ *
+ * Reverse links of the state space, logs and compressed index. See 
+ * reverse_link.h
+ */
+
+#include "reset_define_includes.h"
+#define ASSERTLIB
+#define STDLIB
+#define ERRORLIB
+#define STDIOLIB
+#define PTHREADLIB
+#include "reverse_link.h"
+#include "atomic_interface.h"
+
+//Arcs per block of a log
+#define REVERSE_LINK_BLOCK_ARCS 65536
+
+typedef struct ReverseLinkArcStruct{
+    StateHandle state;
+    StateHandle father;
+}ReverseLinkArc;
+
+typedef struct ReverseLinkBlockStruct{
+    struct ReverseLinkBlockStruct *next;//Previous block of the log
+    ub8 used;
+    ReverseLinkArc arcs[REVERSE_LINK_BLOCK_ARCS];
+}ReverseLinkBlock;
+
+typedef struct ReverseLinkLogStruct{
+    ReverseLinkBlock *blocks;           //Last block
+    ub8 arcs;                           //Arcs appended by the thread
+    struct ReverseLinkLogStruct *next_log;
+}ReverseLinkLog;
+
+static ReverseLinkGetIndex _link_get_index = NULL;
+static ReverseLinkLog *_link_all = NULL;
+static pthread_mutex_t _link_mutex = PTHREAD_MUTEX_INITIALIZER;
+static StateHandle *_link_fathers = NULL;   //Predecessors, by state
+static ub8 _link_arcs = 0;
+static volatile ub8 _link_next = 0;         //First free position
+
+static __thread ReverseLinkLog *link_local = NULL;
+
+void reverse_link_init(ReverseLinkGetIndex get_index){
+    assert(get_index);
+    _link_get_index = get_index;
+}
+
+static ReverseLinkLog * _reverse_link_create(){
+    ReverseLinkLog *log = (ReverseLinkLog *) calloc(1, sizeof(ReverseLinkLog));
+    if(log==NULL)
+        ERRORMACRO(" reverse_link: Impossible to create the log\n");
+    pthread_mutex_lock(&_link_mutex);
+    log->next_log = _link_all;
+    _link_all = log;
+    pthread_mutex_unlock(&_link_mutex);
+    return log;
+}
+
+static ReverseLinkBlock * _reverse_link_grow(ReverseLinkLog *log){
+    ReverseLinkBlock *block = (ReverseLinkBlock *) malloc(sizeof(ReverseLinkBlock));
+    if(block==NULL)
+        ERRORMACRO(" reverse_link: Impossible to extend the log\n");
+    block->next = log->blocks;
+    block->used = 0;
+    log->blocks = block;
+    return block;
+}
+
+void reverse_link_add(StateHandle state, StateHandle father){
+    assert(state && father);
+    ReverseLinkLog *log = link_local;
+    if(log==NULL)
+        log = link_local = _reverse_link_create();
+    ReverseLinkBlock *block = log->blocks;
+    if(block==NULL || block->used==REVERSE_LINK_BLOCK_ARCS)
+        block = _reverse_link_grow(log);
+    block->arcs[block->used].state = state;
+    block->arcs[block->used].father = father;
+    block->used++;
+    log->arcs++;
+}
+
+void reverse_link_count(){
+    assert(_link_get_index);
+    if(link_local==NULL)
+        return;
+    ReverseLinkBlock *block;
+    ub8 i;
+    for(block = link_local->blocks; block; block = block->next)
+        for(i=0; i < block->used; i++)
+            _interface_atomic_inc_32(&(_link_get_index(block->arcs[i].state)->size));
+}
+
+void reverse_link_alloc(){
+    ub8 arcs = 0;
+    ReverseLinkLog *log;
+    pthread_mutex_lock(&_link_mutex);
+    for(log = _link_all; log; log = log->next_log)
+        arcs += log->arcs;
+    pthread_mutex_unlock(&_link_mutex);
+    //Positions are 32-bit
+    if(arcs > (ub8) 0xFFFFFFFF)
+        ERRORMACRO(" reverse_link: Too many arcs for the reverse graph\n");
+    free(_link_fathers);
+    _link_fathers = NULL;
+    if(arcs > 0){
+        _link_fathers = (StateHandle *) malloc(arcs*sizeof(StateHandle));
+        if(_link_fathers==NULL)
+            ERRORMACRO(" reverse_link: Impossible to create the index\n");
+    }
+    _link_arcs = arcs;
+    _link_next = 0;
+}
+
+ub4 reverse_link_reserve(ub8 links){
+    const ub8 first = _interface_atomic_add_64(&_link_next, links);
+    assert(first + links <= _link_arcs);
+    return (ub4) first;
+}
+
+void reverse_link_fill(){
+    assert(_link_get_index);
+    if(link_local==NULL)
+        return;
+    ReverseLinkBlock *block;
+    ub8 i;
+    while((block = link_local->blocks)){
+        for(i=0; i < block->used; i++){
+            ReverseLinkIndex *index = _link_get_index(block->arcs[i].state);
+            const ub4 pos = _interface_atomic_inc_32(&(index->size));
+            _link_fathers[index->first + pos] = block->arcs[i].father;
+        }
+        link_local->blocks = block->next;
+        free(block);
+    }
+}
+
+const StateHandle * reverse_link_get(const ReverseLinkIndex *index){
+    assert(index);
+    return _link_fathers + index->first;
+}
+
+long reverse_link_overhead(){
+    long overhead = 0;
+    ReverseLinkLog *log;
+    ReverseLinkBlock *block;
+    pthread_mutex_lock(&_link_mutex);
+    for(log = _link_all; log; log = log->next_log){
+        overhead += sizeof(ReverseLinkLog);
+        for(block = log->blocks; block; block = block->next)
+            overhead += sizeof(ReverseLinkBlock);
+    }
+    pthread_mutex_unlock(&_link_mutex);
+    if(_link_fathers)
+        overhead += _link_arcs*sizeof(StateHandle);
+    return overhead;
+}
+
+void reverse_link_stats(){
+    ub8 arcs = 0;
+    ReverseLinkLog *log;
+    pthread_mutex_lock(&_link_mutex);
+    for(log = _link_all; log; log = log->next_log)
+        arcs += log->arcs;
+    pthread_mutex_unlock(&_link_mutex);
+    fprintf(stdout, "\n Reverse links:\t %llu (%llu MiB)\n", arcs,
+            (ub8) (reverse_link_overhead() >> 20));
+}
+
+void reverse_link_release(){
+    pthread_mutex_lock(&_link_mutex);
+    while(_link_all){
+        ReverseLinkLog *log = _link_all;
+        _link_all = log->next_log;
+        while(log->blocks){
+            ReverseLinkBlock *block = log->blocks;
+            log->blocks = block->next;
+            free(block);
+        }
+        free(log);
+    }
+    free(_link_fathers);
+    _link_fathers = NULL;
+    _link_arcs = 0;
+    pthread_mutex_unlock(&_link_mutex);
+    //The logs of the threads are gone
+    link_local = NULL;
+}
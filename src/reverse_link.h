@@ -1,14 +1,127 @@
-/* 
- * File:   reverse_link.h
- * Author: rsaad
+/**
+ * @file        reverse_link.h
+ * @author      Rodrigo Tacla Saad
+ * @email       rodrigo.tacla.saad@gmail.com
+ * @company:    LAAS-CNRS / Vertics
+ * @created     on October 18, 2026, 9:40 PM
+ *
+ * @section LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Reverse links of the state space (-graph 0), read by the backward search of
+ * the model checker. During the forward search, each thread appends the arcs
+ * it finds (state, father) to its own log, without lock. Before the backward
+ * search, all threads turn the logs into a single compressed index: the 
+ * predecessors of a state are contiguous in one array of handles, the state
+ * keeps where its predecessors begin and how many they are (ReverseLinkIndex).
+ * The index is built in three steps separated by barriers:
+ * 1) reverse_link_count: each thread counts the predecessors of the states
+ *    from its log;
+ * 2) reverse_link_alloc, by one thread, then each thread places the 
+ *    predecessors of its states in the array (reverse_link_reserve);
+ * 3) reverse_link_fill: each thread copies its log into the array, the log
+ *    is released.
  *
- * Created on February 23, 2011, 3:07 PM
  */
 
 #ifndef _REVERSE_LINK_H
 #define	_REVERSE_LINK_H
 
+#include "standard_includes.h"
+#include "state_arena.h"
 
+//Kept by each state. Before the index is built, a state that is not yet in
+//the dictionary keeps its father in first, with size 1
+typedef struct ReverseLinkIndexStruct{
+    ub4 first;                          //First predecessor in the array
+    ub4 size;                           //Number of predecessors
+}ReverseLinkIndex;
 
-#endif	/* _REVERSE_LINK_H */
+//Returns the index kept by a state
+typedef ReverseLinkIndex * (*ReverseLinkGetIndex)(StateHandle state);
+
+/**
+ * Sets the function that returns the index of a state. Called once, before 
+ * the exploration threads.
+ * @param get_index Index kept by a state
+ */
+extern void reverse_link_init(ReverseLinkGetIndex get_index);
+
+/**
+ * Appends an arc to the log of the calling thread.
+ * @param state Handle of the state in the dictionary
+ * @param father Handle of its predecessor
+ */
+extern void reverse_link_add(StateHandle state, StateHandle father);
+
+/**
+ * Step 1: counts the predecessors of the states from the log of the calling
+ * thread. The indexes must be cleared before.
+ */
+extern void reverse_link_count();
+
+/**
+ * Allocates the array of predecessors, by one thread once all logs are
+ * counted.
+ */
+extern void reverse_link_alloc();
+
+/**
+ * Step 2: reserves a range of the array for the predecessors of the states 
+ * of the calling thread.
+ * @param links Number of predecessors of the states
+ * @return first position of the range
+ */
+extern ub4 reverse_link_reserve(ub8 links);
+
+/**
+ * Step 3: copies the log of the calling thread into the array, then releases
+ * it. The size of the indexes must be set to zero before.
+ */
+extern void reverse_link_fill();
+
+/**
+ * Returns the predecessors of a state, once the index is built.
+ * @param index Index kept by the state
+ */
+extern const StateHandle * reverse_link_get(const ReverseLinkIndex *index);
 
+/**
+ * Memory held by the logs and the array, in bytes.
+ */
+extern long reverse_link_overhead();
+
+/**
+ * Prints the number of arcs.
+ */
+extern void reverse_link_stats();
+
+/**
+ * Releases the logs and the array.
+ */
+extern void reverse_link_release();
+
+#endif	/* _REVERSE_LINK_H */
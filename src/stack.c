@@ -56,6 +56,9 @@
 #include "atomic_interface.h"
 #include <stdarg.h>
 
+//Bytes of an element: a pointer, or a handle
+#define _STACK_ELEMENT_SIZE(stack) ((stack)->encode ? sizeof(ub4) : sizeof(StackVector))
+
 StackType * stack_init(){
     errno = 0;
     StackType *new_stack=NULL;
@@ -77,6 +80,19 @@ StackType * stack_init(){
     new_stack->peak_size = new_stack->size;
     new_stack->option = SEQUENTIAL_STACK;
     new_stack->status = OPEN_STACK;
+    new_stack->encode = NULL;
+    new_stack->decode = NULL;
+    return new_stack;
+}
+
+StackType * stack_init_handles(StackEncode encode, StackDecode decode){
+    assert(encode && decode);
+    StackType *new_stack = stack_init();
+    //Handles take half the space of the vector allocated for pointers
+    new_stack->size = (sizeof(StackVector)/sizeof(ub4))*new_stack->size;
+    new_stack->peak_size = new_stack->size;
+    new_stack->encode = encode;
+    new_stack->decode = decode;
     return new_stack;
 }
 
@@ -100,6 +116,8 @@ StackType * stack_init_concurrent(){
     //Thread safe stack
     new_stack->option = CONCURRENT_STACK;
     new_stack->status = OPEN_STACK;
+    new_stack->encode = NULL;
+    new_stack->decode = NULL;
     //Initialize mutex and cond
     pthread_mutex_init(&(new_stack->mutex_block), NULL);
     pthread_cond_init(&(new_stack->cond_block), NULL);
@@ -125,12 +143,12 @@ StackType * _stack_double_size(StackType *stack){
     //Allocate new vector
     errno = 0;
     StackVector vector = NULL;
-    vector = (StackVector) malloc(sizeof(StackVector)*new_size);
+    vector = (StackVector) malloc(_STACK_ELEMENT_SIZE(stack)*new_size);
     if (vector == NULL || errno != 0){
         ERRORMACRO("Stack_Init: Impossible to create new Stack.\n");
     }
     //Copy old vector
-    memcpy(vector, stack->vector, sizeof(StackVector)*stack->size);
+    memcpy(vector, stack->vector, _STACK_ELEMENT_SIZE(stack)*stack->size);
     //Release old vector
     free(stack->vector);
     //Set new vector data over the stack
@@ -168,12 +186,12 @@ StackType * _stack_shrink_size(StackType *stack){
     //Allocate new vector
     errno = 0;
     StackVector vector = NULL;
-    vector = (StackVector) malloc(sizeof(StackVector)*new_size);
+    vector = (StackVector) malloc(_STACK_ELEMENT_SIZE(stack)*new_size);
     if (vector == NULL || errno != 0){
         ERRORMACRO("Stack_Init: Impossible to create new Stack.\n");
     }
     //Copy old vector
-    memcpy(vector, stack->vector, sizeof(StackVector)*new_size);
+    memcpy(vector, stack->vector, _STACK_ELEMENT_SIZE(stack)*new_size);
     //Release old vector
     free(stack->vector);
     //Set new vector data over the stack
@@ -209,10 +227,17 @@ int stack_push(StackType *pstack, void *pdata){
             pthread_cond_wait(&(pstack->cond_block), &(pstack->mutex_block));
             pthread_mutex_unlock(&(pstack->mutex_block));
         }
-        pstack->vector[_interface_atomic_inc_ulong_nv(&(pstack->head))]= pdata;
+        const unsigned long head = _interface_atomic_inc_ulong_nv(&(pstack->head));
+        if(pstack->encode)
+            ((ub4 *) pstack->vector)[head] = (*pstack->encode)(pdata);
+        else
+            pstack->vector[head]= pdata;
     } else{
         pstack->head +=1;
-        pstack->vector[pstack->head]= pdata;
+        if(pstack->encode)
+            ((ub4 *) pstack->vector)[pstack->head] = (*pstack->encode)(pdata);
+        else
+            pstack->vector[pstack->head]= pdata;
     }
 
     //Save peak head size
@@ -240,7 +265,10 @@ void * stack_pop(StackType *pstack){
             }
         }
         //data = pstack->vector[atomic_dec_ulong_nv(&(pstack->head))+1];
-        data = pstack->vector[pstack->head];
+        if(pstack->encode)
+            data = (*pstack->decode)(((ub4 *) pstack->vector)[pstack->head]);
+        else
+            data = pstack->vector[pstack->head];
         pstack->head--;
         //Release Stack for Concurrent Mode
         if(pstack->option==CONCURRENT_STACK){
@@ -292,7 +320,10 @@ void stack_copy_to(StackType *pstack1, StackType *pstack2){
             //Resize stack2
         }
         //Copy all data from stack1 to stack2
-        memcpy((pstack2->vector + pstack2->head),pstack1->vector, pstack1->head*sizeof(StackVector));
+        if(pstack1->encode!=pstack2->encode)
+            ERRORMACRO("stack_copy_to: Stacks of pointers and of handles\n");
+        memcpy(((ub1 *) pstack2->vector) + pstack2->head*_STACK_ELEMENT_SIZE(pstack2),
+                pstack1->vector, pstack1->head*_STACK_ELEMENT_SIZE(pstack1));
         //Update headers
         pstack2->head += pstack1->head;
         pstack1->head = 0;
@@ -319,7 +350,10 @@ void stack_free(StackType *pstack, void (*_func_free)(void *data)){
         pthread_mutex_unlock(&(pstack->mutex_block));
     }
     for(i=0; i<pstack->size;i++){
-        _func_free(pstack->vector[i]);
+        if(pstack->encode)
+            _func_free((*pstack->decode)(((ub4 *) pstack->vector)[i]));
+        else
+            _func_free(pstack->vector[i]);
     }
     free(pstack->vector);
     free(pstack);
@@ -344,10 +378,10 @@ void stack_stats(StackType *pstack){
 long stack_overhead(StackType *pstack, int state_size, StackOverhead overhead){
     assert(pstack && state_size > 0);
     if(overhead==STACK_OVERHEAD_WITH_STATES){
-        return (sizeof(StackType) + (pstack->peak_size*sizeof(void *)) + (pstack->peak_head*state_size));
+        return (sizeof(StackType) + (pstack->peak_size*_STACK_ELEMENT_SIZE(pstack)) + (pstack->peak_head*state_size));
     }
     //Else STACK_OVERHEAD_WITHOUT_STATES
-    return (sizeof(StackType) + (pstack->peak_size*sizeof(void *)));
+    return (sizeof(StackType) + (pstack->peak_size*_STACK_ELEMENT_SIZE(pstack)));
 
     
 
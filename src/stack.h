@@ -58,6 +58,10 @@
 
 typedef void * StackVector;
 
+//Compact references (32-bit handles) of the elements, see stack_init_handles
+typedef ub4 (*StackEncode)(const void *data);
+typedef void * (*StackDecode)(ub4 handle);
+
 //typedef struct StackNodeStruct{
 //    struct StackNodeStruct *link;
 //    void *data;
@@ -80,12 +84,18 @@ typedef struct StackStructType {
     //For Resize in concurrent mode
     pthread_mutex_t mutex_block;
     pthread_cond_t cond_block;
+    //Elements kept as handles (vector of ub4) if set
+    StackEncode encode;
+    StackDecode decode;
 } StackType;
 
 /* Return a pointer to a new stack. */
 extern StackType * stack_init();
 /* Return a pointer to a new stack.  With concurrent option*/
 extern StackType * stack_init_concurrent();
+/* Return a pointer to a new stack that keeps the elements as 32-bit handles,
+ * half the size of the pointers: encode is called on push, decode on pop */
+extern StackType * stack_init_handles(StackEncode encode, StackDecode decode);
 /* Return a success flag if stack is not empty*/
 extern int stack_empty(const StackType * stack);
 /* Push value onto the stack, returning success flag. */
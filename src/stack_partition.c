@@ -31,48 +31,70 @@
  * 
  * DESCRIPTION
  *
- * TODO
+ * See stack_partition.h
  */
 
+//fallocate
+#ifndef _GNU_SOURCE
+#   define _GNU_SOURCE
+#endif
 #include "reset_define_includes.h"
 #define STRINGLIB
 #define ERRORLIB
 #define ASSERTLIB
 #define STDLIB
+#define STDIOLIB
+#define UNISTD
+#define PTHREADLIB
 #define MAXMACRO  
 #include "stack_partition.h"
 #include "stack.h" 
-#include "tpl.h"
 #include "generic.h"
 #include "atomic_interface.h"
 #include "state_data.h"
+#include <fcntl.h>
+#include <time.h>
 
 #define STACK_THRESHOLD_FACTOR 5        
 #define STACK_THRESHOLD_MAX 256
 #define STACK_THRESHOLD_INIT 40
+//Alignment of the chunks in the spill files
+#define STACK_SPILL_BLOCK 4096
+//A chunk is prefetched when the stack holds less states
+#define STACK_PREFETCH_WATERMARK STACKSIZE
 
 pthread_mutex_t _mutex_wait_for_work;
 pthread_cond_t _cond_wait_for_work;
 
-pthread_rwlock_t _read_write_stack;   
 
 int _stack_partition_exploration_finished = 0; 
        
 void _stack_adjust_threshold(StackPartition *partition){
+    //Memory budget
+    long ceiling = partition->max_threshold_size*STACKSIZE;
+    long limit = partition->spill->limit;
+    if(limit > 0 && limit < ceiling)
+        ceiling = limit;
+    if(limit > 0 && partition->threshold > ceiling)
+        partition->threshold = ceiling;
     if(partition->number_of_threads > 1){
         
         if(_stack_partition_exploration_finished){
             //Set to max
             partition->threshold = partition->local_max_threshold_size;//partition->max_threshold_size*STACKSIZE ;//STACK_THRESHOLD_MAX*STACKSIZE; 
+            if(limit > 0 && partition->threshold > ceiling)
+                partition->threshold = ceiling;
             return;
         }
        
-        if (((partition->threshold) < partition->max_threshold_size*STACKSIZE /*STACK_THRESHOLD_MAX*STACKSIZE*/)
+        if (((partition->threshold) < ceiling /*STACK_THRESHOLD_MAX*STACKSIZE*/)
             && (*(partition->num_write_in_disk) 
             - *(partition->num_removed_from_disk) 
                     > STACK_THRESHOLD_FACTOR*partition->number_of_threads)){ 
 
                     partition->threshold = (partition->threshold)*2;
+                    if(limit > 0 && partition->threshold > ceiling)
+                        partition->threshold = ceiling;
                     if(partition->local_max_threshold_size < partition->threshold)
                         partition->local_max_threshold_size = partition->threshold;
                     char text[255];
@@ -88,7 +110,9 @@ void _stack_adjust_threshold(StackPartition *partition){
                     sprintf(text, " Down threshold %ld ", (partition->threshold));
                     WARNINGMACRO(text);
         }
-    }
+    } else if(partition->threshold < ceiling - 10)
+        //Single thread: back to the max once the limit is raised
+        partition->threshold = ceiling - 10;
 }
 
 
@@ -132,160 +156,278 @@ void _stack_partition_swap_holders(StackPartition* stack){
     stack->stack_dump = temp;
 }
 
+static ub8 _stack_now(){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (ub8) now.tv_sec*1000000000ULL + now.tv_nsec;
+}
+
+static void _stack_reserve(ub1** buffer, ub8* size, ub8 needed){
+    if(*size >= needed)
+        return;
+    free(*buffer);
+    *buffer = (ub1 *) malloc(needed);
+    if(*buffer==NULL)
+        ERRORMACRO("Stack Partition: Impossible to create the spill buffers");
+    *size = needed;
+}
+
+static void _stack_pwrite(int fd, ub1* buffer, ub8 size, ub8 offset){
+    while(size > 0){
+        errno = 0;
+        ssize_t written = pwrite(fd, buffer, size, offset);
+        if(written < 0 && errno==EINTR)
+            continue;
+        if(written <= 0)
+            ERRORMACRO("Stack Partition: Unable to write the spill file");
+        buffer += written;
+        offset += written;
+        size -= written;
+    }
+}
+
+static void _stack_pread(int fd, ub1* buffer, ub8 size, ub8 offset){
+    while(size > 0){
+        errno = 0;
+        ssize_t read_bytes = pread(fd, buffer, size, offset);
+        if(read_bytes < 0 && errno==EINTR)
+            continue;
+        if(read_bytes <= 0)
+            ERRORMACRO("Stack Partition: Unable to read the spill file");
+        buffer += read_bytes;
+        offset += read_bytes;
+        size -= read_bytes;
+    }
+}
+
+#define STACK_DELTA(states, i, slot_size) \
+    (((i) < (ub8) (slot_size)) ? (states)[i] : (states)[i] ^ (states)[(i) - (slot_size)])
+
+/*
+ * Encodes the states XORed with their predecessor, a run of zero bytes is 
+ * written as a zero byte followed by the length of the run. Returns 0 if the 
+ * encoded chunk does not fit in limit bytes.
+ */
+static ub8 _stack_encode(const ub1* states, ub4 count, int slot_size, ub1* out,
+        ub8 limit){
+    ub8 i = 0, o = 0, n = (ub8) count*slot_size;
+    while(i < n){
+        if(o + 2 > limit)
+            return 0;
+        ub1 delta = STACK_DELTA(states, i, slot_size);
+        if(delta){
+            out[o++] = delta;
+            i++;
+            continue;
+        }
+        ub1 run = 0;
+        while(i < n && run < UB1MAXVAL && STACK_DELTA(states, i, slot_size)==0){
+            run++;
+            i++;
+        }
+        out[o++] = 0;
+        out[o++] = run;
+    }
+    return o;
+}
+
+static void _stack_decode(const ub1* in, ub4 count, int slot_size, ub1* states){
+    ub8 i = 0, n = (ub8) count*slot_size;
+    while(i < n){
+        ub1 delta = *in++;
+        if(delta){
+            states[i++] = delta;
+        } else {
+            ub1 run = *in++;
+            memset(states + i, 0, run);
+            i += run;
+        }
+    }
+    for(i = slot_size; i < n; i++)
+        states[i] ^= states[i - slot_size];
+}
+
+/*Removes the oldest chunk from the FIFO. Called with spill->lock held*/
+static int _stack_partition_dequeue(StackPartition* stack, StackPartitionChunk* chunk){
+    StackPartitionSpill* spill = stack->spill;
+    if(spill->chunks_count==0)
+        return 0;
+    *chunk = spill->chunks[spill->chunks_head];
+    spill->chunks_head = (spill->chunks_head + 1) % spill->chunks_capacity;
+    spill->chunks_count--;
+    _interface_atomic_inc_uint(stack->num_removed_from_disk);
+    return 1;
+}
+
+/*Reads a chunk back into states and releases its disc space*/
+static void _stack_partition_read_chunk(StackPartitionSpill* spill, 
+        StackPartitionChunk chunk, int slot_size, ub1** buffer, ub8* buffer_size,
+        ub1** states, ub8* states_size, int release){
+    _stack_reserve(states, states_size, (ub8) chunk.count*slot_size);
+    ub1* data = *states;
+    if(chunk.encoded){
+        _stack_reserve(buffer, buffer_size, chunk.size);
+        data = *buffer;
+    }
+    _stack_pread(spill->fds[chunk.file], data, chunk.size, chunk.offset);
+    if(chunk.encoded)
+        _stack_decode(data, chunk.count, slot_size, *states);
+#ifdef FALLOC_FL_PUNCH_HOLE
+    if(release)
+        fallocate(spill->fds[chunk.file], FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                chunk.offset, chunk.size);
+#endif
+}
+
+/*Moves count states into the (empty) main stack*/
+static void _stack_partition_load(StackPartition* stack, ub1* states, ub4 count){
+    StackInPlace* main = stack->stack_main;
+    if(count <= main->size){
+        memcpy(main->vector, states, (ub8) count*stack->slot_size);
+        main->head = count - 1;
+    } else {
+        ub4 i;
+        main->head = (unsigned long) -1;
+        for(i=0; i < count; i++)
+            stack_in_place_push(main, states + (ub8) i*stack->slot_size);
+    }
+    stack->count += count;
+}
+
 void _stack_partition_write_to_disk(StackPartition* stack){
     assert(stack!=NULL);    
+    StackPartitionSpill* spill = stack->spill;
+    StackPartitionChunk chunk;
+    chunk.file = stack->file;
+    chunk.count = stack->stack_dump->head + 1;
+    chunk.offset = stack->file_end;
+    
+    stack->count -= (long) chunk.count;
+    
+    ub8 raw = (ub8) chunk.count*stack->slot_size;
+    _stack_reserve(&stack->buffer, &stack->buffer_size, raw);
+    ub8 size = _stack_encode(stack->stack_dump->vector, chunk.count, 
+                                stack->slot_size, stack->buffer, raw);
+    ub1* data = stack->buffer;
+    chunk.encoded = (size > 0);
+    if(!chunk.encoded){
+        data = stack->stack_dump->vector;
+        size = raw;
+    }
+    chunk.size = size;
+    _stack_pwrite(spill->fds[stack->file], data, size, chunk.offset);
+    //Chunks start on a block, so that their space can be released
+    stack->file_end += (size + STACK_SPILL_BLOCK - 1) & ~((ub8) STACK_SPILL_BLOCK - 1);
+    //No need to clean the slots, they are overwritten before being read
+    stack->stack_dump->head = (unsigned long) -1;
+    
+    //Publish the chunk
+    pthread_mutex_lock(&spill->lock);
+    if(spill->chunks_count==spill->chunks_capacity){
+        int i, capacity = 2*spill->chunks_capacity;
+        StackPartitionChunk* chunks = (StackPartitionChunk *) 
+                malloc(sizeof(StackPartitionChunk)*capacity);
+        if(chunks==NULL)
+            ERRORMACRO("Stack Partition: Impossible to grow the chunk list");
+        for(i=0; i < spill->chunks_count; i++)
+            chunks[i] = spill->chunks[(spill->chunks_head + i) % spill->chunks_capacity];
+        free(spill->chunks);
+        spill->chunks = chunks;
+        spill->chunks_head = 0;
+        spill->chunks_capacity = capacity;
+    }
+    spill->chunks[(spill->chunks_head + spill->chunks_count) 
+                    % spill->chunks_capacity] = chunk;
+    spill->chunks_count++;
+    spill->bytes_raw += raw;
+    spill->bytes_written += size;
+    _interface_atomic_inc_uint(stack->num_write_in_disk);
+    pthread_mutex_unlock(&spill->lock);
     
-    
-    //Get read lock (write lock is for get_from_disk)
-    pthread_rwlock_rdlock(&_read_write_stack);
-    
-    if(0 && DISCPARALLELSEQUENTIAL)
-        disc_access_lock();
-    
-    //stack->num_write_in_disk++;
-    int num_write_in_disk = _interface_atomic_inc_uint_nv(stack->num_write_in_disk);
-    
-    stack->count -= (int) stack->stack_dump->head + 1;
-    
-    char* file_name = (char*) malloc(sizeof(char)*(strlen(stack->namespace) + 150));
-    char* file_name_head = (char*) malloc(sizeof(char)*(strlen(file_name)+ 150));
-    //Set file name
-    strcpy(file_name, "");
-    strcpy(file_name_head, "");
-    
-    char *num_p =  itoa(num_write_in_disk); 
-    
-    strcat(file_name, stack->namespace);
-    strcat(file_name,num_p);
-    free(num_p); 
-    
-    //File Head
-    strcat(file_name_head, file_name);
-    
-    strcat(file_name_head, "_st_h.tpl");
-    //Dump to file head
-    int slot_size, num_slot, partition_number, head;
-    slot_size = stack->stack_dump->slot_size;
-    num_slot = stack->stack_dump->size;
-    partition_number = num_write_in_disk; 
-    head = stack->stack_dump->head;
-    tpl_node *node_head;
-    node_head = tpl_map("iiii", &slot_size, &num_slot, &head, &partition_number);
-    tpl_pack(node_head, 0);
-    tpl_dump(node_head, TPL_FILE, file_name_head);    
-    tpl_free(node_head);       
-    
-    //Write data 
-    
-    //File data 
-    
-    strcat(file_name, "_st.tpl");
-    //Dump to file
-    ub1* data = stack->stack_dump->vector;
-    tpl_node *node;
-    node = tpl_map("c#", data, slot_size*(head+1)*sizeof(ub1));
-    tpl_pack(node, 0);
-    tpl_dump(node, TPL_FILE, file_name);
-    tpl_free(node); 
-     
-    stack_in_place_reset(stack->stack_dump);
-    free(file_name);
-    free(file_name_head); 
-    
-    if(0 && DISCPARALLELSEQUENTIAL)
-        disc_access_unlock();
-    
-    pthread_rwlock_unlock(&_read_write_stack);
     _stack_wake_up_someone(stack);
-    
-    
 }
 
-void _stack_partition_get_from_disk(StackPartition* stack){
-    assert(stack!=NULL && stack->count==0); 
-    
-    pthread_rwlock_wrlock(&_read_write_stack); 
-    int num_removed_from_disk = _interface_atomic_inc_uint_nv(stack->num_removed_from_disk);
-    if (num_removed_from_disk > *(stack->num_write_in_disk)){ 
-        //give up
-         
-        _interface_atomic_dec_uint(stack->num_removed_from_disk);
-        pthread_rwlock_unlock(&_read_write_stack);
-        return;
-    } else if(num_removed_from_disk == *(stack->num_write_in_disk)){
-        //Should not be a problem
-        //wait if equal  
-        //pthread_rwlock_wrlock(&_read_write_stack); 
+static void * _stack_partition_prefetcher(void * args){
+    StackPartitionSpill* spill = (StackPartitionSpill*) args;
+    ub1* buffer = NULL;
+    ub8 buffer_size = 0;
+    pthread_mutex_lock(&spill->lock);
+    for(;;){
+        while(spill->requests_count==0 && !spill->stop)
+            pthread_cond_wait(&spill->request, &spill->lock);
+        if(spill->requests_count==0)
+            break;
+        StackPartition* stack = spill->requests[--spill->requests_count];
+        StackPartitionChunk chunk;
+        if(!_stack_partition_dequeue(stack, &chunk)){
+            //Taken by an idle thread in the meantime
+            stack->prefetch = STACK_PREFETCH_IDLE;
+            pthread_cond_broadcast(&spill->done);
+            continue;
+        }
+        pthread_mutex_unlock(&spill->lock);
+        
+        _stack_partition_read_chunk(spill, chunk, stack->slot_size, &buffer,
+                &buffer_size, &stack->loaded, &stack->loaded_size, 1);
+        stack->loaded_count = chunk.count;
         
+        pthread_mutex_lock(&spill->lock);
+        stack->prefetch = STACK_PREFETCH_READY;
+        pthread_cond_broadcast(&spill->done);
     }
-    
-    
-    if(0 && DISCPARALLELSEQUENTIAL)
-        disc_access_lock();
-    //stack->num_write_in_disk--;
-    
-    char* file_name = (char*) malloc(sizeof(char)*(strlen(stack->namespace) + 150));
-    char* file_name_head = (char*) malloc(sizeof(char)*(strlen(file_name)+ 150));
-    //Set file name
-    strcpy(file_name, "");
-    strcpy(file_name_head, "");
-    
-    char *num_p =   itoa(num_removed_from_disk); 
-    
-    
-    
-    strcat(file_name, stack->namespace);
-    strcat(file_name,num_p);
-    free(num_p); 
-    
-    //File Head
-    strcat(file_name_head, file_name);
-    
-    strcat(file_name_head, "_st_h.tpl");
-    //Dump to file head
-    int slot_size, num_slot, partition_number, head; 
-    tpl_node *node_head;
-    node_head = tpl_map("iiii", &slot_size, &num_slot, &head, &partition_number);
-    tpl_load(node_head, TPL_FILE, file_name_head);
-    tpl_unpack(node_head, 0);        
-    tpl_free(node_head);
-    //Remove file
-    remove(file_name_head);
-    
-    if(num_slot > stack->stack_main->size){
-        fprintf(stderr, " Stack error %s %d %d %d", file_name_head, num_slot, stack->stack_main->size, stack->stack_dump->size);        
-        ERRORMACRO("Stack partition mismatch");
+    pthread_mutex_unlock(&spill->lock);
+    free(buffer);
+    return NULL;
+}
+
+static void _stack_partition_request_prefetch(StackPartition* stack){
+    StackPartitionSpill* spill = stack->spill;
+    pthread_mutex_lock(&spill->lock);
+    stack->prefetch = STACK_PREFETCH_REQUESTED;
+    spill->requests[spill->requests_count++] = stack;
+    pthread_cond_signal(&spill->request);
+    pthread_mutex_unlock(&spill->lock);
+}
+
+/*
+ * Refills the empty stack with the prefetched chunk or, if there is none, 
+ * with a chunk read synchronously. Returns 0 if there is no chunk on disc.
+ */
+int _stack_partition_get_from_disk(StackPartition* stack){
+    assert(stack!=NULL && stack->count==0); 
+    StackPartitionSpill* spill = stack->spill;
+    
+    if(stack->prefetch != STACK_PREFETCH_IDLE){
+        pthread_mutex_lock(&spill->lock);
+        if(stack->prefetch==STACK_PREFETCH_REQUESTED){
+            ub8 start = _stack_now();
+            spill->prefetch_waits++;
+            while(stack->prefetch==STACK_PREFETCH_REQUESTED)
+                pthread_cond_wait(&spill->done, &spill->lock);
+            spill->wait_ns += _stack_now() - start;
+        } else 
+            spill->prefetch_hits++;
+        int ready = (stack->prefetch==STACK_PREFETCH_READY);
+        stack->prefetch = STACK_PREFETCH_IDLE;
+        pthread_mutex_unlock(&spill->lock);
+        if(ready){
+            _stack_partition_load(stack, stack->loaded, stack->loaded_count);
+            return 1;
+        }
     }
     
-    //Write data 
-    
-    //File data 
-    
-    strcat(file_name, "_st.tpl");
-    //Dump to file
-    stack_in_place_reset(stack->stack_main);
-    stack->stack_main->head = head;    
-    ub1* data = stack->stack_main->vector;    
-    tpl_node *node;
-    node = tpl_map("c#", data, slot_size*(head+1)*sizeof(ub1));
-    tpl_load(node, TPL_FILE, file_name);
-    tpl_unpack(node, 0);    
-    tpl_free(node); 
-    //Remove file
-    remove(file_name);
-    
-    
-    stack->count += head+1;
-     
-    free(file_name);
-    free(file_name_head); 
-    
-    if(0 && DISCPARALLELSEQUENTIAL)
-        disc_access_unlock();
-    
-    pthread_rwlock_unlock(&_read_write_stack);
-    
-    
+    StackPartitionChunk chunk;
+    pthread_mutex_lock(&spill->lock);
+    int found = _stack_partition_dequeue(stack, &chunk);
+    if(found)
+        spill->sync_reads++;
+    pthread_mutex_unlock(&spill->lock);
+    if(!found)
+        return 0;
+    _stack_partition_read_chunk(spill, chunk, stack->slot_size, &stack->buffer,
+            &stack->buffer_size, &stack->loaded, &stack->loaded_size, 1);
+    _stack_partition_load(stack, stack->loaded, chunk.count);
+    return 1;
 }
 
 
@@ -347,10 +489,38 @@ StackPartition * stack_partition_init(int slot_size, long threshold,
     //Start mutex
     pthread_mutex_init(&_mutex_wait_for_work, NULL); 
     pthread_cond_init(&_cond_wait_for_work, NULL);
-    pthread_rwlock_init(&_read_write_stack, NULL);
     
     partition->namespace = name_space; 
     
+    //Spill files, created by stack_partition_copy
+    errno=0;
+    StackPartitionSpill* spill = (StackPartitionSpill *) calloc(1, sizeof(StackPartitionSpill));
+    if(spill!=NULL){
+        spill->chunks_capacity = 4*number_of_threads;
+        spill->chunks = (StackPartitionChunk *) malloc(sizeof(StackPartitionChunk)
+                                                    *spill->chunks_capacity);
+        spill->fds = (int *) malloc(sizeof(int)*number_of_threads);
+        spill->requests = (StackPartition **) malloc(sizeof(StackPartition *)*number_of_threads);
+        spill->copies = (StackPartition **) malloc(sizeof(StackPartition *)*number_of_threads);
+    }
+    if (spill==NULL || !spill->chunks || !spill->fds || !spill->requests || !spill->copies){
+        ERRORMACRO("Stack_Partition_Init: Impossible to create new Stack.\n");
+    }
+    pthread_mutex_init(&spill->lock, NULL);
+    pthread_cond_init(&spill->request, NULL);
+    pthread_cond_init(&spill->done, NULL);
+    if(pthread_create(&spill->prefetcher, NULL, &_stack_partition_prefetcher, spill))
+        ERRORMACRO("Stack_Partition_Init: Impossible to create the prefetcher");
+    partition->spill = spill;
+    partition->file = -1;
+    partition->file_end = 0;
+    partition->buffer = NULL;
+    partition->buffer_size = 0;
+    partition->loaded = NULL;
+    partition->loaded_size = 0;
+    partition->loaded_count = 0;
+    partition->prefetch = STACK_PREFETCH_IDLE;
+    
     //Max threshould 
     if(threshold < STACK_THRESHOLD_FACTOR)
         partition->max_threshold_size = STACK_THRESHOLD_FACTOR; //STACK_THRESHOLD_MAX;//_(int) 12800000/(1280*state_size());
@@ -384,6 +554,19 @@ StackPartition * stack_partition_copy(StackPartition *stack){
     partition->stack_dump = stack_in_place_init_no_shrink(partition->slot_size,
             partition->max_threshold_size);
     
+    //Spill file of the thread
+    StackPartitionSpill* spill = partition->spill;
+    partition->file = _interface_atomic_inc_uint_nv(&(spill->number_of_files)) - 1;
+    if(partition->file >= partition->number_of_threads)
+        ERRORMACRO("Stack_Partition_Copy: More copies than threads");
+    char file_name[strlen(partition->namespace) + 32];
+    sprintf(file_name, "%s.%d.stk", partition->namespace, partition->file);
+    errno = 0;
+    spill->fds[partition->file] = open(file_name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(spill->fds[partition->file] < 0)
+        ERRORMACRO("Stack_Partition_Copy: Unable to create the spill file");
+    spill->copies[partition->file] = partition;
+    
     return partition;
 }
 
@@ -392,10 +575,11 @@ int stack_partition_empty(StackPartition * stack){
         return 0;*/     
     try_again:
     if(stack->count==0){               
-        if(*(stack->num_write_in_disk) > *(stack->num_removed_from_disk))
-                //Recover stack from disk
-                _stack_partition_get_from_disk(stack);   
-                _stack_adjust_threshold(stack);
+        if(stack->prefetch!=STACK_PREFETCH_IDLE
+                || *(stack->num_write_in_disk) > *(stack->num_removed_from_disk))
+            //Recover stack from disk
+            _stack_partition_get_from_disk(stack);   
+        _stack_adjust_threshold(stack);
     }   
     
     if(stack->count > 0){
@@ -446,6 +630,11 @@ int stack_partition_pop(StackPartition *stack, void *data){
     
     if(stack->count > 0){
         stack->count--;
+        //Read ahead the next chunk before the stack runs dry
+        if(stack->count < STACK_PREFETCH_WATERMARK 
+                && stack->prefetch==STACK_PREFETCH_IDLE
+                && stack->spill->chunks_count > 0)
+            _stack_partition_request_prefetch(stack);
         return stack_in_place_pop(stack->stack_main, data);
     } else {
         ERRORMACRO("Stack Partition Underflow");
@@ -462,7 +651,114 @@ void stack_partition_start_again(StackPartition* stack){
 void stack_partition_free(StackPartition *stack){
     stack_in_place_free(stack->stack_main);
     stack_in_place_free(stack->stack_dump);
+    free(stack->buffer);
+    free(stack->loaded);
     free(stack);
 }
 
+void stack_partition_stop(StackPartition *stack){
+    StackPartitionSpill* spill = stack->spill;
+    pthread_mutex_lock(&spill->lock);
+    spill->stop = 1;
+    pthread_cond_broadcast(&spill->request);
+    pthread_mutex_unlock(&spill->lock);
+    pthread_join(spill->prefetcher, NULL);
+    int i;
+    char file_name[strlen(stack->namespace) + 32];
+    for(i=0; i < spill->number_of_files; i++){
+        close(spill->fds[i]);
+        sprintf(file_name, "%s.%d.stk", stack->namespace, i);
+        unlink(file_name);
+    }
+    spill->number_of_files = 0;
+}
+
+static void _stack_checkpoint_write(FILE* file, const void* data, ub8 size){
+    errno = 0;
+    if(size > 0 && fwrite(data, 1, size, file)!=size)
+        ERRORMACRO("stack_partition_checkpoint: Unable to write the checkpoint");
+}
+
+static ub8 _stack_in_place_count(StackInPlace* stack){
+    return stack->head + 1;
+}
+
+ub8 stack_partition_checkpoint(StackPartition *stack, FILE *file){
+    StackPartitionSpill* spill = stack->spill;
+    int i;
+    //The prefetches in flight are part of the checkpoint
+    pthread_mutex_lock(&spill->lock);
+    for(i=0; i < spill->number_of_files; i++)
+        while(spill->copies[i]->prefetch==STACK_PREFETCH_REQUESTED)
+            pthread_cond_wait(&spill->done, &spill->lock);
+    pthread_mutex_unlock(&spill->lock);
+    
+    ub8 header[2] = {0, stack->slot_size};
+    for(i=0; i < spill->number_of_files; i++){
+        StackPartition* copy = spill->copies[i];
+        header[0] += _stack_in_place_count(copy->stack_main) 
+                    + _stack_in_place_count(copy->stack_dump);
+        if(copy->prefetch==STACK_PREFETCH_READY)
+            header[0] += copy->loaded_count;
+    }
+    for(i=0; i < spill->chunks_count; i++)
+        header[0] += spill->chunks[(spill->chunks_head + i) % spill->chunks_capacity].count;
+    _stack_checkpoint_write(file, header, sizeof(header));
+    
+    for(i=0; i < spill->number_of_files; i++){
+        StackPartition* copy = spill->copies[i];
+        _stack_checkpoint_write(file, copy->stack_main->vector, 
+                _stack_in_place_count(copy->stack_main)*stack->slot_size);
+        _stack_checkpoint_write(file, copy->stack_dump->vector, 
+                _stack_in_place_count(copy->stack_dump)*stack->slot_size);
+        if(copy->prefetch==STACK_PREFETCH_READY)
+            _stack_checkpoint_write(file, copy->loaded, 
+                    (ub8) copy->loaded_count*stack->slot_size);
+    }
+    //The chunks stay on disc for the current run
+    ub1 *buffer = NULL, *states = NULL;
+    ub8 buffer_size = 0, states_size = 0;
+    for(i=0; i < spill->chunks_count; i++){
+        StackPartitionChunk chunk = spill->chunks[(spill->chunks_head + i) 
+                                                    % spill->chunks_capacity];
+        _stack_partition_read_chunk(spill, chunk, stack->slot_size, &buffer, 
+                &buffer_size, &states, &states_size, 0);
+        _stack_checkpoint_write(file, states, (ub8) chunk.count*stack->slot_size);
+    }
+    free(buffer);
+    free(states);
+    return sizeof(header) + header[0]*stack->slot_size;
+}
+
+ub8 stack_partition_restore(StackPartition *stack, FILE *file){
+    ub8 header[2], i;
+    errno = 0;
+    if(fread(header, sizeof(ub8), 2, file)!=2 || header[1]!=(ub8) stack->slot_size)
+        ERRORMACRO("stack_partition_restore: Unable to read the checkpoint");
+    ub1 state[stack->slot_size];
+    for(i=0; i < header[0]; i++){
+        if(fread(state, stack->slot_size, 1, file)!=1)
+            ERRORMACRO("stack_partition_restore: Unable to read the checkpoint");
+        stack_partition_push(stack, state);
+    }
+    return header[0];
+}
+
+void stack_partition_set_limit(StackPartition *stack, long states){
+    assert(stack!=NULL);
+    stack->spill->limit = states;
+}
+
+void stack_partition_stats(StackPartition *stack){
+    StackPartitionSpill* spill = stack->spill;
+    fprintf(stdout, "\n\nStack Spill:");
+    fprintf(stdout, "\n\tChunks written:\t %d", *(stack->num_write_in_disk));
+    fprintf(stdout, "\n\tBytes written:\t %llu (%.1f%% of %llu)", spill->bytes_written,
+            spill->bytes_raw ? 100.0*spill->bytes_written/spill->bytes_raw : 0, 
+            spill->bytes_raw);
+    fprintf(stdout, "\n\tPrefetched:\t %llu ready, %llu waited (%f s)", 
+            spill->prefetch_hits, spill->prefetch_waits, spill->wait_ns/1e9);
+    fprintf(stdout, "\n\tSynchronous reads:\t %llu", spill->sync_reads);
+}
+
 
@@ -31,7 +31,13 @@
  * 
  * @section DESCRIPTION
  *
- * TODO
+ * Exploration stack of the disc based exploration. When the stack of a thread
+ * grows over its threshold, the older half is spilled to the spill file of the
+ * thread. The chunks on disc are shared by all threads (FIFO), so an idle 
+ * thread can take the work spilled by another one. States are delta encoded
+ * (XOR with the previous state, runs of zero bytes compacted) before being 
+ * written, and a background prefetcher reads the next chunk of a thread back
+ * before its in memory stack runs dry.
  * 
  */
 
@@ -42,6 +48,45 @@
 #include "stack.h"
 
 
+typedef enum StackPrefetchEnum {STACK_PREFETCH_IDLE, STACK_PREFETCH_REQUESTED, 
+        STACK_PREFETCH_READY} StackPrefetchStatus;
+
+/*Chunk of states spilled to the file of a thread*/
+typedef struct StackPartitionChunkStruct{
+    int file;                   //Thread that wrote the chunk
+    int encoded;                //0 if the states are stored raw
+    ub4 count;                  //Number of states
+    ub4 size;                   //Bytes on disc
+    ub8 offset;
+}StackPartitionChunk;
+
+/*Spill files and prefetcher, shared by all copies of a stack*/
+typedef struct StackPartitionSpillStruct{
+    StackPartitionChunk* chunks;   //FIFO of the chunks on disc
+    int chunks_head;
+    int chunks_count;
+    int chunks_capacity;
+    int* fds;                       //Spill file of each thread
+    struct StackPartitionStruct** copies;  //Stack of each thread
+    int number_of_files;
+    pthread_mutex_t lock;
+    //Prefetcher
+    pthread_t prefetcher;
+    pthread_cond_t request;
+    pthread_cond_t done;
+    struct StackPartitionStruct** requests;
+    int requests_count;
+    int stop;
+    volatile long limit;            //States in memory per thread, 0: no limit
+    //Statistics
+    ub8 bytes_raw;
+    ub8 bytes_written;
+    ub8 prefetch_hits;
+    ub8 prefetch_waits;
+    ub8 sync_reads;
+    ub8 wait_ns;
+}StackPartitionSpill;
+
 typedef struct StackPartitionStruct{
     StackInPlace* stack_main;
     StackInPlace* stack_dump;
@@ -55,7 +100,15 @@ typedef struct StackPartitionStruct{
     long count;                 //Fixed value
     int slot_size;              //Fixed value        
     char* namespace;            //Fixed value
-   
+    StackPartitionSpill* spill; //Value shared by all threads
+    int file;                   //Spill file of the thread
+    ub8 file_end;
+    ub1* buffer;                //Encoded chunk
+    ub8 buffer_size;
+    ub1* loaded;                //States read back from disc
+    ub8 loaded_size;
+    ub4 loaded_count;
+    volatile int prefetch;      //StackPrefetchStatus
 }StackPartition;
 
 /**
@@ -68,6 +121,11 @@ typedef struct StackPartitionStruct{
 extern StackPartition * stack_partition_init(int slot_size, 
         long threshold_in_bits, char* name, int number_of_threads);
 
+/**
+ * Creates the stack of a thread, with its own spill file. 
+ * @param stack the stack returned by stack_partition_init
+ * @return a valid StackPartition reference
+ */
 extern StackPartition * stack_partition_copy(StackPartition *stack);
 
 extern void stack_partition_start_again(StackPartition* stack);
@@ -103,6 +161,43 @@ extern int stack_partition_pop(StackPartition *pstack, void *data);
  */
 extern void stack_partition_free(StackPartition *pstack);
 
+/**
+ * Stops the prefetcher and removes the spill files. 
+ * @param stack the stack returned by stack_partition_init
+ */
+extern void stack_partition_stop(StackPartition *stack);
+
+/**
+ * Writes every state of the stacks of all threads (in memory, prefetched and
+ * spilled) to a checkpoint file. No thread may be using its stack.
+ * @param stack the stack returned by stack_partition_init
+ * @param file a file opened for writing
+ * @return the number of bytes written
+ */
+extern ub8 stack_partition_checkpoint(StackPartition *stack, FILE *file);
+
+/**
+ * Pushes the states written by stack_partition_checkpoint.
+ * @param stack the stack of the calling thread
+ * @param file a file opened for reading
+ * @return the number of states pushed
+ */
+extern ub8 stack_partition_restore(StackPartition *stack, FILE *file);
+
+/**
+ * Limits the number of states each thread keeps in memory before spilling 
+ * (memory budget). The stacks apply it at their next threshold adjustment.
+ * @param stack the stack returned by stack_partition_init
+ * @param states the limit, 0 to use the threshold only
+ */
+extern void stack_partition_set_limit(StackPartition *stack, long states);
+
+/**
+ * Prints the spill statistics.
+ * @param stack the stack returned by stack_partition_init
+ */
+extern void stack_partition_stats(StackPartition *stack);
+
 
 
 #endif	/* STACK_PARTITION_H */
@@ -234,7 +234,9 @@ typedef                 int  word;  /* fastest type available */
 /**
  * Options for dictionary type
  */
-typedef enum DicTypeEnum {NOT_SELECTED, LOCALIZATION_TABLE, PROBABILIST, PROBABILIST_BT_WITH_HASH_COMPACT, PROBABILIST_HASH_COMPACT, NO_DICTIONARY, PARTITION_SSD, HASH_TABLE_TBB}DicType;
+typedef enum DicTypeEnum {NOT_SELECTED, LOCALIZATION_TABLE, PROBABILIST, PROBABILIST_BT_WITH_HASH_COMPACT, PROBABILIST_HASH_COMPACT, NO_DICTIONARY, PARTITION_SSD, HASH_TABLE_TBB, HASH_TABLE_LOCKFREE, TREE_COMPRESSION}DicType;
 typedef enum MultTypeEnum {MULTI_NOT_SET, MULTI_BIT, MULTI_ARRAY, MULTI_LIST} MultType;
+typedef enum GuardTypeEnum {GUARD_LIST, GUARD_COMPILED, GUARD_SIMD} GuardType;
+typedef enum HashModeEnum {HASH_DRIVER, HASH_INCREMENTAL} HashMode;
 
 #endif /* STANDARD */
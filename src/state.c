@@ -61,8 +61,13 @@
 #include "state_cache.h"
 #include "hash_compact.h"
 #include "hash_table.h"
+#include "hash_table_lockfree.h"
+#include "tree_table.h"
 #include "standard_includes.h"
 #include "partition.h"
+#include "state_spill.h"
+#include "state_arena.h"
+#include "reverse_link.h"
 #include "tbb.h"
 
 #include <unistd.h>
@@ -107,6 +112,29 @@ __thread StateType * state_temp_uncompressed_new = NULL;
 
 __thread CompressionChoiches state_compression = NO_COMPRESSION;
 
+//For incremental hashing: base hash of the state being expanded and of its
+//last fired successor (see state_fire_temp)
+__thread const StateType * state_hash_parent = NULL;
+__thread ub8 state_hash_parent_base = 0;
+__thread const StateType * state_hash_child = NULL;
+__thread ub8 state_hash_child_base = 0;
+
+//States of the Localization Table come from the thread arenas (see 
+//state_arena.h), set once by state_set_dictionary
+int state_arena_enabled = 0;
+
+//Incremental hashing is only available for vector markings without data
+static inline int _state_hash_incremental(){
+    return (HASHMODE == HASH_INCREMENTAL && MULTITYPESET == MULTI_ARRAY
+            && !STATEWITHDATA && !state_compression);
+}
+
+static inline ub8 _state_hash_base(const StateType * state){
+    if(state == state_hash_child)
+        return state_hash_child_base;
+    return marking_hash_incremental((Marking) state);
+}
+
 
 //For Dictionaries use - only one is set
 DicType global_state_dictionary_type;
@@ -119,6 +147,12 @@ __thread DicType state_state_data_dictionary_type = 0;
 //Globals vars
 LocalizationTable *state_lt = NULL;
 
+//Shared lock-free table
+HashTableLockFree *state_lockfree_table = NULL;
+
+//Shared tree compression table
+TreeTable *state_tree_table = NULL;
+
 #ifdef TESTING_VERSION
 //For TBB 
 tbb_hash_table *tbb_table;
@@ -150,6 +184,9 @@ __thread HashTable * state_local_store;
 static StateType * _state_new();
 static int _state_get_uncompressed_size();
 static void _state_copy_graph_link_to(StateType *state, StateType *new);
+static ReverseLinkIndex * _state_link_get_ref(StateType *state);
+static ReverseLinkIndex * _state_link_get_index(StateHandle state);
+static void _state_link_log(StateType *state, const StateType *state_new);
 
 /*****************************************************************************/
 //Functions for local  Hash Table use
@@ -184,16 +221,20 @@ static void _state_hash_table_copy(void *item_table, const void *item_new, int s
   state_copy_to(item_new, item_table, state_local_net);
 }
 
+//For the spill of the local tables (-mem_spill)
+static void _state_spill_hash_table_copy(void *item_table, const void *item_new, int size ){
+  state_copy_to(item_new, item_table, state_local_net);
+  state_spill_stamp(item_table);
+}
+
 //For model checking only
 static int _state_hash_table_compare_MC(void *item_table, void *item_new){
     if(!item_table || !item_new)
         return 0;
     if (state_compare((StateType *) item_table, (StateType *) item_new, state_local_net)==0){
-        //Merge links references if needed -- Only for Reverse graph
-        if(GRAPHMC == REVERSE_GRAPH){
-            //Create a reverse link structure and attach it to this state
-            state_link_merge((StateType *) item_table, (StateType *) item_new);            
-        }
+        //Log the arc to the state found -- Only for Reverse graph
+        if(GRAPHMC == REVERSE_GRAPH)
+            _state_link_log((StateType *) item_table, (StateType *) item_new);
         return 1;
     } else 
         return 0;    
@@ -207,10 +248,11 @@ static void _state_hash_table_copy_MC(void *item_table, const void *item_new, in
     _state_copy_graph_link_to((StateType *) item_new, (StateType *) item_table);
     //Change on demand
     if(GRAPHMC == REVERSE_GRAPH){
-        //Copy links
-        state_link_create(item_table, NULL);
-        //Parental link
-        state_link_copy_to(item_new, item_table);
+        //Log the arc to the new state, its index is set by state_link_place
+        _state_link_log((StateType *) item_table, (StateType *) item_new);
+        ReverseLinkIndex *link = _state_link_get_ref((StateType *) item_table);
+        link->first = 0;
+        link->size = 0;
     } else if(GRAPHMC == PARENTAL_GRAPH){
         //Increment Parental number of references
         StateType *father = state_father_get(item_table);
@@ -235,11 +277,17 @@ static ub8 _state_hash_table_get_key_kth(void * item, int number){
     return state_hash_k((StateType *) item, number);
 }
 
+static void _state_hash_table_get_key_wide(void * item, HashWide *wide){
+    state_hash_wide((StateType *) item, wide);
+}
+
 int state_localization_table_stack_empty(int id){
     if((state_dictionary_type==PROBABILIST && !SAVEFALSEPOSITIVE)
             ||  (state_dictionary_type==PROBABILIST_BT_WITH_HASH_COMPACT)
             || state_dictionary_type==PROBABILIST_HASH_COMPACT 
-            || state_dictionary_type==HASH_TABLE_TBB)
+            || state_dictionary_type==HASH_TABLE_TBB
+        || state_dictionary_type==HASH_TABLE_LOCKFREE
+        || state_dictionary_type==TREE_COMPRESSION)
         //Not valid for Bloom Filter and Hash Compact
         return 1;
     return localization_table_stack_empty(state_local_lt, id);
@@ -249,7 +297,9 @@ int state_localization_table_stack_size(int id){
     if((state_dictionary_type==PROBABILIST && !SAVEFALSEPOSITIVE)
         ||  (state_dictionary_type==PROBABILIST_BT_WITH_HASH_COMPACT)
         || state_dictionary_type==PROBABILIST_HASH_COMPACT 
-        || state_dictionary_type==HASH_TABLE_TBB)
+        || state_dictionary_type==HASH_TABLE_TBB
+        || state_dictionary_type==HASH_TABLE_LOCKFREE
+        || state_dictionary_type==TREE_COMPRESSION)
         //Not valid for Bloom Filter and Hash Compact
         return 0;
     return localization_table_stack_size(state_local_lt, id);
@@ -259,7 +309,9 @@ int state_localization_table_check_local_table_open(int id){
     if((state_dictionary_type==PROBABILIST && !SAVEFALSEPOSITIVE)
         ||  (state_dictionary_type==PROBABILIST_BT_WITH_HASH_COMPACT)
         || state_dictionary_type==PROBABILIST_HASH_COMPACT
-        || state_dictionary_type==HASH_TABLE_TBB)
+        || state_dictionary_type==HASH_TABLE_TBB
+        || state_dictionary_type==HASH_TABLE_LOCKFREE
+        || state_dictionary_type==TREE_COMPRESSION)
         //Not valid for Bloom Filter and Hash Compact
         return 0;
     return localization_table_check_local_table_open(state_local_lt, id);
@@ -270,7 +322,9 @@ int state_localization_table_iterate_false_positive_stack(int id,
     if((state_dictionary_type==PROBABILIST && !SAVEFALSEPOSITIVE)
          ||  (state_dictionary_type==PROBABILIST_BT_WITH_HASH_COMPACT)
          || state_dictionary_type==PROBABILIST_HASH_COMPACT
-         || state_dictionary_type==HASH_TABLE_TBB)
+         || state_dictionary_type==HASH_TABLE_TBB
+        || state_dictionary_type==HASH_TABLE_LOCKFREE
+        || state_dictionary_type==TREE_COMPRESSION)
         //Not valid for Bloom Filter and Hash Compact
         return 0;
     return localization_table_iterate_false_positive_stack(state_local_lt,
@@ -518,23 +572,14 @@ static StateType * _state_prob_bt_and_hash_compact_search_and_insert(StateType *
 
 static StateType * _state_new(){
     StateType * state = NULL;
-    state = (StateType *) malloc(state_size_total);
+    if(state_arena_enabled)
+        state = (StateType *) state_arena_new();
+    else
+        state = (StateType *) malloc(state_size_total);
     if(state==NULL || errno!=0){
         ERRORMACRO("_state_new: Impossible do create new state structure");
     }
     memset(state, 0, state_size_total);
-
-
-    if((state_dictionary_type == LOCALIZATION_TABLE)
-            && state_ctl_mc){
-        if(GRAPHMC == REVERSE_GRAPH){
-            //Create a reverse link structure and attach it to this state
-            state_link_create(state, NULL);
-        }/* else if(GRAPHMC == PARENTAL_GRAPH){
-            //Create a reverse link structure and attach it to this state
-            state_link_create(state, NULL);
-        }*/
-    }
     return state;
 }
 
@@ -612,6 +657,9 @@ void state_set_tls(int id, const Net *net){
     
     switch (state_dictionary_type){
         case HASH_TABLE_TBB:
+        case HASH_TABLE_LOCKFREE:
+        case TREE_COMPRESSION:
+        case NO_DICTIONARY:
             break;
         case PARTITION_SSD:{
             break;
@@ -629,8 +677,11 @@ void state_set_tls(int id, const Net *net){
                         &state_local_store, &_state_hash_table_compare_MC,
                         &_state_hash_table_get_key, &_state_hash_table_free,
                         state_size());*/
-                    if(GRAPHMC == PARENTAL_GRAPH){
-                        //Special copy function for stack in place
+                    if(state_arena_enabled)
+                        hash_table_set_alloc(state_local_store, &state_arena_new);
+                    if(GRAPHMC == PARENTAL_GRAPH || GRAPHMC == REVERSE_GRAPH){
+                        //Special copy function for stack in place, the arc
+                        //is logged when the owner inserts the state
                         state_local_lt
                                 = localization_table_config_local_stack_cpfunction(state_lt,
                                 id, state_local_store, &_state_stack_in_place_copy_MC);
@@ -640,12 +691,27 @@ void state_set_tls(int id, const Net *net){
                                 = localization_table_config_local(state_lt, id, state_local_store);
                     
             }
+            else if(MEMSPILL > 0){
+                //One more byte per state for its generation
+                hash_table_create(HASH_TABLE_OF_POINTERS, TABLESIZE,
+                        &state_local_store, & _state_hash_table_compare,
+                        &_state_hash_table_get_key, &_state_hash_table_free,
+			HASH_TABLE_RESIZE, HASH_TABLE_RECOPY_WITH_FUNCTION, 
+			state_size() + 1,&_state_spill_hash_table_copy);
+                hash_table_set_miss(state_local_store, &state_spill_test);
+                state_spill_init_local(state_local_store);
+                if(state_arena_enabled)
+                    hash_table_set_alloc(state_local_store, &state_arena_new);
+                state_local_lt =localization_table_config_local(state_lt, id, state_local_store);
+            }
             else{
                 hash_table_create(HASH_TABLE_OF_POINTERS, TABLESIZE,
                         &state_local_store, & _state_hash_table_compare,
                         &_state_hash_table_get_key, &_state_hash_table_free,
 			HASH_TABLE_RESIZE, HASH_TABLE_RECOPY_WITH_FUNCTION, 
 			state_size(),&_state_hash_table_copy);
+                if(state_arena_enabled)
+                    hash_table_set_alloc(state_local_store, &state_arena_new);
                 state_local_lt =localization_table_config_local(state_lt, id, state_local_store);
             }
             break;
@@ -728,7 +794,7 @@ int state_set_dictionary(DicType type, DicType data_type, const Net *net){
             state_lt = 
                 localization_table_create(HASHSIZE,
                     HASHNUMBER, MEMOIZATION_ON, LT_2BYTE,
-                    (HashFunctionPointer) &_state_hash_table_get_key_kth);
+                    (HashFunctionPointer) &_state_hash_table_get_key_wide);
             if (state_lt)
                 return 1;
             else
@@ -746,13 +812,54 @@ int state_set_dictionary(DicType type, DicType data_type, const Net *net){
             
         }
         
+        case HASH_TABLE_LOCKFREE:
+            if(STATEWITHDATA || state_compression || state_ctl_mc)
+                ERRORMACRO(" Lock-free table: no state data, compression or model checking\n");
+            state_lockfree_table = hash_table_lockfree_create(GLOBALTABLESIZE,
+                    state_size(), (HashTableLockFreeGetKey) &_state_hash_table_get_key_wide,
+                    (HashTableLockFreeCompare) &_state_hash_table_compare);
+            return 1;
+
+        case NO_DICTIONARY:
+            //States are kept by the caller (LTL product, see reachgraph_ltl)
+            if(STATEWITHDATA || state_compression || state_ctl_mc)
+                ERRORMACRO(" No dictionary: no state data, compression or model checking\n");
+            return 1;
+
+        case TREE_COMPRESSION:
+            if(STATEWITHDATA || state_compression || state_ctl_mc)
+                ERRORMACRO(" Tree compression: no state data, compression or model checking\n");
+            state_tree_table = tree_table_create(GLOBALTABLESIZE, state_size());
+            return 1;
+
         case LOCALIZATION_TABLE:
 
             //Create Lt with the args passed from command line
             state_lt = 
                 localization_table_with_tables_create(HASHSIZE,
                     HASHNUMBER, NUMBEROFTHREADS, SYNCMODE,
-                    (HashFunctionPointer) &_state_hash_table_get_key_kth);
+                    (HashFunctionPointer) &_state_hash_table_get_key_wide);
+            if(MEMSPILL > 0){
+                //States are written to disc as they are
+                if(STATEWITHDATA || state_compression || state_ctl_mc)
+                    ERRORMACRO(" Memory spill: no state data, compression or model checking\n");
+                state_spill_init(net, state_size());
+            }
+            //Lists of tokens are not part of the state space (-malloc)
+            if((STATEARENA || (state_ctl_mc && GRAPHMC==REVERSE_GRAPH))
+                    && MULTITYPESET!=MULTI_LIST){
+                //One more byte per state for the spill
+                state_arena_init(state_size() + (MEMSPILL > 0));
+                state_arena_enabled = 1;
+            }
+            //The reverse graph keeps handles to the states
+            if(state_ctl_mc && GRAPHMC==REVERSE_GRAPH){
+                if(!state_arena_enabled)
+                    ERRORMACRO(" Reverse graph (-graph 0): lists of tokens not supported\n");
+                if(!STATEARENA)
+                    WARNINGMACRO(" -malloc is ignored by the reverse graph (-graph 0)");
+                reverse_link_init(&_state_link_get_index);
+            }
             if (state_lt)
                 return 1;
             else
@@ -764,7 +871,7 @@ int state_set_dictionary(DicType type, DicType data_type, const Net *net){
             bloom_of_state
                         = bloom_probabilistic_create(BTHASHSIZE, HASHNUMBER,
                             HASHNUMBER, ONLYFALSEPOSITIVE, NUMBEROFLEVELS,
-                            LVDECREASEINBITS, REJECTCOLLISIONS, (BloomProbGetKey) &_state_hash_table_get_key_kth);
+                            LVDECREASEINBITS, REJECTCOLLISIONS, (BloomProbGetKey) &_state_hash_table_get_key_wide);
             //Create cache to avoid data race between threads
             if(STATECOMPRESSION)
                 WARNINGMACRO( " Cache table is disabled when Probabilistic method is set with compression");
@@ -780,7 +887,7 @@ int state_set_dictionary(DicType type, DicType data_type, const Net *net){
                 state_lt =
                     localization_table_with_tables_create(HASHSIZE,
                         1, NUMBEROFTHREADS, SYNCHRONOUS/*SYNCMODE*/,
-                        (HashFunctionPointer) &_state_hash_table_get_key_kth);
+                        (HashFunctionPointer) &_state_hash_table_get_key_wide);
                 if (state_lt)
                     return 1;
                 else
@@ -794,7 +901,7 @@ int state_set_dictionary(DicType type, DicType data_type, const Net *net){
             bloom_of_state
                         = bloom_probabilistic_create(BTHASHSIZE, HASHNUMBER,
                             HASHNUMBER, ONLYFALSEPOSITIVE, NUMBEROFLEVELS,
-                            LVDECREASEINBITS, REJECTCOLLISIONS, (BloomProbGetKey) &_state_hash_table_get_key_kth);
+                            LVDECREASEINBITS, REJECTCOLLISIONS, (BloomProbGetKey) &_state_hash_table_get_key_wide);
             //Create cache to avoid data race between threads
             if(STATECOMPRESSION)
                 WARNINGMACRO( " Cache table is disabled when Probabilistic method is set with compression");
@@ -849,6 +956,11 @@ void state_get_collisions_and_false_positive_stats(long int * collisions,
     switch (DICTIONARY){
         case HASH_TABLE_TBB:
             break;
+        case HASH_TABLE_LOCKFREE:
+        case TREE_COMPRESSION:
+            *collisions = 0;
+            *false_positive = 0;
+            break;
         case LOCALIZATION_TABLE:
             *collisions = state_local_lt->collisions_found;
             *false_positive = state_local_lt->false_positives_found;
@@ -881,11 +993,23 @@ void state_dictionary_stats(){
         case PROBABILIST_HASH_COMPACT:
             break;
 
+        case HASH_TABLE_LOCKFREE:
+            hash_table_lockfree_print(state_lockfree_table, NUMBEROFTHREADS);
+            break;
+
+        case TREE_COMPRESSION:
+            tree_table_print(state_tree_table, NUMBEROFTHREADS);
+            break;
+
         case PROBABILIST:
             cache_table_print(cache_for_data_race);
             bloom_probabilistic_print(bloom_of_state);
         default:
             hash_table_stats_for_all(state_lt->array_local_tables, NUMBEROFTHREADS);
+            if(state_arena_enabled)
+                state_arena_stats();
+            if(state_ctl_mc && GRAPHMC==REVERSE_GRAPH)
+                reverse_link_stats();
     }
     
 }
@@ -949,6 +1073,26 @@ int state_test_and_insert(StackType * state, StateType **state_return){
             #endif
         }
             
+        case HASH_TABLE_LOCKFREE:
+            if(hash_table_lockfree_find_or_put(state, state_lockfree_table,
+                    state_thread_id, (void **) state_return))
+                return 0;
+            *state_return = NULL;
+            return 1;
+
+        case TREE_COMPRESSION:{
+            ub8 root;
+            if(tree_table_find_or_put(state, state_tree_table,
+                    state_thread_id, &root)){
+                //The table keeps only the root. Return a copy of the state,
+                //released after its expansion
+                *state_return = state_copy(state, state_local_net);
+                return 0;
+            }
+            *state_return = NULL;
+            return 1;
+        }
+
         case LOCALIZATION_TABLE:
              //try to search or insert over lt
             if(localization_table_search_and_insert(state, state_thread_id,
@@ -1001,6 +1145,15 @@ void * state_test(StackType * state){
              return localization_table_search(state, state_thread_id,
                     state_local_lt);
              
+        case HASH_TABLE_LOCKFREE:
+            return hash_table_lockfree_find(state, state_lockfree_table);
+
+        case TREE_COMPRESSION:
+            //States are not stored, the argument stands for the found state
+            if(tree_table_find(state, state_tree_table))
+                return state;
+            return NULL;
+
         case HASH_TABLE_TBB:
             //return tbb_hash_table_lookup(tbb_table, state, 1);
             
@@ -1104,6 +1257,13 @@ int state_get_descendents(StackInteger * enabled_transitions,
     }
 
 
+    //New expansion, forget the incremental hashes of the previous one
+    state_hash_parent = NULL;
+    state_hash_child = NULL;
+    //Successors are compressed relative to their parent
+    if(state_dictionary_type==TREE_COMPRESSION)
+        tree_table_reference(holder_state, state_tree_table, state_thread_id);
+
     //Get enabled transitions from the marking
     int number_trans = marking_enabled_transitions(enabled_transitions,
             (Marking) holder_state, net);
@@ -1286,6 +1446,16 @@ StateType * state_fire_temp(int trans,
     //Get initial marking from petri net file (.net)
     //Get marking reference of new state
     Marking marking = _state_get_marking(holder_state);
+    if(_state_hash_incremental()){
+        //Hash of the new state from the hash of its parent and the delta
+        if(state_hash_parent != holder_state){
+            state_hash_parent_base = marking_hash_incremental(marking);
+            state_hash_parent = holder_state;
+        }
+        state_hash_child_base = marking_hash_incremental_fire(
+                state_hash_parent_base, marking, net, trans);
+        state_hash_child = holder_new;
+    }
     marking_fire_temp_state(marking, net, trans, holder_new);
     if(STATEWITHDATA){
         //State extended with data
@@ -1515,6 +1685,9 @@ StateType * state_copy_with_malloc(StateType * state,
 HashWord state_hash(const StateType * state,
         const Net *net){
 
+    if(_state_hash_incremental())
+        return hash_incremental_derive(_state_hash_base(state), HASHNUMBER+1);
+
     if(state_compression){
         //Hash compressed data
         CompressionType **compressed_data = ((CompressionType **) state);
@@ -1558,7 +1731,20 @@ HashWord state_hash(const StateType * state,
     
 }
 
+void state_hash_wide(const StateType * state, HashWide *wide){
+    if(_state_hash_incremental())
+        hash_incremental_wide(_state_hash_base(state), wide);
+    else if(state_compression || STATEWITHDATA){
+        //Two seeded hashes
+        wide->h1 = state_hash_k(state, 0);
+        wide->h2 = state_hash_k(state, 1) | 1;
+    } else
+        marking_hash_wide((Marking) state, wide);
+}
+
 HashWord state_hash_k(const StateType * state,int number){
+    if(_state_hash_incremental())
+        return hash_incremental_derive(_state_hash_base(state), number);
     if(state_compression){
         //Hash compressed data
         CompressionType **compressed_data = ((CompressionType **) state);
@@ -1698,7 +1884,9 @@ int state_size(){
             if(global_state_dictionary_type == LOCALIZATION_TABLE){
                 //Necessary for backwards traversal
                 if(GRAPHMC==REVERSE_GRAPH){
-                    //Add a pointer to state
+                    //Add the index of the predecessors, aligned for the
+                    //atomic updates of state_link_count and state_link_fill
+                    state_size_total = (state_size_total + 3) & ~3;
                     state_size_before_link=state_size_total;
                     state_size_link= state_link_size_static();
                     state_size_total += state_size_link;
@@ -1747,15 +1935,6 @@ void state_set_compression(int compression){
 
  void state_free(StateType * state){
 
-     
-     //Release links if enabled
-    if((state_dictionary_type == LOCALIZATION_TABLE)
-            && state_ctl_mc){
-        if(GRAPHMC==REVERSE_GRAPH){
-            state_link_free(state);
-        } 
-    }
-
     if(STATEWITHDATA){
         switch (state_state_data_dictionary_type){            
 
@@ -1790,7 +1969,10 @@ void state_set_compression(int compression){
         data_compression_free(*compressed);
     } //else
     //Release marking - and the complete space
-    marking_free(state);
+    if(state_arena_enabled)
+        state_arena_free(state);
+    else
+        marking_free(state);
     
     
  }
@@ -1837,9 +2019,15 @@ StateType * state_iterate_table(int id){
 }
 
 
+int state_handles(){
+    return state_arena_enabled;
+}
+
 long state_overhead(){
     switch (DICTIONARY){
         case LOCALIZATION_TABLE:
+            if(state_ctl_mc && GRAPHMC==REVERSE_GRAPH)
+                return localization_table_overhead(state_lt) + reverse_link_overhead();
             return localization_table_overhead(state_lt);
 
         case PROBABILIST_BT_WITH_HASH_COMPACT:
@@ -1853,6 +2041,12 @@ long state_overhead(){
         case PROBABILIST_HASH_COMPACT:
             hash_compact_count(hash_compact_of_state);
             return hash_compact_overhead(hash_compact_of_state);
+
+        case HASH_TABLE_LOCKFREE:
+            return hash_table_lockfree_overhead(state_lockfree_table);
+
+        case TREE_COMPRESSION:
+            return tree_table_overhead(state_tree_table);
         default:
             return 0;
     }
@@ -1868,7 +2062,7 @@ long state_overhead(){
 
 static int _state_flag_size();
 static int _state_color_flag_size();
-static StateLink ** _state_link_get_ref(StateType *state);
+static ReverseLinkIndex * _state_link_get_ref(StateType *state);
 //static void state_copy_graph_link_to(StateType *state, StateType *new);
 
 /*****************************************************************************/
@@ -1877,248 +2071,72 @@ static StateLink ** _state_link_get_ref(StateType *state);
 /*Reverse links*/
 
 int state_link_size_static(){
-    return sizeof(void *); //pointer size
-}
-
-#define STATE_LINK_SLEEP_CYCLES 100
-
-static void state_link_sleep(){
-    register int i;
-    while(i < STATE_LINK_SLEEP_CYCLES){
-        i++;
-    }
+    return sizeof(ReverseLinkIndex);
 }
 
-StateLink ** _state_link_get_ref(StateType *state){
+static ReverseLinkIndex * _state_link_get_ref(StateType *state){
     assert(state);
-    //Return a pointer for StateLink Structure
-    return (StateLink **) (state + state_size_before_link);
+    //Return a pointer for the index of the state
+    return (ReverseLinkIndex *) (state + state_size_before_link);
 }
 
-static void _state_link_lock(StateLink *link){
-    assert(link);
-    ub1 lock_base = 1;
-    while(lock_base){
-        lock_base = _interface_atomic_cas_8(&(link->lock), 0,1);
-        if(!lock_base)
-            break;
-        //wait, try again
-        if(lock_base!=1){
-            fprintf(stderr, "\n ERROR:: region lock with consistency error %d \n", lock_base);
-            exit(EXIT_FAILURE);
-        }
-        sleep(.001);
-    }
-}
-
-static void _state_link_unlock(StateLink *link){
-    assert(link);
-    ub1 lock_base = 0;
-    lock_base = _interface_atomic_cas_8(&(link->lock), 1,0);
-    if(!lock_base){
-        fprintf(stderr, "\n ERROR:: this region should be locked\n");
-        exit(EXIT_FAILURE);
-    }
+//ReverseLinkGetIndex
+static ReverseLinkIndex * _state_link_get_index(StateHandle state){
+    return _state_link_get_ref((StateType *) state_arena_pointer(state));
 }
 
 void state_link_add_father(StateType *state, StateType *father){
     assert(state && father);
-    StateLink **link_ref = _state_link_get_ref(state);
-    StateLink *link = *link_ref;
-    //Count one link more
+    ReverseLinkIndex *link = _state_link_get_ref(state);
+    //Kept until the state is found or inserted in the dictionary
+    link->first = state_arena_handle(father);
     link->size = 1;
-    //Add new link
-    link->links = father;
-    //Release lock
-    link->lock = (ub1) 0;
-}
-
-void state_link_copy_to(const StateType *state, StateType *state_to){
-    assert(state && state_to);
-    StateLink **link_ref = _state_link_get_ref((StateType *) state);
-    StateLink *link = *link_ref;
-    StateLink **link_to_ref = _state_link_get_ref(state_to);
-    StateLink *link_to = *link_to_ref;
-    //Get lock
-    _state_link_lock(link);
-    _state_link_lock(link_to);
-    //Region locked
-    //Copy size
-    link_to->size = link->size;
-    if(link_to->size > 0){
-        if(link_to->size ==1){
-            //The state ref is the pointer value
-            link_to->links = link->links;
-        } else {
-            //Create a new list
-            errno = 0;
-            StateType **new_list = NULL;
-            new_list = (StateType **) malloc(link_to->size*sizeof(StateType *));
-            if(!new_list || errno){
-                fprintf(stderr, "state_link_add: Impossible do create new link %s",
-                       strerror(errno));
-                exit(EXIT_FAILURE);
-            }
-            //Copy list
-            memcpy(new_list,  link->links, link->size*sizeof(StateType*));
-            //Release old list
-            //free(link_to->links);
-            //Ser reference for new list
-            link_to->links = new_list;
-        }
-    }
-    //Release locks
-    _state_link_unlock(link);
-    _state_link_unlock(link_to);
-}
-
-
-void state_link_add(StateType *state, StateType *state_linked){
-    assert(state && state_linked);
-    StateLink **link_ref = _state_link_get_ref(state);
-    StateLink *link = *link_ref;
-    //Get lock
-    _state_link_lock(link);
-    //Region locked
-    //Count one link more
-    link->size = link->size + 1;
-    //Add link pointer
-    errno = 0;
-    StateType **list_new = NULL;
-    list_new = (StateType **) malloc(sizeof(StateType *)*link->size);
-    if(!list_new || errno){
-        fprintf(stderr, "state_link_add: Impossible do create new link %s",
-               strerror(errno));
-        exit(EXIT_FAILURE);
-    }
-    //Copy old list
-    memcpy(list_new, link->links, (link->size - 1)*(sizeof(StateType *)));
-    //Add new link
-    //*(list_new +(link->size - 1)) = (StateType *) state_linked;
-    //Save new links list
-    StateType * list_old = link->links;
-    link->links = list_new;
-    //Release old list
-    free(list_old);
-    //Release lock
-    _state_link_unlock(link);
-}
-
-uint16_t state_link_get(StateType *state, StateType ** list){
-    assert(state && list);
-    StateLink **link_ref = _state_link_get_ref(state);
-    StateLink *link = *link_ref;
-    *list = link->links;
-    return link->size;
 }
 
-StateType * state_link_get_father(StateType *state){
-    assert(state);
-    StateLink **link_ref = _state_link_get_ref(state);
-    StateLink *link = *link_ref;
-    if(link->size==1)
-        return link->links;
-    else
-        //Root
-        return NULL;
+static void _state_link_log(StateType *state, const StateType *state_new){
+    assert(state && state_new);
+    //Arc from the father of the new state to the state of the dictionary
+    const ReverseLinkIndex *link = _state_link_get_ref((StateType *) state_new);
+    if(link->size)
+        reverse_link_add(state_arena_handle(state), link->first);
 }
 
-uint16_t state_link_size(StateType *state){
-    assert(state);
-    StateLink **link_ref = _state_link_get_ref(state);
-    StateLink *link = *link_ref;
-    return link->size;
+void state_link_count(){
+    reverse_link_count();
 }
 
-void state_link_merge(StateType *state_base, StateType *state_to_merge){
-    assert(state_base && state_to_merge);
-    StateLink **link_base_ref = _state_link_get_ref(state_base);
-    StateLink *link_base = *link_base_ref;
-    StateLink **link_to_merge_ref = _state_link_get_ref(state_to_merge);
-    StateLink *link_to_merge = *link_to_merge_ref;
-    //Get lock
-    //Base
-    _state_link_lock(link_base);
-    //To_merge
-    _state_link_lock(link_to_merge);
-    //Region locked
-    //Count one link more
-    uint16_t old_size = link_base->size;
-    link_base->size = link_base->size + link_to_merge->size;
-     if(link_base->size > 0){
-        if(link_base->size ==1){
-            //The state ref is the pointer value
-            link_base->links = link_to_merge->links;
-        } else {
-            //Add link pointer
-            errno = 0;
-            StateType **list_new = NULL;
-            list_new = (StateType **) malloc(sizeof(StateType *)*link_base->size);
-            if(!list_new || errno){
-                fprintf(stderr, "state_link_add: Impossible do create new link %s",
-                       strerror(errno));
-                exit(EXIT_FAILURE);
-            }
-            //Copy old lists
-            if(old_size > 1){
-                memcpy(list_new, link_base->links, (old_size)*(sizeof(StateType **)));
-            }
-            else if(old_size == 1)
-                 *list_new = link_base->links;
+void state_link_alloc(){
+    reverse_link_alloc();
+}
 
-            if(link_to_merge->size > 1){
-                memcpy((list_new + old_size), link_to_merge->links,
-                    (link_to_merge->size)*(sizeof(StateType **)));
-            }
-            else if(link_to_merge->size == 1)
-                *(list_new + old_size) = link_to_merge->links;
-            //Save new links list
-            StateType * list_old = link_base->links;
-            link_base->links = list_new;
-            //Release old lists
-            if(old_size > 1)
-                free(list_old);
-            //free(link_to_merge->links);
-            //free(link_to_merge);
-            //Release lock
-        }
+void state_link_place(){
+    ReverseLinkIndex *link = NULL;
+    StateType *state = NULL;
+    ub8 links = 0;
+    //Predecessors of the states of the local table
+    hash_table_reset_iterator(state_local_store);
+    while((state = (StateType *) hash_table_iterate_next_not_locked(state_local_store)))
+        links += _state_link_get_ref(state)->size;
+    ub4 first = reverse_link_reserve(links);
+    hash_table_reset_iterator(state_local_store);
+    while((state = (StateType *) hash_table_iterate_next_not_locked(state_local_store))){
+        link = _state_link_get_ref(state);
+        link->first = first;
+        first += link->size;
+        //Counted again by state_link_fill
+        link->size = 0;
     }
-    //Release Locks
-    _state_link_unlock(link_base);
-    _state_link_unlock(link_to_merge);
-
 }
 
-void state_link_free(StateType *state){
-    assert(state);
-    StateLink **link_ref = _state_link_get_ref(state);
-    StateLink *link = *link_ref;
-    if(link->size > 1)
-        free(link->links);
-    free(link);
+void state_link_fill(){
+    reverse_link_fill();
 }
 
-void state_link_create(StateType *state, StateType *father){
-    assert(state);
-    StateLink *link = NULL;
-    errno = 0;
-    link = (StateLink *) malloc(sizeof(StateLink));
-    if(!link || errno){
-        fprintf(stderr, "state_link_create: Impossible do create new link %s",
-               strerror(errno));
-        exit(EXIT_FAILURE);
-    }
-    link->lock = (ub1) 1;
-    if(father)
-        link->size = 1;
-    else
-        link->size = 0;
-    //When only one link -  the reference links points directly to father
-    link->links = father;
-    //Atach to state
-    StateLink **link_reference = _state_link_get_ref(state);
-    *link_reference = link;
-    _state_link_unlock(link);
+ub4 state_link_get(StateType *state, const StateHandle **list){
+    assert(state && list);
+    const ReverseLinkIndex *link = _state_link_get_ref(state);
+    *list = reverse_link_get(link);
+    return link->size;
 }
 
 
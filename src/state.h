@@ -52,6 +52,7 @@
 #include "malloc_bucket.h"
 #include "marking.h"
 #include "hash_driver.h"
+#include "reverse_link.h"
 
 
 /**
@@ -308,6 +309,15 @@ extern HashWord state_hash(const StateType * state,
  */
 extern  HashWord state_hash_k(const StateType * state,int number);
 
+/*
+ * Hashes a given state into a wide (128 bits) value. Any number of hash values
+ * can be derived from it with hash_wide_k, instead of hashing the state once
+ * per value with state_hash_k.
+ * @param state State to be hashed
+ * @param wide Returned hash value
+ */
+extern void state_hash_wide(const StateType * state, HashWide *wide);
+
 
 /*
  * Print the state.
@@ -392,78 +402,52 @@ extern StateType * state_iterate_table(int id);
  */
 extern long state_overhead();
 
+/*
+ * Tells whether the states returned by the dictionary can be referenced by
+ * 32-bit handles (state_arena_handle): the states of the Localization Table,
+ * unless -malloc.
+ * @return 1 if they can, otherwise 0
+ */
+extern int state_handles();
+
 /*###########################################################################*/
 
 /*Reverse link Definitions*/
 /**
- * Link is a virtual definition of reverse arcs. It consists of three data:
- * 1) lock: a ub1 data type to emulate a lock - (CAS primitives)
- * 2) size: the number of arcs (ub1)
- * 3) links: an array of pointers, size is (size x 8) x ub1
- * It should look like this:
- */
-typedef struct StateLinkStruct{
-      ub1 lock;
-      uint16_t size;
-      StateType **links;
-   }StateLink;
-
-/**
- * Add a new link
- * @param state A valid state structure
- * @param father The state father
+ * The reverse arcs (-graph 0) are logged during the forward search, then 
+ * turned into a compressed index before the backward search (reverse_link.h).
+ * Each state keeps its ReverseLinkIndex, a state not yet in the dictionary
+ * keeps its father there.
  */
-extern void state_link_add(StateType *state, StateType *father);
-extern void state_link_add_father(StateType *state, StateType *father);
 
 /**
- * Recover a list with all links reversed connected to the given state
- * @param state A valid state structure
- * @param list The list of links
- * @return the number of links
+ * Sets the father of a new state
+ * @param state A valid state structure, not in the dictionary
+ * @param father The state father, in the dictionary
  */
-extern uint16_t state_link_get(StateType *state, StateType ** list);
+extern void state_link_add_father(StateType *state, StateType *father);
 
 /**
- * Return the father reference -- Only for Parental Graph
- * @param state A valid state structure
- * @return state pointer
+ * Builds the index of the reverse arcs, called by all threads of the 
+ * exploration in this order, separated by barriers:
+ * state_link_count, state_link_alloc (one thread), state_link_place and
+ * state_link_fill.
  */
-extern  StateType * state_link_get_father(StateType *state);
+extern void state_link_count();
+extern void state_link_alloc();
+extern void state_link_place();
+extern void state_link_fill();
 
 /**
- * Return the size of the virtual link structure
- * @param state A valid state structure
+ * Recover the list of all links reversed connected to the given state, once 
+ * the index is built
+ * @param state A valid state structure, in the dictionary
+ * @param list The handles of the fathers (state_arena_pointer)
+ * @return the number of links
  */
-extern uint16_t state_link_size(StateType *state);
+extern ub4 state_link_get(StateType *state, const StateHandle **list);
 extern int state_link_size_static();
 
-/**
- * Merge the list of links of state_to_merge with state_base
- * @param state_base A valid state structure to merge its link list
- * @param state_to_merge A valid state to be merged with state_base
- */
-extern void state_link_merge(StateType *state_base, StateType *state_to_merge);
-
-/**
- * Copy the first link structure to the second one
- * @param state A valid state structure to  be copied
- * @param state_to A valid state to be override
- */
-extern void state_link_copy_to(const StateType *state, StateType *state_to);
-
-/**
- * Release a state_link structure
- * @param state A valid state structure
- */
-extern void state_link_free(StateType *state);
-
-/**
- * Create a state_link structure attached to state
- * @param state A valid state structure
- */
-extern void state_link_create(StateType *state, StateType *father);
-
 /*###########################################################################*/
 
 /* Parental link Definitions
@@ -0,0 +1,205 @@
+/*
+ * File:    state_arena.c
+ * Author:  Rodrigo Tacla Saad
+ * Email:   rodrigo.tacla.saad@gmail.com
+ * Company: LAAS-CNRS / Vertics
+ * Created  on October 18, 2026, 6:10 PM
+ *
+ * LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * DESCRIPTION
+ *
+ * Per-thread slab arenas of the states. See state_arena.h
+ */
+
+#include "reset_define_includes.h"
+#define ASSERTLIB
+#define STDLIB
+#define ERRORLIB
+#define STDIOLIB
+#define PTHREADLIB
+#include "state_arena.h"
+#include "atomic_interface.h"
+
+//Chunks are aligned on their size, the first slot of a chunk keeps its index
+//in the directory: a slot is found from its handle, and its handle from its
+//address. Chunks are large enough for malloc to map them, their pages are 
+//placed when the owner touches them first
+#define STATE_ARENA_MIN_CHUNK_BITS 20
+#define STATE_ARENA_MIN_CHUNK_SLOTS 64
+
+typedef struct StateArenaStruct{
+    ub1 *chunk;                         //Last chunk
+    ub8 next;                           //Next unused slot of the last chunk
+    void *free_list;                    //Slots released, the first word of a 
+                                        //slot links the next one
+    ub8 chunk_count;                    //For stats: chunks allocated,
+    ub8 allocated;                      //slots handed out and released by
+    ub8 released;                       //this thread
+    struct StateArenaStruct *next_arena;
+}StateArena;
+
+static int _arena_slot_size = 0;
+static int _arena_chunk_bits = 0;
+static ub8 _arena_chunk_slots = 0;
+static int _arena_slot_bits = 0;        //Handle: chunk index, then the slot
+static ub1 **_arena_directory = NULL;   //Chunks by index
+static ub8 _arena_directory_size = 0;
+static volatile ub8 _arena_chunks = 0;
+static StateArena *_arena_all = NULL;
+static pthread_mutex_t _arena_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static __thread StateArena *arena_local = NULL;
+
+void state_arena_init(int slot_size){
+    assert(slot_size > 0);
+    //Keep the slots aligned on pointers, and large enough for the free list
+    _arena_slot_size = (slot_size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+    _arena_chunk_bits = STATE_ARENA_MIN_CHUNK_BITS;
+    while((((ub8) 1) << _arena_chunk_bits) 
+            < ((ub8) _arena_slot_size)*STATE_ARENA_MIN_CHUNK_SLOTS)
+        _arena_chunk_bits++;
+    _arena_chunk_slots = (((ub8) 1) << _arena_chunk_bits)/_arena_slot_size;
+    _arena_slot_bits = 0;
+    while((((ub8) 1) << _arena_slot_bits) < _arena_chunk_slots)
+        _arena_slot_bits++;
+    //Slot 0 of a chunk is its header, a handle is never 0
+    _arena_directory_size = ((ub8) 1) << (32 - _arena_slot_bits);
+    _arena_directory = (ub1 **) calloc(_arena_directory_size, sizeof(ub1 *));
+    if(_arena_directory==NULL)
+        ERRORMACRO(" state_arena: Impossible to create the directory\n");
+    _arena_chunks = 0;
+}
+
+static StateArena * _state_arena_create(){
+    assert(_arena_slot_size > 0);
+    StateArena *arena = (StateArena *) calloc(1, sizeof(StateArena));
+    if(arena==NULL)
+        ERRORMACRO(" state_arena: Impossible to create the arena\n");
+    //First chunk is allocated on demand
+    arena->next = _arena_chunk_slots;
+    pthread_mutex_lock(&_arena_mutex);
+    arena->next_arena = _arena_all;
+    _arena_all = arena;
+    pthread_mutex_unlock(&_arena_mutex);
+    return arena;
+}
+
+static void _state_arena_grow(StateArena *arena){
+    const ub8 index = _interface_atomic_add_64(&_arena_chunks, 1);
+    if(index >= _arena_directory_size)
+        ERRORMACRO(" state_arena: Out of handles, use -malloc\n");
+    ub1 *chunk = NULL;
+    const size_t bytes = ((size_t) 1) << _arena_chunk_bits;
+    if(posix_memalign((void **) &chunk, bytes, bytes) || chunk==NULL)
+        ERRORMACRO(" state_arena: Impossible to allocate a new chunk\n");
+    *((ub8 *) chunk) = index;
+    _arena_directory[index] = chunk;
+    arena->chunk = chunk;
+    arena->chunk_count++;
+    arena->next = 1;
+}
+
+void * state_arena_new(){
+    StateArena *arena = arena_local;
+    if(arena==NULL)
+        arena = arena_local = _state_arena_create();
+    arena->allocated++;
+    if(arena->free_list){
+        void *slot = arena->free_list;
+        arena->free_list = *((void **) slot);
+        return slot;
+    }
+    if(arena->next==_arena_chunk_slots)
+        _state_arena_grow(arena);
+    return arena->chunk + (arena->next++)*_arena_slot_size;
+}
+
+void state_arena_free(void *slot){
+    if(slot==NULL)
+        return;
+    StateArena *arena = arena_local;
+    if(arena==NULL)
+        arena = arena_local = _state_arena_create();
+    arena->released++;
+    *((void **) slot) = arena->free_list;
+    arena->free_list = slot;
+}
+
+StateHandle state_arena_handle(const void *slot){
+    assert(slot);
+    const ub1 *chunk = (const ub1 *) 
+            ((size_t) slot & ~((((size_t) 1) << _arena_chunk_bits) - 1));
+    return (StateHandle) ((*((const ub8 *) chunk) << _arena_slot_bits)
+            | (((const ub1 *) slot - chunk)/_arena_slot_size));
+}
+
+void * state_arena_pointer(StateHandle handle){
+    assert(handle);
+    return _arena_directory[handle >> _arena_slot_bits]
+            + (handle & ((((StateHandle) 1) << _arena_slot_bits) - 1))*_arena_slot_size;
+}
+
+long state_arena_overhead(){
+    return (((long) _arena_chunks) << _arena_chunk_bits) 
+            + _arena_directory_size*sizeof(ub1 *);
+}
+
+void state_arena_stats(){
+    ub8 allocated = 0, released = 0;
+    int arenas = 0;
+    StateArena *arena;
+    pthread_mutex_lock(&_arena_mutex);
+    for(arena = _arena_all; arena; arena = arena->next_arena){
+        arenas++;
+        allocated += arena->allocated;
+        released += arena->released;
+    }
+    pthread_mutex_unlock(&_arena_mutex);
+    fprintf(stdout, "\n State arenas:\t %d (%d bytes per slot)", arenas,
+            _arena_slot_size);
+    fprintf(stdout, "\n \t Chunks:\t %llu (%llu MiB, at most %llu)", 
+            (ub8) _arena_chunks, (ub8) (state_arena_overhead() >> 20),
+            _arena_directory_size);
+    fprintf(stdout, "\n \t Slots in use:\t %llu\n", allocated - released);
+}
+
+void state_arena_release(){
+    pthread_mutex_lock(&_arena_mutex);
+    ub8 i;
+    for(i=0; i < _arena_chunks && i < _arena_directory_size; i++){
+        free(_arena_directory[i]);
+        _arena_directory[i] = NULL;
+    }
+    _arena_chunks = 0;
+    while(_arena_all){
+        StateArena *arena = _arena_all;
+        _arena_all = arena->next_arena;
+        free(arena);
+    }
+    pthread_mutex_unlock(&_arena_mutex);
+    //The arenas of the threads are gone
+    arena_local = NULL;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file        state_arena.h
+ * @author      Rodrigo Tacla Saad
+ * @email       rodrigo.tacla.saad@gmail.com
+ * @company:    LAAS-CNRS / Vertics
+ * @created     on October 18, 2026, 6:10 PM
+ *
+ * @section LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Per-thread slab arenas of the states. A thread allocates its states from 
+ * its own chunks of fixed-size slots (bump allocation, then the slots released
+ * by the thread), without the per-allocation header and lock of malloc. 
+ * The chunks are touched first by the thread that fills them, so they are 
+ * placed on its memory node. A slot may be released by any thread: it goes to
+ * the arena of that thread. All chunks are released at once at the end of the
+ * run (state_arena_release).
+ * A slot is also referenced by a 32-bit handle (index of its chunk, then its
+ * index in the chunk), half the size of a pointer, for the structures holding
+ * large numbers of references to states (stacks, links).
+ *
+ */
+
+#ifndef _STATE_ARENA_H
+#define	_STATE_ARENA_H
+
+#include "standard_includes.h"
+
+//Compact reference of a slot, never 0
+typedef ub4 StateHandle;
+
+/**
+ * Sets the slot size of the arenas. Called once, before the exploration 
+ * threads.
+ * @param slot_size Bytes of a state (rounded up to a pointer)
+ */
+extern void state_arena_init(int slot_size);
+
+/**
+ * Returns a slot from the arena of the calling thread (created on first use).
+ * The slot is not cleared.
+ */
+extern void * state_arena_new();
+
+/**
+ * Gives a slot back to the arena of the calling thread.
+ * @param slot Slot returned by state_arena_new, by any thread
+ */
+extern void state_arena_free(void *slot);
+
+/**
+ * Returns the handle of a slot.
+ * @param slot Slot returned by state_arena_new
+ */
+extern StateHandle state_arena_handle(const void *slot);
+
+/**
+ * Returns the slot of a handle.
+ * @param handle Handle returned by state_arena_handle
+ */
+extern void * state_arena_pointer(StateHandle handle);
+
+/**
+ * Memory held by all arenas, in bytes.
+ */
+extern long state_arena_overhead();
+
+/**
+ * Prints the usage of the arenas.
+ */
+extern void state_arena_stats();
+
+/**
+ * Releases the chunks of all arenas. No slot may be used afterwards.
+ */
+extern void state_arena_release();
+
+#endif	/* _STATE_ARENA_H */
+
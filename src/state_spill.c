@@ -0,0 +1,311 @@
+/*
+ * File:    state_spill.c
+ * Author:  Rodrigo Tacla Saad
+ * Email:   rodrigo.tacla.saad@gmail.com
+ * Company: LAAS-CNRS / Vertics
+ * Created  on October 18, 2026, 4:40 PM
+ *
+ * LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * DESCRIPTION
+ *
+ * Spill of the local hash tables to disc past a threshold of resident memory.
+ * See state_spill.h
+ */
+
+#include "reset_define_includes.h"
+#define ASSERTLIB
+#define STDLIB
+#define ERRORLIB
+#define STRINGLIB
+#define STDIOLIB
+#define PTHREADLIB
+#include "state_spill.h"
+#include "partition.h"
+#include "atomic_interface.h"
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+//Ranges of hash values, one partition each
+#define SPILL_SEGMENT_BITS 8
+#define SPILL_SEGMENTS (1 << SPILL_SEGMENT_BITS)
+#define SPILL_INTERVAL_US 100000
+#define SPILL_SETTLE 10                 //Intervals of a generation
+#define SPILL_MIN_TABLE_BITS 10
+//Byte after a state in the local tables: its generation and whether it
+//waits on a stack for its expansion (the stacks keep references)
+#define SPILL_GENERATION_MASK 0x7f
+#define SPILL_PINNED 0x80
+#define SPILL_STATE_OVERHEAD 16         //Allocation header and alignment
+#define SPILL_MARGIN_SHIFT 4            //Growth (1/16 of the threshold) past
+                                        //the last spill before the next one
+
+static PartitionTable *_spill_table = NULL;
+static int _spill_slot_size = 0;
+static ub8 _spill_threshold = 0;
+static volatile ub1 _spill_on_disc[SPILL_SEGMENTS];
+static pthread_mutex_t _spill_locks[SPILL_SEGMENTS];
+//The generation ticks every SPILL_SETTLE intervals, the round when the
+//threads have to spill the states of _spill_old_generation and before
+static volatile ub8 _spill_generation = 0;
+static volatile ub8 _spill_old_generation = 0;
+static volatile ub8 _spill_round = 0;
+static volatile int _spill_stop = 0;
+static pthread_t _spill_monitor;
+//Stats
+static volatile ub8 _spill_states = 0;
+static volatile ub8 _spill_hits = 0;
+static ub8 _spill_peak = 0;
+
+__thread HashTable *spill_local_table = NULL;
+//The last state tested was found on disc
+__thread int spill_found = 0;
+__thread ub8 spill_round_seen = 0;
+__thread ub1 spill_old_generation = 0;     //Masked
+//States spilled by the last round of the thread and their ranges
+__thread void **spill_batch = NULL;
+__thread ub4 *spill_batch_segments = NULL;
+__thread ub8 spill_batch_count = 0;
+__thread ub8 spill_batch_capacity = 0;
+__thread ub8 spill_batch_generation = 0;
+
+//Resident set size of the process in bytes
+static ub8 _state_spill_rss(){
+    unsigned long pages = 0, resident = 0;
+    FILE *file = fopen("/proc/self/statm", "r");
+    if(file==NULL)
+        return 0;
+    if(fscanf(file, "%lu %lu", &pages, &resident)!=2)
+        resident = 0;
+    fclose(file);
+    return ((ub8) resident)*sysconf(_SC_PAGESIZE);
+}
+
+static inline ub4 _state_spill_segment(void *item){
+    ub8 key = (*spill_local_table->hash_table_get_key)(item);
+    return (ub4) (key >> (8*sizeof(HashWord) - SPILL_SEGMENT_BITS)) & (SPILL_SEGMENTS - 1);
+}
+
+static void * _state_spill_monitor(void * args){
+    int ticks = 0, settle = 0;
+    ub8 high = 0;
+    while(!_spill_stop){
+        usleep(SPILL_INTERVAL_US);
+        if(++ticks==SPILL_SETTLE){
+            ticks = 0;
+            _spill_generation++;
+        }
+        ub8 rss = _state_spill_rss();
+        if(rss > _spill_peak)
+            _spill_peak = rss;
+        if(settle > 0){
+            settle--;
+        } else if(rss > _spill_threshold && rss > high && _spill_generation > 0){
+            //Freed states are reused before the memory is given back: spill
+            //again only if it still grows
+            high = rss + (_spill_threshold >> SPILL_MARGIN_SHIFT);
+            //Keep what the threads inserted since the last generation
+            _spill_old_generation = _spill_generation - 1;
+            __sync_synchronize();
+            _spill_round++;
+            settle = SPILL_SETTLE;
+        }
+    }
+    return NULL;
+}
+
+void state_spill_init(const Net *net, int slot_size){
+    assert(net);
+    int i;
+    _spill_slot_size = slot_size;
+    _spill_threshold = (ub8) (MEMSPILL*(((ub8) 1) << 30));
+    for(i=0; i < SPILL_SEGMENTS; i++){
+        _spill_on_disc[i] = 0;
+        pthread_mutex_init(&_spill_locks[i], NULL);
+    }
+    //The summaries grow with the Localization Table
+    int table_size = HASHSIZE - SPILL_SEGMENT_BITS;
+    if(table_size < SPILL_MIN_TABLE_BITS)
+        table_size = SPILL_MIN_TABLE_BITS;
+    char prefix[strlen(net->name) + 7];
+    sprintf(prefix, "%s.spill", net->name);
+    _spill_table = partition_table_init(prefix, "/spill", SPILL_SEGMENTS, 
+                        slot_size, table_size);
+    for(i=0; i < SPILL_SEGMENTS; i++)
+        partition_get_number(_spill_table);
+    if(pthread_create(&_spill_monitor, NULL, &_state_spill_monitor, NULL))
+        ERRORMACRO(" Memory spill: Impossible to create the monitor");
+}
+
+void state_spill_init_local(HashTable *table){
+    assert(table);
+    spill_local_table = table;
+    spill_round_seen = 0;
+}
+
+void state_spill_stamp(void *item){
+    ub1 stamp = ((ub1) _spill_generation) & SPILL_GENERATION_MASK;
+    //A state read back from disc is not on a stack
+    if(!spill_found)
+        stamp |= SPILL_PINNED;
+    spill_found = 0;
+    ((ub1 *) item)[_spill_slot_size] = stamp;
+}
+
+void state_spill_unpin(void *item){
+    ((ub1 *) item)[_spill_slot_size] &= SPILL_GENERATION_MASK;
+}
+
+int state_spill_test(void *item){
+    ub4 segment = _state_spill_segment(item);
+    if(!_spill_on_disc[segment])
+        return 0;
+    pthread_mutex_lock(&_spill_locks[segment]);
+    spill_found = partition_search(_spill_table, segment + 1, item);
+    pthread_mutex_unlock(&_spill_locks[segment]);
+    if(spill_found)
+        _interface_atomic_inc_64(&_spill_hits);
+    return spill_found;
+}
+
+//States expanded and stamped with the old generation or before
+static inline int _state_spill_old(void *item){
+    ub1 stamp = ((ub1 *) item)[_spill_slot_size];
+    ub1 age = (spill_old_generation - stamp) & SPILL_GENERATION_MASK;
+    return !(stamp & SPILL_PINNED) && age <= (SPILL_GENERATION_MASK >> 1);
+}
+
+//HashTableEvict: moves the old states into the batch
+static int _state_spill_select(void *item){
+    if(!_state_spill_old(item))
+        return 0;
+    if(spill_batch_count==spill_batch_capacity){
+        spill_batch_capacity = (spill_batch_capacity > 0) ? 2*spill_batch_capacity : 1024;
+        spill_batch = (void **) realloc(spill_batch, spill_batch_capacity*sizeof(void *));
+        spill_batch_segments = (ub4 *) realloc(spill_batch_segments, 
+                                        spill_batch_capacity*sizeof(ub4));
+        if(spill_batch==NULL || spill_batch_segments==NULL)
+            ERRORMACRO(" Memory spill: Impossible to grow the batch of states");
+    }
+    spill_batch[spill_batch_count] = item;
+    spill_batch_segments[spill_batch_count] = _state_spill_segment(item);
+    spill_batch_count++;
+    return 1;
+}
+
+//Writes the batch as one sorted run per range of hash values
+static void _state_spill_write(){
+    ub8 counts[SPILL_SEGMENTS], starts[SPILL_SEGMENTS], i;
+    int s;
+    memset(counts, 0, sizeof(counts));
+    for(i=0; i < spill_batch_count; i++)
+        counts[spill_batch_segments[i]]++;
+    //Every range is followed by its scratch space (partition_append_sorted)
+    ub8 start = 0;
+    for(s=0; s < SPILL_SEGMENTS; s++){
+        starts[s] = start;
+        start += 2*counts[s];
+    }
+    ub1 **references = (ub1 **) malloc(start*sizeof(ub1 *));
+    if(references==NULL)
+        ERRORMACRO(" Memory spill: Impossible to sort the batch of states");
+    ub8 next[SPILL_SEGMENTS];
+    memcpy(next, starts, sizeof(next));
+    for(i=0; i < spill_batch_count; i++)
+        references[next[spill_batch_segments[i]]++] = (ub1 *) spill_batch[i];
+    for(s=0; s < SPILL_SEGMENTS; s++){
+        if(counts[s]==0)
+            continue;
+        pthread_mutex_lock(&_spill_locks[s]);
+        partition_append_sorted(_spill_table, s + 1, references + starts[s], counts[s]);
+        _spill_on_disc[s] = 1;
+        pthread_mutex_unlock(&_spill_locks[s]);
+    }
+    free(references);
+    _interface_atomic_add_64(&_spill_states, spill_batch_count);
+}
+
+//Other threads may still be comparing against the states of the last batch
+//and walking the array they were moved out of: both are released a 
+//generation later, under the table lock
+static void _state_spill_release(){
+    ub8 i;
+    for(i=0; i < spill_batch_count; i++)
+        (*spill_local_table->hash_table_free)(spill_batch[i]);
+    spill_batch_count = 0;
+    hash_table_free_retired(spill_local_table);
+#ifdef __GLIBC__
+    //Give the pages back, the threshold is on the resident memory
+    malloc_trim(0);
+#endif
+}
+
+void state_spill_evict(){
+    const int release = spill_batch_count > 0 
+            && spill_batch_generation!=_spill_generation;
+    if(!release && spill_round_seen==_spill_round)
+        return;
+    hash_table_lock(spill_local_table);
+    if(spill_batch_count > 0){
+        _state_spill_release();
+    }
+    if(spill_round_seen!=_spill_round){
+        spill_round_seen = _spill_round;
+        spill_old_generation = ((ub1) _spill_old_generation) & SPILL_GENERATION_MASK;
+        //The states kept are moved into a new array: it pays off only if 
+        //the old states take more memory than the array
+        ub8 old = 0;
+        void *item = NULL;
+        hash_table_reset_iterator(spill_local_table);
+        while((item = hash_table_iterate_next_not_locked(spill_local_table)))
+            old += _state_spill_old(item);
+        ub8 ev = 0;
+        if(old*(_spill_slot_size + 1 + SPILL_STATE_OVERHEAD) 
+                > (ub8) hash_table_overhead(spill_local_table))
+            ev = hash_table_evict(spill_local_table, &_state_spill_select);
+        if(ev > 0)
+            _state_spill_write();
+        spill_batch_generation = _spill_generation;
+    }
+    hash_table_unlock(spill_local_table);
+}
+
+void state_spill_stop(){
+    if(_spill_table==NULL)
+        return;
+    _spill_stop = 1;
+    pthread_join(_spill_monitor, NULL);
+    fprintf(stdout, "\n\n Memory spill: %.2f GiB threshold, %llu MiB peak\n", 
+            MEMSPILL, _spill_peak >> 20);
+    fprintf(stdout, " \t States spilled:\t %llu in %llu rounds\n", 
+            _spill_states, _spill_round);
+    fprintf(stdout, " \t States found on disc:\t %llu", _spill_hits);
+    partition_stats(_spill_table);
+    close(_spill_table->segment_fd);
+    unlink(_spill_table->segment_name);
+    _spill_table = NULL;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file        state_spill.h
+ * @author      Rodrigo Tacla Saad
+ * @email       rodrigo.tacla.saad@gmail.com
+ * @company:    LAAS-CNRS / Vertics
+ * @created     on October 18, 2026, 4:40 PM
+ *
+ * @section LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Spill of the local hash tables (Localization Table) to disc. It is idle 
+ * until the resident memory goes over a threshold (-mem_spill): the states 
+ * expanded and inserted before the previous generation (about one second) are
+ * then moved out of the tables and written as sorted runs of a partition table, one 
+ * partition per range of hash values. A state missing from a table is looked
+ * up on disc (summary first, then one block per run) only if its range has 
+ * been spilled; the states found there are inserted again.
+ *
+ */
+
+#ifndef _STATE_SPILL_H
+#define	_STATE_SPILL_H
+
+#include "standard_includes.h"
+#include "hash_table.h"
+#include "petri_net.h"
+
+/**
+ * Creates the partition table of the spilled states and starts the monitor
+ * of the resident memory. Called once, before the exploration threads.
+ * @param net Petri net reference (name of the segment file)
+ * @param slot_size Bytes of a state written to disc
+ */
+extern void state_spill_init(const Net *net, int slot_size);
+
+/**
+ * Registers the local hash table of the calling thread. It must be called
+ * before the table is shared (localization_table_config_local).
+ * @param table Local hash table, its items have one byte after the state
+ * (see state_spill_stamp)
+ */
+extern void state_spill_init_local(HashTable *table);
+
+/**
+ * Stamps an item of the local tables with the current generation. A new 
+ * state is pinned: it is not spilled before state_spill_unpin.
+ * @param item State about to be inserted into a local table
+ */
+extern void state_spill_stamp(void *item);
+
+/**
+ * Allows a state of the local tables to be spilled, once expanded.
+ * @param item State returned by the local tables
+ */
+extern void state_spill_unpin(void *item);
+
+/**
+ * Miss function of the local tables (HashTableMiss).
+ * @param item State not found in a local table
+ * @return 1 if the state had been spilled, otherwise 0
+ */
+extern int state_spill_test(void *item);
+
+/**
+ * Spills the old states of the local table of the calling thread when the 
+ * monitor asked for it, and releases the states spilled long enough ago. 
+ * Cheap otherwise: called by the exploration loop.
+ */
+extern void state_spill_evict();
+
+/**
+ * Stops the monitor, prints the statistics and removes the segment file.
+ */
+extern void state_spill_stop();
+
+#endif	/* _STATE_SPILL_H */
@@ -0,0 +1,257 @@
+/*
+ * File:    termination.c
+ * Author:  Rodrigo Tacla Saad
+ * Email:   rodrigo.tacla.saad@gmail.com
+ * Company: LAAS-CNRS / Vertics
+ * Created  on October 18, 2026, 2:40 PM
+ *
+ * LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * DESCRIPTION
+ *
+ * Termination detection for the work-stealing engines. It keeps a counter of
+ * busy threads (threads that may still hold or publish work) and one eventcount
+ * slot per thread. Idle threads park over their own slot (futex on Linux) and
+ * producers wake exactly one parked thread per published batch, instead of
+ * broadcasting a condition to every sleeper. The last thread to park detects
+ * the end of the phase. It is shared by the parallel explorer, the Localization
+ * Table false positive path, the disk (SSD) engine and the CTL backward search.
+ */
+
+#include "reset_define_includes.h"
+#define ASSERTLIB
+#define STDLIB
+#define ERRORLIB
+#define PTHREADLIB
+#include "termination.h"
+#include "atomic_interface.h"
+
+#ifdef __linux__
+    //Futex based eventcount
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+//Sleeps over the slot if its sequence number is still "key"
+static void _termination_sleep(TerminationSlot *slot, int key){
+#ifdef __linux__
+    syscall(SYS_futex, &slot->seq, FUTEX_WAIT_PRIVATE, key, NULL, NULL, 0);
+#else
+    pthread_mutex_lock(&slot->mutex);
+    if(slot->seq == key)
+        pthread_cond_wait(&slot->cond, &slot->mutex);
+    pthread_mutex_unlock(&slot->mutex);
+#endif
+}
+
+//Signals a new event over the slot and wakes up its owner
+static void _termination_wake(TerminationSlot *slot){
+    _interface_atomic_inc_32(&slot->seq);
+#ifdef __linux__
+    syscall(SYS_futex, &slot->seq, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#else
+    pthread_mutex_lock(&slot->mutex);
+    pthread_cond_signal(&slot->cond);
+    pthread_mutex_unlock(&slot->mutex);
+#endif
+}
+
+//Moves slot "id" from "parked" to busy. Only one thread can win the slot
+//transition and it is the one that counts the slot owner as busy again.
+static int _termination_claim(TerminationType *t, int id, int parked){
+    TerminationSlot *slot = t->slots + id;
+    if(slot->parked != parked
+            || _interface_atomic_cas_32(&slot->parked, parked,
+                                TERMINATION_SLOT_BUSY) != parked)
+        return 0;
+    if(parked == TERMINATION_SLOT_IDLE)
+        _interface_atomic_dec_32(&t->parked_threads);
+    _interface_atomic_inc_32(&t->busy);
+    return 1;
+}
+
+void termination_init(TerminationType *t, int number_of_threads,
+        int (*work_pending)(int)){
+    assert(t && number_of_threads > 0);
+    t->number_of_threads = number_of_threads;
+    t->busy = number_of_threads;
+    t->parked_threads = 0;
+    t->epoch = 0;
+    t->closed = 0;
+    t->work_pending = work_pending;
+    errno = 0;
+    t->slots = NULL;
+    if(posix_memalign((void **) &t->slots, 64,
+            number_of_threads*sizeof(TerminationSlot)) || !t->slots){
+        ERRORMACRO("Termination: Impossible to create parking slots.\n");
+    }
+    int i;
+    for(i = 0; i < number_of_threads; i++){
+        t->slots[i].seq = 0;
+        t->slots[i].parked = TERMINATION_SLOT_BUSY;
+#ifndef __linux__
+        pthread_mutex_init(&t->slots[i].mutex, NULL);
+        pthread_cond_init(&t->slots[i].cond, NULL);
+#endif
+    }
+    __sync_synchronize();
+}
+
+static TerminationWait _termination_park(TerminationType *t, int id, int mode){
+    assert(t && t->slots && id >= 0 && id < t->number_of_threads);
+    TerminationSlot *slot = t->slots + id;
+    const int epoch = t->epoch;
+    if(t->closed)
+        return TERMINATION_RELEASED;
+    //Publish the slot before leaving the busy set: a producer that pushes
+    //work after this point will see it
+    slot->parked = mode;
+    if(mode == TERMINATION_SLOT_IDLE)
+        _interface_atomic_inc_32(&t->parked_threads);
+    __sync_synchronize();
+    if(_interface_atomic_dec_32_nv(&t->busy) == 0){
+        //Nobody else is busy. If no work is left, this thread detects the
+        //end of the phase and stays as the only busy thread.
+        if(!(mode == TERMINATION_SLOT_IDLE && t->work_pending
+                    && t->work_pending(-1))
+                && _interface_atomic_cas_32(&t->busy, 0, 1) == 0){
+            slot->parked = TERMINATION_SLOT_BUSY;
+            if(mode == TERMINATION_SLOT_IDLE)
+                _interface_atomic_dec_32(&t->parked_threads);
+            __sync_synchronize();
+            return TERMINATION_LAST;
+        }
+    }
+
+    for(;;){
+        //Eventcount: read the key before the last checks
+        const int key = slot->seq;
+        __sync_synchronize();
+        if(slot->parked == TERMINATION_SLOT_BUSY)
+            //Woken up by a producer or released, it already counted us as busy
+            return (t->closed || t->epoch != epoch
+                        || mode == TERMINATION_SLOT_BARRIER) ?
+                    TERMINATION_RELEASED : TERMINATION_WORK;
+        if(t->closed || t->epoch != epoch){
+            if(_termination_claim(t, id, mode))
+                return TERMINATION_RELEASED;
+            continue;
+        }
+        if(mode == TERMINATION_SLOT_IDLE && t->work_pending
+                && t->work_pending(id)){
+            //Some work was published meanwhile
+            if(_termination_claim(t, id, mode))
+                return TERMINATION_WORK;
+            continue;
+        }
+        _termination_sleep(slot, key);
+    }
+}
+
+TerminationWait termination_wait(TerminationType *t, int id){
+    return _termination_park(t, id, TERMINATION_SLOT_IDLE);
+}
+
+int termination_barrier(TerminationType *t, int id){
+    return (_termination_park(t, id, TERMINATION_SLOT_BARRIER)
+            == TERMINATION_LAST);
+}
+
+void termination_notify(TerminationType *t, int from){
+    //Fast path, nobody is waiting for work
+    __sync_synchronize();
+    if(t->parked_threads <= 0)
+        return;
+    //Wake up exactly one thread, starting by the producer neighbours
+    const int number_of_threads = t->number_of_threads;
+    int i, n = from;
+    for(i = 1; i < number_of_threads; i++){
+        n = (n + 1 == number_of_threads) ? 0 : n + 1;
+        if(_termination_claim(t, n, TERMINATION_SLOT_IDLE)){
+            _termination_wake(t->slots + n);
+            return;
+        }
+    }
+}
+
+void termination_notify_thread(TerminationType *t, int id){
+    if(!t->slots)
+        return;
+    __sync_synchronize();
+    if(_termination_claim(t, id, TERMINATION_SLOT_IDLE))
+        _termination_wake(t->slots + id);
+}
+
+static void _termination_wake_all(TerminationType *t){
+    int i;
+    for(i = 0; i < t->number_of_threads; i++){
+        //Count released threads as busy on their behalf, before they run.
+        //The sequence is changed even if the slot is not parked, a thread
+        //that is about to sleep will notice it
+        const int parked = t->slots[i].parked;
+        if(parked != TERMINATION_SLOT_BUSY && _termination_claim(t, i, parked))
+            _termination_wake(t->slots + i);
+        else
+            _interface_atomic_inc_32(&t->slots[i].seq);
+    }
+}
+
+void termination_release(TerminationType *t){
+    if(!t->slots)
+        return;
+    _interface_atomic_inc_32(&t->epoch);
+    _termination_wake_all(t);
+}
+
+void termination_close(TerminationType *t){
+    if(!t->slots || t->closed)
+        return;
+    t->closed = 1;
+    __sync_synchronize();
+    _termination_wake_all(t);
+}
+
+int termination_is_closed(TerminationType *t){
+    return t->closed;
+}
+
+int termination_someone_is_idle(TerminationType *t){
+    return (t->parked_threads > 0);
+}
+
+void termination_free(TerminationType *t){
+    if(!t->slots)
+        return;
+#ifndef __linux__
+    int i;
+    for(i = 0; i < t->number_of_threads; i++){
+        pthread_mutex_destroy(&t->slots[i].mutex);
+        pthread_cond_destroy(&t->slots[i].cond);
+    }
+#endif
+    free(t->slots);
+    t->slots = NULL;
+}
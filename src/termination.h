@@ -0,0 +1,178 @@
+/**
+ * @file        termination.h
+ * @author      Rodrigo Tacla Saad
+ * @email       rodrigo.tacla.saad@gmail.com
+ * @company:    LAAS-CNRS / Vertics
+ * @created     on October 18, 2026, 2:40 PM
+ *
+ * @section LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Termination detection for the work-stealing engines. It keeps a counter of
+ * busy threads (threads that may still hold or publish work) and one eventcount
+ * slot per thread. Idle threads park over their own slot (futex on Linux) and
+ * producers wake exactly one parked thread per published batch, instead of
+ * broadcasting a condition to every sleeper. The last thread to park detects
+ * the end of the phase. It is shared by the parallel explorer, the Localization
+ * Table false positive path, the disk (SSD) engine and the CTL backward search.
+ *
+ */
+
+#ifndef _TERMINATION_H
+#define	_TERMINATION_H
+
+#include "standard_includes.h"
+
+/**
+ * Return values of termination_wait
+ */
+typedef enum TerminationWaitEnum{
+    TERMINATION_WORK,       //Woken up by a producer (or work found), look for work
+    TERMINATION_LAST,       //Last thread to park, the phase is over
+    TERMINATION_RELEASED    //Released by termination_release or termination_close
+}TerminationWait;
+
+/**
+ * Slot state
+ */
+#define TERMINATION_SLOT_BUSY 0
+#define TERMINATION_SLOT_IDLE 1     //Parked waiting for work
+#define TERMINATION_SLOT_BARRIER 2  //Parked waiting for a release only
+
+/**
+ * Parking slot, one per thread. "seq" is the eventcount word: a waiter reads
+ * it before its last check and only sleeps if it did not change. Slots are
+ * padded to avoid false sharing between neighbours.
+ */
+typedef struct TerminationSlotStruct{
+    volatile int seq;
+    volatile int parked;
+#ifndef __linux__
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+#endif
+    char pad[64 - 2*sizeof(int)];
+}TerminationSlot;
+
+/**
+ * Termination detection type. "busy" counts the threads that are not parked.
+ * It may only be incremented by a busy thread (on behalf of the thread it
+ * wakes up) or by a waking thread that owns its slot transition, so once it
+ * reaches zero with no pending work the phase is over.
+ */
+typedef struct TerminationStruct{
+    int number_of_threads;
+    volatile int busy;
+    char pad_busy[64 - 2*sizeof(int)];
+    volatile int parked_threads;
+    volatile int epoch;
+    volatile int closed;
+    char pad_parked[64 - 3*sizeof(int)];
+    TerminationSlot *slots;
+    /**
+     * Optional callback: returns 1 if there is still some published work
+     * (shared deques, false positive stacks...) that thread "id" can take, or
+     * any work at all if "id" is -1. Checked before parking.
+     */
+    int (*work_pending)(int id);
+}TerminationType;
+
+/**
+ * Init termination structure. All threads start busy.
+ * @param t termination structure
+ * @param number_of_threads
+ * @param work_pending callback or NULL
+ */
+extern void termination_init(TerminationType *t, int number_of_threads,
+        int (*work_pending)(int));
+
+/**
+ * Park thread "id" until some work is published, the phase is over or the
+ * threads are released.
+ * @param t termination structure
+ * @param id thread id
+ * @return TERMINATION_WORK, TERMINATION_LAST or TERMINATION_RELEASED
+ */
+extern TerminationWait termination_wait(TerminationType *t, int id);
+
+/**
+ * Barrier. All threads have to arrive, the last one returns 1 and has to call
+ * termination_release when its serial work is done. The others are only
+ * woken up by the release and return 0.
+ * @param t termination structure
+ * @param id thread id
+ * @return 1 for the last thread, 0 otherwise
+ */
+extern int termination_barrier(TerminationType *t, int id);
+
+/**
+ * Wakes up one parked thread (if any) after a batch of work is published.
+ * Cheap if nobody is parked.
+ * @param t termination structure
+ * @param from producer id, parked threads are searched from its neighbour
+ */
+extern void termination_notify(TerminationType *t, int from);
+
+/**
+ * Wakes up thread "id" if it is parked waiting for work. Used when work is
+ * pushed into a private stack of "id" (Localization Table false positives).
+ * @param t termination structure
+ * @param id thread id
+ */
+extern void termination_notify_thread(TerminationType *t, int id);
+
+/**
+ * Releases all parked threads (end of barrier or phase).
+ * @param t termination structure
+ */
+extern void termination_release(TerminationType *t);
+
+/**
+ * Releases all parked threads and closes the structure: every later wait
+ * returns TERMINATION_RELEASED.
+ * @param t termination structure
+ */
+extern void termination_close(TerminationType *t);
+
+/**
+ * @param t termination structure
+ * @return 1 if closed
+ */
+extern int termination_is_closed(TerminationType *t);
+
+/**
+ * @param t termination structure
+ * @return 1 if some thread is parked waiting for work
+ */
+extern int termination_someone_is_idle(TerminationType *t);
+
+/**
+ * Release memory.
+ * @param t termination structure
+ */
+extern void termination_free(TerminationType *t);
+
+#endif	/* _TERMINATION_H */
@@ -0,0 +1,339 @@
+/*
+ * File:    tree_table.c
+ * Author:  Rodrigo Tacla Saad
+ * Email:   rodrigo.tacla.saad@gmail.com
+ * Company: LAAS-CNRS / Vertics
+ * Created  on October 18, 2026, 10:12 AM
+ *
+ * LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * DESCRIPTION
+ *
+ * Tree compression table for the parallel exploration. A state (vector of
+ * bytes) is split recursively in two halves down to leaves of 7 bytes. Each
+ * leaf is interned in a shared table of leaves and each pair of halves in a
+ * shared table of nodes, so a state is stored as the index of its root pair.
+ * Similar states share most of their subtrees. Tables are open addressing with
+ * linear probing and buckets are claimed with a compare-and-swap: an entry is
+ * its own key (a leaf or a pair of indexes) and its index is the bucket
+ * position.
+ */
+
+#include "reset_define_includes.h"
+#define ASSERTLIB
+#define STDLIB
+#define ERRORLIB
+#define STRINGLIB
+#define STDIOLIB
+#include "tree_table.h"
+#include "hash_driver.h"
+#include "atomic_interface.h"
+
+//Bytes per leaf, the 8th byte holds the leaf mark (a leaf is never 0)
+#define TREE_TABLE_LEAF_BYTES 7
+#define TREE_TABLE_LEAF_MARK (((ub8) 1) << 56)
+#define TREE_TABLE_INDEX_MASK ((((ub8) 1) << 32) - 1)
+
+static void _tree_table_set_init(TreeTableSet *set, int size){
+    set->mask = (((ub8) 1) << size) - 1;
+    errno = 0;
+    set->table = (ub8 *) calloc(set->mask + 1, sizeof (ub8));
+    if(!set->table || errno != 0)
+        ERRORMACRO(" Tree table: Impossible to allocate buckets\n");
+}
+
+//Returns 1 if the key is new. Its index is returned in "index"
+static inline int _tree_table_set_put(TreeTableSet *set, ub8 key,
+        ub8 *index, const char *name){
+    volatile ub8 *buckets = (volatile ub8 *) set->table;
+    ub8 i = hash_word(key) & set->mask;
+    ub8 probe;
+    for (probe = 0; probe <= set->mask; probe++) {
+        ub8 bucket = buckets[i];
+        if(!bucket){
+            bucket = _interface_atomic_cas_64(buckets + i, (ub8) 0, key);
+            if(!bucket){
+                *index = i;
+                return 1;
+            }
+            //Lost the race, bucket holds the winner
+        }
+        if(bucket == key){
+            *index = i;
+            return 0;
+        }
+        i = (i + 1) & set->mask;
+    }
+    char message[255];
+    sprintf(message, " Tree table: FULL %s TABLE, increase it with -Hts\n", name);
+    ERRORMACRO(message);
+    return 0;
+}
+
+static inline int _tree_table_set_find(TreeTableSet *set, ub8 key, ub8 *index){
+    volatile ub8 *buckets = (volatile ub8 *) set->table;
+    ub8 i = hash_word(key) & set->mask;
+    ub8 probe;
+    for (probe = 0; probe <= set->mask; probe++) {
+        ub8 bucket = buckets[i];
+        if(!bucket)
+            return 0;
+        if(bucket == key){
+            *index = i;
+            return 1;
+        }
+        i = (i + 1) & set->mask;
+    }
+    return 0;
+}
+
+static inline ub8 _tree_table_leaf(const TreeTable *table, const ub1 *vector,
+        int leaf){
+    const int offset = leaf * TREE_TABLE_LEAF_BYTES;
+    int bytes = table->vector_size - offset;
+    if(bytes > TREE_TABLE_LEAF_BYTES)
+        bytes = TREE_TABLE_LEAF_BYTES;
+    ub8 key = 0;
+    memcpy(&key, vector + offset, bytes);
+    return key | TREE_TABLE_LEAF_MARK;
+}
+
+//Indexes are shifted by one, a pair is never 0
+static inline ub8 _tree_table_pair(ub8 left, ub8 right){
+    return ((left + 1) << 32) | (right + 1);
+}
+
+//Tree of the reference vector of the thread (the state being expanded): key
+//and index of every position (pre-order). A successor shares most of its
+//subtrees with its parent, only the positions whose key changed are looked up.
+__thread ub8 *tree_table_cache_keys = NULL;
+__thread ub8 *tree_table_cache_index = NULL;
+
+static void _tree_table_cache_init(TreeTable *table){
+    if(tree_table_cache_keys)
+        return;
+    //Less than 2n positions. Keys are never 0, the empty cache never hits
+    const int n = table->number_of_leaves;
+    errno = 0;
+    tree_table_cache_keys = (ub8 *) calloc(4 * n, sizeof (ub8));
+    if(!tree_table_cache_keys || errno != 0)
+        ERRORMACRO(" Tree table: Impossible to allocate the thread cache\n");
+    tree_table_cache_index = tree_table_cache_keys + 2 * n;
+}
+
+//Interns the subtree of "n" leaves starting at "first" and returns its index.
+//"position" is the pre-order position of the subtree. The reference tree is
+//updated only if "update" is set.
+static ub8 _tree_table_put(TreeTable *table, const ub1 *vector, int first,
+        int n, int *position, int update, TreeTableStats *stats){
+    const int p = (*position)++;
+    ub8 key, index;
+    if(n == 1){
+        key = _tree_table_leaf(table, vector, first);
+        if(tree_table_cache_keys[p] == key)
+            return tree_table_cache_index[p];
+        if(_tree_table_set_put(&table->leaves, key, &index, "LEAF"))
+            stats->leaves++;
+    } else {
+        const int half = (n + 1) / 2;
+        const ub8 left = _tree_table_put(table, vector, first, half,
+                position, update, stats);
+        const ub8 right = _tree_table_put(table, vector, first + half,
+                n - half, position, update, stats);
+        key = _tree_table_pair(left, right);
+        if(tree_table_cache_keys[p] == key)
+            return tree_table_cache_index[p];
+        if(_tree_table_set_put(&table->nodes, key, &index, "NODE"))
+            stats->nodes++;
+    }
+    if(update){
+        tree_table_cache_keys[p] = key;
+        tree_table_cache_index[p] = index;
+    }
+    return index;
+}
+
+//Same as _tree_table_put without insertion. Returns 0 if a subtree is missing
+static int _tree_table_lookup(TreeTable *table, const ub1 *vector, int first,
+        int n, ub8 *index){
+    if(n == 1)
+        return _tree_table_set_find(&table->leaves,
+                _tree_table_leaf(table, vector, first), index);
+    const int half = (n + 1) / 2;
+    ub8 left, right;
+    if(!_tree_table_lookup(table, vector, first, half, &left)
+            || !_tree_table_lookup(table, vector, first + half, n - half, &right))
+        return 0;
+    return _tree_table_set_find(&table->nodes, _tree_table_pair(left, right),
+            index);
+}
+
+static void _tree_table_get(TreeTable *table, ub8 index, int first, int n,
+        ub1 *vector){
+    if(n == 1){
+        const ub8 leaf = table->leaves.table[index];
+        const int offset = first * TREE_TABLE_LEAF_BYTES;
+        int bytes = table->vector_size - offset;
+        if(bytes > TREE_TABLE_LEAF_BYTES)
+            bytes = TREE_TABLE_LEAF_BYTES;
+        memcpy(vector + offset, &leaf, bytes);
+        return;
+    }
+    const int half = (n + 1) / 2;
+    const ub8 pair = table->nodes.table[index];
+    _tree_table_get(table, (pair >> 32) - 1, first, half, vector);
+    _tree_table_get(table, (pair & TREE_TABLE_INDEX_MASK) - 1, first + half,
+            n - half, vector);
+}
+
+TreeTable * tree_table_create(int size, int vector_size){
+    assert(size > 4 && vector_size > 0);
+    //Indexes are stored on 32 bits
+    if(size > 31)
+        ERRORMACRO(" Tree table: -Hts must be smaller than 31\n");
+    TreeTable *table = NULL;
+    errno = 0;
+    table = (TreeTable *) malloc(sizeof (TreeTable));
+    if(!table || errno != 0)
+        ERRORMACRO(" Tree table: Impossible to create the table\n");
+    memset(table, 0, sizeof (TreeTable));
+    table->vector_size = vector_size;
+    table->number_of_leaves = (vector_size + TREE_TABLE_LEAF_BYTES - 1)
+            / TREE_TABLE_LEAF_BYTES;
+    _tree_table_set_init(&table->roots, size);
+    _tree_table_set_init(&table->nodes, size);
+    _tree_table_set_init(&table->leaves, size - 4);
+    return table;
+}
+
+//Key of the root pair of a vector
+static ub8 _tree_table_root_key(TreeTable *table, const ub1 *vector,
+        int update, TreeTableStats *stats){
+    const int n = table->number_of_leaves;
+    _tree_table_cache_init(table);
+    int position = 0;
+    if(n == 1)
+        return _tree_table_pair(_tree_table_put(table, vector, 0, 1, &position,
+                update, stats), -1);
+    const int half = (n + 1) / 2;
+    const ub8 left = _tree_table_put(table, vector, 0, half, &position,
+            update, stats);
+    const ub8 right = _tree_table_put(table, vector, half, n - half, &position,
+            update, stats);
+    return _tree_table_pair(left, right);
+}
+
+void tree_table_reference(const void *vector, TreeTable *table, int id){
+    assert(vector && table);
+    _tree_table_root_key(table, (const ub1 *) vector, 1, table->stats + id);
+}
+
+int tree_table_find_or_put(const void *vector, TreeTable *table, int id,
+        ub8 *root){
+    assert(vector && table);
+    TreeTableStats *stats = table->stats + id;
+    stats->lookups++;
+    const ub8 key = _tree_table_root_key(table, (const ub1 *) vector, 0, stats);
+    if(_tree_table_set_put(&table->roots, key, root, "ROOT")){
+        stats->roots++;
+        return 1;
+    }
+    return 0;
+}
+
+int tree_table_find(const void *vector, TreeTable *table){
+    assert(vector && table);
+    const ub1 *v = (const ub1 *) vector;
+    const int n = table->number_of_leaves;
+    ub8 key, left, right, root;
+    if(n == 1){
+        if(!_tree_table_lookup(table, v, 0, 1, &left))
+            return 0;
+        key = _tree_table_pair(left, -1);
+    } else {
+        const int half = (n + 1) / 2;
+        if(!_tree_table_lookup(table, v, 0, half, &left)
+                || !_tree_table_lookup(table, v, half, n - half, &right))
+            return 0;
+        key = _tree_table_pair(left, right);
+    }
+    return _tree_table_set_find(&table->roots, key, &root);
+}
+
+void tree_table_get(TreeTable *table, ub8 root, void *vector){
+    assert(table && vector && root <= table->roots.mask);
+    ub1 *v = (ub1 *) vector;
+    const int n = table->number_of_leaves;
+    const ub8 pair = table->roots.table[root];
+    if(n == 1){
+        _tree_table_get(table, (pair >> 32) - 1, 0, 1, v);
+        return;
+    }
+    const int half = (n + 1) / 2;
+    _tree_table_get(table, (pair >> 32) - 1, 0, half, v);
+    _tree_table_get(table, (pair & TREE_TABLE_INDEX_MASK) - 1, half, n - half, v);
+}
+
+long tree_table_overhead(TreeTable *table){
+    return (long) ((table->roots.mask + table->nodes.mask
+            + table->leaves.mask + 3) * sizeof (ub8));
+}
+
+void tree_table_print(TreeTable *table, int number_of_threads){
+    long long lookups = 0, roots = 0, nodes = 0, leaves = 0;
+    int i;
+    for (i = 0; i < number_of_threads; i++) {
+        lookups += table->stats[i].lookups;
+        roots += table->stats[i].roots;
+        nodes += table->stats[i].nodes;
+        leaves += table->stats[i].leaves;
+    }
+    fprintf(stdout, "\n Tree Compression Table:\t\t\t");
+    fprintf(stdout, "\n \t Vector size:\t \t \t %d bytes (%d leaves) \t",
+            table->vector_size, table->number_of_leaves);
+    fprintf(stdout, "\n \t Roots:\t \t \t \t %lld (load %.3f) \t", roots,
+            (double) roots / (double) (table->roots.mask + 1));
+    fprintf(stdout, "\n \t Nodes:\t \t \t \t %lld (load %.3f) \t", nodes,
+            (double) nodes / (double) (table->nodes.mask + 1));
+    fprintf(stdout, "\n \t Leaves:\t \t \t %lld (load %.3f) \t", leaves,
+            (double) leaves / (double) (table->leaves.mask + 1));
+    fprintf(stdout, "\n \t Lookups:\t \t \t %lld \t", lookups);
+    if(roots){
+        fprintf(stdout, "\n \t Bytes per state (used):\t %.2f \t",
+                (double) ((roots + nodes + leaves) * sizeof (ub8)) / (double) roots);
+        fprintf(stdout, "\n \t Bytes per state (allocated):\t %.2f \t",
+                (double) tree_table_overhead(table) / (double) roots);
+    }
+    fprintf(stdout, "\n");
+}
+
+void tree_table_free(TreeTable *table){
+    if(!table)
+        return;
+    free(table->roots.table);
+    free(table->nodes.table);
+    free(table->leaves.table);
+    free(table);
+}
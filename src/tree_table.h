@@ -0,0 +1,150 @@
+/**
+ * @file        tree_table.h
+ * @author      Rodrigo Tacla Saad
+ * @email       rodrigo.tacla.saad@gmail.com
+ * @company:    LAAS-CNRS / Vertics
+ * @created     on October 18, 2026, 10:12 AM
+ *
+ * @section LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Tree compression table for the parallel exploration. A state (vector of
+ * bytes) is split recursively in two halves down to leaves of 7 bytes. Each
+ * leaf is interned in a shared table of leaves and each pair of halves in a
+ * shared table of nodes, so a state is stored as the index of its root pair.
+ * Similar states share most of their subtrees. Tables are open addressing with
+ * linear probing and buckets are claimed with a compare-and-swap: an entry is
+ * its own key (a leaf or a pair of indexes) and its index is the bucket
+ * position.
+ *
+ */
+
+#ifndef _TREE_TABLE_H
+#define	_TREE_TABLE_H
+
+#include "flags.h"
+#include "standard_includes.h"
+
+/**
+ * Set of words (keys) with open addressing. The index of a key is its bucket.
+ * The key 0 is an empty bucket.
+ */
+typedef struct TreeTableSetStruct{
+    ub8 *table;                             //Buckets
+    ub8 mask;                               //Number of buckets - 1
+}TreeTableSet;
+
+/**
+ * Per thread statistics
+ */
+typedef struct TreeTableStatsStruct{
+    long long lookups;                      //Calls to find_or_put
+    long long roots;                        //New states
+    long long nodes;                        //New nodes
+    long long leaves;                       //New leaves
+    char padding[32];
+}TreeTableStats;
+
+/**
+ * Tree compression table. Roots are kept apart from the inner nodes: a state
+ * is new if and only if its root pair is new.
+ */
+typedef struct TreeTableStruct{
+    TreeTableSet roots;                     //One entry per state
+    TreeTableSet nodes;                     //Inner nodes, shared by all states
+    TreeTableSet leaves;                    //Leaves, shared by all states
+    int vector_size;                        //Size in bytes of the vectors
+    int number_of_leaves;                   //Leaves per vector
+    //For stats, one cache line per thread
+    TreeTableStats stats[MAX_NUMBER_OF_THREADS];
+}TreeTable;
+
+/**
+ * Creates a tree compression table. The tables of roots and of nodes have
+ * 2^size buckets and the table of leaves 2^(size-4).
+ * @param size The number of root buckets in bits
+ * @param vector_size Size in bytes of the vectors (states)
+ * @return A TreeTable reference
+ */
+extern TreeTable * tree_table_create(int size, int vector_size);
+
+/**
+ * Sets the reference vector of the calling thread, usually the state being
+ * expanded. The next insertions only look up the subtrees that differ from it.
+ * @param vector Reference vector
+ * @param table The TreeTable reference
+ * @param id Thread id (for stats)
+ */
+extern void tree_table_reference(const void *vector, TreeTable *table, int id);
+
+/**
+ * Searches a vector and inserts it if it is not part of the table.
+ * @param vector Vector to be searched
+ * @param table The TreeTable reference
+ * @param id Thread id (for stats)
+ * @param root Returns the index of the root of the vector
+ * @return 1 if the vector was inserted (new), 0 if it was already there
+ */
+extern int tree_table_find_or_put(const void *vector, TreeTable *table,
+        int id, ub8 *root);
+
+/**
+ * Searches a vector.
+ * @param vector Vector to be searched
+ * @param table The TreeTable reference
+ * @return 1 if the vector is part of the table, 0 otherwise
+ */
+extern int tree_table_find(const void *vector, TreeTable *table);
+
+/**
+ * Rebuilds the vector stored under a root index.
+ * @param table The TreeTable reference
+ * @param root Root index returned by tree_table_find_or_put
+ * @param vector Returned vector (vector_size bytes)
+ */
+extern void tree_table_get(TreeTable *table, ub8 root, void *vector);
+
+/**
+ * Returns the memory space used by the three tables.
+ * @param table The TreeTable reference
+ * @return Size in bytes
+ */
+extern long tree_table_overhead(TreeTable *table);
+
+/**
+ * Prints statistics about the table.
+ * @param table The TreeTable reference
+ * @param number_of_threads Number of threads that used the table
+ */
+extern void tree_table_print(TreeTable *table, int number_of_threads);
+
+/**
+ * Releases the table.
+ * @param table The TreeTable reference
+ */
+extern void tree_table_free(TreeTable *table);
+
+#endif	/* _TREE_TABLE_H */
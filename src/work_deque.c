@@ -0,0 +1,250 @@
+/*
+ * File:    work_deque.c
+ * Author:  Rodrigo Tacla Saad
+ * Email:   rodrigo.tacla.saad@gmail.com
+ * Company: LAAS-CNRS / Vertics
+ * Created  on October 18, 2026, 10:12 AM
+ *
+ * LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * DESCRIPTION
+ *
+ * Lock-free work-stealing deque (Chase-Lev). See work_deque.h.
+ */
+
+#include "reset_define_includes.h"
+#define STDIOLIB
+#define ERRORLIB
+#define ASSERTLIB
+#define STDLIB
+#define STRINGLIB
+#include "work_deque.h"
+
+#include "atomic_interface.h"
+
+//Full memory barrier (GCC builtin)
+#define _work_deque_fence() __sync_synchronize()
+
+//Bytes of an element: a pointer, or a handle
+#define _WORK_DEQUE_ELEMENT_SIZE(deque) ((deque)->encode ? sizeof(ub4) : sizeof(void *))
+
+static WorkDequeArray * _work_deque_array_new(long size, size_t element_size){
+    errno = 0;
+    WorkDequeArray *array = NULL;
+    array = (WorkDequeArray *) malloc(sizeof(WorkDequeArray));
+    if (array==NULL || errno != 0){
+        ERRORMACRO("Work_Deque: Impossible to create new Deque.\n");
+    }
+    errno = 0;
+    array->vector = NULL;
+    array->vector = (void **) malloc(element_size*size);
+    if (array->vector==NULL || errno != 0){
+        ERRORMACRO("Work_Deque: Impossible to create new Deque.\n");
+    }
+    array->size = size;
+    array->mask = size - 1;
+    array->retired = NULL;
+    return array;
+}
+
+static WorkDequeType * _work_deque_init(StackEncode encode, StackDecode decode){
+    errno = 0;
+    WorkDequeType *deque = NULL;
+    if(posix_memalign((void **) &deque, 64, sizeof(WorkDequeType)) || deque==NULL){
+        ERRORMACRO("Work_Deque: Impossible to create new Deque.\n");
+    }
+    deque->encode = encode;
+    deque->decode = decode;
+    //Circular array size has to be a power of two
+    long size = 1;
+    while(size < STACKSIZE)
+        size <<= 1;
+    deque->array = _work_deque_array_new(size, _WORK_DEQUE_ELEMENT_SIZE(deque));
+    deque->top = 0;
+    deque->bottom = 0;
+    deque->peak_size = size;
+    deque->peak_head = 0;
+    return deque;
+}
+
+WorkDequeType * work_deque_init(){
+    return _work_deque_init(NULL, NULL);
+}
+
+WorkDequeType * work_deque_init_handles(StackEncode encode, StackDecode decode){
+    assert(encode && decode);
+    return _work_deque_init(encode, decode);
+}
+
+static inline void _work_deque_set(const WorkDequeType *deque, 
+        WorkDequeArray *array, long i, void *data){
+    if(deque->encode)
+        ((ub4 *) array->vector)[i & array->mask] = (*deque->encode)(data);
+    else
+        array->vector[i & array->mask] = data;
+}
+
+static inline void * _work_deque_get(const WorkDequeType *deque, 
+        const WorkDequeArray *array, long i){
+    if(deque->encode)
+        return (*deque->decode)(((ub4 *) array->vector)[i & array->mask]);
+    return array->vector[i & array->mask];
+}
+
+//Owner only. Elements from [top, bottom) are copied into a twice bigger array.
+static WorkDequeArray * _work_deque_grow(WorkDequeType *deque, long bottom, long top){
+    WorkDequeArray *old = deque->array;
+    WorkDequeArray *new = _work_deque_array_new(old->size*2, 
+            _WORK_DEQUE_ELEMENT_SIZE(deque));
+    register long i;
+    if(deque->encode)
+        for(i = top; i < bottom; i++)
+            ((ub4 *) new->vector)[i & new->mask] 
+                    = ((ub4 *) old->vector)[i & old->mask];
+    else
+        for(i = top; i < bottom; i++)
+            new->vector[i & new->mask] = old->vector[i & old->mask];
+    //Old array may still be read by a thief
+    new->retired = old;
+    _work_deque_fence();
+    deque->array = new;
+    if(deque->peak_size < new->size)
+        deque->peak_size = new->size;
+    return new;
+}
+
+void work_deque_push(WorkDequeType *deque, void *data){
+    assert(deque && data);
+    const long bottom = deque->bottom;
+    const long top = deque->top;
+    WorkDequeArray *array = deque->array;
+    if(bottom - top >= array->size)
+        array = _work_deque_grow(deque, bottom, top);
+    _work_deque_set(deque, array, bottom, data);
+    //Save peak head size
+    if(deque->peak_head < (unsigned long) (bottom - top + 1))
+        deque->peak_head = bottom - top + 1;
+    //Element has to be visible before the new bottom
+    _work_deque_fence();
+    deque->bottom = bottom + 1;
+}
+
+void * work_deque_pop(WorkDequeType *deque){
+    assert(deque);
+    const long bottom = deque->bottom - 1;
+    WorkDequeArray *array = deque->array;
+    deque->bottom = bottom;
+    _work_deque_fence();
+    const long top = deque->top;
+    if(top > bottom){
+        //Empty
+        deque->bottom = bottom + 1;
+        return NULL;
+    }
+    void *data = _work_deque_get(deque, array, bottom);
+    if(top == bottom){
+        //Last element, race against thieves
+        if(_interface_atomic_cas_64(&(deque->top), top, top + 1) != top)
+            data = NULL;
+        deque->bottom = bottom + 1;
+    }
+    return data;
+}
+
+void * work_deque_steal(WorkDequeType *deque){
+    assert(deque);
+    const long top = deque->top;
+    _work_deque_fence();
+    const long bottom = deque->bottom;
+    if(top >= bottom)
+        return NULL;
+    WorkDequeArray *array = deque->array;
+    void *data = _work_deque_get(deque, array, top);
+    if(_interface_atomic_cas_64(&(deque->top), top, top + 1) != top)
+        //Lost the race against another thief or the owner
+        return NULL;
+    return data;
+}
+
+int work_deque_steal_half(WorkDequeType *deque, StackType *stack, int max){
+    assert(deque && stack);
+    long available = deque->bottom - deque->top;
+    if(available <= 0 || max <= 0)
+        return 0;
+    long batch = (available + 1)/2;
+    if(batch > max)
+        batch = max;
+    register int stolen = 0;
+    //Retries are bounded, a failed CAS means someone else is consuming this deque
+    register int retries = 0;
+    while(stolen < batch){
+        void *data = work_deque_steal(deque);
+        if(data){
+            stack_push(stack, data);
+            stolen++;
+        } else if(work_deque_empty(deque) || ++retries > batch)
+            break;
+    }
+    return stolen;
+}
+
+int work_deque_empty(const WorkDequeType *deque){
+    assert(deque);
+    return (deque->bottom <= deque->top);
+}
+
+long work_deque_size(const WorkDequeType *deque){
+    assert(deque);
+    const long size = deque->bottom - deque->top;
+    return (size > 0) ? size : 0;
+}
+
+long work_deque_overhead(WorkDequeType *deque, int state_size,
+            StackOverhead overhead){
+    assert(deque);
+    long overhead_bytes = sizeof(WorkDequeType);
+    //Current and retired arrays
+    WorkDequeArray *array = deque->array;
+    while(array){
+        overhead_bytes += sizeof(WorkDequeArray) 
+                + array->size*_WORK_DEQUE_ELEMENT_SIZE(deque);
+        array = array->retired;
+    }
+    if(overhead == STACK_OVERHEAD_WITH_STATES)
+        overhead_bytes += deque->peak_head*state_size;
+    return overhead_bytes;
+}
+
+void work_deque_free(WorkDequeType *deque){
+    assert(deque);
+    WorkDequeArray *array = deque->array, *next = NULL;
+    while(array){
+        next = array->retired;
+        free(array->vector);
+        free(array);
+        array = next;
+    }
+    free(deque);
+}
@@ -0,0 +1,164 @@
+/**
+ * @file        work_deque.h
+ * @author      Rodrigo Tacla Saad
+ * @email       rodrigo.tacla.saad@gmail.com
+ * @company:    LAAS-CNRS / Vertics
+ * @created     on October 18, 2026, 10:12 AM
+ *
+ * @section LICENSE
+ *
+ * MIT License
+ *
+ * Copyright LAAS-CNRS / Vertics
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @section DESCRIPTION
+ *
+ * Lock-free work-stealing deque (Chase-Lev) used to publish work among threads.
+ * The owner thread pushes and pops at the bottom end without any lock, while
+ * thieves take elements from the top end with a single compare-and-swap each.
+ * Thieves always steal a batch: half of the elements observed in the victim
+ * deque (bounded by the caller), which replaces the fixed size pop/push loops
+ * over mutex protected stacks used before.
+ *
+ */
+
+#ifndef _WORK_DEQUE_H
+#define	_WORK_DEQUE_H
+
+#include "standard_includes.h"
+
+#include "stack.h"
+
+/**
+ * Circular array of the deque. Its size is always a power of two. When the
+ * owner has to grow the deque, the old array is kept into the retired list
+ * because a late thief may still be reading from it. Retired arrays are only
+ * released by work_deque_free.
+ */
+typedef struct WorkDequeArrayStruct{
+    long size;
+    long mask;
+    void **vector;
+    struct WorkDequeArrayStruct *retired;
+}WorkDequeArray;
+
+/**
+ * Work deque type. "top" is only modified by CAS (thieves and the owner when
+ * it competes for the last element) and "bottom" only by the owner. They are
+ * kept into different cache lines to avoid false sharing between the owner
+ * and the thieves.
+ */
+typedef struct WorkDequeStructType{
+    volatile long top;
+    char pad_top[64 - sizeof(long)];
+    volatile long bottom;
+    WorkDequeArray * volatile array;
+    //For stats
+    unsigned long peak_size;
+    unsigned long peak_head;
+    //Elements kept as handles (vector of ub4) if set
+    StackEncode encode;
+    StackDecode decode;
+    char pad_bottom[64 - 3*sizeof(long) - 3*sizeof(void *)];
+}WorkDequeType;
+
+/**
+ * Creates a new empty deque.
+ * @return a valid WorkDequeType reference
+ */
+extern WorkDequeType * work_deque_init();
+
+/**
+ * Creates a new empty deque that keeps its elements as 32-bit handles.
+ * @param encode called on push
+ * @param decode called on pop and steal
+ * @return a valid WorkDequeType reference
+ */
+extern WorkDequeType * work_deque_init_handles(StackEncode encode,
+        StackDecode decode);
+
+/**
+ * Pushes an element at the bottom of the deque. Owner only.
+ * @param deque a valid WorkDequeType reference
+ * @param data the element to be pushed (not NULL)
+ */
+extern void work_deque_push(WorkDequeType *deque, void *data);
+
+/**
+ * Pops the last pushed element from the bottom of the deque. Owner only.
+ * @param deque a valid WorkDequeType reference
+ * @return the element or NULL if the deque is empty
+ */
+extern void * work_deque_pop(WorkDequeType *deque);
+
+/**
+ * Steals one element from the top of the deque. Any thread.
+ * @param deque a valid WorkDequeType reference
+ * @return the element or NULL if the deque is empty or the race was lost
+ */
+extern void * work_deque_steal(WorkDequeType *deque);
+
+/**
+ * Steals half of the elements observed in the deque (at least one and at
+ * most "max") and pushes them into the private stack of the caller. Each
+ * element is claimed by its own CAS over top, so the batch never overlaps
+ * with the owner pops.
+ * @param deque a valid WorkDequeType reference (the victim)
+ * @param stack the private stack of the thief
+ * @param max upper bound for the batch
+ * @return number of stolen elements
+ */
+extern int work_deque_steal_half(WorkDequeType *deque, StackType *stack, int max);
+
+/**
+ * Test if the deque is empty. The answer is only a hint when called by a
+ * thread that is not the owner.
+ * @param deque a valid WorkDequeType reference
+ * @return 1 if the deque is empty or 0 otherwise
+ */
+extern int work_deque_empty(const WorkDequeType *deque);
+
+/**
+ * Number of elements into the deque (hint for non owners).
+ * @param deque a valid WorkDequeType reference
+ * @return number of elements
+ */
+extern long work_deque_size(const WorkDequeType *deque);
+
+/**
+ * Return memory overhead caused by the deque. Same semantic as stack_overhead.
+ * @param deque a valid WorkDequeType reference
+ * @param state_size the state size in bytes
+ * @param overhead take or not into account the states
+ * @return memory overhead in bytes
+ */
+extern long work_deque_overhead(WorkDequeType *deque, int state_size,
+            StackOverhead overhead);
+
+/**
+ * Releases the deque and all its retired arrays. No other thread may access
+ * the deque at this point.
+ * @param deque a valid WorkDequeType reference
+ */
+extern void work_deque_free(WorkDequeType *deque);
+
+#endif	/* _WORK_DEQUE_H */
+
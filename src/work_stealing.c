@@ -47,67 +47,64 @@ WorkStealingType work_stealing_global_sharing;
 
 const int work_stealing_get = 100;
 
-int work_stealing_close_after_last_one = 0;
-
-//
-typedef enum WorkStealingStateEnum{WS_BUSY, WS_END, WS_CLOSED}WorkStealingState;
-int global_state = WS_CLOSED;
+//Published work for the termination detection
+static int _work_stealing_work_pending(int id){
+    int i;
+    for (i = 0; i < work_stealing_global_sharing.number_of_threads; i++) {
+        if(!work_deque_empty(work_stealing_global_sharing.shared_stacks[i]))
+            return 1;
+    }
+    return 0;
+}
 
 void work_stealing_config(int number_of_threads){
     assert(number_of_threads > 0);    
     work_stealing_global_sharing.number_of_threads = number_of_threads;
-    //Init Parking
-    pthread_cond_init(&work_stealing_global_sharing.cond_wait_work, NULL);
-    pthread_cond_init(&work_stealing_global_sharing.cond_wait_restart, NULL);
-    pthread_mutex_init(&work_stealing_global_sharing.mutex_wait_work, NULL);
-    pthread_mutex_init(&work_stealing_global_sharing.mutex_wait_restart, NULL);
-    work_stealing_global_sharing.number_of_parked_threads = 0;
     //Alloc memory
-    //Alloc Stacks and mutex
+    //Alloc shared deques
     errno=0;
     work_stealing_global_sharing.shared_stacks
-            = (StackType **) malloc(number_of_threads*sizeof(StackType *));
-    work_stealing_global_sharing.mutex_shared_stack
-            = (pthread_mutex_t *) malloc(number_of_threads*sizeof(pthread_mutex_t));
-    //Loop to init mutex and stacks
+            = (WorkDequeType **) malloc(number_of_threads*sizeof(WorkDequeType *));
+    if(!work_stealing_global_sharing.shared_stacks || errno!=0){
+        ERRORMACRO("Work Stealing: Impossible to create shared deques.\n");
+    }
+    //Loop to init deques
     int i = 0;
     for (i = 0; i < NUMBEROFTHREADS; i++) {
-        //Mutex
-        pthread_mutex_init((work_stealing_global_sharing.mutex_shared_stack + i), NULL);
-        //Stack
-        work_stealing_global_sharing.shared_stacks[i] = stack_init();
+        work_stealing_global_sharing.shared_stacks[i] = work_deque_init();
     }
-    //Start Work Stealing
-    global_state = WS_BUSY;
+    //Start Work Stealing: init parking and termination detection
+    termination_free(&work_stealing_global_sharing.termination);
+    termination_init(&work_stealing_global_sharing.termination,
+            number_of_threads, &_work_stealing_work_pending);
 }
 
 void work_stealing_share_work(StackType *stack, int size, int id){
     assert(stack && size > 0);
-    register int i=0;    
-    pthread_mutex_lock((work_stealing_global_sharing.mutex_shared_stack + id));
-    StackType *st = work_stealing_global_sharing.shared_stacks[id];
+    register int i=0;
+    //Only the owner (id) pushes into its deque, no lock needed
+    WorkDequeType *st = work_stealing_global_sharing.shared_stacks[id];
     while (i < size && !stack_empty(stack)) {
-        stack_push(st,stack_pop(stack));
+        work_deque_push(st,stack_pop(stack));
         i++;
    }
-   pthread_mutex_unlock((work_stealing_global_sharing.mutex_shared_stack + id));
 }
 
 int work_stealing_shared_stack_empty(int id){
-    return stack_empty(work_stealing_global_sharing.shared_stacks[id]);
+    return work_deque_empty(work_stealing_global_sharing.shared_stacks[id]);
 }
 
 int work_stealing_get_work(StackType *stack, int id){
     assert(stack);
-    StackType *st = work_stealing_global_sharing.shared_stacks[id];
+    WorkDequeType *st = work_stealing_global_sharing.shared_stacks[id];
     register int l=0;
-    pthread_mutex_lock((work_stealing_global_sharing.mutex_shared_stack + id));
-    while(!stack_empty(st)
-            && (l < work_stealing_get)){
-        stack_push(stack, stack_pop(st));
+    void *data = NULL;
+    //Take back its own work first (owner side)
+    while((l < work_stealing_get)
+            && (data = work_deque_pop(st))){
+        stack_push(stack, data);
         l++;
     }
-    pthread_mutex_unlock((work_stealing_global_sharing.mutex_shared_stack + id));
     if(l > 0)
         return l;
 
@@ -126,25 +123,14 @@ int work_stealing_get_work(StackType *stack, int id){
             n2 -= number_of_threads;
         else if (n2 < 0)
             n2 *= -1;
-        /*Acquire Mutex for the manipulation of the nth shared_stack*/        
-        pthread_mutex_lock((work_stealing_global_sharing.mutex_shared_stack+ n1));
-        st = work_stealing_global_sharing.shared_stacks[n1];
-        while (!stack_empty(st) && j < work_stealing_get/**/) {
-            stack_push(stack, stack_pop(st));
-            j += 1;
-        }
-        pthread_mutex_unlock((work_stealing_global_sharing.mutex_shared_stack +n1));
-
-        if(n1!=id && n2!=id && j < work_stealing_get && n2!=n1){
-            //If not enough work had been found, tries another shared stack
-            /*Acquire Mutex for the manipulation of the nth shared_stack*/
-            pthread_mutex_lock((work_stealing_global_sharing.mutex_shared_stack + n2));
-            st = work_stealing_global_sharing.shared_stacks[n2];
-            while (!stack_empty(st) && j < work_stealing_get/**/) {
-                stack_push(stack, stack_pop(st));
-                j += 1;
-            }
-            pthread_mutex_unlock((work_stealing_global_sharing.mutex_shared_stack + n2));
+        //Steal half of the nth shared deque (at most work_stealing_get)
+        j += work_deque_steal_half(work_stealing_global_sharing.shared_stacks[n1],
+                stack, work_stealing_get);
+
+        if(n1!=id && n2!=id && j == 0 && n2!=n1){
+            //If no work had been found, tries another shared deque
+            j += work_deque_steal_half(work_stealing_global_sharing.shared_stacks[n2],
+                    stack, work_stealing_get);
         }
         if (!stack_empty(stack))
             not_found_work = 0;
@@ -154,117 +140,33 @@ int work_stealing_get_work(StackType *stack, int id){
     return j;
 }
 
-int work_stealing_wait_for_work(){    
-
-    pthread_mutex_lock(&work_stealing_global_sharing.mutex_wait_restart);
-    if(global_state == WS_END){
-        //change state
-        pthread_cond_wait(&work_stealing_global_sharing.cond_wait_restart,
-            &work_stealing_global_sharing.mutex_wait_restart);
-    } else if(global_state == WS_CLOSED){
-        pthread_mutex_unlock(&work_stealing_global_sharing.mutex_wait_restart);
-        return 0;
-    }
-    pthread_mutex_unlock(&work_stealing_global_sharing.mutex_wait_restart);
-
-    pthread_mutex_lock(&work_stealing_global_sharing.mutex_wait_work);
-    work_stealing_global_sharing.number_of_parked_threads++;
-    if(work_stealing_global_sharing.number_of_parked_threads
-            == work_stealing_global_sharing.number_of_threads){
-        //Dec number of parked threads
-        work_stealing_global_sharing.number_of_parked_threads--;
-        //Change Global State
-        pthread_mutex_lock(&work_stealing_global_sharing.mutex_wait_restart);
-        if(work_stealing_global_sharing.number_of_parked_threads!=0)
-            global_state = WS_END;
-        pthread_mutex_unlock(&work_stealing_global_sharing.mutex_wait_restart);
-        
-        //Everybody idle
-        //Wake up
-        //pthread_cond_broadcast(&work_stealing_global_sharing.cond_wait_work);
-        pthread_mutex_unlock(&work_stealing_global_sharing.mutex_wait_work);
-        return 1; //over
-    } else {
-        pthread_cond_wait(&work_stealing_global_sharing.cond_wait_work,
-                &work_stealing_global_sharing.mutex_wait_work);
-        work_stealing_global_sharing.number_of_parked_threads--;
-        if(work_stealing_global_sharing.number_of_parked_threads==0){
-            pthread_mutex_lock(&work_stealing_global_sharing.mutex_wait_restart);
-            if(global_state != WS_CLOSED)
-                global_state = WS_BUSY;
-            pthread_cond_broadcast(&work_stealing_global_sharing.cond_wait_restart);
-            pthread_mutex_unlock(&work_stealing_global_sharing.mutex_wait_restart);
-        }
-        pthread_mutex_unlock(&work_stealing_global_sharing.mutex_wait_work);
-        return 0; //not over
-    }
+int work_stealing_wait_for_work(int id){
+    //Park until some work is published or everybody is idle
+    return (termination_wait(&work_stealing_global_sharing.termination, id)
+            == TERMINATION_LAST);
 }
 
 void work_stealing_broadcast(){
-    //Wake up
-    pthread_mutex_lock(&work_stealing_global_sharing.mutex_wait_work);
-    pthread_cond_broadcast(&work_stealing_global_sharing.cond_wait_work);
-    pthread_mutex_unlock(&work_stealing_global_sharing.mutex_wait_work);
+    //Release parked threads
+    termination_release(&work_stealing_global_sharing.termination);
 }
 
 void work_stealing_end(){
-    //Close work stealing state    
-    if(global_state == WS_BUSY){
-        pthread_mutex_lock(&work_stealing_global_sharing.mutex_wait_work);
-        //change state
-        global_state = WS_CLOSED;
-        pthread_cond_broadcast(&work_stealing_global_sharing.cond_wait_work);
-        pthread_mutex_unlock(&work_stealing_global_sharing.mutex_wait_work);
-    }
-}
-
-int work_stealing_barrier(){    
-    //Nobody is idle
-    //work as a barrier
-    pthread_mutex_lock(&work_stealing_global_sharing.mutex_wait_restart);
-    if(global_state == WS_CLOSED){
-        pthread_mutex_unlock(&work_stealing_global_sharing.mutex_wait_restart);
-        return 0;
-    }
-    if(global_state == WS_END){       
-        //change state
-        pthread_cond_wait(&work_stealing_global_sharing.cond_wait_restart,
-                &work_stealing_global_sharing.mutex_wait_restart);
-        //global_state = WS_BUSY;
-    }
-    pthread_mutex_unlock(&work_stealing_global_sharing.mutex_wait_restart);
-    
-    if(work_stealing_wait_for_work()){
-       //work_stealing_busy_state();
-       return 1;
-    }
-    return 0;
-}
-
-void work_stealing_busy_state(){
-    pthread_mutex_lock(&work_stealing_global_sharing.mutex_wait_work);
-    if(global_state == WS_END){
-        //change state
-        global_state = WS_BUSY;
-    }
-    pthread_mutex_unlock(&work_stealing_global_sharing.mutex_wait_work);
+    //Close work stealing state
+    termination_close(&work_stealing_global_sharing.termination);
 }
 
-void work_stealing_close_state(){
-    pthread_mutex_lock(&work_stealing_global_sharing.mutex_wait_work);
-    //change state
-    global_state = WS_CLOSED;
-    pthread_mutex_unlock(&work_stealing_global_sharing.mutex_wait_work);
+int work_stealing_barrier(int id){
+    //Work as a barrier, the last thread to arrive returns 1 and has to call
+    //work_stealing_broadcast to release the others
+    return termination_barrier(&work_stealing_global_sharing.termination, id);
 }
 
-
-void work_stealing_wake_up(){
-    if(work_stealing_global_sharing.number_of_parked_threads > 0)
-        work_stealing_broadcast();
+void work_stealing_wake_up(int id){
+    //Wake up only one thief
+    termination_notify(&work_stealing_global_sharing.termination, id);
 }
 
 int work_stealing_someone_is_idle(){
-    if(work_stealing_global_sharing.number_of_parked_threads > 0)
-        return 1;
-    return 0;
+    return termination_someone_is_idle(&work_stealing_global_sharing.termination);
 }
@@ -44,25 +44,19 @@
 #include "standard_includes.h"
 
 #include "stack.h"
+#include "work_deque.h"
+#include "termination.h"
 
 typedef struct WorkStealingStructureType{
     int number_of_threads;
     /**
-     * Mutex for shared stacks access
+     * Parking and termination detection
      */
-    pthread_mutex_t *mutex_shared_stack;
+    TerminationType termination;
     /**
-     * Mutex for wait signal
+     * Lock-free shared deques, one per thread
      */
-    pthread_cond_t cond_wait_work;
-    pthread_cond_t cond_wait_restart;
-    pthread_mutex_t mutex_wait_work;
-    pthread_mutex_t mutex_wait_restart;
-    /**
-     * Number of threads parked - waiting for work
-     */
-    int number_of_parked_threads;
-    StackType **shared_stacks;
+    WorkDequeType **shared_stacks;
 }WorkStealingType;
 
 /*
@@ -83,14 +77,10 @@ extern void work_stealing_share_work(StackType *stack, int size, int id);
 extern int work_stealing_shared_stack_empty(int id);
 
 /*
- *
- */
-extern void work_stealing_wake_up();
-
-/*
- *
+ * Wakes up one parked thread, if any
+ * @param id
  */
-extern void work_stealing_busy_state();
+extern void work_stealing_wake_up(int id);
 
 /*
  * @param stack
@@ -99,10 +89,10 @@ extern void work_stealing_busy_state();
 extern int work_stealing_get_work(StackType *stack, int id);
 
 /*
- *
+ * @param id
  * @return 1 - Over, all threads are idle 0 - do not know if it is over
  */
-extern int work_stealing_wait_for_work();
+extern int work_stealing_wait_for_work(int id);
 
 /*
  *
@@ -115,9 +105,10 @@ extern void work_stealing_broadcast();
 extern void work_stealing_end();
 
 /*
- *
+ * @param id
+ * @return 1 for the last thread to arrive, it must call work_stealing_broadcast
  */
-extern int work_stealing_barrier();
+extern int work_stealing_barrier(int id);
 
 /*
  *